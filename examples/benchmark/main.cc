@@ -0,0 +1,758 @@
+// Micro benchmarks for tinygltf.
+//
+//   benchmark accessor [count]
+//   benchmark parse [count]
+//   benchmark write [count]
+//   benchmark alloc [count]
+//   benchmark lookup [count]
+//   benchmark transform [count]
+//   benchmark animation [count]
+//   benchmark extras [count]
+//   benchmark objects [count]
+//
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define TINYGLTF_IMPLEMENTATION
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "tiny_gltf.h"
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#if defined(__GLIBC__) && \
+    ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 33)))
+#include <malloc.h>
+#define BENCHMARK_HAS_MALLINFO2
+#endif
+
+// Number of heap allocations through operator new, and of frees.
+static std::atomic<size_t> g_allocations(0);
+static std::atomic<size_t> g_frees(0);
+
+void *operator new(size_t size) {
+  g_allocations++;
+  void *p = malloc(size ? size : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  if (p) g_frees++;
+  free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+  if (p) g_frees++;
+  free(p);
+}
+
+// Peak resident memory in MB, or -1 if unknown.
+static double PeakMemoryMB() {
+#if !defined(_WIN32)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+    return double(usage.ru_maxrss) / (1024.0 * 1024.0);
+#else
+    return double(usage.ru_maxrss) / 1024.0;
+#endif
+  }
+#endif
+  return -1.0;
+}
+
+// Heap memory in use in MB, or -1 if unknown.
+static double HeapInUseMB() {
+#if defined(BENCHMARK_HAS_MALLINFO2)
+  struct mallinfo2 info = mallinfo2();
+  return double(info.uordblks + info.hblkhd) / (1024.0 * 1024.0);
+#else
+  return -1.0;
+#endif
+}
+
+// Runs `fn` `iterations` times, prints and returns the best time.
+static double Measure(const char *name, int iterations,
+                      const std::function<void()> &fn) {
+  double best = 1e30;
+  for (int i = 0; i < iterations; i++) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto end = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    if (ms < best) {
+      best = ms;
+    }
+  }
+  printf("  %-40s %10.3f ms\n", name, best);
+  return best;
+}
+
+// Appends an accessor of `count` elements with filler data.
+static int AddAccessor(tinygltf::Model *model, int component_type, int type,
+                       bool normalized, size_t count) {
+  const size_t size =
+      size_t(tinygltf::GetComponentSizeInBytes(uint32_t(component_type))) *
+      size_t(tinygltf::GetNumComponentsInType(uint32_t(type))) * count;
+
+  tinygltf::Buffer buffer;
+  buffer.data.resize(size);
+  for (size_t i = 0; i < size; i++) {
+    buffer.data[i] = static_cast<unsigned char>(i * 7);
+  }
+  if (component_type == TINYGLTF_COMPONENT_TYPE_FLOAT) {
+    for (size_t i = 0; i < size / 4; i++) {
+      float f = float(i % 1000) * 0.5f;
+      memcpy(&buffer.data[i * 4], &f, 4);
+    }
+  }
+  model->buffers.push_back(buffer);
+
+  tinygltf::BufferView view;
+  view.buffer = int(model->buffers.size() - 1);
+  view.byteLength = size;
+  model->bufferViews.push_back(view);
+
+  tinygltf::Accessor accessor;
+  accessor.bufferView = int(model->bufferViews.size() - 1);
+  accessor.componentType = component_type;
+  accessor.type = type;
+  accessor.normalized = normalized;
+  accessor.count = count;
+  model->accessors.push_back(accessor);
+  return int(model->accessors.size() - 1);
+}
+
+// Element by element conversion, as commonly written in user code.
+template <size_t N>
+static void ScalarReference(const tinygltf::Model &model, int accessor_idx,
+                            std::vector<float> *out) {
+  tinygltf::AccessorView<std::array<float, N> > view(model, accessor_idx);
+  out->resize(view.size() * N);
+  for (size_t i = 0; i < view.size(); i++) {
+    std::array<float, N> v = view[i];
+    for (size_t c = 0; c < N; c++) {
+      (*out)[i * N + c] = v[c];
+    }
+  }
+}
+
+static void BenchmarkAccessor(size_t count) {
+  printf("accessor: %zu elements\n", count);
+
+  tinygltf::Model model;
+  struct Case {
+    const char *name;
+    int component_type;
+    int type;
+    bool normalized;
+  };
+  const Case cases[] = {
+      {"VEC4 UNSIGNED_SHORT normalized", TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
+       TINYGLTF_TYPE_VEC4, true},
+      {"VEC4 UNSIGNED_BYTE normalized", TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE,
+       TINYGLTF_TYPE_VEC4, true},
+      {"VEC4 BYTE normalized", TINYGLTF_COMPONENT_TYPE_BYTE, TINYGLTF_TYPE_VEC4,
+       true},
+      {"VEC4 SHORT(quantized)", TINYGLTF_COMPONENT_TYPE_SHORT,
+       TINYGLTF_TYPE_VEC4, false},
+      {"VEC4 FLOAT", TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_TYPE_VEC4, false},
+  };
+
+  std::vector<float> out;
+  for (const Case &c : cases) {
+    int idx = AddAccessor(&model, c.component_type, c.type, c.normalized, count);
+    printf(" %s\n", c.name);
+    Measure("scalar reference", 5, [&]() { ScalarReference<4>(model, idx, &out); });
+    Measure("UnpackAccessorToFloat", 5, [&]() {
+      tinygltf::UnpackAccessorToFloat(model, idx, &out);
+    });
+  }
+  {
+    int idx = AddAccessor(&model, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
+                          TINYGLTF_TYPE_SCALAR, false, count);
+    std::vector<uint32_t> indices;
+    printf(" SCALAR UNSIGNED_SHORT indices\n");
+    Measure("UnpackAccessorToUint32", 5, [&]() {
+      tinygltf::UnpackAccessorToUint32(model, idx, &indices);
+    });
+  }
+}
+
+// glTF JSON with `count` nodes, accessors and meshes.
+static std::string MakeLargeGltf(size_t count) {
+  std::string s;
+  s += "{\"asset\": {\"version\": \"2.0\"},\n";
+  s += "\"buffers\": [{\"byteLength\": 1024, \"uri\": \"data:application/"
+       "octet-stream;base64,";
+  s += tinygltf::base64_encode(std::vector<unsigned char>(1024, 0).data(),
+                               1024);
+  s += "\"}],\n";
+  s += "\"bufferViews\": [{\"buffer\": 0, \"byteLength\": 1024}],\n";
+
+  s += "\"accessors\": [";
+  for (size_t i = 0; i < count; i++) {
+    s += (i ? ",\n" : "\n");
+    s += "{\"bufferView\": 0, \"componentType\": 5126, \"count\": 2, "
+         "\"type\": \"VEC3\", \"min\": [-1.5, -2.25, -3.0], "
+         "\"max\": [1.5, 2.25, 3.0]}";
+  }
+  s += "],\n\"meshes\": [";
+  for (size_t i = 0; i < count; i++) {
+    s += (i ? ",\n" : "\n");
+    s += "{\"primitives\": [{\"attributes\": {\"POSITION\": " +
+         std::to_string(i) + "}}]}";
+  }
+  s += "],\n\"nodes\": [";
+  for (size_t i = 0; i < count; i++) {
+    s += (i ? ",\n" : "\n");
+    s += "{\"name\": \"node" + std::to_string(i) + "\", \"mesh\": " +
+         std::to_string(i) +
+         ", \"translation\": [1.0, 2.0, 3.0], \"rotation\": [0.0, 0.0, 0.0, "
+         "1.0], \"extras\": {\"id\": " +
+         std::to_string(i) + "}}";
+  }
+  s += "],\n\"scenes\": [{\"nodes\": [0]}], \"scene\": 0}\n";
+  return s;
+}
+
+static void BenchmarkParse(size_t count) {
+  const std::string gltf = MakeLargeGltf(count);
+  printf("parse: %zu nodes/accessors/meshes, %.1f MB of JSON\n", count,
+         double(gltf.size()) / (1024.0 * 1024.0));
+
+  // Streaming first, so the peak memory of the DOM parse does not hide it.
+  const bool modes[] = {true, false};
+  for (bool streaming : modes) {
+    tinygltf::TinyGLTF ctx;
+    ctx.SetStreamingJsonParse(streaming);
+    Measure(streaming ? "streaming(SAX)" : "DOM", 3, [&]() {
+      tinygltf::Model model;
+      std::string err;
+      std::string warn;
+      if (!ctx.LoadASCIIFromString(&model, &err, &warn, gltf.c_str(),
+                                   gltf.size(), "")) {
+        printf("Failed to parse: %s\n", err.c_str());
+      }
+    });
+    printf("  %-40s %10.1f MB\n", "peak memory so far", PeakMemoryMB());
+  }
+}
+
+static void BenchmarkWrite(size_t count) {
+  tinygltf::Model model;
+  {
+    const std::string gltf = MakeLargeGltf(count);
+    tinygltf::TinyGLTF ctx;
+    std::string err;
+    std::string warn;
+    if (!ctx.LoadASCIIFromString(&model, &err, &warn, gltf.c_str(),
+                                 gltf.size(), "")) {
+      printf("Failed to parse: %s\n", err.c_str());
+      return;
+    }
+  }
+  printf("write: %zu nodes/accessors/meshes\n", count);
+
+  // Direct writer first, so the peak memory of the DOM does not hide it.
+  const bool modes[] = {true, false};
+  for (bool direct : modes) {
+    tinygltf::TinyGLTF ctx;
+    ctx.SetDirectJsonWriter(direct);
+    size_t size = 0;
+    Measure(direct ? "direct writer" : "DOM", 3, [&]() {
+      std::stringstream ss;
+      if (!ctx.WriteGltfSceneToStream(&model, ss, false, false)) {
+        printf("Failed to write\n");
+      }
+      size = size_t(ss.tellp());
+    });
+    printf("  %-40s %10.1f MB\n", "output", double(size) / (1024.0 * 1024.0));
+    printf("  %-40s %10.1f MB\n", "peak memory so far", PeakMemoryMB());
+  }
+}
+
+static void BenchmarkAlloc(size_t count) {
+  const std::string gltf = MakeLargeGltf(count);
+#ifdef TINYGLTF_USE_ARENA
+  printf("alloc: %zu nodes/accessors/meshes(TINYGLTF_USE_ARENA)\n", count);
+#else
+  printf("alloc: %zu nodes/accessors/meshes\n", count);
+#endif
+
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+  for (int i = 0; i < 3; i++) {
+    tinygltf::Model *model = new tinygltf::Model();
+    const size_t before = g_allocations;
+    auto start = std::chrono::steady_clock::now();
+    if (!ctx.LoadASCIIFromString(model, &err, &warn, gltf.c_str(), gltf.size(),
+                                 "")) {
+      printf("Failed to parse: %s\n", err.c_str());
+    }
+    auto loaded = std::chrono::steady_clock::now();
+    const size_t allocations = g_allocations - before;
+    const size_t frees_before = g_frees;
+    delete model;
+    auto end = std::chrono::steady_clock::now();
+    const size_t frees = g_frees - frees_before;
+    printf("  %-40s %10.3f ms\n", "load",
+           std::chrono::duration<double, std::milli>(loaded - start).count());
+    printf("  %-40s %10.3f ms\n", "destroy",
+           std::chrono::duration<double, std::milli>(end - loaded).count());
+    printf("  %-40s %10zu (%.1f per element)\n", "allocations during load",
+           allocations, double(allocations) / double(count));
+    printf("  %-40s %10zu (%.1f per element)\n", "frees during destroy",
+           frees, double(frees) / double(count));
+  }
+}
+
+// Looks up the attributes of `count` primitives.
+template <typename Map>
+static void MeasureLookup(const char *name, size_t count) {
+  const char *keys[] = {"POSITION",   "NORMAL",  "TANGENT", "TEXCOORD_0",
+                        "TEXCOORD_1", "COLOR_0", "JOINTS_0", "WEIGHTS_0"};
+  std::vector<Map> maps(count);
+  for (size_t i = 0; i < count; i++) {
+    for (int k = 0; k < 8; k++) {
+      maps[i][keys[k]] = int(i) + k;
+    }
+  }
+
+  int64_t sum = 0;
+  Measure(name, 5, [&]() {
+    for (size_t i = 0; i < count; i++) {
+      auto it = maps[i].find("POSITION");
+      if (it != maps[i].end()) sum += it->second;
+      it = maps[i].find("NORMAL");
+      if (it != maps[i].end()) sum += it->second;
+      it = maps[i].find("TEXCOORD_0");
+      if (it != maps[i].end()) sum += it->second;
+      it = maps[i].find("WEIGHTS_0");
+      if (it != maps[i].end()) sum += it->second;
+    }
+  });
+  if (sum == 0) {
+    printf("Unexpected sum\n");
+  }
+}
+
+static void BenchmarkLookup(size_t count) {
+  printf("lookup: %zu primitives with 8 attributes, 4 lookups each\n", count);
+  MeasureLookup<std::map<std::string, int> >("std::map", count);
+  MeasureLookup<tinygltf::FlatMap<std::string, int> >("FlatMap", count);
+#ifdef TINYGLTF_USE_STRING_INTERNING
+  {
+    // Keys share the strings of one pool, like the keys of loaded models.
+    std::shared_ptr<tinygltf::StringPool> pool =
+        std::make_shared<tinygltf::StringPool>();
+    tinygltf::StringPool::Scope scope(pool.get());
+    MeasureLookup<tinygltf::FlatMap<tinygltf::InternedString, int> >(
+        "FlatMap<InternedString>", count);
+  }
+#endif
+
+  const std::string gltf = MakeLargeGltf(count);
+  tinygltf::TinyGLTF ctx;
+#if defined(TINYGLTF_USE_STRING_INTERNING)
+  const char *load_name = "load(TINYGLTF_USE_STRING_INTERNING)";
+#elif defined(TINYGLTF_USE_FLAT_MAP)
+  const char *load_name = "load(TINYGLTF_USE_FLAT_MAP)";
+#else
+  const char *load_name = "load(std::map)";
+#endif
+  Measure(load_name, 3, [&]() {
+    tinygltf::Model model;
+    std::string err;
+    std::string warn;
+    if (!ctx.LoadASCIIFromString(&model, &err, &warn, gltf.c_str(),
+                                 gltf.size(), "")) {
+      printf("Failed to parse: %s\n", err.c_str());
+    }
+  });
+  printf("  %-40s %10.1f MB\n", "peak memory so far", PeakMemoryMB());
+}
+
+static void BenchmarkTransform(size_t count) {
+  printf("transform: %zu nodes with translation/rotation/scale\n", count);
+  tinygltf::Model model;
+  model.nodes.resize(count);
+  for (size_t i = 0; i < count; i++) {
+    tinygltf::Node &node = model.nodes[i];
+    node.translation = {double(i), 2.0, 3.0};
+    node.rotation = {0.0, 0.0, 0.0, 1.0};
+    node.scale = {1.0, 1.0, 1.0};
+  }
+
+  std::vector<float> matrices(count * 16);
+  Measure("local matrices from Node", 5, [&]() {
+    for (size_t i = 0; i < count; i++) {
+      const tinygltf::Node &node = model.nodes[i];
+      tinygltf::NodeTransform<float> xform;
+      for (size_t k = 0; k < node.translation.size(); k++) {
+        xform.translation[k] = float(node.translation[k]);
+      }
+      for (size_t k = 0; k < node.rotation.size(); k++) {
+        xform.rotation[k] = float(node.rotation[k]);
+      }
+      for (size_t k = 0; k < node.scale.size(); k++) {
+        xform.scale[k] = float(node.scale[k]);
+      }
+      xform.LocalMatrix(&matrices[i * 16]);
+    }
+  });
+
+  std::vector<tinygltf::NodeTransform<float> > xforms;
+  Measure("BuildNodeTransforms<float>", 5,
+          [&]() { tinygltf::BuildNodeTransforms(model, &xforms); });
+  Measure("local matrices from NodeTransform", 5, [&]() {
+    for (size_t i = 0; i < count; i++) {
+      xforms[i].LocalMatrix(&matrices[i * 16]);
+    }
+  });
+
+  // Groups of 10 nodes, each a root with 9 children.
+  model.scenes.resize(1);
+  for (size_t i = 0; i < count; i++) {
+    if (i % 10 == 0) {
+      model.scenes[0].nodes.push_back(int(i));
+    } else {
+      model.nodes[i - i % 10].children.push_back(int(i));
+    }
+  }
+  tinygltf::SceneTransforms<float> scene;
+  Measure("SceneTransforms::Build", 5, [&]() { scene.Build(model, 0); });
+  Measure("SceneTransforms::Update(1% of roots)", 5, [&]() {
+    for (size_t i = 0; i < count; i += 1000) {
+      scene.MarkDirty(int(i));
+    }
+    scene.Update();
+  });
+}
+
+// Appends a float accessor with `values`.
+static int AddFloatAccessor(tinygltf::Model *model,
+                            const std::vector<float> &values, int type) {
+  tinygltf::Buffer buffer;
+  buffer.data.resize(values.size() * sizeof(float));
+  memcpy(buffer.data.data(), values.data(), buffer.data.size());
+  model->buffers.push_back(buffer);
+
+  tinygltf::BufferView view;
+  view.buffer = int(model->buffers.size() - 1);
+  view.byteLength = buffer.data.size();
+  model->bufferViews.push_back(view);
+
+  tinygltf::Accessor accessor;
+  accessor.bufferView = int(model->bufferViews.size() - 1);
+  accessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+  accessor.type = type;
+  accessor.count =
+      values.size() / size_t(tinygltf::GetNumComponentsInType(uint32_t(type)));
+  model->accessors.push_back(accessor);
+  return int(model->accessors.size() - 1);
+}
+
+static void BenchmarkAnimation(size_t count) {
+  // A character: 60 joints with translation/rotation/scale channels and 100
+  // keyframes.
+  const size_t joints = 60;
+  const size_t keys = 100;
+  tinygltf::Model model;
+  model.nodes.resize(joints);
+  model.animations.resize(1);
+  std::vector<float> times(keys);
+  for (size_t k = 0; k < keys; k++) {
+    times[k] = float(k) / 30.0f;
+  }
+  const int input = AddFloatAccessor(&model, times, TINYGLTF_TYPE_SCALAR);
+  const char *paths[] = {"translation", "rotation", "scale"};
+  for (size_t j = 0; j < joints; j++) {
+    for (int p = 0; p < 3; p++) {
+      const size_t n = (p == 1) ? 4 : 3;
+      std::vector<float> values(keys * n);
+      for (size_t i = 0; i < values.size(); i++) {
+        values[i] = float((i + j) % 7) * 0.1f;
+      }
+      tinygltf::AnimationSampler sampler;
+      sampler.input = input;
+      sampler.output = AddFloatAccessor(
+          &model, values, (n == 4) ? TINYGLTF_TYPE_VEC4 : TINYGLTF_TYPE_VEC3);
+      model.animations[0].samplers.push_back(sampler);
+      tinygltf::AnimationChannel channel;
+      channel.sampler = int(model.animations[0].samplers.size() - 1);
+      channel.target_node = int(j);
+      channel.target_path = paths[p];
+      model.animations[0].channels.push_back(channel);
+    }
+  }
+
+  tinygltf::AnimationEvaluator anim;
+  std::string err;
+  if (!anim.Init(model, 0, &err)) {
+    printf("Failed to init: %s\n", err.c_str());
+    return;
+  }
+  printf("animation: %zu instances of %zu joints, 3 channels, %zu keyframes\n",
+         count, joints, keys);
+
+  std::vector<tinygltf::NodeTransform<float> > pose;
+  tinygltf::BuildNodeTransforms(model, &pose);
+  std::vector<std::vector<tinygltf::NodeTransform<float> > > poses(count, pose);
+  std::vector<tinygltf::AnimationCursor> cursors(count);
+  std::vector<float> instance_times(count);
+  for (size_t i = 0; i < count; i++) {
+    instance_times[i] = float(i % 97) / 30.0f;
+  }
+
+  // One frame of playback(1/60s) per evaluation.
+  auto advance = [&]() {
+    for (size_t i = 0; i < count; i++) {
+      instance_times[i] += 1.0f / 60.0f;
+      if (instance_times[i] > anim.EndTime()) {
+        instance_times[i] = 0.0f;
+      }
+    }
+  };
+  Measure("cached cursors", 10, [&]() {
+    advance();
+    anim.Evaluate(count, instance_times.data(), cursors.data(), poses.data());
+  });
+  Measure("fresh cursors(binary search)", 10, [&]() {
+    advance();
+    std::vector<tinygltf::AnimationCursor> fresh(count);
+    anim.Evaluate(count, instance_times.data(), fresh.data(), poses.data());
+  });
+  Measure("cached cursors, all threads", 10, [&]() {
+    advance();
+    anim.Evaluate(count, instance_times.data(), cursors.data(), poses.data(),
+                  nullptr, 0);
+  });
+}
+
+static void BenchmarkExtras(size_t count) {
+  std::string s = "{\"asset\": {\"version\": \"2.0\"}, \"nodes\": [";
+  for (size_t i = 0; i < count; i++) {
+    const std::string id = std::to_string(i);
+    s += (i ? ",\n" : "\n");
+    s += "{\"name\": \"node" + id +
+         "\", \"extras\": {\"id\": " + id +
+         ", \"part\": \"assembly-" + id +
+         "-with-a-long-part-number\", \"weight\": 0.25, \"visible\": true, "
+         "\"tags\": [\"metal\", \"painted\", \"outdoor\"], "
+         "\"lod\": {\"level\": 2, \"distance\": 15.5, \"offset\": -3}}}";
+  }
+  s += "]}\n";
+  printf("extras: %zu nodes with extras, sizeof(Value) = %zu\n", count,
+         sizeof(tinygltf::Value));
+
+  auto load = [&](const char *label, bool lazy) {
+    tinygltf::TinyGLTF ctx;
+    ctx.SetLazyExtrasAndExtensions(lazy);
+    std::string err;
+    std::string warn;
+    const double before = HeapInUseMB();
+    tinygltf::Model model;
+    auto start = std::chrono::steady_clock::now();
+    if (!ctx.LoadASCIIFromString(&model, &err, &warn, s.c_str(), s.size(),
+                                 "")) {
+      printf("Failed to parse: %s\n", err.c_str());
+      return;
+    }
+    auto end = std::chrono::steady_clock::now();
+    const double used = HeapInUseMB() - before;
+    printf("%s\n", label);
+    printf("  %-40s %10.3f ms\n", "load",
+           std::chrono::duration<double, std::milli>(end - start).count());
+    printf("  %-40s %10.1f MB\n", "heap used by the model", used);
+    printf("  %-40s %10.1f bytes\n", "per node",
+           used * 1024.0 * 1024.0 / double(count));
+    if (lazy) {
+      // Typical access pattern: extras of a few objects.
+      tinygltf::Value extras;
+      start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < count; i += 100) {
+        model.nodes[i].lazy_extras.GetExtras(&extras);
+      }
+      end = std::chrono::steady_clock::now();
+      printf("  %-40s %10.3f ms\n", "materialize 1% of the extras",
+             std::chrono::duration<double, std::milli>(end - start).count());
+    }
+  };
+  load("eager", false);
+  load("lazy(SetLazyExtrasAndExtensions)", true);
+}
+
+// glTF with `count` elements of the top level array `section`, each built
+// by `element`. Minimal other sections make the elements valid.
+static std::string MakeSectionGltf(
+    const char *section, size_t count,
+    const std::function<std::string(size_t)> &element) {
+  std::string s = "{\"asset\": {\"version\": \"2.0\"},\n";
+  s += "\"buffers\": [{\"byteLength\": 1024, \"uri\": \"data:application/"
+       "octet-stream;base64,";
+  s += tinygltf::base64_encode(std::vector<unsigned char>(1024, 0).data(),
+                               1024);
+  s += "\"}],\n";
+  if (strcmp(section, "bufferViews") != 0) {
+    s += "\"bufferViews\": [{\"buffer\": 0, \"byteLength\": 1024}],\n";
+  }
+  if (strcmp(section, "accessors") != 0) {
+    s += "\"accessors\": [{\"bufferView\": 0, \"componentType\": 5126, "
+         "\"count\": 2, \"type\": \"VEC3\"}],\n";
+  }
+  if (strcmp(section, "materials") != 0) {
+    s += "\"materials\": [{}],\n";
+  }
+  s += "\"" + std::string(section) + "\": [";
+  for (size_t i = 0; i < count; i++) {
+    s += (i ? ",\n" : "\n");
+    s += element(i);
+  }
+  s += "]}\n";
+  return s;
+}
+
+// Load time per glTF object type, split into the JSON parse and the
+// conversion of the JSON into tinygltf objects.
+static void BenchmarkObjects(size_t count) {
+  struct Section {
+    const char *name;
+    std::function<std::string(size_t)> element;
+  };
+  const Section sections[] = {
+      {"nodes",
+       [](size_t i) {
+         return "{\"name\": \"node" + std::to_string(i) +
+                "\", \"translation\": [1.0, 2.0, 3.0], \"rotation\": [0.0, "
+                "0.0, 0.0, 1.0], \"scale\": [2.0, 2.0, 2.0]}";
+       }},
+      {"accessors",
+       [](size_t) {
+         return std::string(
+             "{\"bufferView\": 0, \"byteOffset\": 0, \"componentType\": 5126, "
+             "\"count\": 2, \"type\": \"VEC3\", \"min\": [-1.5, -2.25, -3.0], "
+             "\"max\": [1.5, 2.25, 3.0]}");
+       }},
+      {"bufferViews",
+       [](size_t) {
+         return std::string(
+             "{\"buffer\": 0, \"byteOffset\": 0, \"byteLength\": 1024, "
+             "\"byteStride\": 12, \"target\": 34962}");
+       }},
+      {"meshes",
+       [](size_t i) {
+         return "{\"name\": \"mesh" + std::to_string(i) +
+                "\", \"primitives\": [{\"attributes\": {\"POSITION\": 0, "
+                "\"NORMAL\": 0}, \"indices\": 0, \"material\": 0, \"mode\": "
+                "4}]}";
+       }},
+      {"materials",
+       [](size_t i) {
+         return "{\"name\": \"material" + std::to_string(i) +
+                "\", \"pbrMetallicRoughness\": {\"baseColorFactor\": [1.0, "
+                "0.5, 0.25, 1.0], \"metallicFactor\": 0.5, "
+                "\"roughnessFactor\": 0.25}, \"alphaMode\": \"MASK\", "
+                "\"alphaCutoff\": 0.25, \"doubleSided\": true}";
+       }},
+  };
+
+  for (const Section &section : sections) {
+    const std::string gltf =
+        MakeSectionGltf(section.name, count, section.element);
+    printf("objects: %zu %s, %.1f MB of JSON\n", count, section.name,
+           double(gltf.size()) / (1024.0 * 1024.0));
+
+#if defined(TINYGLTF_USE_SIMDJSON)
+    const double parse = Measure("JSON parse", 3, [&]() {
+      simdjson::dom::parser parser;
+      simdjson::dom::element root;
+      if (parser.parse(gltf).get(root) != simdjson::SUCCESS) {
+        printf("Failed to parse JSON\n");
+      }
+    });
+#elif !defined(TINYGLTF_USE_RAPIDJSON)
+    const double parse = Measure("JSON parse", 3, [&]() {
+      nlohmann::json j = nlohmann::json::parse(gltf.begin(), gltf.end());
+    });
+#endif
+    tinygltf::TinyGLTF ctx;
+    const double load = Measure("load", 3, [&]() {
+      tinygltf::Model model;
+      std::string err;
+      std::string warn;
+      if (!ctx.LoadASCIIFromString(&model, &err, &warn, gltf.c_str(),
+                                   gltf.size(), "")) {
+        printf("Failed to parse: %s\n", err.c_str());
+      }
+    });
+#ifndef TINYGLTF_USE_RAPIDJSON
+    printf("  %-40s %10.1f MB/s\n", "JSON parse throughput",
+           double(gltf.size()) / (1024.0 * 1024.0) / (parse / 1000.0));
+    printf("  %-40s %10.3f ms\n", "conversion(load - JSON parse)",
+           load - parse);
+#else
+    (void)load;
+#endif
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    printf(
+        "Usage: benchmark "
+        "accessor|parse|write|alloc|lookup|transform|animation|extras|"
+        "objects "
+        "[count]\n");
+    return EXIT_FAILURE;
+  }
+
+  const std::string mode = argv[1];
+  if (mode == "accessor") {
+    size_t count = (argc > 2) ? size_t(atol(argv[2])) : 4 * 1024 * 1024;
+    BenchmarkAccessor(count);
+  } else if (mode == "parse") {
+    size_t count = (argc > 2) ? size_t(atol(argv[2])) : 500 * 1000;
+    BenchmarkParse(count);
+  } else if (mode == "write") {
+    size_t count = (argc > 2) ? size_t(atol(argv[2])) : 500 * 1000;
+    BenchmarkWrite(count);
+  } else if (mode == "alloc") {
+    size_t count = (argc > 2) ? size_t(atol(argv[2])) : 100 * 1000;
+    BenchmarkAlloc(count);
+  } else if (mode == "lookup") {
+    size_t count = (argc > 2) ? size_t(atol(argv[2])) : 100 * 1000;
+    BenchmarkLookup(count);
+  } else if (mode == "transform") {
+    size_t count = (argc > 2) ? size_t(atol(argv[2])) : 500 * 1000;
+    BenchmarkTransform(count);
+  } else if (mode == "animation") {
+    size_t count = (argc > 2) ? size_t(atol(argv[2])) : 5000;
+    BenchmarkAnimation(count);
+  } else if (mode == "extras") {
+    size_t count = (argc > 2) ? size_t(atol(argv[2])) : 200 * 1000;
+    BenchmarkExtras(count);
+  } else if (mode == "objects") {
+    size_t count = (argc > 2) ? size_t(atol(argv[2])) : 1000 * 1000;
+    BenchmarkObjects(count);
+  } else {
+    printf("Unknown mode: %s\n", mode.c_str());
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -167,7 +167,7 @@ static std::string PrintFilterMode(int mode) {
   return "**UNKNOWN**";
 }
 
-static std::string PrintIntArray(const std::vector<int> &arr) {
+static std::string PrintIntArray(const tinygltf::ModelVector<int> &arr) {
   if (arr.size() == 0) {
     return "";
   }
@@ -185,7 +185,8 @@ static std::string PrintIntArray(const std::vector<int> &arr) {
   return ss.str();
 }
 
-static std::string PrintFloatArray(const std::vector<double> &arr) {
+static std::string PrintFloatArray(
+    const tinygltf::ModelVector<double> &arr) {
   if (arr.size() == 0) {
     return "";
   }
@@ -314,9 +315,9 @@ static void DumpNode(const tinygltf::Node &node, int indent) {
             << "children    : " << PrintIntArray(node.children) << std::endl;
 }
 
-static void DumpStringIntMap(const std::map<std::string, int> &m, int indent) {
-  std::map<std::string, int>::const_iterator it(m.begin());
-  std::map<std::string, int>::const_iterator itEnd(m.end());
+static void DumpStringIntMap(const tinygltf::StringMap<int> &m, int indent) {
+  tinygltf::StringMap<int>::const_iterator it(m.begin());
+  tinygltf::StringMap<int>::const_iterator itEnd(m.end());
   for (; it != itEnd; it++) {
     std::cout << Indent(indent) << it->first << ": " << it->second << std::endl;
   }
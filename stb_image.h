@@ -46,6 +46,12 @@ LICENSE
 
   See end of file for license information.
 
+LOCAL PATCHES (tinygltf):
+
+      stbi__g_failure_reason is thread-local(STBI_THREAD_LOCAL, backported
+      from stb_image 2.23) so that images can be decoded on several threads
+      at once. Keep this when updating this file to a release older than 2.23.
+
 RECENT REVISION HISTORY:
 
       2.21  (2019-02-25) fix typo in comment
@@ -869,8 +875,26 @@ static void    *stbi__pnm_load(stbi__context *s, int *x, int *y, int *comp, int
 static int      stbi__pnm_info(stbi__context *s, int *x, int *y, int *comp);
 #endif
 
-// this is not threadsafe
-static const char *stbi__g_failure_reason;
+#ifndef STBI_NO_THREAD_LOCALS
+   #if defined(__cplusplus) &&  __cplusplus >= 201103L
+      #define STBI_THREAD_LOCAL       thread_local
+   #elif defined (__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+      #define STBI_THREAD_LOCAL       _Thread_local
+   #elif defined(__GNUC__)
+      #define STBI_THREAD_LOCAL       __thread
+   #elif defined(_MSC_VER)
+      #define STBI_THREAD_LOCAL       __declspec(thread)
+   #endif
+#endif
+
+#ifndef STBI_THREAD_LOCAL
+   #define STBI_THREAD_LOCAL
+#endif
+
+// tinygltf local patch(see LOCAL PATCHES at the top of this file), backported
+// from stb_image 2.23: thread-local, so concurrent decodes don't race on the
+// failure reason
+static STBI_THREAD_LOCAL const char *stbi__g_failure_reason;
 
 STBIDEF const char *stbi_failure_reason(void)
 {
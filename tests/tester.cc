@@ -9,13 +9,27 @@
 #define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() - only do this in one cpp file
 #include "catch.hpp"
 
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cassert>
 #include <iostream>
+#include <set>
 #include <sstream>
 #include <fstream>
 
+// Path of `name` in the temporary directory, for the files written by tests.
+static std::string TempPath(const char *name) {
+  const char *dir = std::getenv("TMPDIR");
+#ifdef _WIN32
+  if (!dir) dir = std::getenv("TEMP");
+  if (!dir) dir = ".";
+#else
+  if (!dir) dir = "/tmp";
+#endif
+  return std::string(dir) + "/" + name;
+}
+
 static JsonDocument JsonConstruct(const char* str)
 {
   JsonDocument doc;
@@ -74,13 +88,13 @@ TEST_CASE("extension-with-empty-object", "[issue-97]") {
 
   // TODO(syoyo): create temp directory.
   {
-    ret = ctx.WriteGltfSceneToFile(&model, "issue-97.gltf", true, true);
+    ret = ctx.WriteGltfSceneToFile(&model, TempPath("issue-97.gltf"), true, true);
     REQUIRE(true == ret);
 
     tinygltf::Model m;
 
     // read back serialized glTF
-    bool ret = ctx.LoadASCIIFromFile(&m, &err, &warn, "issue-97.gltf");
+    bool ret = ctx.LoadASCIIFromFile(&m, &err, &warn, TempPath("issue-97.gltf"));
     if (!err.empty()) {
       std::cerr << err << std::endl;
     }
@@ -127,13 +141,13 @@ TEST_CASE("extension-overwrite", "[issue-261]") {
 
   // TODO(syoyo): create temp directory.
   {
-    ret = ctx.WriteGltfSceneToFile(&model, "issue-261.gltf", true, true);
+    ret = ctx.WriteGltfSceneToFile(&model, TempPath("issue-261.gltf"), true, true);
     REQUIRE(true == ret);
 
     tinygltf::Model m;
 
     // read back serialized glTF
-    bool ret = ctx.LoadASCIIFromFile(&m, &err, &warn, "issue-261.gltf");
+    bool ret = ctx.LoadASCIIFromFile(&m, &err, &warn, TempPath("issue-261.gltf"));
     if (!err.empty()) {
       std::cerr << err << std::endl;
     }
@@ -482,3 +496,2359 @@ TEST_CASE("expandpath-utf-8", "[pr-226]") {
 
 }
 #endif
+
+TEST_CASE("zero-copy-glb-buffer", "[glb]") {
+
+  std::ifstream ifs("../models/SparseMorphTargets-issue280/singleBlendshapeCube_sparse.glb", std::ios::binary);
+  REQUIRE(ifs.good());
+  std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(ifs)),
+                                   std::istreambuf_iterator<char>());
+
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+
+  tinygltf::Model copied;
+  bool ret = ctx.LoadBinaryFromMemory(&copied, &err, &warn, bytes.data(),
+                                      static_cast<unsigned int>(bytes.size()));
+  REQUIRE(true == ret);
+  REQUIRE(1 == copied.buffers.size());
+  REQUIRE(nullptr == copied.buffers[0].view_data);
+  REQUIRE(1016 == copied.buffers[0].data.size());
+
+  ctx.SetZeroCopyBinaryBuffer(true);
+  REQUIRE(true == ctx.GetZeroCopyBinaryBuffer());
+
+  tinygltf::Model model;
+  ret = ctx.LoadBinaryFromMemory(&model, &err, &warn, bytes.data(),
+                                 static_cast<unsigned int>(bytes.size()));
+  REQUIRE(true == ret);
+  REQUIRE(1 == model.buffers.size());
+
+  const tinygltf::Buffer &buffer = model.buffers[0];
+  REQUIRE(buffer.data.empty());
+  REQUIRE(1016 == buffer.DataSize());
+  // Points into the BIN chunk of `bytes`.
+  REQUIRE(buffer.DataPtr() > bytes.data());
+  REQUIRE(buffer.DataPtr() + buffer.DataSize() <= bytes.data() + bytes.size());
+
+  REQUIRE(copied.buffers[0] == buffer);
+
+  // Serialized contents must match the copying path.
+  std::stringstream os_copied;
+  std::stringstream os;
+  REQUIRE(ctx.WriteGltfSceneToStream(&copied, os_copied, false, true));
+  REQUIRE(ctx.WriteGltfSceneToStream(&model, os, false, true));
+  REQUIRE(os_copied.str() == os.str());
+}
+
+#ifndef TINYGLTF_NO_FS
+TEST_CASE("mmap-buffers", "[fs]") {
+
+  tinygltf::FsCallbacks fs = {&tinygltf::FileExists, &tinygltf::ExpandFilePath,
+                              &tinygltf::ReadWholeFile,
+                              &tinygltf::WriteWholeFile, nullptr,
+                              &tinygltf::MapWholeFile};
+
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+
+  // GLB: the BIN chunk is referenced from the mapped file.
+  {
+    tinygltf::Model read;
+    bool ret = ctx.LoadBinaryFromFile(&read, &err, &warn, "../models/SparseMorphTargets-issue280/singleBlendshapeCube_sparse.glb");
+    REQUIRE(true == ret);
+
+    ctx.SetFsCallbacks(fs);
+    tinygltf::Model mapped;
+    ret = ctx.LoadBinaryFromFile(&mapped, &err, &warn, "../models/SparseMorphTargets-issue280/singleBlendshapeCube_sparse.glb");
+    REQUIRE(true == ret);
+    REQUIRE(1 == mapped.buffers.size());
+    REQUIRE(mapped.buffers[0].data.empty());
+    REQUIRE(nullptr != mapped.buffers[0].view_data);
+    REQUIRE(nullptr != mapped.buffers[0].view_owner);
+    REQUIRE(read.buffers[0] == mapped.buffers[0]);
+  }
+
+  // glTF: external .bin is mapped.
+  {
+    tinygltf::Model mapped;
+    bool ret = ctx.LoadASCIIFromFile(&mapped, &err, &warn, "../models/Cube/Cube.gltf");
+    REQUIRE(true == ret);
+    REQUIRE(1 == mapped.buffers.size());
+    REQUIRE(mapped.buffers[0].data.empty());
+    REQUIRE(nullptr != mapped.buffers[0].view_owner);
+
+    // Copies share the mapping.
+    tinygltf::Buffer copy = mapped.buffers[0];
+    mapped = tinygltf::Model();
+    REQUIRE(nullptr != copy.view_owner);
+
+    std::ifstream ifs("../models/Cube/Cube.bin", std::ios::binary);
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(ifs)),
+                                     std::istreambuf_iterator<char>());
+    REQUIRE(bytes.size() == copy.DataSize());
+    REQUIRE(0 == memcmp(bytes.data(), copy.DataPtr(), bytes.size()));
+  }
+
+  // Missing file.
+  {
+    tinygltf::Model mapped;
+    bool ret = ctx.LoadBinaryFromFile(&mapped, &err, &warn, "../models/not-found.glb");
+    REQUIRE(false == ret);
+  }
+}
+#endif
+
+TEST_CASE("glb-bin-chunk-bounds", "[bounds-checking]") {
+
+  std::ifstream ifs("../models/SparseMorphTargets-issue280/singleBlendshapeCube_sparse.glb", std::ios::binary);
+  REQUIRE(ifs.good());
+  std::string bytes((std::istreambuf_iterator<char>(ifs)),
+                    std::istreambuf_iterator<char>());
+
+  // byteLength exceeds the BIN chunk data(1016 bytes) but not the chunk
+  // including its 8 bytes header.
+  size_t pos = bytes.find("\"byteLength\": 1016");
+  REQUIRE(std::string::npos != pos);
+  bytes.replace(pos, strlen("\"byteLength\": 1016"), "\"byteLength\": 1020");
+
+  tinygltf::Model model;
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+
+  const size_t size = bytes.size();  // size_t entry point
+  bool ret = ctx.LoadBinaryFromMemory(
+      &model, &err, &warn, reinterpret_cast<const unsigned char *>(bytes.data()),
+      size);
+  REQUIRE_FALSE(ret);
+  REQUIRE_THAT(err, Catch::Contains("Invalid `byteLength'"));
+}
+
+TEST_CASE("glb-bin-chunk-type", "[glb]") {
+
+  std::ifstream ifs("../models/SparseMorphTargets-issue280/singleBlendshapeCube_sparse.glb", std::ios::binary);
+  REQUIRE(ifs.good());
+  std::string bytes((std::istreambuf_iterator<char>(ifs)),
+                    std::istreambuf_iterator<char>());
+
+  tinygltf::Model model;
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+  REQUIRE(ctx.LoadBinaryFromMemory(
+      &model, &err, &warn,
+      reinterpret_cast<const unsigned char *>(bytes.data()), bytes.size()));
+
+  // The second chunk is not used as the BIN chunk unless its type is BIN.
+  uint32_t json_length;
+  memcpy(&json_length, bytes.data() + 12, 4);
+  const size_t chunk_type = 20 + json_length + 4;
+  REQUIRE(0 == bytes.compare(chunk_type, 4, std::string("BIN\0", 4)));
+  bytes.replace(chunk_type, 4, std::string("XYZ\0", 4));
+
+  err.clear();
+  REQUIRE_FALSE(ctx.LoadBinaryFromMemory(
+      &model, &err, &warn,
+      reinterpret_cast<const unsigned char *>(bytes.data()), bytes.size()));
+  REQUIRE_THAT(err, Catch::Contains("Invalid binary data"));
+}
+
+TEST_CASE("glb-write-4gb-limit", "[glb]") {
+
+  // Only the size of the buffer matters, its contents are never read.
+  const unsigned char dummy[4] = {0, 0, 0, 0};
+
+  tinygltf::Model model;
+  tinygltf::Buffer buffer;
+  buffer.view_data = dummy;
+  buffer.view_size = size_t((std::numeric_limits<uint32_t>::max)());
+  model.buffers.push_back(buffer);
+
+  tinygltf::TinyGLTF ctx;
+  std::stringstream os;
+  if (sizeof(size_t) > 4) {
+    // Can't be split into an external file when writing to a stream.
+    REQUIRE_FALSE(ctx.WriteGltfSceneToStream(&model, os, false, true));
+    REQUIRE(os.str().empty());
+  }
+}
+
+TEST_CASE("glb-write-bin-chunk", "[glb]") {
+
+  // BIN chunk is written straight from the (zero-copy) buffer, padded to 4.
+  const unsigned char data[6] = {1, 2, 3, 4, 5, 6};
+
+  tinygltf::Model model;
+  model.asset.version = "2.0";
+  tinygltf::Buffer buffer;
+  buffer.view_data = data;
+  buffer.view_size = sizeof(data);
+  model.buffers.push_back(buffer);
+
+  tinygltf::TinyGLTF ctx;
+  std::stringstream os;
+  REQUIRE(ctx.WriteGltfSceneToStream(&model, os, false, true));
+  const std::string glb = os.str();
+  REQUIRE(0 == (glb.size() % 4));
+  REQUIRE(0 == glb.compare(glb.size() - 8, 8,
+                           std::string("\x01\x02\x03\x04\x05\x06\x00\x00", 8)));
+
+  tinygltf::Model loaded;
+  std::string err;
+  std::string warn;
+  REQUIRE(ctx.LoadBinaryFromMemory(
+      &loaded, &err, &warn, reinterpret_cast<const unsigned char *>(glb.data()),
+      static_cast<unsigned int>(glb.size())));
+  REQUIRE(1 == loaded.buffers.size());
+  REQUIRE(sizeof(data) == loaded.buffers[0].DataSize());
+  REQUIRE(0 == memcmp(data, loaded.buffers[0].DataPtr(), sizeof(data)));
+}
+
+TEST_CASE("pack-glb-buffers", "[glb]") {
+
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+  ctx.SetDeferImageDecoding(true);
+
+  tinygltf::Model model;
+  REQUIRE(ctx.LoadASCIIFromFile(&model, &err, &warn, "../models/Cube/Cube.gltf"));
+  REQUIRE(1 == model.buffers.size());
+  REQUIRE(2 == model.images.size());
+
+  // Split the data into two buffers.
+  model.buffers.push_back(model.buffers[0]);
+  for (size_t i = 0; i < model.bufferViews.size(); i += 2) {
+    model.bufferViews[i].buffer = 1;
+  }
+
+  std::vector<std::vector<float> > expected(model.accessors.size());
+  for (size_t i = 0; i < model.accessors.size(); i++) {
+    REQUIRE(tinygltf::UnpackAccessorToFloat(model, int(i), &expected[i], &err));
+  }
+
+  REQUIRE(false == ctx.GetPackGlbBuffers());
+  ctx.SetPackGlbBuffers(true);
+  tinygltf::Model copy = model;
+  copy.buffers[0].name = "packed";
+  tinygltf::Value::Object extension;
+  extension["level"] = tinygltf::Value(3);
+  copy.buffers[0].extensions["EXT_test"] = tinygltf::Value(extension);
+  std::stringstream os;
+  REQUIRE(ctx.WriteGltfSceneToStream(&copy, os, false, true));
+  const std::string glb = os.str();
+
+  tinygltf::Model packed;
+  REQUIRE(ctx.LoadBinaryFromMemory(
+      &packed, &err, &warn, reinterpret_cast<const unsigned char *>(glb.data()),
+      glb.size()));
+  REQUIRE(1 == packed.buffers.size());
+  REQUIRE("packed" == packed.buffers[0].name);
+  REQUIRE(1 == packed.buffers[0].extensions.count("EXT_test"));
+  REQUIRE(3 == packed.buffers[0].extensions["EXT_test"].Get("level").GetNumberAsInt());
+  REQUIRE(model.bufferViews.size() + 2 == packed.bufferViews.size());
+  for (size_t i = 0; i < packed.bufferViews.size(); i++) {
+    REQUIRE(0 == packed.bufferViews[i].buffer);
+  }
+  for (size_t i = 0; i < model.accessors.size(); i++) {
+    std::vector<float> values;
+    REQUIRE(tinygltf::UnpackAccessorToFloat(packed, int(i), &values, &err));
+    REQUIRE(expected[i] == values);
+  }
+
+  // Images are stored as bufferViews holding the encoded data.
+  for (size_t i = 0; i < packed.images.size(); i++) {
+    const tinygltf::Image &image = packed.images[i];
+    REQUIRE(image.uri.empty());
+    REQUIRE("image/png" == image.mimeType);
+    REQUIRE(image.bufferView >= int(model.bufferViews.size()));
+    const tinygltf::BufferView &view = packed.bufferViews[size_t(image.bufferView)];
+    REQUIRE(0 == (view.byteOffset % 16));
+    REQUIRE(model.images[i].image.size() == view.byteLength);
+    REQUIRE(0 == memcmp(model.images[i].image.data(),
+                        packed.buffers[0].DataPtr() + view.byteOffset,
+                        view.byteLength));
+  }
+}
+
+TEST_CASE("parallel-image-decoding", "[image]") {
+
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+
+  tinygltf::Model serial;
+  REQUIRE(1 == ctx.GetNumThreads());
+  bool ret = ctx.LoadASCIIFromFile(&serial, &err, &warn, "../models/Cube/Cube.gltf");
+  REQUIRE(true == ret);
+  REQUIRE(2 == serial.images.size());
+
+  ctx.SetNumThreads(4);
+  tinygltf::Model parallel;
+  ret = ctx.LoadASCIIFromFile(&parallel, &err, &warn, "../models/Cube/Cube.gltf");
+  REQUIRE(true == ret);
+  REQUIRE(serial.images.size() == parallel.images.size());
+  for (size_t i = 0; i < serial.images.size(); i++) {
+    REQUIRE(serial.images[i].width > 0);
+    REQUIRE(serial.images[i] == parallel.images[i]);
+  }
+
+  // Errors are reported in image order, up to the first image that fails.
+  const char *gltf = R"({
+    "asset": {"version": "2.0"},
+    "images": [
+      {"uri": "data:image/png;base64,AAAA"},
+      {"uri": "data:image/png;base64,AAAA"},
+      {"uri": "data:image/png;base64,AAAA"}
+    ]
+  })";
+  tinygltf::Model broken;
+  err.clear();
+  ret = ctx.LoadASCIIFromString(&broken, &err, &warn, gltf, strlen(gltf), "");
+  REQUIRE_FALSE(ret);
+  REQUIRE(std::string::npos != err.find("image[0]"));
+  REQUIRE(std::string::npos == err.find("image[1]"));
+
+  ctx.SetNumThreads(1);
+  std::string serial_err;
+  ret = ctx.LoadASCIIFromString(&broken, &serial_err, &warn, gltf,
+                                strlen(gltf), "");
+  REQUIRE_FALSE(ret);
+  REQUIRE(err == serial_err);
+
+  // Images 2 and 4 fail. Messages of images 0 to 2 are reported for any
+  // number of threads.
+  struct FailingLoader {
+    static bool Load(tinygltf::Image *, const int image_idx, std::string *err,
+                     std::string *warn, int, int, const unsigned char *, int,
+                     void *user_data) {
+      (*static_cast<std::atomic<int> *>(user_data))++;
+      (*warn) += "decoded image " + std::to_string(image_idx) + "\n";
+      if ((image_idx == 2) || (image_idx == 4)) {
+        (*err) += "failed image " + std::to_string(image_idx) + "\n";
+        return false;
+      }
+      return true;
+    }
+  };
+  const char *two_broken = R"({
+    "asset": {"version": "2.0"},
+    "images": [
+      {"uri": "data:image/png;base64,AAAA"},
+      {"uri": "data:image/png;base64,AAAA"},
+      {"uri": "data:image/png;base64,AAAA"},
+      {"uri": "data:image/png;base64,AAAA"},
+      {"uri": "data:image/png;base64,AAAA"},
+      {"uri": "data:image/png;base64,AAAA"}
+    ]
+  })";
+  std::atomic<int> calls(0);
+  ctx.SetImageLoader(FailingLoader::Load, &calls);
+  serial_err.clear();
+  std::string serial_warn;
+  ret = ctx.LoadASCIIFromString(&broken, &serial_err, &serial_warn, two_broken,
+                                strlen(two_broken), "");
+  REQUIRE_FALSE(ret);
+  REQUIRE(3 == calls);
+  REQUIRE("failed image 2\n" == serial_err);
+  REQUIRE("decoded image 0\ndecoded image 1\ndecoded image 2\n" ==
+          serial_warn);
+
+  ctx.SetNumThreads(4);
+  for (int i = 0; i < 16; i++) {
+    std::string parallel_err;
+    std::string parallel_warn;
+    ret = ctx.LoadASCIIFromString(&broken, &parallel_err, &parallel_warn,
+                                  two_broken, strlen(two_broken), "");
+    REQUIRE_FALSE(ret);
+    REQUIRE(serial_err == parallel_err);
+    REQUIRE(serial_warn == parallel_warn);
+  }
+
+  // An exception thrown by the loader reaches the caller for any number of
+  // threads. The one of the first throwing image is rethrown.
+  struct ThrowingLoader {
+    static bool Load(tinygltf::Image *, const int image_idx, std::string *,
+                     std::string *, int, int, const unsigned char *, int,
+                     void *) {
+      if ((image_idx == 1) || (image_idx == 5)) {
+        throw std::runtime_error("image " + std::to_string(image_idx));
+      }
+      return true;
+    }
+  };
+  ctx.SetImageLoader(ThrowingLoader::Load, nullptr);
+  for (int num_threads = 1; num_threads <= 4; num_threads += 3) {
+    ctx.SetNumThreads(num_threads);
+    for (int i = 0; i < 16; i++) {
+      std::string what;
+      try {
+        ctx.LoadASCIIFromString(&broken, &err, &warn, two_broken,
+                                strlen(two_broken), "");
+      } catch (const std::runtime_error &e) {
+        what = e.what();
+      }
+      REQUIRE("image 1" == what);
+    }
+  }
+}
+
+TEST_CASE("parallel-serialization", "[write]") {
+
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+
+  tinygltf::Model model;
+  REQUIRE(ctx.LoadASCIIFromFile(&model, &err, &warn, "../models/Cube/Cube.gltf"));
+
+  // Enough elements to be split into several work items.
+  const tinygltf::Model cube = model;
+  for (int n = 0; n < 300; n++) {
+    for (const tinygltf::Accessor &accessor : cube.accessors) {
+      model.accessors.push_back(accessor);
+      model.accessors.back().name = std::to_string(n);
+    }
+    for (const tinygltf::Node &node : cube.nodes) {
+      model.nodes.push_back(node);
+      model.nodes.back().translation = {double(n), 0.5, -1.25};
+    }
+    for (const tinygltf::Material &material : cube.materials) {
+      model.materials.push_back(material);
+    }
+    model.animations.push_back(tinygltf::Animation());  // Not serialized.
+  }
+
+  std::stringstream serial;
+  REQUIRE(ctx.WriteGltfSceneToStream(&model, serial, true, false));
+
+  ctx.SetNumThreads(4);
+  std::stringstream parallel;
+  REQUIRE(ctx.WriteGltfSceneToStream(&model, parallel, true, false));
+  REQUIRE(serial.str() == parallel.str());
+}
+
+TEST_CASE("direct-json-writer", "[write]") {
+  const char *files[] = {
+      "../models/Cube/Cube.gltf",
+      "../models/Cube-texture-ext/Cube-textransform.gltf",
+      "../models/Extensions-issue97/test.gltf",
+      "../models/Extensions-overwrite-issue261/issue-261.gltf",
+      "../models/SparseMorphTargets-issue280/singleBlendshapeCube_sparse.glb",
+      "../models/regression/unassigned-skeleton.gltf"};
+
+  for (const char *file : files) {
+    INFO(file);
+    const bool binary = (std::string(file).rfind(".glb") != std::string::npos);
+
+    tinygltf::TinyGLTF ctx;
+    ctx.SetImageWriter(nullptr, nullptr);  // Keep image uris as is.
+    std::string err;
+    std::string warn;
+    tinygltf::Model model;
+    REQUIRE((binary ? ctx.LoadBinaryFromFile(&model, &err, &warn, file)
+                    : ctx.LoadASCIIFromFile(&model, &err, &warn, file)));
+    if (!model.nodes.empty()) {
+      model.nodes[0].name = "quote\" backslash\\ tab\t \x01 \xc3\xa9";
+      model.nodes[0].extras = tinygltf::Value(tinygltf::Value::Object{
+          {"big", tinygltf::Value(uint64_t(1) << 40)},
+          {"real", tinygltf::Value(0.1)},
+          {"list", tinygltf::Value(tinygltf::Value::Array{
+                       tinygltf::Value(-3), tinygltf::Value(true)})}});
+    }
+
+    std::stringstream dom;
+    REQUIRE(ctx.WriteGltfSceneToStream(&model, dom, false, false));
+
+    REQUIRE(false == ctx.GetDirectJsonWriter());
+    ctx.SetDirectJsonWriter(true);
+    std::stringstream direct;
+    REQUIRE(ctx.WriteGltfSceneToStream(&model, direct, false, false));
+    std::stringstream pretty;
+    REQUIRE(ctx.WriteGltfSceneToStream(&model, pretty, true, false));
+
+    // Same JSON, regardless of member order and formatting.
+    REQUIRE(nlohmann::json::parse(dom.str()) == nlohmann::json::parse(direct.str()));
+    REQUIRE(nlohmann::json::parse(direct.str()) == nlohmann::json::parse(pretty.str()));
+
+    tinygltf::Model loaded;
+    REQUIRE(ctx.LoadASCIIFromString(&loaded, &err, &warn, pretty.str().c_str(),
+                                    pretty.str().size(), ""));
+    REQUIRE(model.nodes.size() == loaded.nodes.size());
+    if (!model.nodes.empty()) {
+      REQUIRE(model.nodes[0].name == loaded.nodes[0].name);
+    }
+    REQUIRE(model.accessors == loaded.accessors);
+
+    // GLB output.
+    std::stringstream glb;
+    REQUIRE(ctx.WriteGltfSceneToStream(&model, glb, false, true));
+    const std::string glb_str = glb.str();
+    REQUIRE(ctx.LoadBinaryFromMemory(
+        &loaded, &err, &warn,
+        reinterpret_cast<const unsigned char *>(glb_str.data()), glb_str.size()));
+    REQUIRE(model.buffers.size() == loaded.buffers.size());
+  }
+}
+
+TEST_CASE("deferred-image-decoding", "[image]") {
+
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+
+  tinygltf::Model decoded;
+  REQUIRE(ctx.LoadASCIIFromFile(&decoded, &err, &warn, "../models/Cube/Cube.gltf"));
+  REQUIRE(2 == decoded.images.size());
+
+  REQUIRE(false == ctx.GetDeferImageDecoding());
+  ctx.SetDeferImageDecoding(true);
+
+  tinygltf::Model model;
+  REQUIRE(ctx.LoadASCIIFromFile(&model, &err, &warn, "../models/Cube/Cube.gltf"));
+  REQUIRE(2 == model.images.size());
+
+  // Encoded PNG data is kept as is.
+  tinygltf::Image &image = model.images[0];
+  REQUIRE(image.as_is);
+  REQUIRE(image.image.size() > 8);
+  REQUIRE(0 == memcmp(image.image.data(), "\x89PNG", 4));
+  REQUIRE(-1 == image.width);
+
+  // Re-save without decoding. The PNG is embedded as is.
+  // (Embedding rewrites image.uri, so save a copy.)
+  tinygltf::Model copy = model;
+  REQUIRE(ctx.WriteGltfSceneToFile(&copy, TempPath("issue-deferred.gltf"), /* embedImages */ true, true, true, false));
+  tinygltf::Model resaved;
+  REQUIRE(ctx.LoadASCIIFromFile(&resaved, &err, &warn, TempPath("issue-deferred.gltf")));
+  REQUIRE(resaved.images[0].as_is);
+  REQUIRE(image.image == resaved.images[0].image);
+
+  REQUIRE(image.Decode(model, &err, &warn));
+  REQUIRE_FALSE(image.as_is);
+  REQUIRE(decoded.images[0] == image);
+
+  // Decoding again is a no-op.
+  REQUIRE(image.Decode(model, &err, &warn));
+  REQUIRE(decoded.images[0] == image);
+
+  // bufferView image.
+  std::ifstream ifs("../models/Cube/Cube_BaseColor.png", std::ios::binary);
+  std::vector<unsigned char> png((std::istreambuf_iterator<char>(ifs)),
+                                 std::istreambuf_iterator<char>());
+  std::string gltf = R"({
+    "asset": {"version": "2.0"},
+    "buffers": [{"byteLength": )" + std::to_string(png.size()) +
+    R"(, "uri": "data:application/octet-stream;base64,)" +
+    tinygltf::base64_encode(png.data(), png.size()) + R"("}],
+    "bufferViews": [{"buffer": 0, "byteLength": )" + std::to_string(png.size()) + R"(}],
+    "images": [{"bufferView": 0, "mimeType": "image/png"}]
+  })";
+
+  tinygltf::Model bv;
+  REQUIRE(ctx.LoadASCIIFromString(&bv, &err, &warn, gltf.c_str(), gltf.size(), ""));
+  REQUIRE(1 == bv.images.size());
+  REQUIRE(bv.images[0].as_is);
+  REQUIRE(bv.images[0].image.empty());
+
+  tinygltf::LoadImageDataOption option;
+  option.preserve_channels = true;
+  REQUIRE(bv.images[0].Decode(bv, &err, &warn, &tinygltf::LoadImageData, &option));
+  REQUIRE_FALSE(bv.images[0].as_is);
+  REQUIRE(decoded.images[0].width == bv.images[0].width);
+  REQUIRE(decoded.images[0].height == bv.images[0].height);
+
+  // Image data larger than INT_MAX is rejected instead of being truncated.
+  // Only the size of the buffer matters, its contents are never read.
+  if (sizeof(size_t) > 4) {
+    const unsigned char dummy[4] = {0, 0, 0, 0};
+    const size_t huge = size_t((std::numeric_limits<int>::max)()) + 1;
+    bv.buffers[0].view_data = dummy;
+    bv.buffers[0].view_size = huge;
+    bv.bufferViews[0].byteLength = huge;
+    bv.images[0].as_is = true;
+    err.clear();
+    REQUIRE_FALSE(bv.images[0].Decode(bv, &err, &warn));
+    REQUIRE(bv.images[0].as_is);
+    REQUIRE_THAT(err, Catch::Contains("too large"));
+  }
+}
+
+TEST_CASE("base64", "[base64]") {
+  REQUIRE("" == tinygltf::base64_encode(nullptr, 0));
+  REQUIRE("TWFu" == tinygltf::base64_encode(
+                        reinterpret_cast<const unsigned char *>("Man"), 3));
+  REQUIRE("TWE=" == tinygltf::base64_encode(
+                        reinterpret_cast<const unsigned char *>("Ma"), 2));
+  REQUIRE("TQ==" == tinygltf::base64_encode(
+                        reinterpret_cast<const unsigned char *>("M"), 1));
+
+  REQUIRE("Man" == tinygltf::base64_decode("TWFu"));
+  REQUIRE("Ma" == tinygltf::base64_decode("TWE="));
+  REQUIRE("M" == tinygltf::base64_decode("TQ=="));
+  // Decoding stops at the first non base64 character.
+  REQUIRE("Man" == tinygltf::base64_decode("TWFu!TWFu"));
+
+  // Round trip through the SIMD and scalar paths.
+  std::vector<unsigned char> bytes(1000);
+  for (size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = static_cast<unsigned char>((i * 7919) >> 3);
+  }
+  for (size_t len = 0; len < bytes.size(); len += (len < 100) ? 1 : 37) {
+    std::string encoded = tinygltf::base64_encode(bytes.data(), len);
+    REQUIRE(encoded.size() == ((len + 2) / 3) * 4);
+
+    std::vector<unsigned char> decoded;
+    REQUIRE(len == tinygltf::base64_decode(encoded.data(), encoded.size(),
+                                           &decoded));
+    REQUIRE(std::equal(decoded.begin(), decoded.end(), bytes.begin()));
+
+    // Bad character far into the data.
+    if (len > 90) {
+      encoded[80] = '#';
+      decoded.clear();
+      REQUIRE(60 == tinygltf::base64_decode(encoded.data(), encoded.size(),
+                                            &decoded));
+      REQUIRE(std::equal(decoded.begin(), decoded.end(), bytes.begin()));
+    }
+  }
+}
+
+TEST_CASE("accessor-view", "[accessor]") {
+  tinygltf::Model model;
+  model.buffers.resize(1);
+  std::vector<unsigned char> &data = model.buffers[0].data;
+
+  // 0: float VEC3 x 2, tightly packed.
+  const float positions[] = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  data.resize(sizeof(positions));
+  memcpy(data.data(), positions, sizeof(positions));
+
+  // 24: interleaved {uint16 x 2, int8 x 2} x 2, normalized.
+  const uint16_t texcoords[] = {0, 65535, 32768, 0};
+  const int8_t bytes[] = {127, -128, -127, 0};
+  data.resize(24 + 12);
+  for (size_t i = 0; i < 2; i++) {
+    memcpy(&data[24 + i * 6], &texcoords[i * 2], 4);
+    memcpy(&data[24 + i * 6 + 4], &bytes[i * 2], 2);
+  }
+
+  // 36: MAT2 of uint8. Columns are padded to 4 bytes.
+  const unsigned char mat2[] = {1, 2, 0, 0, 3, 4, 0, 0};
+  data.insert(data.end(), mat2, mat2 + 8);
+
+  // 44: sparse indices(uint16) and values(float).
+  const uint16_t sparse_indices[] = {1, 3};
+  const float sparse_values[] = {10.0f, 30.0f};
+  data.insert(data.end(), reinterpret_cast<const unsigned char *>(sparse_indices),
+              reinterpret_cast<const unsigned char *>(sparse_indices) + 4);
+  data.insert(data.end(), reinterpret_cast<const unsigned char *>(sparse_values),
+              reinterpret_cast<const unsigned char *>(sparse_values) + 8);
+
+  auto add_view = [&model](size_t offset, size_t length, size_t stride) {
+    tinygltf::BufferView view;
+    view.buffer = 0;
+    view.byteOffset = offset;
+    view.byteLength = length;
+    view.byteStride = stride;
+    model.bufferViews.push_back(view);
+    return int(model.bufferViews.size() - 1);
+  };
+  auto add_accessor = [&model](int view, size_t offset, int component_type,
+                               int type, size_t count, bool normalized) {
+    tinygltf::Accessor accessor;
+    accessor.bufferView = view;
+    accessor.byteOffset = offset;
+    accessor.componentType = component_type;
+    accessor.type = type;
+    accessor.count = count;
+    accessor.normalized = normalized;
+    model.accessors.push_back(accessor);
+    return int(model.accessors.size() - 1);
+  };
+
+  {
+    int acc = add_accessor(add_view(0, 24, 0), 0, TINYGLTF_COMPONENT_TYPE_FLOAT,
+                           TINYGLTF_TYPE_VEC3, 2, false);
+    tinygltf::AccessorView<std::array<float, 3> > view(model, acc);
+    REQUIRE(view.IsValid());
+    REQUIRE(2 == view.size());
+    REQUIRE(nullptr != view.Data());
+    REQUIRE(5.0f == view[1][1]);
+    std::vector<std::array<float, 3> > v = view.ToVector();
+    REQUIRE(0 == memcmp(v.data(), positions, sizeof(positions)));
+
+    // Converted to double. No direct access.
+    tinygltf::AccessorView<std::array<double, 3> > dview(model, acc);
+    REQUIRE(nullptr == dview.Data());
+    REQUIRE(6.0 == dview[1][2]);
+
+    // Component count mismatch.
+    std::string err;
+    tinygltf::AccessorView<float> bad(model, acc, &err);
+    REQUIRE_FALSE(bad.IsValid());
+    REQUIRE_FALSE(err.empty());
+  }
+
+  {
+    int interleaved = add_view(24, 12, 6);
+    int uvs = add_accessor(interleaved, 0,
+                           TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
+                           TINYGLTF_TYPE_VEC2, 2, true);
+    tinygltf::AccessorView<std::array<float, 2> > view(model, uvs);
+    REQUIRE(view.IsValid());
+    REQUIRE(nullptr == view.Data());
+    std::vector<std::array<float, 2> > v;
+    for (const std::array<float, 2> &uv : view) {
+      v.push_back(uv);
+    }
+    REQUIRE(2 == v.size());
+    REQUIRE(0.0f == v[0][0]);
+    REQUIRE(1.0f == v[0][1]);
+    REQUIRE(Approx(32768.0f / 65535.0f) == v[1][0]);
+
+    // Integer destination keeps raw values.
+    tinygltf::AccessorView<std::array<uint32_t, 2> > raw(model, uvs);
+    REQUIRE(65535 == raw[0][1]);
+
+    int snorm = add_accessor(interleaved, 4, TINYGLTF_COMPONENT_TYPE_BYTE,
+                             TINYGLTF_TYPE_VEC2, 2, true);
+    tinygltf::AccessorView<std::array<float, 2> > sview(model, snorm);
+    std::vector<std::array<float, 2> > s = sview.ToVector();
+    REQUIRE(1.0f == s[0][0]);
+    REQUIRE(-1.0f == s[0][1]);
+    REQUIRE(-1.0f == s[1][0]);
+    REQUIRE(0.0f == s[1][1]);
+
+    // Last element exceeds the bufferView.
+    int overrun = add_accessor(interleaved, 4, TINYGLTF_COMPONENT_TYPE_FLOAT,
+                               TINYGLTF_TYPE_SCALAR, 2, false);
+    tinygltf::AccessorView<float> oview(model, overrun);
+    REQUIRE_FALSE(oview.IsValid());
+    REQUIRE(0 == oview.size());
+  }
+
+  {
+    int acc = add_accessor(add_view(36, 8, 0), 0,
+                           TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE,
+                           TINYGLTF_TYPE_MAT2, 1, false);
+    tinygltf::AccessorView<std::array<uint8_t, 4> > view(model, acc);
+    REQUIRE(view.IsValid());
+    REQUIRE(nullptr == view.Data());
+    std::array<uint8_t, 4> m = view[0];
+    REQUIRE(1 == m[0]);
+    REQUIRE(2 == m[1]);
+    REQUIRE(3 == m[2]);
+    REQUIRE(4 == m[3]);
+  }
+
+  {
+    // Sparse without a base bufferView.
+    int acc = add_accessor(-1, 0, TINYGLTF_COMPONENT_TYPE_FLOAT,
+                           TINYGLTF_TYPE_SCALAR, 5, false);
+    tinygltf::Accessor &accessor = model.accessors[size_t(acc)];
+    accessor.sparse.isSparse = true;
+    accessor.sparse.count = 2;
+    accessor.sparse.indices.bufferView = add_view(44, 4, 0);
+    accessor.sparse.indices.byteOffset = 0;
+    accessor.sparse.indices.componentType =
+        TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+    accessor.sparse.values.bufferView = add_view(48, 8, 0);
+    accessor.sparse.values.byteOffset = 0;
+
+    tinygltf::AccessorView<float> view(model, acc);
+    REQUIRE(view.IsValid());
+    REQUIRE(nullptr == view.Data());
+    REQUIRE(0.0f == view[0]);
+    REQUIRE(10.0f == view[1]);
+    REQUIRE(30.0f == view[3]);
+    std::vector<float> v = view.ToVector();
+    REQUIRE(std::vector<float>({0.0f, 10.0f, 0.0f, 30.0f, 0.0f}) == v);
+
+    // Out of range sparse index.
+    accessor.count = 3;
+    tinygltf::AccessorView<float> bad(model, acc);
+    REQUIRE_FALSE(bad.IsValid());
+  }
+}
+
+TEST_CASE("unpack-accessor", "[accessor]") {
+  // 37 elements exercise both the SIMD kernels and the scalar tail.
+  const size_t count = 37;
+  const int component_types[] = {
+      TINYGLTF_COMPONENT_TYPE_BYTE,  TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE,
+      TINYGLTF_COMPONENT_TYPE_SHORT, TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT,
+      TINYGLTF_COMPONENT_TYPE_INT,   TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT,
+      TINYGLTF_COMPONENT_TYPE_FLOAT, TINYGLTF_COMPONENT_TYPE_DOUBLE};
+
+  tinygltf::Model model;
+  model.buffers.resize(1);
+  std::vector<unsigned char> &data = model.buffers[0].data;
+  for (int component_type : component_types) {
+    const size_t size = size_t(tinygltf::GetComponentSizeInBytes(
+                            uint32_t(component_type))) * count * 2;
+    tinygltf::BufferView view;
+    view.buffer = 0;
+    view.byteOffset = data.size();
+    view.byteLength = size;
+    for (size_t i = 0; i < size; i++) {
+      data.push_back(static_cast<unsigned char>(i * 37 + 11));
+    }
+    if (component_type == TINYGLTF_COMPONENT_TYPE_FLOAT ||
+        component_type == TINYGLTF_COMPONENT_TYPE_DOUBLE) {
+      // Avoid NaNs.
+      for (size_t i = 0; i < count * 2; i++) {
+        if (component_type == TINYGLTF_COMPONENT_TYPE_FLOAT) {
+          float f = float(i) * 0.25f - 3.0f;
+          memcpy(&data[view.byteOffset + i * 4], &f, 4);
+        } else {
+          double d = double(i) * 0.125 - 2.0;
+          memcpy(&data[view.byteOffset + i * 8], &d, 8);
+        }
+      }
+    }
+    model.bufferViews.push_back(view);
+
+    for (int normalized = 0; normalized < 2; normalized++) {
+      tinygltf::Accessor accessor;
+      accessor.bufferView = int(model.bufferViews.size() - 1);
+      accessor.componentType = component_type;
+      accessor.type = TINYGLTF_TYPE_VEC2;
+      accessor.count = count;
+      accessor.normalized = (normalized != 0);
+      model.accessors.push_back(accessor);
+    }
+  }
+
+  for (size_t a = 0; a < model.accessors.size(); a++) {
+    const tinygltf::Accessor &accessor = model.accessors[a];
+    tinygltf::AccessorView<std::array<float, 2> > view(model, int(a));
+    REQUIRE(view.IsValid());
+
+    std::vector<float> values;
+    REQUIRE(tinygltf::UnpackAccessorToFloat(model, int(a), &values));
+    REQUIRE(count * 2 == values.size());
+    for (size_t i = 0; i < count; i++) {
+      REQUIRE(view[i][0] == values[i * 2]);
+      REQUIRE(view[i][1] == values[i * 2 + 1]);
+    }
+
+    std::vector<uint32_t> indices;
+    std::string err;
+    const bool is_float =
+        (accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) ||
+        (accessor.componentType == TINYGLTF_COMPONENT_TYPE_DOUBLE);
+    REQUIRE(!is_float == tinygltf::UnpackAccessorToUint32(model, int(a),
+                                                          &indices, &err));
+    if (!is_float) {
+      tinygltf::AccessorView<std::array<uint32_t, 2> > iview(model, int(a));
+      for (size_t i = 0; i < count; i++) {
+        REQUIRE(iview[i][0] == indices[i * 2]);
+        REQUIRE(iview[i][1] == indices[i * 2 + 1]);
+      }
+    } else {
+      REQUIRE_FALSE(err.empty());
+    }
+  }
+
+  // An empty accessor unpacks to an empty vector.
+  for (int component_type : {TINYGLTF_COMPONENT_TYPE_FLOAT,
+                             TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT}) {
+    tinygltf::Accessor accessor;
+    accessor.bufferView = 0;
+    accessor.componentType = component_type;
+    accessor.type = TINYGLTF_TYPE_SCALAR;
+    accessor.count = 0;
+    model.accessors.push_back(accessor);
+    const int empty = int(model.accessors.size() - 1);
+    std::vector<float> values;
+    REQUIRE(tinygltf::UnpackAccessorToFloat(model, empty, &values));
+    REQUIRE(values.empty());
+    std::vector<uint32_t> indices;
+    REQUIRE(tinygltf::UnpackAccessorToUint32(model, empty, &indices) ==
+            (component_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT));
+    REQUIRE(indices.empty());
+  }
+
+  // Destination too small.
+  std::vector<float> small(3);
+  std::string err;
+  REQUIRE_FALSE(tinygltf::UnpackAccessorToFloat(model, 0, small.data(),
+                                                small.size(), &err));
+  REQUIRE_FALSE(err.empty());
+}
+
+TEST_CASE("materialize-sparse-accessors", "[accessor]") {
+  tinygltf::Model model;
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+  REQUIRE(ctx.LoadBinaryFromFile(&model, &err, &warn, "../models/SparseMorphTargets-issue280/singleBlendshapeCube_sparse.glb"));
+
+  std::vector<size_t> sparse;
+  std::vector<std::vector<std::array<float, 3> > > expected;
+  for (size_t i = 0; i < model.accessors.size(); i++) {
+    if (model.accessors[i].sparse.isSparse) {
+      REQUIRE(TINYGLTF_TYPE_VEC3 == model.accessors[i].type);
+      REQUIRE(TINYGLTF_COMPONENT_TYPE_FLOAT == model.accessors[i].componentType);
+      tinygltf::AccessorView<std::array<float, 3> > view(model, int(i));
+      REQUIRE(view.IsValid());
+      sparse.push_back(i);
+      expected.push_back(view.ToVector());
+
+      std::vector<unsigned char> dense;
+      REQUIRE(tinygltf::MaterializeSparseAccessor(model, int(i), &dense));
+      REQUIRE(dense.size() == view.size() * 12);
+      REQUIRE(0 == memcmp(dense.data(), expected.back().data(), dense.size()));
+    }
+  }
+  REQUIRE(!sparse.empty());
+
+  const size_t num_buffers = model.buffers.size();
+  REQUIRE(tinygltf::MaterializeSparseAccessors(&model, &err, 2));
+  REQUIRE(num_buffers + 1 == model.buffers.size());
+  for (size_t j = 0; j < sparse.size(); j++) {
+    REQUIRE_FALSE(model.accessors[sparse[j]].sparse.isSparse);
+    tinygltf::AccessorView<std::array<float, 3> > view(model, int(sparse[j]));
+    REQUIRE(nullptr != view.Data());
+    REQUIRE(expected[j] == view.ToVector());
+  }
+}
+
+TEST_CASE("sparse-accessor-index-type", "[accessor]") {
+  // Sparse indices must be UNSIGNED_BYTE, UNSIGNED_SHORT or UNSIGNED_INT.
+  tinygltf::Model model;
+  model.buffers.resize(1);
+  model.buffers[0].data = {0, 2, 0, 0, 0, 0, 0, 0, 0, 0};
+  float values[2] = {10.0f, 30.0f};
+  memcpy(&model.buffers[0].data[2], values, sizeof(values));
+  tinygltf::BufferView indices_view;
+  indices_view.buffer = 0;
+  indices_view.byteOffset = 0;
+  indices_view.byteLength = 2;
+  model.bufferViews.push_back(indices_view);
+  tinygltf::BufferView values_view;
+  values_view.buffer = 0;
+  values_view.byteOffset = 2;
+  values_view.byteLength = 8;
+  model.bufferViews.push_back(values_view);
+
+  tinygltf::Accessor accessor;
+  accessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+  accessor.type = TINYGLTF_TYPE_SCALAR;
+  accessor.count = 4;
+  accessor.sparse.isSparse = true;
+  accessor.sparse.count = 2;
+  accessor.sparse.indices.bufferView = 0;
+  accessor.sparse.indices.byteOffset = 0;
+  accessor.sparse.indices.componentType =
+      TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+  accessor.sparse.values.bufferView = 1;
+  accessor.sparse.values.byteOffset = 0;
+  model.accessors.push_back(accessor);
+
+  std::vector<float> floats;
+  REQUIRE(tinygltf::UnpackAccessorToFloat(model, 0, &floats));
+  REQUIRE(std::vector<float>({10.0f, 0.0f, 30.0f, 0.0f}) == floats);
+
+  const int invalid_types[] = {TINYGLTF_COMPONENT_TYPE_BYTE,
+                               TINYGLTF_COMPONENT_TYPE_SHORT,
+                               TINYGLTF_COMPONENT_TYPE_FLOAT};
+  for (int component_type : invalid_types) {
+    INFO(component_type);
+    model.accessors[0].sparse.indices.componentType = component_type;
+    tinygltf::AccessorView<float> view(model, 0);
+    REQUIRE_FALSE(view.IsValid());
+    std::string err;
+    REQUIRE_FALSE(tinygltf::UnpackAccessorToFloat(model, 0, &floats, &err));
+    REQUIRE_FALSE(err.empty());
+    std::vector<unsigned char> dense;
+    REQUIRE_FALSE(tinygltf::MaterializeSparseAccessor(model, 0, &dense));
+  }
+
+  // Rejected when loading.
+  const char *gltf = R"({
+    "asset": {"version": "2.0"},
+    "buffers": [{"byteLength": 10,
+                 "uri": "data:application/octet-stream;base64,AAIAACBBAADwQQ=="}],
+    "bufferViews": [{"buffer": 0, "byteLength": 2},
+                    {"buffer": 0, "byteOffset": 2, "byteLength": 8}],
+    "accessors": [{"componentType": 5126, "count": 4, "type": "SCALAR",
+                   "sparse": {"count": 2,
+                              "indices": {"bufferView": 0, "componentType": 5120},
+                              "values": {"bufferView": 1}}}]
+  })";
+  tinygltf::TinyGLTF ctx;
+  tinygltf::Model loaded;
+  std::string err;
+  std::string warn;
+  REQUIRE_FALSE(
+      ctx.LoadASCIIFromString(&loaded, &err, &warn, gltf, strlen(gltf), ""));
+  REQUIRE(std::string::npos != err.find("sparse accessor indices"));
+
+  std::string valid(gltf);
+  valid.replace(valid.find("5120"), 4, "5121");
+  err.clear();
+  REQUIRE(ctx.LoadASCIIFromString(&loaded, &err, &warn, valid.c_str(),
+                                  valid.size(), ""));
+  REQUIRE(tinygltf::UnpackAccessorToFloat(loaded, 0, &floats));
+  REQUIRE(std::vector<float>({10.0f, 0.0f, 30.0f, 0.0f}) == floats);
+}
+
+TEST_CASE("streaming-json-parse", "[parse]") {
+  const char *files[] = {
+      "../models/Cube/Cube.gltf",
+      "../models/Cube-texture-ext/Cube-textransform.gltf",
+      "../models/CubeImageUriSpaces/CubeImageUriSpaces.gltf",
+      "../models/Extensions-issue97/test.gltf",
+      "../models/SparseMorphTargets-issue280/singleBlendshapeCube_sparse.glb",
+      "../models/box01.glb"};
+
+  for (const char *file : files) {
+    INFO(file);
+    const bool binary = (std::string(file).rfind(".glb") != std::string::npos);
+
+    tinygltf::TinyGLTF ctx;
+    ctx.SetStoreOriginalJSONForExtrasAndExtensions(true);
+    std::string err;
+    std::string warn;
+    tinygltf::Model dom;
+    REQUIRE((binary ? ctx.LoadBinaryFromFile(&dom, &err, &warn, file)
+                    : ctx.LoadASCIIFromFile(&dom, &err, &warn, file)));
+
+    REQUIRE(false == ctx.GetStreamingJsonParse());
+    ctx.SetStreamingJsonParse(true);
+    tinygltf::Model streamed;
+    std::string streamed_err;
+    std::string streamed_warn;
+    REQUIRE((binary ? ctx.LoadBinaryFromFile(&streamed, &streamed_err,
+                                             &streamed_warn, file)
+                    : ctx.LoadASCIIFromFile(&streamed, &streamed_err,
+                                            &streamed_warn, file)));
+    REQUIRE(dom == streamed);
+    REQUIRE(err == streamed_err);
+    REQUIRE(warn == streamed_warn);
+    REQUIRE(dom.nodes.size() == streamed.nodes.size());
+    REQUIRE(dom.accessors.size() == streamed.accessors.size());
+  }
+
+  tinygltf::TinyGLTF ctx;
+  ctx.SetStreamingJsonParse(true);
+  tinygltf::Model model;
+  std::string err;
+  std::string warn;
+
+  // Invalid JSON.
+  std::string invalid = R"({"asset": {"version": "2.0"}, "nodes": [{}, )";
+  REQUIRE_FALSE(ctx.LoadASCIIFromString(&model, &err, &warn, invalid.c_str(),
+                                        invalid.size(), ""));
+  REQUIRE_FALSE(err.empty());
+
+  // Element parse error.
+  err.clear();
+  std::string bad = R"({"asset": {"version": "2.0"}, "buffers": [1]})";
+  REQUIRE_FALSE(ctx.LoadASCIIFromString(&model, &err, &warn, bad.c_str(),
+                                        bad.size(), ""));
+  REQUIRE_THAT(err, Catch::Contains("`buffers' does not contain an JSON object"));
+
+  // Root must be an object.
+  err.clear();
+  std::string array = R"([{"asset": {"version": "2.0"}}])";
+  REQUIRE_FALSE(ctx.LoadASCIIFromString(&model, &err, &warn, array.c_str(),
+                                        array.size(), ""));
+  REQUIRE_FALSE(err.empty());
+}
+
+TEST_CASE("insitu-json-parse", "[parse]") {
+  const char *files[] = {
+      "../models/Cube/Cube.gltf",
+      "../models/Cube-texture-ext/Cube-textransform.gltf",
+      "../models/Extensions-issue97/test.gltf",
+      "../models/SparseMorphTargets-issue280/singleBlendshapeCube_sparse.glb",
+      "../models/box01.glb"};
+
+  for (const char *file : files) {
+    INFO(file);
+    const bool binary = (std::string(file).rfind(".glb") != std::string::npos);
+
+    tinygltf::TinyGLTF ctx;
+    std::string err;
+    std::string warn;
+    tinygltf::Model reference;
+    REQUIRE((binary ? ctx.LoadBinaryFromFile(&reference, &err, &warn, file)
+                    : ctx.LoadASCIIFromFile(&reference, &err, &warn, file)));
+
+    REQUIRE(false == ctx.GetInsituJsonParse());
+    ctx.SetInsituJsonParse(true);
+    REQUIRE(ctx.GetInsituJsonParse());
+
+    // The second load reuses the buffer and the value pool of the first one.
+    for (int i = 0; i < 2; i++) {
+      INFO(i);
+      tinygltf::Model model;
+      std::string insitu_err;
+      std::string insitu_warn;
+      REQUIRE((binary ? ctx.LoadBinaryFromFile(&model, &insitu_err,
+                                               &insitu_warn, file)
+                      : ctx.LoadASCIIFromFile(&model, &insitu_err,
+                                              &insitu_warn, file)));
+      REQUIRE(model == reference);
+      REQUIRE(err == insitu_err);
+      REQUIRE(warn == insitu_warn);
+    }
+  }
+}
+
+// An object parsed by looking up its members in a single pass(JsonMembers).
+struct MemberDispatchObject {
+  const char *type;
+  std::string object;             // JSON text
+  std::set<std::string> members;  // Members read by its Parse*()
+  // A number member to duplicate, with the value of the duplicate, and the
+  // value of the member in the model(the first element of arrays).
+  const char *duplicate;
+  const char *duplicate_value;
+  double (*value)(const tinygltf::Model &);
+};
+
+// Member names dispatched by JsonMembers, for objects of any type.
+static const char *kDispatchedMembers[] = {
+    "alphaCutoff",     "alphaMode",
+    "attributes",      "baseColorFactor",
+    "baseColorTexture", "buffer",
+    "bufferView",      "byteLength",
+    "byteOffset",      "byteStride",
+    "camera",          "children",
+    "componentType",   "count",
+    "doubleSided",     "emissiveFactor",
+    "emissiveTexture", "extensions",
+    "extras",          "indices",
+    "material",        "matrix",
+    "max",             "mesh",
+    "metallicFactor",  "metallicRoughnessTexture",
+    "min",             "mode",
+    "name",            "normalTexture",
+    "normalized",      "occlusionTexture",
+    "pbrMetallicRoughness", "primitives",
+    "rotation",        "roughnessFactor",
+    "scale",           "skin",
+    "sparse",          "target",
+    "targets",         "translation",
+    "type",            "weights"};
+
+static std::vector<MemberDispatchObject> MemberDispatchObjects() {
+  std::vector<MemberDispatchObject> objects;
+  objects.push_back(
+      {"bufferView",
+       R"({"buffer": 0, "byteOffset": 0, "byteLength": 12, "byteStride": 4,
+           "target": 34962, "name": "view", "extras": {"e": 1}})",
+       {"buffer", "byteOffset", "byteLength", "byteStride", "target", "name",
+        "extensions", "extras"},
+       "byteStride",
+       "8",
+       [](const tinygltf::Model &m) {
+         return double(m.bufferViews[0].byteStride);
+       }});
+  objects.push_back(
+      {"accessor",
+       R"({"bufferView": 0, "byteOffset": 0, "componentType": 5126,
+           "normalized": false, "count": 3, "type": "SCALAR", "min": [0],
+           "max": [1], "name": "accessor", "extras": {"e": 2}})",
+       {"bufferView", "byteOffset", "componentType", "normalized", "count",
+        "type", "min", "max", "sparse", "name", "extensions", "extras"},
+       "componentType",
+       "5125",
+       [](const tinygltf::Model &m) {
+         return double(m.accessors[0].componentType);
+       }});
+  objects.push_back(
+      {"primitive",
+       R"({"attributes": {"POSITION": 0}, "material": 0, "mode": 0,
+           "targets": [{"POSITION": 0}], "extras": {"e": 3}})",
+       {"attributes", "indices", "material", "mode", "targets", "extensions",
+        "extras"},
+       "mode",
+       "4",
+       [](const tinygltf::Model &m) {
+         return double(m.meshes[0].primitives[0].mode);
+       }});
+  objects.push_back(
+      {"mesh",
+       R"({"name": "mesh", "primitives": [PRIMITIVE], "weights": [0.5],
+           "extras": {"e": 4}})",
+       {"name", "primitives", "weights", "extensions", "extras"},
+       "weights",
+       "[0.25]",
+       [](const tinygltf::Model &m) { return m.meshes[0].weights[0]; }});
+  objects.push_back(
+      {"pbrMetallicRoughness",
+       R"({"baseColorFactor": [1, 0.5, 0.5, 1], "metallicFactor": 0.25,
+           "roughnessFactor": 0.75, "extras": {"e": 5}})",
+       {"baseColorFactor", "baseColorTexture", "metallicFactor",
+        "roughnessFactor", "metallicRoughnessTexture", "extensions", "extras"},
+       "metallicFactor",
+       "0.5",
+       [](const tinygltf::Model &m) {
+         return m.materials[0].pbrMetallicRoughness.metallicFactor;
+       }});
+  objects.push_back(
+      {"material",
+       R"({"name": "material", "pbrMetallicRoughness": PBR,
+           "emissiveFactor": [0.5, 0, 0], "alphaMode": "MASK",
+           "alphaCutoff": 0.25, "doubleSided": true, "extras": {"e": 6}})",
+       {"name", "pbrMetallicRoughness", "normalTexture", "occlusionTexture",
+        "emissiveTexture", "emissiveFactor", "alphaMode", "alphaCutoff",
+        "doubleSided", "extensions", "extras"},
+       "alphaCutoff",
+       "0.5",
+       [](const tinygltf::Model &m) { return m.materials[0].alphaCutoff; }});
+  objects.push_back(
+      {"node",
+       R"({"name": "node", "mesh": 0, "children": [1], "translation": [1, 2, 3],
+           "rotation": [0, 0, 0, 1], "scale": [2, 2, 2], "weights": [0.5],
+           "extras": {"e": 7}})",
+       {"name", "mesh", "skin", "camera", "children", "matrix", "translation",
+        "rotation", "scale", "weights", "extensions", "extras"},
+       "translation",
+       "[4, 5, 6]",
+       [](const tinygltf::Model &m) { return m.nodes[0].translation[0]; }});
+  return objects;
+}
+
+static void ReplaceAll(std::string *s, const std::string &from,
+                       const std::string &to) {
+  for (size_t pos = s->find(from); pos != std::string::npos;
+       pos = s->find(from, pos + to.size())) {
+    s->replace(pos, from.size(), to);
+  }
+}
+
+// glTF with one of each object of `objects`.
+static std::string MemberDispatchGltf(
+    const std::vector<MemberDispatchObject> &objects) {
+  std::string gltf = R"({"asset": {"version": "2.0"},
+      "buffers": [{"byteLength": 12,
+                   "uri": "data:application/octet-stream;base64,AAAAAAAAAAAAAAAA"}],
+      "bufferViews": [BUFFER_VIEW], "accessors": [ACCESSOR],
+      "meshes": [MESH], "materials": [MATERIAL],
+      "nodes": [NODE, {"name": "child"}], "scenes": [{"nodes": [0]}]})";
+  // Nested objects last.
+  const char *placeholders[] = {"BUFFER_VIEW", "ACCESSOR", "PRIMITIVE", "MESH",
+                                "PBR", "MATERIAL", "NODE"};
+  const int order[] = {0, 1, 3, 2, 5, 4, 6};
+  for (int i : order) {
+    ReplaceAll(&gltf, placeholders[i], objects[size_t(i)].object);
+  }
+  return gltf;
+}
+
+// `object` with `members` appended.
+static std::string AppendMembers(const std::string &object,
+                                 const std::string &members) {
+  const size_t end = object.rfind('}');
+  return object.substr(0, end) + ", " + members + object.substr(end);
+}
+
+static bool LoadMemberDispatchGltf(
+    const std::vector<MemberDispatchObject> &objects, tinygltf::Model *model,
+    std::string *err) {
+  tinygltf::TinyGLTF ctx;
+  std::string warn;
+  const std::string gltf = MemberDispatchGltf(objects);
+  return ctx.LoadASCIIFromString(model, err, &warn, gltf.c_str(),
+                                 static_cast<unsigned int>(gltf.size()), "");
+}
+
+TEST_CASE("json-member-dispatch", "[parse]") {
+  const std::vector<MemberDispatchObject> objects = MemberDispatchObjects();
+  tinygltf::Model reference;
+  std::string err;
+  REQUIRE(LoadMemberDispatchGltf(objects, &reference, &err));
+  REQUIRE(err.empty());
+  REQUIRE(reference.materials[0].additionalValues.size() == 4);
+
+  for (size_t i = 0; i < objects.size(); i++) {
+    INFO(objects[i].type);
+
+    // Members of other object types, with values of the wrong type for any
+    // of them, are skipped like unknown members.
+    std::string others;
+    for (const char *member : kDispatchedMembers) {
+      if (!objects[i].members.count(member)) {
+        others += std::string(others.empty() ? "" : ", ") + "\"" + member +
+                  "\": \"other\"";
+      }
+    }
+    const std::string unknown = R"("unknown": {"name": 1, "mesh": [2]})";
+    for (const std::string &members : {unknown, others}) {
+      INFO(members);
+      std::vector<MemberDispatchObject> changed = objects;
+      changed[i].object = AppendMembers(objects[i].object, members);
+      tinygltf::Model model;
+      err.clear();
+      REQUIRE(LoadMemberDispatchGltf(changed, &model, &err));
+      REQUIRE(err.empty());
+      // Also kept as material parameters.
+      if (std::string(objects[i].type) == "material") {
+        REQUIRE(model.materials[0].additionalValues.size() >
+                reference.materials[0].additionalValues.size());
+        model.materials[0].additionalValues =
+            reference.materials[0].additionalValues;
+      } else if (std::string(objects[i].type) == "pbrMetallicRoughness") {
+        REQUIRE(model.materials[0].values.size() >
+                reference.materials[0].values.size());
+        model.materials[0].values = reference.materials[0].values;
+      }
+      REQUIRE(model == reference);
+    }
+
+    // A duplicated member has the value FindMember() finds(the first one,
+    // unless the JSON backend keeps only the last one).
+    std::vector<MemberDispatchObject> changed = objects;
+    changed[i].object = AppendMembers(
+        objects[i].object, std::string("\"") + objects[i].duplicate +
+                               "\": " + objects[i].duplicate_value);
+    std::string object = changed[i].object;
+    ReplaceAll(&object, "PRIMITIVE", "{}");
+    ReplaceAll(&object, "PBR", "{}");
+    JsonDocument doc = JsonConstruct(object.c_str());
+    json_const_iterator it;
+    REQUIRE(tinygltf::FindMember(doc, objects[i].duplicate, it));
+    double expected = 0;
+    const json &value = tinygltf::GetValue(it);
+    REQUIRE(tinygltf::GetNumber(tinygltf::IsArray(value)
+                                    ? *tinygltf::ArrayBegin(value)
+                                    : value,
+                                expected));
+
+    tinygltf::Model model;
+    err.clear();
+    REQUIRE(LoadMemberDispatchGltf(changed, &model, &err));
+    REQUIRE(objects[i].value(model) == expected);
+  }
+}
+
+TEST_CASE("flat-map", "[map]") {
+  tinygltf::FlatMap<std::string, int> map;
+  map["TEXCOORD_0"] = 2;
+  map["POSITION"] = 0;
+  map[std::string("NORMAL")] = 1;
+  REQUIRE(map.size() == 3);
+
+  // Iterated in key order, like std::map.
+  std::map<std::string, int> ref{
+      {"TEXCOORD_0", 2}, {"POSITION", 0}, {"NORMAL", 1}};
+  REQUIRE(std::equal(map.begin(), map.end(), ref.begin(),
+                     [](const std::pair<std::string, int> &a,
+                        const std::pair<const std::string, int> &b) {
+                       return a.first == b.first && a.second == b.second;
+                     }));
+
+  REQUIRE(map.find("POSITION") != map.end());
+  REQUIRE(map.find("POSITION")->second == 0);
+  REQUIRE(map.find(std::string("NORMAL"))->second == 1);
+  REQUIRE(map.find("POSITION_") == map.end());
+  REQUIRE(map.find("POSITIO") == map.end());
+  REQUIRE(map.find("") == map.end());
+  REQUIRE(map.count("TEXCOORD_0") == 1);
+  REQUIRE(map.count("TEXCOORD_1") == 0);
+
+  REQUIRE_FALSE(map.insert(std::make_pair(std::string("NORMAL"), 5)).second);
+  REQUIRE(map["NORMAL"] == 1);
+  REQUIRE(map.emplace("COLOR_0", 3).second);
+  REQUIRE(map.begin()->first == "COLOR_0");
+
+  REQUIRE(map.erase("NORMAL") == 1);
+  REQUIRE(map.erase("NORMAL") == 0);
+  map.erase(map.find("COLOR_0"));
+  REQUIRE(map.size() == 2);
+
+  tinygltf::FlatMap<std::string, int> other{{"TEXCOORD_0", 2},
+                                            {"POSITION", 0}};
+  REQUIRE(map == other);
+  other["POSITION"] = 4;
+  REQUIRE(map != other);
+}
+
+#ifdef TINYGLTF_USE_STRING_INTERNING
+TEST_CASE("interned-string", "[map]") {
+  std::shared_ptr<tinygltf::StringPool> pool =
+      std::make_shared<tinygltf::StringPool>();
+  tinygltf::InternedString a;
+  tinygltf::InternedString c;
+  {
+    tinygltf::StringPool::Scope scope(pool.get());
+    REQUIRE(tinygltf::StringPool::Current() == pool.get());
+    a = "KHR_materials_emissive_strength";
+    tinygltf::InternedString b(std::string("KHR_materials_emissive_strength"));
+    c = "KHR_texture_transform";
+    REQUIRE(a == b);
+    REQUIRE(&a.str() == &b.str());
+    REQUIRE(pool->size() == 2);
+
+    // Copies of pooled handles share the pooled string while it is current.
+    tinygltf::InternedString copy = a;
+    REQUIRE(&copy.str() == &a.str());
+  }
+  REQUIRE(tinygltf::StringPool::Current() == nullptr);
+  REQUIRE(a != c);
+  REQUIRE(a < c);
+  REQUIRE(a == "KHR_materials_emissive_strength");
+  REQUIRE(std::string("KHR_texture_transform") == c);
+  REQUIRE(tinygltf::InternedString().empty());
+
+  // Other copies own their string.
+  tinygltf::InternedString copy = a;
+  REQUIRE(copy == a);
+  REQUIRE(&copy.str() != &a.str());
+  copy = c;
+  REQUIRE(&copy.str() != &c.str());
+  REQUIRE(copy == c);
+
+  // Strings interned outside of a pool are equal by their characters, and
+  // copies own their string.
+  tinygltf::InternedString d("KHR_texture_transform");
+  REQUIRE(d == c);
+  REQUIRE(&d.str() != &c.str());
+  REQUIRE_FALSE(d < c);
+  REQUIRE_FALSE(c < d);
+  tinygltf::InternedString e = d;
+  REQUIRE(e == d);
+  REQUIRE(&e.str() != &d.str());
+  d = tinygltf::InternedString("KHR_lights_punctual");
+  REQUIRE(e == "KHR_texture_transform");
+  tinygltf::InternedString f = std::move(e);
+  REQUIRE(f == "KHR_texture_transform");
+  REQUIRE(e.empty());
+
+  std::stringstream ss;
+  ss << a;
+  REQUIRE(ss.str() == "KHR_materials_emissive_strength");
+
+  tinygltf::FlatMap<tinygltf::InternedString, int> map;
+  map[c] = 1;
+  map[std::string("KHR_materials_emissive_strength")] = 2;
+  REQUIRE(map.begin()->first == a);
+  REQUIRE(map.find("KHR_texture_transform")->second == 1);
+  REQUIRE(map.find(a)->second == 2);
+  REQUIRE(map.find(f)->second == 1);
+  REQUIRE(map.find("KHR_texture") == map.end());
+
+  // Loaded models keep the pool of their keys alive.
+  tinygltf::Model model;
+  {
+    tinygltf::TinyGLTF ctx;
+    std::string err;
+    std::string warn;
+    REQUIRE(ctx.LoadASCIIFromFile(&model, &err, &warn,
+                                  "../models/Cube/Cube.gltf"));
+  }
+  REQUIRE(model.string_pool);
+  REQUIRE(model.string_pool->size() > 0);
+  tinygltf::Model copied = model;
+  model = tinygltf::Model();
+  REQUIRE(copied.meshes[0].primitives[0].attributes["POSITION"] >= 0);
+
+  // Copies of parts of a model outlive it and its loader.
+  tinygltf::Mesh mesh;
+  {
+    tinygltf::TinyGLTF ctx;
+    tinygltf::Model temp;
+    std::string err;
+    std::string warn;
+    REQUIRE(ctx.LoadASCIIFromFile(&temp, &err, &warn,
+                                  "../models/Cube/Cube.gltf"));
+    mesh = temp.meshes[0];
+  }
+  REQUIRE(mesh.primitives[0].attributes.find("POSITION") !=
+          mesh.primitives[0].attributes.end());
+
+  // Each load has its own pool.
+  {
+    tinygltf::TinyGLTF ctx;
+    tinygltf::Model m0;
+    tinygltf::Model m1;
+    std::string err;
+    std::string warn;
+    REQUIRE(ctx.LoadASCIIFromFile(&m0, &err, &warn,
+                                  "../models/Cube/Cube.gltf"));
+    REQUIRE(ctx.LoadASCIIFromFile(&m1, &err, &warn,
+                                  "../models/Cube/Cube.gltf"));
+    REQUIRE(m0.string_pool != m1.string_pool);
+    REQUIRE(m0.string_pool->size() == m1.string_pool->size());
+  }
+
+  // Keys moved or swapped out of a model outlive it too.
+  std::vector<tinygltf::InternedString> keys;
+  tinygltf::InternedString swapped("swapped");
+  {
+    tinygltf::TinyGLTF ctx;
+    tinygltf::Model temp;
+    std::string err;
+    std::string warn;
+    REQUIRE(ctx.LoadASCIIFromFile(&temp, &err, &warn,
+                                  "../models/Cube/Cube.gltf"));
+    for (auto &attribute : temp.meshes[0].primitives[0].attributes) {
+      keys.push_back(std::move(attribute.first));
+    }
+    std::swap(swapped, temp.meshes[0].primitives[0].attributes.begin()->first);
+  }
+  REQUIRE(std::find(keys.begin(), keys.end(), "POSITION") != keys.end());
+  REQUIRE(!swapped.empty());
+  REQUIRE(swapped != "swapped");
+}
+#endif
+
+TEST_CASE("node-transforms", "[node]") {
+  tinygltf::Model model;
+  model.nodes.resize(4);
+  model.nodes[0].translation = {1.0, 2.0, 3.0};
+  // 90 degrees around +Z.
+  model.nodes[1].rotation = {0.0, 0.0, std::sqrt(0.5), std::sqrt(0.5)};
+  model.nodes[1].scale = {2.0, 2.0, 2.0};
+  model.nodes[2].matrix = {1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0,
+                           0.0, 0.0, 1.0, 0.0, 4.0, 5.0, 6.0, 1.0};
+  model.nodes[3].scale = {1.0, 2.0};  // invalid
+
+  std::vector<tinygltf::NodeTransform<double> > xforms;
+  std::string err;
+  REQUIRE_FALSE(tinygltf::BuildNodeTransforms(model, &xforms, &err));
+  REQUIRE_THAT(err, Catch::Contains("nodes[3].scale"));
+  REQUIRE(xforms.size() == 4);
+  REQUIRE(xforms[3].flags == 0);
+  REQUIRE(xforms[3].scale[1] == 1.0);
+
+  typedef tinygltf::NodeTransform<double> Xform;
+  REQUIRE(xforms[0].flags == Xform::HAS_TRANSLATION);
+  REQUIRE(xforms[1].flags == (Xform::HAS_ROTATION | Xform::HAS_SCALE));
+  REQUIRE(xforms[2].flags == Xform::HAS_MATRIX);
+
+  double m[16];
+  xforms[0].LocalMatrix(m);
+  REQUIRE(m[0] == 1.0);
+  REQUIRE(m[12] == 1.0);
+  REQUIRE(m[13] == 2.0);
+  REQUIRE(m[14] == 3.0);
+
+  // +X is mapped to +2Y.
+  xforms[1].LocalMatrix(m);
+  REQUIRE(m[0] == Approx(0.0));
+  REQUIRE(m[1] == Approx(2.0));
+  REQUIRE(m[4] == Approx(-2.0));
+  REQUIRE(m[10] == Approx(2.0));
+
+  xforms[2].LocalMatrix(m);
+  REQUIRE(m[12] == 4.0);
+  REQUIRE(m[14] == 6.0);
+
+  model.nodes.resize(3);
+  std::vector<tinygltf::NodeTransform<float> > xformsf;
+  REQUIRE(tinygltf::BuildNodeTransforms(model, &xformsf));
+  float mf[16];
+  xformsf[1].LocalMatrix(mf);
+  REQUIRE(mf[1] == Approx(2.0f));
+}
+
+TEST_CASE("scene-transforms", "[node]") {
+  tinygltf::Model model;
+  model.nodes.resize(5);
+  model.nodes[0].translation = {1.0, 0.0, 0.0};
+  model.nodes[0].children = {1, 3};
+  model.nodes[1].translation = {0.0, 2.0, 0.0};
+  model.nodes[1].children = {2};
+  model.nodes[2].scale = {2.0, 2.0, 2.0};
+  model.nodes[2].translation = {0.0, 0.0, 3.0};
+  model.nodes[3].translation = {0.0, 0.0, -1.0};
+  model.nodes[4].translation = {5.0, 0.0, 0.0};
+  model.scenes.resize(1);
+  model.scenes[0].nodes = {4, 0};
+
+  tinygltf::SceneTransforms<double> xforms;
+  std::string err;
+  REQUIRE(xforms.Build(model, -1, &err));
+  REQUIRE(xforms.Size() == 5);
+  REQUIRE(xforms.Nodes() == std::vector<int>({4, 0, 1, 2, 3}));
+
+  const double *w = xforms.WorldMatrix(2);
+  REQUIRE(w != nullptr);
+  REQUIRE(w[0] == 2.0);
+  REQUIRE(w[12] == 1.0);
+  REQUIRE(w[13] == 2.0);
+  REQUIRE(w[14] == 3.0);
+  REQUIRE(xforms.WorldMatrix(3)[14] == -1.0);
+  REQUIRE(xforms.WorldMatrix(4)[12] == 5.0);
+
+  // Moving node 1 updates its subtree only.
+  tinygltf::NodeTransform<double> moved = *xforms.LocalTransform(1);
+  moved.translation[1] = 10.0;
+  xforms.SetLocalTransform(1, moved);
+  xforms.MarkDirty(2);
+  xforms.Update();
+  REQUIRE(xforms.WorldMatrix(1)[13] == 10.0);
+  REQUIRE(xforms.WorldMatrix(2)[13] == 10.0);
+  REQUIRE(xforms.WorldMatrix(2)[14] == 3.0);
+  REQUIRE(xforms.WorldMatrix(3)[13] == 0.0);
+
+  // Moving a root updates all of its descendants.
+  moved = *xforms.LocalTransform(0);
+  moved.translation[0] = -1.0;
+  xforms.SetLocalTransform(0, moved);
+  xforms.Update();
+  REQUIRE(xforms.WorldMatrix(2)[12] == -1.0);
+  REQUIRE(xforms.WorldMatrix(3)[12] == -1.0);
+  REQUIRE(xforms.WorldMatrix(4)[12] == 5.0);
+
+  // Node not in the scene.
+  model.nodes.resize(6);
+  REQUIRE(xforms.Build(model, 0, &err));
+  REQUIRE(xforms.WorldMatrix(5) == nullptr);
+  REQUIRE(xforms.LocalTransform(5) == nullptr);
+  REQUIRE(xforms.LocalTransform(-1) == nullptr);
+  REQUIRE(xforms.Slot(5) == -1);
+
+  // Errors.
+  REQUIRE_FALSE(xforms.Build(model, 1, &err));
+  REQUIRE_THAT(err, Catch::Contains("Invalid scene index"));
+  err.clear();
+  model.nodes[3].children = {0};
+  REQUIRE_FALSE(xforms.Build(model, 0, &err));
+  REQUIRE_THAT(err, Catch::Contains("referenced more than once"));
+  err.clear();
+  model.nodes[3].children = {7};
+  REQUIRE_FALSE(xforms.Build(model, 0, &err));
+  REQUIRE_THAT(err, Catch::Contains("Invalid node index 7"));
+
+  // A failed Build leaves an empty scene.
+  REQUIRE(xforms.Size() == 0);
+  REQUIRE(xforms.WorldMatrices().empty());
+  REQUIRE(xforms.Slot(0) == -1);
+  REQUIRE(xforms.WorldMatrix(0) == nullptr);
+  REQUIRE(xforms.LocalTransform(0) == nullptr);
+  xforms.SetLocalTransform(0, tinygltf::NodeTransform<double>());
+  xforms.MarkDirty(0);
+  xforms.Update();
+  REQUIRE(xforms.Size() == 0);
+
+  // Only the transforms of the nodes of the scene are checked.
+  model.nodes[3].children.clear();
+  model.nodes[5].rotation = {1.0};
+  REQUIRE(xforms.Build(model, 0, &err));
+  REQUIRE(xforms.Size() == 5);
+  model.nodes[3].rotation = {1.0};
+  REQUIRE_FALSE(xforms.Build(model, 0, &err));
+  REQUIRE_THAT(err, Catch::Contains("nodes[3].rotation must have 4"));
+  REQUIRE(xforms.WorldMatrix(4) == nullptr);
+}
+
+TEST_CASE("animation-evaluator", "[animation]") {
+  tinygltf::Model model;
+  model.buffers.resize(1);
+  model.nodes.resize(2);
+  // Appends a float accessor with `values`.
+  auto add_accessor = [&](const std::vector<float> &values, int type) {
+    std::vector<unsigned char> &data = model.buffers[0].data;
+    tinygltf::BufferView view;
+    view.buffer = 0;
+    view.byteOffset = data.size();
+    view.byteLength = values.size() * sizeof(float);
+    data.resize(data.size() + view.byteLength);
+    memcpy(&data[view.byteOffset], values.data(), view.byteLength);
+    model.bufferViews.push_back(view);
+
+    tinygltf::Accessor accessor;
+    accessor.bufferView = int(model.bufferViews.size() - 1);
+    accessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+    accessor.type = type;
+    accessor.count =
+        values.size() / size_t(tinygltf::GetNumComponentsInType(uint32_t(type)));
+    model.accessors.push_back(accessor);
+    return int(model.accessors.size() - 1);
+  };
+  auto add_channel = [&](int node, const char *path, int input, int output,
+                         const char *interpolation) {
+    tinygltf::Animation &animation = model.animations[0];
+    tinygltf::AnimationSampler sampler;
+    sampler.input = input;
+    sampler.output = output;
+    sampler.interpolation = interpolation;
+    animation.samplers.push_back(sampler);
+    tinygltf::AnimationChannel channel;
+    channel.sampler = int(animation.samplers.size() - 1);
+    channel.target_node = node;
+    channel.target_path = path;
+    animation.channels.push_back(channel);
+  };
+
+  model.animations.resize(1);
+  const int times = add_accessor({1.0f, 2.0f, 4.0f}, TINYGLTF_TYPE_SCALAR);
+  add_channel(0, "translation", times,
+              add_accessor({0, 0, 0, 1, 2, 3, 3, 6, 9}, TINYGLTF_TYPE_VEC3),
+              "LINEAR");
+  // 0 and 90 degrees around +Z, then back to 0.
+  const float h = std::sqrt(0.5f);
+  add_channel(0, "rotation", times,
+              add_accessor({0, 0, 0, 1, 0, 0, h, h, 0, 0, 0, 1},
+                           TINYGLTF_TYPE_VEC4),
+              "LINEAR");
+  add_channel(1, "scale", times,
+              add_accessor({1, 1, 1, 2, 2, 2, 3, 3, 3}, TINYGLTF_TYPE_VEC3),
+              "STEP");
+  add_channel(1, "weights", times,
+              add_accessor({0, 1, 0.5f, 0.5f, 1, 0}, TINYGLTF_TYPE_SCALAR),
+              "LINEAR");
+  // Zero tangents: smoothstep between the values.
+  add_channel(1, "translation",
+              add_accessor({0.0f, 1.0f}, TINYGLTF_TYPE_SCALAR),
+              add_accessor({0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 2, 2, 0, 0, 0},
+                           TINYGLTF_TYPE_VEC3),
+              "CUBICSPLINE");
+  // Skipped.
+  add_channel(-1, "translation", times, 1, "LINEAR");
+
+  tinygltf::AnimationEvaluator anim;
+  std::string err;
+  REQUIRE(anim.Init(model, 0, &err));
+  REQUIRE(anim.StartTime() == 0.0f);
+  REQUIRE(anim.EndTime() == 4.0f);
+
+  std::vector<tinygltf::NodeTransform<float> > pose;
+  REQUIRE(tinygltf::BuildNodeTransforms(model, &pose));
+  std::vector<std::vector<float> > weights;
+  tinygltf::AnimationCursor cursor;
+
+  anim.Evaluate(1.5f, &cursor, &pose, &weights);
+  REQUIRE(pose[0].translation[0] == Approx(0.5f));
+  REQUIRE(pose[0].translation[2] == Approx(1.5f));
+  REQUIRE((pose[0].flags & tinygltf::NodeTransform<float>::HAS_ROTATION) != 0);
+  // 45 degrees around +Z.
+  REQUIRE(pose[0].rotation[2] == Approx(std::sin(0.3926991f)));
+  REQUIRE(pose[0].rotation[3] == Approx(std::cos(0.3926991f)));
+  REQUIRE(pose[1].scale[0] == 1.0f);
+  REQUIRE(weights.size() == 2);
+  REQUIRE(weights[1].size() == 2);
+  REQUIRE(weights[1][0] == Approx(0.25f));
+  REQUIRE(weights[1][1] == Approx(0.75f));
+  REQUIRE(pose[1].translation[0] == Approx(2.0f));
+
+  // Forward playback, then a jump back.
+  anim.Evaluate(3.0f, &cursor, &pose, &weights);
+  REQUIRE(pose[0].translation[1] == Approx(4.0f));
+  REQUIRE(pose[1].scale[0] == 2.0f);
+  REQUIRE(cursor.keys[0] == 1);
+  anim.Evaluate(10.0f, &cursor, &pose, &weights);
+  REQUIRE(pose[0].translation[2] == Approx(9.0f));
+  REQUIRE(pose[1].scale[0] == 3.0f);
+  anim.Evaluate(0.0f, &cursor, &pose, &weights);
+  REQUIRE(pose[0].translation[0] == 0.0f);
+  REQUIRE(pose[1].translation[0] == 0.0f);
+  anim.Evaluate(0.5f, &cursor, &pose, &weights);
+  REQUIRE(pose[1].translation[0] == Approx(1.0f));
+
+  // Batch evaluation matches single evaluation.
+  const size_t count = 50;
+  std::vector<float> instance_times(count);
+  std::vector<tinygltf::AnimationCursor> cursors(count);
+  std::vector<std::vector<tinygltf::NodeTransform<float> > > poses(count, pose);
+  for (size_t i = 0; i < count; i++) {
+    instance_times[i] = float(i) * 0.1f;
+  }
+  anim.Evaluate(count, instance_times.data(), cursors.data(), poses.data(),
+                nullptr, 4);
+  for (size_t i = 0; i < count; i++) {
+    tinygltf::AnimationCursor single;
+    anim.Evaluate(instance_times[i], &single, &pose);
+    REQUIRE(memcmp(&poses[i][0], &pose[0], sizeof(pose[0])) == 0);
+    REQUIRE(memcmp(&poses[i][1], &pose[1], sizeof(pose[1])) == 0);
+  }
+
+  // Errors.
+  REQUIRE_FALSE(anim.Init(model, 1, &err));
+  REQUIRE_THAT(err, Catch::Contains("Invalid animation index"));
+  err.clear();
+  model.animations[0].samplers[0].output = times;
+  REQUIRE_FALSE(anim.Init(model, 0, &err));
+  REQUIRE_THAT(err, Catch::Contains("must have 3 components"));
+}
+
+TEST_CASE("value-storage", "[value]") {
+  tinygltf::Value::Object object;
+  object["name"] = tinygltf::Value(std::string(40, 'x'));
+  object["list"] = tinygltf::Value(tinygltf::Value::Array{
+      tinygltf::Value(1), tinygltf::Value(2.5), tinygltf::Value(true)});
+  object["big"] = tinygltf::Value(uint64_t(1) << 40);
+  tinygltf::Value value(std::move(object));
+
+  // Copies are deep.
+  tinygltf::Value copy = value;
+  REQUIRE(copy == value);
+  copy.Get<tinygltf::Value::Object>()["name"] = tinygltf::Value(1);
+  REQUIRE(value.Get("name").Get<std::string>() == std::string(40, 'x'));
+  REQUIRE_FALSE(copy == value);
+
+  // Assigning an element of a Value to itself.
+  tinygltf::Value list = value.Get("list");
+  list = list.Get(1);
+  REQUIRE(list.IsReal());
+  REQUIRE(list.Get<double>() == 2.5);
+  copy = std::move(copy.Get<tinygltf::Value::Object>()["list"]);
+  REQUIRE(copy.IsArray());
+  REQUIRE(copy.ArrayLen() == 3);
+  const tinygltf::Value &self = copy;
+  copy = self;
+  REQUIRE(copy.ArrayLen() == 3);
+
+  // const Get<T>() of another type returns a default value.
+  REQUIRE(value.Get("name").Get<int>() == 0);
+  REQUIRE(value.Get("name").Get<tinygltf::Value::Array>().empty());
+  REQUIRE(value.Get("list").Get<std::string>().empty());
+  REQUIRE(tinygltf::Value(3).Get<double>() == 3.0);
+
+  // Non-const Get<T>() of another type also returns a default value and
+  // leaves the value unchanged.
+  tinygltf::Value number(7);
+  REQUIRE(number.Get<std::string>().empty());
+  number.Get<std::string>() = "discarded";
+  REQUIRE(number.Get<std::string>().empty());
+  REQUIRE(number.IsInt());
+  REQUIRE(number.Get<int>() == 7);
+  tinygltf::Value big(uint64_t(1) << 40);
+  REQUIRE(big.Get<double>() == 0.0);
+  REQUIRE(big.IsUInt());
+  REQUIRE(big.Get<uint64_t>() == (uint64_t(1) << 40));
+  tinygltf::Value mutable_copy = value;
+  REQUIRE(mutable_copy.Get<std::string>().empty());
+  REQUIRE(mutable_copy.Get<tinygltf::Value::Array>().empty());
+  REQUIRE(mutable_copy.IsObject());
+  REQUIRE(mutable_copy == value);
+
+  // Get(idx) and Get(key) on a non container Value return a null Value.
+  const tinygltf::Value long_string(std::string(64, 'y'));
+  const tinygltf::Value real(1.5);
+  const tinygltf::Value null_value;
+  REQUIRE(long_string.Get(2).Type() == tinygltf::NULL_TYPE);
+  REQUIRE(long_string.Get("name").Type() == tinygltf::NULL_TYPE);
+  REQUIRE(real.Get(0).Type() == tinygltf::NULL_TYPE);
+  REQUIRE(real.Get("name").Type() == tinygltf::NULL_TYPE);
+  REQUIRE(null_value.Get(0).Type() == tinygltf::NULL_TYPE);
+  REQUIRE(null_value.Get("name").Type() == tinygltf::NULL_TYPE);
+  REQUIRE(value.Get(0).Type() == tinygltf::NULL_TYPE);
+  REQUIRE(value.Get("list").Get("name").Type() == tinygltf::NULL_TYPE);
+
+  // Unsigned and negative numbers.
+  REQUIRE(value.Get("big").IsNumber());
+  REQUIRE(value.Get("big").GetNumberAsDouble() == double(uint64_t(1) << 40));
+  REQUIRE(value.Size() == 3);
+  REQUIRE(value.Get("list").Size() == 3);
+
+  tinygltf::Model model;
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+  const std::string gltf =
+      R"({"asset": {"version": "2.0"}, "extras": {"a": -3, "b": 4}})";
+  REQUIRE(ctx.LoadASCIIFromString(&model, &err, &warn, gltf.c_str(),
+                                  gltf.size(), ""));
+  REQUIRE(model.extras.Get("a").IsInt());
+  REQUIRE(model.extras.Get("a").GetNumberAsInt() == -3);
+  REQUIRE(model.extras.Get("b").GetNumberAsInt() == 4);
+}
+
+TEST_CASE("lazy-extras", "[extras]") {
+  const std::string gltf = R"({
+    "asset": {"version": "2.0"},
+    "extras": {"name": "root", "values": [1, 2, {"nested": "}]\""}]},
+    "extensionsUsed": ["KHR_texture_transform", "EXT_custom"],
+    "extensions": {"EXT_custom": {"a/b": 1, "extras": {"inner": true}}},
+    "nodes": [
+      {"name": "n0"},
+      {"name": "n1", "extras": {"id": 7}, "extensions": {"EXT_custom": {"x": 2}}}
+    ],
+    "materials": [{
+      "pbrMetallicRoughness": {
+        "baseColorTexture": {
+          "index": 0,
+          "extensions": {"KHR_texture_transform": {"scale": [2, 3]}}
+        }
+      },
+      "extras": "material"
+    }]
+  })";
+
+  tinygltf::Model model;
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+  ctx.SetLazyExtrasAndExtensions(true);
+  REQUIRE(ctx.LoadASCIIFromString(&model, &err, &warn, gltf.c_str(),
+                                  gltf.size(), ""));
+  REQUIRE(model.lazy_json);
+  REQUIRE(model.nodes.size() == 2);
+  REQUIRE(model.nodes[1].extras.Type() == tinygltf::NULL_TYPE);
+  REQUIRE(model.nodes[1].extensions.empty());
+  REQUIRE(model.extensions.empty());
+
+  const tinygltf::LazyJson &lazy = *model.lazy_json;
+  tinygltf::Value extras;
+  REQUIRE(lazy.GetExtras("", &extras));
+  REQUIRE(extras.Get("name").Get<std::string>() == "root");
+  REQUIRE(extras.Get("values").ArrayLen() == 3);
+  REQUIRE(extras.Get("values").Get(2).Get("nested").Get<std::string>() ==
+          "}]\"");
+
+  REQUIRE(!lazy.HasExtras("/nodes/0"));
+  REQUIRE(!lazy.GetExtras("/nodes/0", &extras));
+  REQUIRE(lazy.GetExtras("/nodes/1", &extras));
+  REQUIRE(extras.Get("id").GetNumberAsInt() == 7);
+  std::string json;
+  REQUIRE(lazy.GetExtrasJson("/nodes/1", &json));
+  REQUIRE(json == R"({"id": 7})");
+  REQUIRE(lazy.GetExtras("/materials/0", &extras));
+  REQUIRE(extras.Get<std::string>() == "material");
+
+  tinygltf::ExtensionMap extensions;
+  REQUIRE(lazy.GetExtensions("/nodes/1", &extensions));
+  REQUIRE(extensions.size() == 1);
+  REQUIRE(extensions["EXT_custom"].Get("x").GetNumberAsInt() == 2);
+  REQUIRE(lazy.GetExtensions(
+      "/materials/0/pbrMetallicRoughness/baseColorTexture", &extensions));
+  REQUIRE(extensions["KHR_texture_transform"].Get("scale").ArrayLen() == 2);
+  REQUIRE(lazy.GetExtensions("", &extensions));
+  REQUIRE(extensions["EXT_custom"].Get("a/b").GetNumberAsInt() == 1);
+
+  // Objects inside extensions.
+  REQUIRE(lazy.GetExtras("/extensions/EXT_custom", &extras));
+  REQUIRE(extras.Get("inner").Get<bool>());
+  REQUIRE(lazy.Source() == gltf);
+  REQUIRE(!lazy.HasExtras("/nodes/2"));
+  REQUIRE(!lazy.HasExtras("/nodes/n1"));
+
+  // Objects get their spans by their index while loading.
+  REQUIRE(!model.nodes[0].lazy_extras.HasExtras());
+  REQUIRE(model.nodes[1].lazy_extras.GetExtras(&extras));
+  REQUIRE(extras.Get("id").GetNumberAsInt() == 7);
+  REQUIRE(model.materials[0].lazy_extras.GetExtras(&extras));
+  REQUIRE(extras.Get<std::string>() == "material");
+  REQUIRE(model.materials[0]
+              .pbrMetallicRoughness.baseColorTexture.lazy_extras
+              .HasExtensions());
+  REQUIRE(model.materials[0].pbrMetallicRoughness.lazy_extras.Empty());
+
+#ifndef TINYGLTF_NO_THREADS
+  // Getters may run concurrently, also with a load on another thread.
+  {
+    std::atomic<int> found(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&lazy, &found]() {
+        tinygltf::Value value;
+        tinygltf::ExtensionMap map;
+        if (lazy.GetExtras("/nodes/1", &value) &&
+            value.Get("id").GetNumberAsInt() == 7 &&
+            lazy.GetExtensions("/nodes/1", &map) && map.size() == 1) {
+          found++;
+        }
+      });
+    }
+    tinygltf::TinyGLTF loader;
+    tinygltf::Model other;
+    std::string other_err;
+    std::string other_warn;
+    const bool loaded = loader.LoadASCIIFromString(
+        &other, &other_err, &other_warn, gltf.c_str(), gltf.size(), "");
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    REQUIRE(loaded);
+    REQUIRE(found == 4);
+  }
+#endif
+
+  // Saving writes the extras and extensions of lazy_json, without keeping
+  // them in the model.
+  tinygltf::Model eager;
+  {
+    tinygltf::TinyGLTF eager_ctx;
+    REQUIRE(eager_ctx.LoadASCIIFromString(&eager, &err, &warn, gltf.c_str(),
+                                          gltf.size(), ""));
+  }
+  for (int direct = 0; direct < 2; direct++) {
+    INFO(direct);
+    tinygltf::TinyGLTF writer;
+    writer.SetDirectJsonWriter(direct == 1);
+    std::stringstream ss;
+    REQUIRE(writer.WriteGltfSceneToStream(&model, ss, false, false));
+    REQUIRE(model.nodes[1].extras.Type() == tinygltf::NULL_TYPE);
+    REQUIRE(model.extensions.empty());
+
+    const std::string saved = ss.str();
+    tinygltf::Model reloaded;
+    REQUIRE(writer.LoadASCIIFromString(&reloaded, &err, &warn, saved.c_str(),
+                                       saved.size(), ""));
+    REQUIRE(reloaded == eager);
+  }
+
+  // Lazy models are compared by the source of their extras and extensions.
+  {
+    tinygltf::Model same;
+    REQUIRE(ctx.LoadASCIIFromString(&same, &err, &warn, gltf.c_str(),
+                                     gltf.size(), ""));
+    REQUIRE(same == model);
+
+    std::string changed = gltf;
+    changed.replace(changed.find("\"id\": 7"), 7, "\"id\": 8");
+    tinygltf::Model other;
+    REQUIRE(ctx.LoadASCIIFromString(&other, &err, &warn, changed.c_str(),
+                                     changed.size(), ""));
+    REQUIRE_FALSE(other == model);
+    REQUIRE_FALSE(eager == model);
+  }
+
+  // Loading again without the option parses eagerly and drops lazy_json.
+  ctx.SetLazyExtrasAndExtensions(false);
+  REQUIRE(ctx.LoadASCIIFromString(&model, &err, &warn, gltf.c_str(),
+                                  gltf.size(), ""));
+  REQUIRE(!model.lazy_json);
+  REQUIRE(model.nodes[1].extras.Get("id").GetNumberAsInt() == 7);
+  REQUIRE(model.extensions.size() == 1);
+
+  // Keys with '~' and '/' are escaped as "~0" and "~1".
+  const std::string keys = R"({"a/b": {"c~d": {"extras": 1}}})";
+  tinygltf::LazyJson escaped(keys.c_str(), keys.size());
+  REQUIRE(escaped.HasExtras("/a~1b/c~0d"));
+}
+
+TEST_CASE("lazy-extras-round-trip", "[extras]") {
+  // `extras` and `extensions` named after their owner.
+  auto x = [](const std::string &name) {
+    return R"("extras": {"t": ")" + name +
+           R"("}, "extensions": {"EXT_t": {"t": ")" + name + R"("}})";
+  };
+  // With a UTF-8 BOM, which the JSON parsers accept.
+  const std::string gltf =
+      "\xEF\xBB\xBF{"
+      R"("asset": {"version": "2.0", )" + x("asset") + "}," +
+      R"("extras": {"t": "root"},)"
+      R"("extensionsUsed": ["EXT_t", "KHR_lights_punctual"],)"
+      R"("extensions": {"EXT_t": {"t": "root"}, "KHR_lights_punctual": {)"
+      R"("lights": [{"type": "spot", "spot": {)" + x("spot") + "}, " +
+      x("light") + "}]}}," +
+      R"("buffers": [{"byteLength": 12, )"
+      R"("uri": "data:application/octet-stream;base64,AAAAAAAAAAAAAAAA", )" +
+      x("buffer") + "}]," +
+      R"("bufferViews": [{"buffer": 0, "byteLength": 12, )" + x("view") +
+      "}]," +
+      R"("accessors": [{"bufferView": 0, "componentType": 5126, "count": 1, )"
+      R"("type": "VEC3", )" + x("accessor") + "}]," +
+      R"("meshes": [{"primitives": [{"attributes": {"POSITION": 0}, )" +
+      x("primitive") + "}], " + x("mesh") + "}]," +
+      R"("nodes": [{"mesh": 0, )" + x("node0") + "}, {" + x("node1") + "}]," +
+      R"("scenes": [{"nodes": [0], )" + x("scene") + "}]," +
+      R"("skins": [{"joints": [1], )" + x("skin") + "}]," +
+      R"("images": [{"bufferView": 0, "mimeType": "image/png", )" +
+      x("image") + "}]," +
+      R"("samplers": [{)" + x("sampler") + "}]," +
+      R"("textures": [{"source": 0, "sampler": 0, )" + x("texture") + "}]," +
+      R"("materials": [{"pbrMetallicRoughness": {)"
+      R"("baseColorTexture": {"index": 0, )" + x("baseColor") + "}, " +
+      R"("metallicRoughnessTexture": {"index": 0, )" +
+      x("metallicRoughness") + "}, " + x("pbr") + "}, " +
+      R"("normalTexture": {"index": 0, )" + x("normal") + "}, " +
+      R"("occlusionTexture": {"index": 0, )" + x("occlusion") + "}, " +
+      R"("emissiveTexture": {"index": 0, )" + x("emissive") + "}, " +
+      x("material") + "}]," +
+      R"("cameras": [)"
+      R"({"type": "perspective", "perspective": {"yfov": 1, "znear": 0.1, )" +
+      x("perspective") + "}, " + x("camera0") + "}, " +
+      R"({"type": "orthographic", "orthographic": {"xmag": 1, "ymag": 1, )"
+      R"("zfar": 10, "znear": 0.1, )" + x("orthographic") + "}, " +
+      x("camera1") + "}]," +
+      R"("animations": [{)"
+      R"("channels": [{"sampler": 0, "target": {"node": 0, )"
+      R"("path": "translation", "extensions": {"EXT_t": {"t": "target"}}}, )" +
+      x("channel") + "}], " +
+      R"("samplers": [{"input": 0, "output": 0, )" + x("animationSampler") +
+      "}], " + x("animation") + "}]}";
+
+  std::string err;
+  std::string warn;
+  auto load = [&](const std::string &json, bool lazy) {
+    tinygltf::TinyGLTF ctx;
+    ctx.SetImageLoader(
+        [](tinygltf::Image *, const int, std::string *, std::string *, int,
+           int, const unsigned char *, int, void *) { return true; },
+        nullptr);
+    ctx.SetLazyExtrasAndExtensions(lazy);
+    tinygltf::Model model;
+    REQUIRE(ctx.LoadASCIIFromString(&model, &err, &warn, json.c_str(),
+                                    json.size(), ""));
+    return model;
+  };
+  bool direct = false;
+  // Saves `model` and loads it back eagerly.
+  auto save = [&](tinygltf::Model *model) {
+    tinygltf::TinyGLTF writer;
+    writer.SetDirectJsonWriter(direct);
+    std::stringstream ss;
+    REQUIRE(writer.WriteGltfSceneToStream(model, ss, false, false));
+    return load(ss.str(), false);
+  };
+
+  // Every object type gets its lazy extras and extensions, and writes them.
+  {
+    tinygltf::Model lazy = load(gltf, true);
+    REQUIRE(lazy.extras.Type() == tinygltf::NULL_TYPE);
+    tinygltf::Model saved = save(&lazy);
+    std::set<std::string> names;
+    tinygltf::ForEachExtrasOwner(
+        &saved, [&](const tinygltf::LazyExtras &, tinygltf::Value *extras,
+                    tinygltf::ExtensionMap *extensions) {
+          const auto it = extensions->find("EXT_t");
+          if (it == extensions->end()) {
+            REQUIRE((!extras || extras->Type() == tinygltf::NULL_TYPE));
+            return;
+          }
+          const std::string name = it->second.Get("t").Get<std::string>();
+          INFO(name);
+          if (extras) {
+            REQUIRE(extras->Get("t").Get<std::string>() == name);
+          }
+          names.insert(name);
+        });
+    const std::set<std::string> expected = {
+        "root",      "asset",       "buffer",      "view",
+        "accessor",  "mesh",        "primitive",   "node0",
+        "node1",     "scene",       "skin",        "image",
+        "sampler",   "texture",     "material",    "pbr",
+        "baseColor", "metallicRoughness",          "normal",
+        "occlusion", "emissive",    "camera0",     "perspective",
+        "camera1",   "orthographic", "animation",  "channel",
+        "target",    "animationSampler",           "light",
+        "spot"};
+    REQUIRE(names == expected);
+    REQUIRE(saved.lights.size() == 1);
+    REQUIRE(saved == save(&saved));
+  }
+
+  // Edits of a lazily loaded model are saved like those of an eagerly loaded
+  // one.
+  auto edit = [](tinygltf::Model *model) {
+    std::swap(model->nodes[0], model->nodes[1]);
+    model->materials[0].extras = tinygltf::Value(std::string("edited"));
+    model->cameras[1].orthographic.extensions["EXT_t"] =
+        tinygltf::Value(tinygltf::Value::Object());
+    tinygltf::Primitive &primitive = model->meshes[0].primitives[0];
+    primitive.lazy_extras.Load(&primitive.extras, &primitive.extensions);
+    primitive.extensions["EXT_u"] =
+        tinygltf::Value(tinygltf::Value::Object());
+    model->animations[0].channels[0].target_lazy_extras.Reset();
+    model->animations[0].channels[0].target_extensions.clear();
+    model->lights[0].spot.lazy_extras.Reset();
+    model->lights[0].spot.extras = tinygltf::Value();
+    model->lights[0].spot.extensions.clear();
+  };
+  for (int d = 0; d < 2; d++) {
+    INFO(d);
+    direct = (d == 1);
+    tinygltf::Model lazy = load(gltf, true);
+    tinygltf::Model eager = load(gltf, false);
+    edit(&lazy);
+    edit(&eager);
+    tinygltf::Model saved_lazy = save(&lazy);
+    REQUIRE(saved_lazy == save(&eager));
+    REQUIRE(saved_lazy.materials[0].extras.Get<std::string>() == "edited");
+    REQUIRE(saved_lazy.nodes[0].extras.Get("t").Get<std::string>() ==
+            "node1");
+    REQUIRE(saved_lazy.meshes[0].primitives[0].extensions.size() == 2);
+    REQUIRE(saved_lazy.animations[0].channels[0].target_extensions.empty());
+  }
+}
+
+TEST_CASE("lazy-extras-edit", "[extras]") {
+  const std::string gltf = R"({
+    "asset": {"version": "2.0"},
+    "nodes": [
+      {"name": "n0", "extras": {"id": 0}},
+      {"name": "n1", "extras": {"id": 1},
+       "extensions": {"EXT_a": {"v": 1}, "EXT_b": {"v": 2}}},
+      {"name": "n2", "extras": {"id": 2}}
+    ],
+    "buffers": [{"byteLength": 12,
+      "uri": "data:application/octet-stream;base64,AAAAAAAAAAAAAAAA"}],
+    "bufferViews": [{"buffer": 0, "byteLength": 12}],
+    "accessors": [
+      {"bufferView": 0, "componentType": 5126, "count": 1, "type": "VEC3"}
+    ],
+    "meshes": [{"primitives": [
+      {"extras": "skipped"},
+      {"attributes": {"POSITION": 0}, "extras": "kept"}
+    ]}]
+  })";
+
+  tinygltf::TinyGLTF ctx;
+  std::string err;
+  std::string warn;
+  ctx.SetLazyExtrasAndExtensions(true);
+  auto load = [&]() {
+    tinygltf::Model model;
+    REQUIRE(ctx.LoadASCIIFromString(&model, &err, &warn, gltf.c_str(),
+                                    gltf.size(), ""));
+    return model;
+  };
+  bool direct = false;
+  // Saves `model` and loads it back eagerly.
+  auto save = [&](tinygltf::Model *model) {
+    tinygltf::TinyGLTF writer;
+    writer.SetDirectJsonWriter(direct);
+    std::stringstream ss;
+    REQUIRE(writer.WriteGltfSceneToStream(model, ss, false, false));
+    const std::string saved = ss.str();
+    tinygltf::Model reloaded;
+    REQUIRE(writer.LoadASCIIFromString(&reloaded, &err, &warn, saved.c_str(),
+                                       saved.size(), ""));
+    return reloaded;
+  };
+
+  // The primitive without attributes is skipped, the kept one still has its
+  // extras.
+  {
+    tinygltf::Model model = load();
+    REQUIRE(model.meshes[0].primitives.size() == 1);
+    tinygltf::Value extras;
+    REQUIRE(model.meshes[0].primitives[0].lazy_extras.GetExtras(&extras));
+    REQUIRE(extras.Get<std::string>() == "kept");
+    tinygltf::Model saved = save(&model);
+    REQUIRE(saved.meshes[0].primitives[0].extras.Get<std::string>() ==
+            "kept");
+  }
+
+  // Erased and reordered objects keep their own extras.
+  {
+    tinygltf::Model model = load();
+    model.nodes.erase(model.nodes.begin());
+    std::swap(model.nodes[0], model.nodes[1]);
+    tinygltf::Model saved = save(&model);
+    REQUIRE(saved.nodes.size() == 2);
+    REQUIRE(saved.nodes[0].name == "n2");
+    REQUIRE(saved.nodes[0].extras.Get("id").GetNumberAsInt() == 2);
+    REQUIRE(saved.nodes[0].extensions.empty());
+    REQUIRE(saved.nodes[1].name == "n1");
+    REQUIRE(saved.nodes[1].extras.Get("id").GetNumberAsInt() == 1);
+    REQUIRE(saved.nodes[1].extensions.size() == 2);
+  }
+
+  // Cleared after Load(), or dropped with Reset(): nothing is written.
+  {
+    tinygltf::Model model = load();
+    tinygltf::Node &node = model.nodes[1];
+    node.lazy_extras.Load(&node.extras, &node.extensions);
+    REQUIRE(node.lazy_extras.Empty());
+    REQUIRE(node.extras.Get("id").GetNumberAsInt() == 1);
+    REQUIRE(node.extensions.size() == 2);
+    node.extras = tinygltf::Value();
+    node.extensions.clear();
+    model.nodes[2].lazy_extras.Reset();
+    tinygltf::Model saved = save(&model);
+    REQUIRE(saved.nodes[0].extras.Get("id").GetNumberAsInt() == 0);
+    REQUIRE(saved.nodes[1].extras.Type() == tinygltf::NULL_TYPE);
+    REQUIRE(saved.nodes[1].extensions.empty());
+    REQUIRE(saved.nodes[2].extras.Type() == tinygltf::NULL_TYPE);
+  }
+
+  // An added extension is written along with the lazy ones, and replaces
+  // the lazy one of the same name.
+  {
+    tinygltf::Model model = load();
+    tinygltf::Node &node = model.nodes[1];
+    tinygltf::Value::Object b;
+    b["v"] = tinygltf::Value(4);
+    tinygltf::Value::Object c;
+    c["v"] = tinygltf::Value(3);
+    node.extensions["EXT_b"] = tinygltf::Value(b);
+    node.extensions["EXT_c"] = tinygltf::Value(c);
+    tinygltf::Model saved = save(&model);
+    REQUIRE(node.extensions.size() == 2);
+    tinygltf::ExtensionMap &extensions = saved.nodes[1].extensions;
+    REQUIRE(extensions.size() == 3);
+    REQUIRE(extensions["EXT_a"].Get("v").GetNumberAsInt() == 1);
+    REQUIRE(extensions["EXT_b"].Get("v").GetNumberAsInt() == 4);
+    REQUIRE(extensions["EXT_c"].Get("v").GetNumberAsInt() == 3);
+
+    // Load() merges the same way.
+    node.lazy_extras.Load(&node.extras, &node.extensions);
+    REQUIRE(node.extensions.size() == 3);
+    REQUIRE(node.extensions["EXT_b"].Get("v").GetNumberAsInt() == 4);
+  }
+}
+
+#ifdef TINYGLTF_USE_ARENA
+TEST_CASE("arena", "[arena]") {
+  tinygltf::ModelVector<int> outlived;
+  {
+    tinygltf::Arena arena(256);
+    tinygltf::Arena::Scope scope(&arena);
+    REQUIRE(tinygltf::Arena::Current() == &arena);
+    {
+      tinygltf::Arena::Scope heap(nullptr);
+      REQUIRE(tinygltf::Arena::Current() == nullptr);
+    }
+    REQUIRE(tinygltf::Arena::Current() == &arena);
+
+    for (int i = 0; i < 1000; i++) {
+      outlived.push_back(i);
+    }
+    REQUIRE(arena.NumBlocks() > 1);
+
+    // Large arrays are allocated from the heap.
+    const size_t num_blocks = arena.NumBlocks();
+    tinygltf::ModelVector<char> large(2 * 1024 * 1024);
+    REQUIRE(arena.NumBlocks() == num_blocks);
+  }
+  REQUIRE(tinygltf::Arena::Current() == nullptr);
+  REQUIRE(outlived.size() == 1000);
+  REQUIRE(outlived[999] == 999);
+
+  const char *files[] = {
+      "../models/Cube/Cube.gltf",
+      "../models/Cube-texture-ext/Cube-textransform.gltf",
+      "../models/Extensions-issue97/test.gltf",
+      "../models/SparseMorphTargets-issue280/singleBlendshapeCube_sparse.glb",
+      "../models/box01.glb"};
+
+  for (const char *file : files) {
+    INFO(file);
+    const bool binary = (std::string(file).rfind(".glb") != std::string::npos);
+
+    tinygltf::Model copy;
+    {
+      tinygltf::TinyGLTF ctx;
+      std::string err;
+      std::string warn;
+      tinygltf::Model model;
+      REQUIRE((binary ? ctx.LoadBinaryFromFile(&model, &err, &warn, file)
+                      : ctx.LoadASCIIFromFile(&model, &err, &warn, file)));
+      copy = model;
+      REQUIRE(model == copy);
+
+      // Loading again gives the same result.
+      tinygltf::Model reloaded;
+      REQUIRE((binary ? ctx.LoadBinaryFromFile(&reloaded, &err, &warn, file)
+                      : ctx.LoadASCIIFromFile(&reloaded, &err, &warn, file)));
+      REQUIRE(reloaded == copy);
+      copy = std::move(model);
+    }
+
+    // The model outlives the loader and its arenas, and can be freed on
+    // another thread.
+    tinygltf::Model reference = copy;
+    REQUIRE(reference == copy);
+#ifndef TINYGLTF_NO_THREADS
+    std::thread([&copy]() { tinygltf::Model released = std::move(copy); })
+        .join();
+#endif
+    REQUIRE_FALSE(reference.nodes.empty());
+  }
+}
+#endif
@@ -53,21 +53,36 @@
 #ifndef TINY_GLTF_H_
 #define TINY_GLTF_H_
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>  // std::fabs
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <initializer_list>
+#include <iterator>
 #include <limits>
 #include <map>
+#include <memory>
+#include <new>
+#include <ostream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#ifdef TINYGLTF_USE_STRING_INTERNING
+#include <unordered_set>
+#endif
+
 #ifndef TINYGLTF_USE_CPP14
 #include <functional>
 #endif
 
+#ifdef TINYGLTF_USE_ARENA
+#include <atomic>
+#endif
+
 #ifdef __ANDROID__
 #ifdef TINYGLTF_ANDROID_LOAD_FROM_ASSETS
 #include <android/asset_manager.h>
@@ -251,6 +266,556 @@ bool IsDataURI(const std::string &in);
 bool DecodeDataURI(std::vector<unsigned char> *out, std::string &mime_type,
                    const std::string &in, size_t reqBytes, bool checkSize);
 
+#ifdef TINYGLTF_USE_STRING_INTERNING
+class StringPool;
+
+// Handle to a string of a StringPool. Equal strings of the same pool share
+// the same copy, so comparing two handles for equality mostly compares
+// pointers. Ordering compares the characters, so maps keyed by
+// InternedString iterate in the same order as maps keyed by std::string.
+// Handles created while a pool is current(see `StringPool::Scope`) point into
+// it without owning it, and are valid as long as the pool. Other handles own
+// a copy of their string. Copies and moves only share the pooled string when
+// the pool is current or when the destination already points into the same
+// pool, so keys copied or moved out of a Model own their string and outlive
+// its pool.
+class InternedString {
+ public:
+  InternedString() {}
+  inline InternedString(const std::string &s);
+  InternedString(const char *s) : InternedString(std::string(s)) {}
+  InternedString(const InternedString &other) { Copy(other); }
+  InternedString(InternedString &&other) { Move(other); }
+  InternedString &operator=(const InternedString &other) {
+    if (this != &other) {
+      const bool same_pool = pool_ && (pool_ == other.pool_);
+      Reset();
+      if (same_pool) {
+        str_ = other.str_;
+        pool_ = other.pool_;
+      } else {
+        Copy(other);
+      }
+    }
+    return *this;
+  }
+  InternedString &operator=(InternedString &&other) {
+    if (this != &other) {
+      const bool same_pool = pool_ && (pool_ == other.pool_);
+      Reset();
+      if (same_pool) {
+        str_ = other.str_;
+        pool_ = other.pool_;
+      } else {
+        Move(other);
+      }
+    }
+    return *this;
+  }
+  ~InternedString() { Reset(); }
+
+  const std::string &str() const { return str_ ? *str_ : Empty(); }
+  operator const std::string &() const { return str(); }
+  const char *c_str() const { return str().c_str(); }
+  size_t size() const { return str().size(); }
+  bool empty() const { return str().empty(); }
+
+  bool operator==(const InternedString &other) const {
+    // Handles of different pools, or owning a copy, may point to equal
+    // strings.
+    return (str_ == other.str_) ||
+           (((pool_ == nullptr) || (pool_ != other.pool_)) &&
+            (str() == other.str()));
+  }
+  bool operator!=(const InternedString &other) const {
+    return !(*this == other);
+  }
+  bool operator<(const InternedString &other) const {
+    return (str_ != other.str_) && (str() < other.str());
+  }
+
+ private:
+  inline void Copy(const InternedString &other);
+  inline void Move(InternedString &other);
+  void Reset() {
+    if (!pool_) delete str_;
+    str_ = nullptr;
+    pool_ = nullptr;
+  }
+  static const std::string &Empty() {
+    static const std::string empty;
+    return empty;
+  }
+
+  const std::string *str_ = nullptr;  // nullptr for the empty string.
+  const StringPool *pool_ = nullptr;  // nullptr when `str_` is owned.
+};
+
+///
+/// Pool of the strings of InternedString keys(TINYGLTF_USE_STRING_INTERNING).
+/// TinyGLTF creates one per loaded Model and makes it current while loading,
+/// so the keys of the model share one copy of each attribute, extension and
+/// parameter name. The Model keeps the pool alive through
+/// `Model::string_pool`.
+/// Strings are added from one thread at a time, like TinyGLTF loads.
+///
+class StringPool {
+ public:
+  StringPool() = default;
+  StringPool(const StringPool &) = delete;
+  StringPool &operator=(const StringPool &) = delete;
+
+  /// Pooled copy of `s`, valid as long as the pool.
+  const std::string *Intern(const std::string &s) {
+    return &(*strings_.insert(s).first);
+  }
+
+  size_t size() const { return strings_.size(); }
+
+  /// StringPool used by InternedString on this thread, or nullptr.
+  static StringPool *Current() { return CurrentSlot(); }
+
+  ///
+  /// Makes `pool`(may be nullptr) current on this thread for the lifetime of
+  /// the Scope. `pool` must outlive the handles created in the Scope.
+  ///
+  class Scope {
+   public:
+    explicit Scope(StringPool *pool) : previous_(CurrentSlot()) {
+      CurrentSlot() = pool;
+    }
+    ~Scope() { CurrentSlot() = previous_; }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+   private:
+    StringPool *previous_;
+  };
+
+ private:
+  static StringPool *&CurrentSlot() {
+    static thread_local StringPool *current = nullptr;
+    return current;
+  }
+
+  // std::unordered_set never moves its elements, so pooled strings stay at
+  // the same address when the pool grows.
+  std::unordered_set<std::string> strings_;
+};
+
+inline InternedString::InternedString(const std::string &s) {
+  if (s.empty()) return;
+  StringPool *pool = StringPool::Current();
+  pool_ = pool;
+  str_ = pool ? pool->Intern(s) : new std::string(s);
+}
+
+inline void InternedString::Copy(const InternedString &other) {
+  if (!other.str_) return;
+  if (other.pool_ && (other.pool_ == StringPool::Current())) {
+    str_ = other.str_;
+    pool_ = other.pool_;
+  } else {
+    str_ = new std::string(*other.str_);
+  }
+}
+
+// Takes the string of `other`, or copies it when it is pooled in a pool
+// which is not current.
+inline void InternedString::Move(InternedString &other) {
+  if (other.pool_ && (other.pool_ != StringPool::Current())) {
+    Copy(other);
+    return;
+  }
+  str_ = other.str_;
+  pool_ = other.pool_;
+  other.str_ = nullptr;
+  other.pool_ = nullptr;
+}
+
+inline std::ostream &operator<<(std::ostream &os, const InternedString &s) {
+  return os << s.str();
+}
+
+// Comparisons with plain strings do not add them to the pool.
+inline bool operator==(const InternedString &a, const std::string &b) {
+  return a.str() == b;
+}
+inline bool operator==(const std::string &a, const InternedString &b) {
+  return a == b.str();
+}
+inline bool operator==(const InternedString &a, const char *b) {
+  return a.str() == b;
+}
+inline bool operator!=(const InternedString &a, const std::string &b) {
+  return a.str() != b;
+}
+inline bool operator!=(const std::string &a, const InternedString &b) {
+  return a != b.str();
+}
+inline bool operator!=(const InternedString &a, const char *b) {
+  return a.str() != b;
+}
+inline bool operator<(const InternedString &a, const std::string &b) {
+  return a.str() < b;
+}
+inline bool operator<(const std::string &a, const InternedString &b) {
+  return a < b.str();
+}
+#endif  // TINYGLTF_USE_STRING_INTERNING
+
+#ifdef TINYGLTF_USE_ARENA
+///
+/// Monotonic arena for the containers of a Model(TINYGLTF_USE_ARENA).
+/// While an Arena is current on a thread(see `Arena::Scope`), ArenaAllocator
+/// allocations made on that thread are carved out of large blocks instead of
+/// being separate heap allocations. `LoadFromString()` and the other loaders
+/// use one arena for the JSON document and another one for the Model.
+///
+/// Freeing is a reference count decrement: a block goes back to the heap once
+/// all of its allocations are freed and the arena moved on to another block
+/// (or was destroyed). Memory is not reused within a block, so an arena suits
+/// data built once and released together, like a loaded Model.
+///
+/// Blocks are not owned by the Arena or by a Model: containers may outlive
+/// both, be moved between models and be freed on any thread.
+///
+class Arena {
+ public:
+  explicit Arena(size_t first_block_size = 64 * 1024)
+      : block_size_(first_block_size) {}
+  ~Arena() { Retire(); }
+  Arena(const Arena &) = delete;
+  Arena &operator=(const Arena &) = delete;
+
+  /// Aligned like `::operator new`(up to 16 bytes).
+  void *Allocate(size_t size) {
+    const size_t n = kHeaderSize + RoundUp(size);
+    if (size_t(end_ - next_) < n) {
+      return AllocateSlow(size);
+    }
+    char *p = next_;
+    next_ += n;
+    pending_++;
+    *reinterpret_cast<Block **>(p) = block_;
+    return p + kHeaderSize;
+  }
+
+  /// Allocates from the heap, freed by Deallocate() like arena memory.
+  static void *AllocateHeap(size_t size) {
+    char *p = static_cast<char *>(::operator new(kHeaderSize + size));
+    *reinterpret_cast<Block **>(p) = nullptr;
+    return p + kHeaderSize;
+  }
+
+  /// Frees memory of Allocate() or AllocateHeap(), from any thread.
+  static void Deallocate(void *p) {
+    char *header = static_cast<char *>(p) - kHeaderSize;
+    Block *block = *reinterpret_cast<Block **>(header);
+    if (!block) {
+      ::operator delete(header);
+    } else if (block->refs.fetch_sub(1) == 1) {
+      FreeBlock(block);
+    }
+  }
+
+  /// Number of blocks allocated so far.
+  size_t NumBlocks() const { return num_blocks_; }
+
+  /// Arena used by ArenaAllocator on this thread, or nullptr for the heap.
+  static Arena *Current() { return CurrentSlot(); }
+
+  ///
+  /// Makes `arena`(may be nullptr) current on this thread for the lifetime
+  /// of the Scope.
+  ///
+  class Scope {
+   public:
+    explicit Scope(Arena *arena) : previous_(CurrentSlot()) {
+      CurrentSlot() = arena;
+    }
+    ~Scope() { CurrentSlot() = previous_; }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+   private:
+    Arena *previous_;
+  };
+
+ private:
+  struct Block {
+    Block() : refs(kBias) {}
+
+    // Allocations not freed yet, plus kBias while the arena allocates from
+    // the block.
+    std::atomic<size_t> refs;
+  };
+
+  static const size_t kAlignment = 16;
+  static const size_t kHeaderSize = 16;  // Block of the allocation.
+  static const size_t kMaxBlockSize = 4 * 1024 * 1024;
+  static const size_t kBias = (std::numeric_limits<size_t>::max)() / 2;
+
+  static size_t RoundUp(size_t size) {
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+  }
+  static Arena *&CurrentSlot() {
+    static thread_local Arena *current = nullptr;
+    return current;
+  }
+  static void FreeBlock(Block *block) {
+    block->~Block();
+    ::operator delete(block);
+  }
+  void *AllocateSlow(size_t size);
+  void Retire();
+
+  Block *block_ = nullptr;
+  char *next_ = nullptr;
+  char *end_ = nullptr;
+  size_t pending_ = 0;  // Allocations from `block_` not counted in `refs`.
+  size_t block_size_;
+  size_t num_blocks_ = 0;
+};
+
+///
+/// Stateless allocator using the current Arena of the thread, or the heap
+/// when there is none. All instances are equal, so containers can exchange
+/// their storage whichever arena it came from.
+///
+template <typename T>
+struct ArenaAllocator {
+  typedef T value_type;
+
+  ArenaAllocator() = default;
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &) {}
+
+  T *allocate(size_t n) {
+    Arena *arena = Arena::Current();
+    return static_cast<T *>(arena ? arena->Allocate(n * sizeof(T))
+                                  : Arena::AllocateHeap(n * sizeof(T)));
+  }
+  void deallocate(T *p, size_t) { Arena::Deallocate(p); }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U> &) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U> &) const {
+    return false;
+  }
+};
+#endif
+
+// Vector type of the arrays of model objects(e.g. `Node::children`,
+// `Mesh::primitives`). Large arrays(`Buffer::data`, `Image::image`) and the
+// top level arrays of `Model` stay std::vector.
+#ifdef TINYGLTF_USE_ARENA
+template <typename T>
+using ModelVector = std::vector<T, ArenaAllocator<T> >;
+#else
+template <typename T>
+using ModelVector = std::vector<T>;
+#endif
+
+// Associative container backed by a sorted std::vector, implementing the
+// subset of the std::map interface used for glTF dictionaries. Lookups are a
+// binary search over contiguous storage, and can take any key comparable with
+// `Key`(e.g. a string literal) without constructing a temporary `Key`.
+// Iteration is in key order like std::map, so serialization is unaffected.
+//
+// Unlike std::map, inserting or erasing an element invalidates iterators and
+// references to the other elements.
+template <typename Key, typename T>
+class FlatMap {
+ public:
+  typedef Key key_type;
+  typedef T mapped_type;
+  typedef std::pair<Key, T> value_type;
+  typedef typename ModelVector<value_type>::size_type size_type;
+  typedef typename ModelVector<value_type>::iterator iterator;
+  typedef typename ModelVector<value_type>::const_iterator const_iterator;
+
+  FlatMap() = default;
+  FlatMap(std::initializer_list<value_type> init) {
+    insert(init.begin(), init.end());
+  }
+  template <typename InputIt>
+  FlatMap(InputIt first, InputIt last) {
+    insert(first, last);
+  }
+
+  iterator begin() { return data_.begin(); }
+  iterator end() { return data_.end(); }
+  const_iterator begin() const { return data_.begin(); }
+  const_iterator end() const { return data_.end(); }
+  const_iterator cbegin() const { return data_.begin(); }
+  const_iterator cend() const { return data_.end(); }
+
+  bool empty() const { return data_.empty(); }
+  size_type size() const { return data_.size(); }
+  void clear() { data_.clear(); }
+  void reserve(size_type n) { data_.reserve(n); }
+  void swap(FlatMap &other) { data_.swap(other.data_); }
+
+  template <typename K>
+  iterator lower_bound(const K &key) {
+    return data_.begin() + (LowerBound(LookupKey(key)) - data_.cbegin());
+  }
+  template <typename K>
+  const_iterator lower_bound(const K &key) const {
+    return LowerBound(LookupKey(key));
+  }
+
+  template <typename K>
+  iterator find(const K &key) {
+    return data_.begin() + (Find(LookupKey(key)) - data_.cbegin());
+  }
+  template <typename K>
+  const_iterator find(const K &key) const {
+    return Find(LookupKey(key));
+  }
+  template <typename K>
+  size_type count(const K &key) const {
+    return (find(key) != data_.end()) ? 1 : 0;
+  }
+
+  T &operator[](const Key &key) {
+    iterator it = Position(key);
+    if (it == data_.end() || key < it->first) {
+      it = data_.emplace(it, key, T());
+    }
+    return it->second;
+  }
+  T &operator[](Key &&key) {
+    iterator it = Position(key);
+    if (it == data_.end() || key < it->first) {
+      it = data_.emplace(it, std::move(key), T());
+    }
+    return it->second;
+  }
+
+  std::pair<iterator, bool> insert(const value_type &value) {
+    iterator it = Position(value.first);
+    if (it != data_.end() && !(value.first < it->first)) {
+      return std::make_pair(it, false);
+    }
+    return std::make_pair(data_.insert(it, value), true);
+  }
+  std::pair<iterator, bool> insert(value_type &&value) {
+    iterator it = Position(value.first);
+    if (it != data_.end() && !(value.first < it->first)) {
+      return std::make_pair(it, false);
+    }
+    return std::make_pair(data_.insert(it, std::move(value)), true);
+  }
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      insert(value_type(*first));
+    }
+  }
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&... args) {
+    return insert(value_type(std::forward<Args>(args)...));
+  }
+
+  iterator erase(iterator pos) { return data_.erase(pos); }
+  iterator erase(const_iterator pos) {
+    return data_.erase(data_.begin() + (pos - data_.cbegin()));
+  }
+  template <typename K>
+  size_type erase(const K &key) {
+    iterator it = find(key);
+    if (it == data_.end()) {
+      return 0;
+    }
+    data_.erase(it);
+    return 1;
+  }
+
+  bool operator==(const FlatMap &other) const { return data_ == other.data_; }
+  bool operator!=(const FlatMap &other) const { return data_ != other.data_; }
+
+ private:
+  // Insert position for `key`. Elements are mostly inserted in key order
+  // (JSON objects are parsed in sorted order), so check the back first.
+  iterator Position(const Key &key) {
+    if (data_.empty() || data_.back().first < key) {
+      return data_.end();
+    }
+    return lower_bound(key);
+  }
+
+  // String keys are looked up through their characters and length, so that a
+  // string literal is not measured again for every comparison.
+  struct StringRef {
+    const char *data;
+    size_t size;
+  };
+  static StringRef LookupKey(const char *s) { return {s, strlen(s)}; }
+  static StringRef LookupKey(const std::string &s) {
+    return {s.data(), s.size()};
+  }
+#ifdef TINYGLTF_USE_STRING_INTERNING
+  static StringRef LookupKey(const InternedString &s) {
+    return {s.str().data(), s.size()};
+  }
+#endif
+  template <typename K>
+  static const K &LookupKey(const K &key) {
+    return key;
+  }
+
+  static bool Less(const StringRef &a, const StringRef &b) {
+    const size_t n = (a.size < b.size) ? a.size : b.size;
+    const int r = (n > 0) ? memcmp(a.data, b.data, n) : 0;
+    return (r != 0) ? (r < 0) : (a.size < b.size);
+  }
+  template <typename A, typename B>
+  static bool Less(const A &a, const B &b) {
+    return a < b;
+  }
+
+  template <typename L>
+  const_iterator LowerBound(const L &key) const {
+    return std::lower_bound(
+        data_.begin(), data_.end(), key,
+        [](const value_type &a, const L &b) {
+          return Less(LookupKey(a.first), b);
+        });
+  }
+  template <typename L>
+  const_iterator Find(const L &key) const {
+    const_iterator it = LowerBound(key);
+    return (it != data_.end() && !Less(key, LookupKey(it->first)))
+               ? it
+               : data_.end();
+  }
+
+  ModelVector<value_type> data_;
+};
+
+// Map type used for the string keyed dictionaries of the model
+// (`Value::Object`, `ExtensionMap`, `ParameterMap` and primitive attributes).
+#if defined(TINYGLTF_USE_STRING_INTERNING)
+template <typename T>
+using StringMap = FlatMap<InternedString, T>;
+#elif defined(TINYGLTF_USE_FLAT_MAP)
+template <typename T>
+using StringMap = FlatMap<std::string, T>;
+#elif defined(TINYGLTF_USE_ARENA)
+template <typename T>
+using StringMap =
+    std::map<std::string, T, std::less<std::string>,
+             ArenaAllocator<std::pair<const std::string, T> > >;
+#else
+template <typename T>
+using StringMap = std::map<std::string, T>;
+#endif
+
 #ifdef __clang__
 #pragma clang diagnostic push
 // Suppress warning for : static Value null_value
@@ -260,45 +825,78 @@ bool DecodeDataURI(std::vector<unsigned char> *out, std::string &mime_type,
 #endif
 
 // Simple class to represent JSON object
+//
+// Only the payload of the stored type is kept(a tagged union), so a Value is
+// not much larger than its biggest payload type.
 class Value {
  public:
-  typedef std::vector<Value> Array;
-  typedef std::map<std::string, Value> Object;
+  typedef ModelVector<Value> Array;
+#ifdef TINYGLTF_USE_STRING_INTERNING
+  // Keys of extras are arbitrary, so they are not added to the StringPool.
+  typedef FlatMap<std::string, Value> Object;
+#else
+  typedef StringMap<Value> Object;
+#endif
 
-  Value()
-      : type_(NULL_TYPE),
-        int_value_(0),
-        real_value_(0.0),
-        boolean_value_(false) {}
+  Value() : type_(NULL_TYPE), int_value_(0), real_value_(0.0) {}
 
-  explicit Value(bool b) : type_(BOOL_TYPE) { boolean_value_ = b; }
-  explicit Value(int i) : type_(INT_TYPE) {
-    int_value_ = i;
-    real_value_ = i;
+  explicit Value(bool b) : type_(BOOL_TYPE), int_value_(0) {
+    boolean_value_ = b;
   }
-  explicit Value(uint64_t ui) : type_(UINT_TYPE), uint_value_(ui) {}
-  explicit Value(double n) : type_(REAL_TYPE) { real_value_ = n; }
-  explicit Value(const std::string &s) : type_(STRING_TYPE) {
-    string_value_ = s;
+  explicit Value(int i) : type_(INT_TYPE), int_value_(i) { real_value_ = i; }
+  explicit Value(uint64_t ui) : type_(UINT_TYPE), int_value_(0) {
+    uint_value_ = ui;
   }
-  explicit Value(std::string &&s)
-      : type_(STRING_TYPE), string_value_(std::move(s)) {}
-  explicit Value(const unsigned char *p, size_t n) : type_(BINARY_TYPE) {
-    binary_value_.resize(n);
-    memcpy(binary_value_.data(), p, n);
+  explicit Value(double n) : type_(REAL_TYPE), int_value_(0) {
+    real_value_ = n;
   }
+  explicit Value(const std::string &s)
+      : type_(STRING_TYPE), int_value_(0), string_value_(s) {}
+  explicit Value(std::string &&s)
+      : type_(STRING_TYPE), int_value_(0), string_value_(std::move(s)) {}
+  explicit Value(const unsigned char *p, size_t n)
+      : type_(BINARY_TYPE), int_value_(0), binary_value_(p, p + n) {}
   explicit Value(std::vector<unsigned char> &&v) noexcept
       : type_(BINARY_TYPE),
+        int_value_(0),
         binary_value_(std::move(v)) {}
-  explicit Value(const Array &a) : type_(ARRAY_TYPE) { array_value_ = a; }
+  explicit Value(const Array &a)
+      : type_(ARRAY_TYPE), int_value_(0), array_value_(a) {}
   explicit Value(Array &&a) noexcept : type_(ARRAY_TYPE),
+                                       int_value_(0),
                                        array_value_(std::move(a)) {}
 
-  explicit Value(const Object &o) : type_(OBJECT_TYPE) { object_value_ = o; }
+  explicit Value(const Object &o)
+      : type_(OBJECT_TYPE), int_value_(0), object_value_(o) {}
   explicit Value(Object &&o) noexcept : type_(OBJECT_TYPE),
+                                        int_value_(0),
                                         object_value_(std::move(o)) {}
 
-  DEFAULT_METHODS(Value)
+  ~Value() { Destroy(); }
+  Value(const Value &other) : type_(NULL_TYPE), int_value_(0) {
+    CopyFrom(other);
+  }
+  Value(Value &&other) TINYGLTF_NOEXCEPT : type_(NULL_TYPE), int_value_(0) {
+    MoveFrom(std::move(other));
+  }
+  // `other` may be an element of this Value, so it is copied/moved out before
+  // the current payload is destroyed.
+  Value &operator=(const Value &other) {
+    if (this != &other) {
+      Value tmp(other);
+      Destroy();
+      MoveFrom(std::move(tmp));
+    }
+    return *this;
+  }
+  Value &operator=(Value &&other) TINYGLTF_NOEXCEPT {
+    if (this != &other) {
+      Value tmp(std::move(other));
+      Destroy();
+      MoveFrom(std::move(tmp));
+    }
+    return *this;
+  }
 
   char Type() const { return static_cast<char>(type_); }
 
@@ -308,7 +906,9 @@ class Value {
 
   bool IsUInt() const { return (type_ == UINT_TYPE); }
 
-  bool IsNumber() const { return (type_ == REAL_TYPE) || (type_ == INT_TYPE); }
+  bool IsNumber() const {
+    return (type_ == REAL_TYPE) || (type_ == INT_TYPE) || (type_ == UINT_TYPE);
+  }
 
   bool IsReal() const { return (type_ == REAL_TYPE); }
 
@@ -324,9 +924,12 @@ class Value {
   double GetNumberAsDouble() const {
     if (type_ == INT_TYPE) {
       return double(int_value_);
-    } else {
+    } else if (type_ == UINT_TYPE) {
+      return double(uint_value_);
+    } else if (type_ == REAL_TYPE) {
       return real_value_;
     }
+    return 0.0;
   }
 
   // Use this function if you want to have number value as int.
@@ -334,31 +937,38 @@ class Value {
   int GetNumberAsInt() const {
     if (type_ == REAL_TYPE) {
       return int(real_value_);
+    } else if (type_ == UINT_TYPE) {
+      return int(uint_value_);
     } else {
       return int_value_;
     }
   }
 
-  // Accessor
+  // Accessor. Get<T>() for a type other than the stored one returns a
+  // default constructed T and leaves the value unchanged. The non-const
+  // Get<T>() then returns a per-thread T reset on each such call: writes to
+  // it are discarded. Get<double>() also returns the value of an INT_TYPE.
   template <typename T>
   const T &Get() const;
   template <typename T>
   T &Get();
 
-  // Lookup value from an array
+  // Lookup value from an array. Returns a null Value when this is not an
+  // array or idx is out of range.
   const Value &Get(int idx) const {
     static Value null_value;
-    assert(IsArray());
     assert(idx >= 0);
+    if (!IsArray()) return null_value;
     return (static_cast<size_t>(idx) < array_value_.size())
                ? array_value_[static_cast<size_t>(idx)]
                : null_value;
   }
 
-  // Lookup value from a key-value pair
+  // Lookup value from a key-value pair. Returns a null Value when this is not
+  // an object or key is missing.
   const Value &Get(const std::string &key) const {
     static Value null_value;
-    assert(IsObject());
+    if (!IsObject()) return null_value;
     Object::const_iterator it = object_value_.find(key);
     return (it != object_value_.end()) ? it->second : null_value;
   }
@@ -388,44 +998,129 @@ class Value {
     return keys;
   }
 
-  size_t Size() const { return (IsArray() ? ArrayLen() : Keys().size()); }
+  size_t Size() const {
+    return IsArray() ? ArrayLen() : (IsObject() ? object_value_.size() : 0);
+  }
 
   bool operator==(const tinygltf::Value &other) const;
 
  protected:
-  int type_ = NULL_TYPE;
-
-  int int_value_ = 0;
-  uint64_t uint_value_ = 0;
-  double real_value_ = 0.0;
-  std::string string_value_;
-  std::vector<unsigned char> binary_value_;
-  Array array_value_;
-  Object object_value_;
-  bool boolean_value_ = false;
+  void Destroy() {
+    switch (type_) {
+      case STRING_TYPE:
+        string_value_.~basic_string();
+        break;
+      case BINARY_TYPE:
+        binary_value_.~vector();
+        break;
+      case ARRAY_TYPE:
+        array_value_.~Array();
+        break;
+      case OBJECT_TYPE:
+        object_value_.~Object();
+        break;
+      default:
+        break;
+    }
+    type_ = NULL_TYPE;
+  }
+
+  // Requires this Value to be destroyed(NULL_TYPE).
+  void CopyFrom(const Value &other) {
+    switch (other.type_) {
+      case STRING_TYPE:
+        new (&string_value_) std::string(other.string_value_);
+        break;
+      case BINARY_TYPE:
+        new (&binary_value_) std::vector<unsigned char>(other.binary_value_);
+        break;
+      case ARRAY_TYPE:
+        new (&array_value_) Array(other.array_value_);
+        break;
+      case OBJECT_TYPE:
+        new (&object_value_) Object(other.object_value_);
+        break;
+      default:
+        uint_value_ = other.uint_value_;  // Copies all scalar bits.
+        break;
+    }
+    type_ = other.type_;
+    int_value_ = other.int_value_;
+  }
+
+  // Requires this Value to be destroyed(NULL_TYPE). `other` keeps its type
+  // with a moved-from payload.
+  void MoveFrom(Value &&other) {
+    switch (other.type_) {
+      case STRING_TYPE:
+        new (&string_value_) std::string(std::move(other.string_value_));
+        break;
+      case BINARY_TYPE:
+        new (&binary_value_)
+            std::vector<unsigned char>(std::move(other.binary_value_));
+        break;
+      case ARRAY_TYPE:
+        new (&array_value_) Array(std::move(other.array_value_));
+        break;
+      case OBJECT_TYPE:
+        new (&object_value_) Object(std::move(other.object_value_));
+        break;
+      default:
+        uint_value_ = other.uint_value_;  // Copies all scalar bits.
+        break;
+    }
+    type_ = other.type_;
+    int_value_ = other.int_value_;
+  }
+
+  template <typename T>
+  static const T &DefaultValue() {
+    static const T value{};
+    return value;
+  }
+  template <typename T>
+  static T &ScratchValue() {
+    static thread_local T value;
+    value = T();
+    return value;
+  }
+
+  int type_;
+  int int_value_;  // Outside of the union, so Get<int>() is always valid.
+  union {
+    bool boolean_value_;
+    uint64_t uint_value_;
+    double real_value_;  // Also set for INT_TYPE.
+    std::string string_value_;
+    std::vector<unsigned char> binary_value_;
+    Array array_value_;
+    Object object_value_;
+  };
 };
 
 #ifdef __clang__
 #pragma clang diagnostic pop
 #endif
 
-#define TINYGLTF_VALUE_GET(ctype, var)            \
-  template <>                                     \
-  inline const ctype &Value::Get<ctype>() const { \
-    return var;                                   \
-  }                                               \
-  template <>                                     \
-  inline ctype &Value::Get<ctype>() {             \
-    return var;                                   \
-  }
-TINYGLTF_VALUE_GET(bool, boolean_value_)
-TINYGLTF_VALUE_GET(double, real_value_)
-TINYGLTF_VALUE_GET(int, int_value_)
-TINYGLTF_VALUE_GET(uint64_t, uint_value_)
-TINYGLTF_VALUE_GET(std::string, string_value_)
-TINYGLTF_VALUE_GET(std::vector<unsigned char>, binary_value_)
-TINYGLTF_VALUE_GET(Value::Array, array_value_)
-TINYGLTF_VALUE_GET(Value::Object, object_value_)
+#define TINYGLTF_VALUE_GET(ctype, var, active)          \
+  template <>                                           \
+  inline const ctype &Value::Get<ctype>() const {       \
+    return (active) ? var : DefaultValue<ctype>();      \
+  }                                                     \
+  template <>                                           \
+  inline ctype &Value::Get<ctype>() {                   \
+    return (active) ? var : ScratchValue<ctype>();      \
+  }
+TINYGLTF_VALUE_GET(bool, boolean_value_, type_ == BOOL_TYPE)
+TINYGLTF_VALUE_GET(double, real_value_,
+                   (type_ == REAL_TYPE) || (type_ == INT_TYPE))
+TINYGLTF_VALUE_GET(int, int_value_, true)
+TINYGLTF_VALUE_GET(uint64_t, uint_value_, type_ == UINT_TYPE)
+TINYGLTF_VALUE_GET(std::string, string_value_, type_ == STRING_TYPE)
+TINYGLTF_VALUE_GET(std::vector<unsigned char>, binary_value_,
+                   type_ == BINARY_TYPE)
+TINYGLTF_VALUE_GET(Value::Array, array_value_, type_ == ARRAY_TYPE)
+TINYGLTF_VALUE_GET(Value::Object, object_value_, type_ == OBJECT_TYPE)
 #undef TINYGLTF_VALUE_GET
 
 #ifdef __clang__
@@ -443,7 +1138,7 @@ struct Parameter {
   bool bool_value = false;
   bool has_number_value = false;
   std::string string_value;
-  std::vector<double> number_array;
+  ModelVector<double> number_array;
   std::map<std::string, double> json_double_value;
   double number_value = 0.0;
 
@@ -528,8 +1223,68 @@ struct Parameter {
 #pragma clang diagnostic ignored "-Wpadded"
 #endif
 
-typedef std::map<std::string, Parameter> ParameterMap;
-typedef std::map<std::string, Value> ExtensionMap;
+typedef StringMap<Parameter> ParameterMap;
+typedef StringMap<Value> ExtensionMap;
+
+class LazyJson;
+
+/// Location of a value in a JSON text.
+struct JsonSpan {
+  size_t offset;
+  size_t length;
+};
+
+///
+/// The `extras` and `extensions` of an object loaded with
+/// TinyGLTF::SetLazyExtrasAndExtensions(true), left unparsed in the source
+/// JSON(see LazyJson). It is a member of the object, so it stays with the
+/// object when the object is copied, reordered or erased.
+///
+/// When writing, an object with empty `extras` is written with the `extras`
+/// of its LazyExtras, and the extensions of its LazyExtras are written along
+/// with those of the object(the object's own win for the same name). Load()
+/// parses them into the object and resets the LazyExtras, so the members of
+/// the object are then written as they are. Reset() drops them.
+///
+class LazyExtras {
+ public:
+  LazyExtras() = default;
+
+  /// The `extras` and `extensions` of the object at JSON pointer `pointer`
+  /// (see LazyJson) in `json`, if it has any.
+  LazyExtras(const std::shared_ptr<const LazyJson> &json,
+             const std::string &pointer);
+
+  /// The `extras` and `extensions` of the JSON object at `object` in the
+  /// source of `json`, if it has any.
+  LazyExtras(const std::shared_ptr<const LazyJson> &json,
+             const JsonSpan &object);
+
+  bool Empty() const { return !json_; }
+  bool HasExtras() const { return extras_.length != 0; }
+  bool HasExtensions() const { return extensions_.length != 0; }
+
+  /// Parses the `extras`. Returns false when there are none.
+  bool GetExtras(Value *extras) const;
+
+  /// Parses the `extensions`. Returns false when there are none.
+  bool GetExtensions(ExtensionMap *extensions) const;
+
+  /// Parses the `extras` into `extras` when it is empty(NULL_TYPE), and the
+  /// extensions `extensions` does not have into it, then resets. `extras` is
+  /// nullptr for objects without extras(AnimationChannel's target).
+  void Load(Value *extras, ExtensionMap *extensions);
+
+  void Reset() { *this = LazyExtras(); }
+
+  /// Compares the source text of the `extras` and `extensions`.
+  bool operator==(const LazyExtras &other) const;
+
+ private:
+  std::shared_ptr<const LazyJson> json_;
+  JsonSpan extras_ = {0, 0};  // Zero length when absent.
+  JsonSpan extensions_ = {0, 0};
+};
 
 struct AnimationChannel {
   int sampler;              // required
@@ -545,6 +1300,10 @@ struct AnimationChannel {
   std::string extensions_json_string;
   std::string target_extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+  LazyExtras target_lazy_extras;  // Of `target`.
+
   AnimationChannel() : sampler(-1), target_node(-1) {}
   DEFAULT_METHODS(AnimationChannel)
   bool operator==(const AnimationChannel &) const;
@@ -562,6 +1321,9 @@ struct AnimationSampler {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   AnimationSampler() : input(-1), output(-1), interpolation("LINEAR") {}
   DEFAULT_METHODS(AnimationSampler)
   bool operator==(const AnimationSampler &) const;
@@ -569,8 +1331,8 @@ struct AnimationSampler {
 
 struct Animation {
   std::string name;
-  std::vector<AnimationChannel> channels;
-  std::vector<AnimationSampler> samplers;
+  ModelVector<AnimationChannel> channels;
+  ModelVector<AnimationSampler> samplers;
   Value extras;
   ExtensionMap extensions;
 
@@ -578,6 +1340,9 @@ struct Animation {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   Animation() = default;
   DEFAULT_METHODS(Animation)
   bool operator==(const Animation &) const;
@@ -587,7 +1352,7 @@ struct Skin {
   std::string name;
   int inverseBindMatrices;  // required here but not in the spec
   int skeleton;             // The index of the node used as a skeleton root
-  std::vector<int> joints;  // Indices of skeleton nodes
+  ModelVector<int> joints;  // Indices of skeleton nodes
 
   Value extras;
   ExtensionMap extensions;
@@ -596,6 +1361,9 @@ struct Skin {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   Skin() {
     inverseBindMatrices = -1;
     skeleton = -1;
@@ -629,6 +1397,9 @@ struct Sampler {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   Sampler()
       : minFilter(-1),
         magFilter(-1),
@@ -638,6 +1409,17 @@ struct Sampler {
   bool operator==(const Sampler &) const;
 };
 
+struct Image;
+class Model;
+
+///
+/// LoadImageDataFunction type. Signature for custom image loading callbacks.
+///
+typedef bool (*LoadImageDataFunction)(Image *, const int, std::string *,
+                                      std::string *, int, int,
+                                      const unsigned char *, int,
+                                      void *user_pointer);
+
 struct Image {
   std::string name;
   int width;
@@ -659,12 +1441,15 @@ struct Image {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   // When this flag is true, data is stored to `image` in as-is format(e.g. jpeg
   // compressed for "image/jpeg" mime) This feature is good if you use custom
   // image loader function. (e.g. delayed decoding of images for faster glTF
-  // parsing) Default parser for Image does not provide as-is loading feature at
-  // the moment. (You can manipulate this by providing your own LoadImageData
-  // function)
+  // parsing) The default parser keeps images as-is when
+  // `TinyGLTF::SetDeferImageDecoding(true)`; `image` is left empty for images
+  // stored in a bufferView then. Use `Decode()` to decode them on demand.
   bool as_is;
 
   Image() : as_is(false) {
@@ -677,6 +1462,18 @@ struct Image {
   }
   DEFAULT_METHODS(Image)
 
+  ///
+  /// Decodes an as-is image(see `as_is`) into `image` and clears `as_is`.
+  /// `model` is the Model the image belongs to, used to look up bufferView
+  /// image data. `load_image_data`/`user_data` default to the builtin
+  /// (stb_image) loader, which takes a `LoadImageDataOption` as `user_data`.
+  /// Does nothing and returns true if the image is not as-is.
+  /// Returns false and keeps the as-is data if decoding fails.
+  ///
+  bool Decode(const Model &model, std::string *err, std::string *warn,
+              LoadImageDataFunction load_image_data = nullptr,
+              void *user_data = nullptr);
+
   bool operator==(const Image &) const;
 };
 
@@ -692,6 +1489,9 @@ struct Texture {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   Texture() : sampler(-1), source(-1) {}
   DEFAULT_METHODS(Texture)
 
@@ -710,6 +1510,9 @@ struct TextureInfo {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   TextureInfo() : index(-1), texCoord(0) {}
   DEFAULT_METHODS(TextureInfo)
   bool operator==(const TextureInfo &) const;
@@ -729,6 +1532,9 @@ struct NormalTextureInfo {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   NormalTextureInfo() : index(-1), texCoord(0), scale(1.0) {}
   DEFAULT_METHODS(NormalTextureInfo)
   bool operator==(const NormalTextureInfo &) const;
@@ -748,6 +1554,9 @@ struct OcclusionTextureInfo {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   OcclusionTextureInfo() : index(-1), texCoord(0), strength(1.0) {}
   DEFAULT_METHODS(OcclusionTextureInfo)
   bool operator==(const OcclusionTextureInfo &) const;
@@ -755,7 +1564,7 @@ struct OcclusionTextureInfo {
 
 // pbrMetallicRoughness class defined in glTF 2.0 spec.
 struct PbrMetallicRoughness {
-  std::vector<double> baseColorFactor;  // len = 4. default [1,1,1,1]
+  ModelVector<double> baseColorFactor;  // len = 4. default [1,1,1,1]
   TextureInfo baseColorTexture;
   double metallicFactor;   // default 1
   double roughnessFactor;  // default 1
@@ -768,8 +1577,11 @@ struct PbrMetallicRoughness {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   PbrMetallicRoughness()
-      : baseColorFactor(std::vector<double>{1.0, 1.0, 1.0, 1.0}),
+      : baseColorFactor(ModelVector<double>{1.0, 1.0, 1.0, 1.0}),
         metallicFactor(1.0),
         roughnessFactor(1.0) {}
   DEFAULT_METHODS(PbrMetallicRoughness)
@@ -782,7 +1594,7 @@ struct PbrMetallicRoughness {
 struct Material {
   std::string name;
 
-  std::vector<double> emissiveFactor;  // length 3. default [0, 0, 0]
+  ModelVector<double> emissiveFactor;  // length 3. default [0, 0, 0]
   std::string alphaMode;               // default "OPAQUE"
   double alphaCutoff;                  // default 0.5
   bool doubleSided;                    // default false;
@@ -805,6 +1617,9 @@ struct Material {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   Material() : alphaMode("OPAQUE"), alphaCutoff(0.5), doubleSided(false) {}
   DEFAULT_METHODS(Material)
 
@@ -827,6 +1642,9 @@ struct BufferView {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   bool dracoDecoded{false};  // Flag indicating this has been draco decoded
 
   BufferView()
@@ -856,9 +1674,12 @@ struct Accessor {
   std::string extras_json_string;
   std::string extensions_json_string;
 
-  std::vector<double>
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
+  ModelVector<double>
       minValues;  // optional. integer value is promoted to double
-  std::vector<double>
+  ModelVector<double>
       maxValues;  // optional. integer value is promoted to double
 
   struct {
@@ -946,6 +1767,9 @@ struct PerspectiveCamera {
   // Filled when SetStoreOriginalJSONForExtrasAndExtensions is enabled.
   std::string extras_json_string;
   std::string extensions_json_string;
+
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
 };
 
 struct OrthographicCamera {
@@ -964,6 +1788,9 @@ struct OrthographicCamera {
   // Filled when SetStoreOriginalJSONForExtrasAndExtensions is enabled.
   std::string extras_json_string;
   std::string extensions_json_string;
+
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
 };
 
 struct Camera {
@@ -983,18 +1810,21 @@ struct Camera {
   // Filled when SetStoreOriginalJSONForExtrasAndExtensions is enabled.
   std::string extras_json_string;
   std::string extensions_json_string;
+
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
 };
 
 struct Primitive {
-  std::map<std::string, int> attributes;  // (required) A dictionary object of
-                                          // integer, where each integer
-                                          // is the index of the accessor
-                                          // containing an attribute.
+  StringMap<int> attributes;  // (required) A dictionary object of
+                              // integer, where each integer
+                              // is the index of the accessor
+                              // containing an attribute.
   int material;  // The index of the material to apply to this primitive
                  // when rendering.
   int indices;   // The index of the accessor that contains the indices.
   int mode;      // one of TINYGLTF_MODE_***
-  std::vector<std::map<std::string, int> > targets;  // array of morph targets,
+  ModelVector<StringMap<int> > targets;  // array of morph targets,
   // where each target is a dict with attribues in ["POSITION, "NORMAL",
   // "TANGENT"] pointing
   // to their corresponding accessors
@@ -1005,6 +1835,9 @@ struct Primitive {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   Primitive() {
     material = -1;
     indices = -1;
@@ -1016,8 +1849,8 @@ struct Primitive {
 
 struct Mesh {
   std::string name;
-  std::vector<Primitive> primitives;
-  std::vector<double> weights;  // weights to be applied to the Morph Targets
+  ModelVector<Primitive> primitives;
+  ModelVector<double> weights;  // weights to be applied to the Morph Targets
   ExtensionMap extensions;
   Value extras;
 
@@ -1025,6 +1858,9 @@ struct Mesh {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   Mesh() = default;
   DEFAULT_METHODS(Mesh)
   bool operator==(const Mesh &) const;
@@ -1043,12 +1879,12 @@ class Node {
   std::string name;
   int skin;
   int mesh;
-  std::vector<int> children;
-  std::vector<double> rotation;     // length must be 0 or 4
-  std::vector<double> scale;        // length must be 0 or 3
-  std::vector<double> translation;  // length must be 0 or 3
-  std::vector<double> matrix;       // length must be 0 or 16
-  std::vector<double> weights;  // The weights of the instantiated Morph Target
+  ModelVector<int> children;
+  ModelVector<double> rotation;     // length must be 0 or 4
+  ModelVector<double> scale;        // length must be 0 or 3
+  ModelVector<double> translation;  // length must be 0 or 3
+  ModelVector<double> matrix;       // length must be 0 or 16
+  ModelVector<double> weights;  // The weights of the instantiated Morph Target
 
   ExtensionMap extensions;
   Value extras;
@@ -1056,6 +1892,9 @@ class Node {
   // Filled when SetStoreOriginalJSONForExtrasAndExtensions is enabled.
   std::string extras_json_string;
   std::string extensions_json_string;
+
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
 };
 
 struct Buffer {
@@ -1071,6 +1910,29 @@ struct Buffer {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
+  // View of the buffer contents which is not owned by `data`(`data` is empty
+  // in that case). Set for the GLB-stored buffer when loaded with
+  // `TinyGLTF::SetZeroCopyBinaryBuffer(true)`: points into the memory passed
+  // to `LoadBinaryFromMemory()`, so the caller must keep that memory alive
+  // while this Buffer(or a copy of it) is in use. Also set when buffers are
+  // loaded from memory mapped files(see `view_owner`).
+  const unsigned char *view_data{nullptr};
+  size_t view_size{0};
+  // Keeps `view_data` alive when the Buffer references memory owned by the
+  // loader(e.g. a memory mapped file, see `FsCallbacks::MapWholeFile`).
+  // Empty for caller-owned memory.
+  std::shared_ptr<void> view_owner;
+
+  // Accessors for the buffer contents, regardless of whether they are owned
+  // (`data`) or referenced(`view_data`).
+  const unsigned char *DataPtr() const {
+    return view_data ? view_data : data.data();
+  }
+  size_t DataSize() const { return view_data ? view_size : data.size(); }
+
   Buffer() = default;
   DEFAULT_METHODS(Buffer)
   bool operator==(const Buffer &) const;
@@ -1088,6 +1950,9 @@ struct Asset {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   Asset() = default;
   DEFAULT_METHODS(Asset)
   bool operator==(const Asset &) const;
@@ -1095,7 +1960,7 @@ struct Asset {
 
 struct Scene {
   std::string name;
-  std::vector<int> nodes;
+  ModelVector<int> nodes;
 
   ExtensionMap extensions;
   Value extras;
@@ -1104,6 +1969,9 @@ struct Scene {
   std::string extras_json_string;
   std::string extensions_json_string;
 
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
   Scene() = default;
   DEFAULT_METHODS(Scene)
   bool operator==(const Scene &) const;
@@ -1123,11 +1991,14 @@ struct SpotLight {
   // Filled when SetStoreOriginalJSONForExtrasAndExtensions is enabled.
   std::string extras_json_string;
   std::string extensions_json_string;
+
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
 };
 
 struct Light {
   std::string name;
-  std::vector<double> color;
+  ModelVector<double> color;
   double intensity{1.0};
   std::string type;
   double range{0.0};  // 0.0 = inifinite
@@ -1144,42 +2015,1139 @@ struct Light {
   // Filled when SetStoreOriginalJSONForExtrasAndExtensions is enabled.
   std::string extras_json_string;
   std::string extensions_json_string;
+
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
 };
 
-class Model {
- public:
+///
+/// Source JSON of a model loaded with
+/// TinyGLTF::SetLazyExtrasAndExtensions(true). The loaded objects refer to
+/// their `extras` and `extensions` in it with their LazyExtras, which also
+/// holds on to the LazyJson. The getters below address objects by their JSON
+/// pointer(RFC 6901) in the source: "" for the root object, "/nodes/3",
+/// "/materials/0/pbrMetallicRoughness/baseColorTexture", ... They walk the
+/// source to find the object, prefer the `lazy_extras` of the loaded objects.
+/// Immutable, so it can be shared between threads. The getters may run
+/// concurrently, also with loads and saves of other models(with RapidJSON
+/// too: they do not use its single active document).
+///
+class LazyJson {
+ public:
+  LazyJson() = default;
+
+  /// Copies `length` bytes of JSON text.
+  LazyJson(const char *json, size_t length) : json_(json, length) {}
+
+  /// Parses the `extras` of the object at `pointer`. Returns false when the
+  /// object has no `extras`.
+  bool GetExtras(const std::string &pointer, Value *extras) const;
+
+  /// Parses the `extensions` of the object at `pointer`. Returns false when
+  /// the object has no `extensions` or it is not a JSON object.
+  bool GetExtensions(const std::string &pointer,
+                     ExtensionMap *extensions) const;
+
+  /// Source text of the `extras` of the object at `pointer`, as written in
+  /// the file. Returns false when the object has no `extras`.
+  bool GetExtrasJson(const std::string &pointer, std::string *json) const;
+
+  /// Source text of the `extensions` of the object at `pointer`, as written
+  /// in the file. Returns false when the object has no `extensions`.
+  bool GetExtensionsJson(const std::string &pointer, std::string *json) const;
+
+  bool HasExtras(const std::string &pointer) const {
+    return GetExtrasJson(pointer, nullptr);
+  }
+
+  bool HasExtensions(const std::string &pointer) const {
+    return GetExtensionsJson(pointer, nullptr);
+  }
+
+  const std::string &Source() const { return json_; }
+
+ private:
+  friend class LazyExtras;
+
+  void ParseExtras(const JsonSpan &span, Value *extras) const;
+  bool ParseExtensions(const JsonSpan &span, ExtensionMap *extensions) const;
+
+  std::string json_;
+};
+
+class Model {
+ public:
   Model() = default;
   DEFAULT_METHODS(Model)
 
-  bool operator==(const Model &) const;
+  bool operator==(const Model &) const;
+
+  std::vector<Accessor> accessors;
+  std::vector<Animation> animations;
+  std::vector<Buffer> buffers;
+  std::vector<BufferView> bufferViews;
+  std::vector<Material> materials;
+  std::vector<Mesh> meshes;
+  std::vector<Node> nodes;
+  std::vector<Texture> textures;
+  std::vector<Image> images;
+  std::vector<Skin> skins;
+  std::vector<Sampler> samplers;
+  std::vector<Camera> cameras;
+  std::vector<Scene> scenes;
+  std::vector<Light> lights;
+
+  int defaultScene = -1;
+  std::vector<std::string> extensionsUsed;
+  std::vector<std::string> extensionsRequired;
+
+  Asset asset;
+
+  Value extras;
+  ExtensionMap extensions;
+
+  // Filled when SetStoreOriginalJSONForExtrasAndExtensions is enabled.
+  std::string extras_json_string;
+  std::string extensions_json_string;
+
+  // Set when SetLazyExtrasAndExtensions is enabled(see LazyExtras).
+  LazyExtras lazy_extras;
+
+  // Source JSON, set when SetLazyExtrasAndExtensions is enabled.
+  std::shared_ptr<const LazyJson> lazy_json;
+
+#ifdef TINYGLTF_USE_STRING_INTERNING
+  // Pool of the InternedString keys of the model, set by the loader. Keys
+  // copied out of the model own their string.
+  std::shared_ptr<StringPool> string_pool;
+#endif
+};
+
+///
+/// Fixed size copy of the local transform of a Node, without heap
+/// allocations. See BuildNodeTransforms. Components absent from the Node hold
+/// the glTF defaults and their flag is not set. `T` is double or float.
+///
+template <typename T>
+struct NodeTransform {
+  enum {
+    HAS_TRANSLATION = 0x1,
+    HAS_ROTATION = 0x2,
+    HAS_SCALE = 0x4,
+    HAS_MATRIX = 0x8
+  };
+
+  T translation[3];
+  T rotation[4];  // Quaternion(x, y, z, w).
+  T scale[3];
+  T matrix[16];  // Column major.
+  uint32_t flags;
+
+  NodeTransform()
+      : translation{T(0), T(0), T(0)},
+        rotation{T(0), T(0), T(0), T(1)},
+        scale{T(1), T(1), T(1)},
+        matrix{T(1), T(0), T(0), T(0), T(0), T(1), T(0), T(0),
+               T(0), T(0), T(1), T(0), T(0), T(0), T(0), T(1)},
+        flags(0) {}
+
+  ///
+  /// Local transform as a column major 4x4 matrix: `matrix` when the Node has
+  /// one, translation * rotation * scale otherwise.
+  ///
+  void LocalMatrix(T out[16]) const {
+    if (flags & HAS_MATRIX) {
+      memcpy(out, matrix, sizeof(matrix));
+      return;
+    }
+    const T x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+    const T xx = x * x, yy = y * y, zz = z * z;
+    const T xy = x * y, xz = x * z, yz = y * z;
+    const T wx = w * x, wy = w * y, wz = w * z;
+
+    out[0] = (T(1) - T(2) * (yy + zz)) * scale[0];
+    out[1] = T(2) * (xy + wz) * scale[0];
+    out[2] = T(2) * (xz - wy) * scale[0];
+    out[3] = T(0);
+    out[4] = T(2) * (xy - wz) * scale[1];
+    out[5] = (T(1) - T(2) * (xx + zz)) * scale[1];
+    out[6] = T(2) * (yz + wx) * scale[1];
+    out[7] = T(0);
+    out[8] = T(2) * (xz + wy) * scale[2];
+    out[9] = T(2) * (yz - wx) * scale[2];
+    out[10] = (T(1) - T(2) * (xx + yy)) * scale[2];
+    out[11] = T(0);
+    out[12] = translation[0];
+    out[13] = translation[1];
+    out[14] = translation[2];
+    out[15] = T(1);
+  }
+};
+
+///
+/// Fills `out` with the transform of `node`, model.nodes[node_idx].
+///
+/// Returns false and appends to `err` when its translation/rotation/scale/
+/// matrix has an invalid length. That component is left at its default.
+///
+template <typename T>
+bool BuildNodeTransform(const Node &node, size_t node_idx,
+                        NodeTransform<T> *out, std::string *err = nullptr) {
+  bool ret = true;
+  *out = NodeTransform<T>();
+  auto copy = [&](const ModelVector<double> &src, size_t n, T *dst,
+                  uint32_t flag, const char *name) {
+    if (src.empty()) {
+      return;
+    }
+    if (src.size() != n) {
+      if (err) {
+        (*err) += "nodes[" + std::to_string(node_idx) + "]." + name +
+                  " must have " + std::to_string(n) + " elements.\n";
+      }
+      ret = false;
+      return;
+    }
+    for (size_t k = 0; k < n; k++) {
+      dst[k] = static_cast<T>(src[k]);
+    }
+    out->flags |= flag;
+  };
+  copy(node.translation, 3, out->translation,
+       NodeTransform<T>::HAS_TRANSLATION, "translation");
+  copy(node.rotation, 4, out->rotation, NodeTransform<T>::HAS_ROTATION,
+       "rotation");
+  copy(node.scale, 3, out->scale, NodeTransform<T>::HAS_SCALE, "scale");
+  copy(node.matrix, 16, out->matrix, NodeTransform<T>::HAS_MATRIX, "matrix");
+  return ret;
+}
+
+///
+/// Fills `out` with the transform of every node of `model`(out[i] is
+/// model.nodes[i]), so transforms can be evaluated from contiguous memory
+/// instead of the per node std::vector<double>s.
+///
+/// Returns false and appends to `err` when a translation/rotation/scale/matrix
+/// of a node has an invalid length. That component is left at its default.
+///
+template <typename T>
+bool BuildNodeTransforms(const Model &model,
+                         std::vector<NodeTransform<T> > *out,
+                         std::string *err = nullptr) {
+  bool ret = true;
+  out->resize(model.nodes.size());
+  for (size_t i = 0; i < model.nodes.size(); i++) {
+    if (!BuildNodeTransform(model.nodes[i], i, &(*out)[i], err)) {
+      ret = false;
+    }
+  }
+  return ret;
+}
+
+///
+/// World transforms of the nodes of a scene. Build() flattens the node
+/// hierarchy into a topologically ordered array(each parent comes before its
+/// children, and the descendants of a node directly follow it) and computes
+/// the world matrix of every node into one contiguous array of column major
+/// 4x4 matrices.
+///
+/// After changing local transforms with SetLocalTransform()/MarkDirty(),
+/// Update() only recomputes the dirty nodes and their descendants.
+///
+/// Usage:
+///
+///   tinygltf::SceneTransforms<float> xforms;
+///   if (!xforms.Build(model, model.defaultScene, &err)) { ... }
+///   const float *world = xforms.WorldMatrix(node_index);
+///   ...
+///   xforms.SetLocalTransform(node_index, animated);
+///   xforms.Update();
+///
+template <typename T>
+class SceneTransforms {
+ public:
+  ///
+  /// Flattens scene `scene_idx`(-1: the default scene, or scene 0 when none
+  /// is set) of `model` and computes all world matrices. Returns false and
+  /// appends to `err` for an invalid scene or node index, a node which is
+  /// referenced more than once, or a node of the scene with a transform of an
+  /// invalid length. The scene is then left empty.
+  ///
+  bool Build(const Model &model, int scene_idx, std::string *err = nullptr) {
+    Clear(model.nodes.size());
+
+    if (scene_idx < 0) {
+      scene_idx = (model.defaultScene >= 0) ? model.defaultScene : 0;
+    }
+    if (size_t(scene_idx) >= model.scenes.size()) {
+      if (err) {
+        (*err) += "Invalid scene index " + std::to_string(scene_idx) + ".\n";
+      }
+      return false;
+    }
+
+    // Depth first traversal with an explicit stack, so that deep hierarchies
+    // do not overflow the call stack. (node, parent slot) pairs.
+    const ModelVector<int> &roots = model.scenes[size_t(scene_idx)].nodes;
+    std::vector<std::pair<int, int> > stack;
+    for (size_t i = roots.size(); i > 0; i--) {
+      stack.push_back(std::make_pair(roots[i - 1], -1));
+    }
+    while (!stack.empty()) {
+      const int node = stack.back().first;
+      const int parent = stack.back().second;
+      stack.pop_back();
+      if ((node < 0) || (size_t(node) >= model.nodes.size())) {
+        if (err) {
+          (*err) += "Invalid node index " + std::to_string(node) + ".\n";
+        }
+        Clear(model.nodes.size());
+        return false;
+      }
+      if (slots_[size_t(node)] != -1) {
+        if (err) {
+          (*err) += "nodes[" + std::to_string(node) +
+                    "] is referenced more than once in the scene.\n";
+        }
+        Clear(model.nodes.size());
+        return false;
+      }
+      NodeTransform<T> local;
+      if (!BuildNodeTransform(model.nodes[size_t(node)], size_t(node), &local,
+                              err)) {
+        Clear(model.nodes.size());
+        return false;
+      }
+      const int slot = int(nodes_.size());
+      slots_[size_t(node)] = slot;
+      nodes_.push_back(node);
+      parents_.push_back(parent);
+      locals_.push_back(local);
+
+      const ModelVector<int> &children =
+          model.nodes[size_t(node)].children;
+      for (size_t i = children.size(); i > 0; i--) {
+        stack.push_back(std::make_pair(children[i - 1], slot));
+      }
+    }
+
+    // Number of nodes in the subtree of each slot. Parents come first.
+    sizes_.assign(nodes_.size(), 1);
+    for (size_t i = nodes_.size(); i > 0; i--) {
+      if (parents_[i - 1] >= 0) {
+        sizes_[size_t(parents_[i - 1])] += sizes_[i - 1];
+      }
+    }
+
+    world_.resize(nodes_.size() * 16);
+    UpdateRange(0, nodes_.size());
+    return true;
+  }
+
+  /// Number of nodes in the scene.
+  size_t Size() const { return nodes_.size(); }
+
+  /// Node indices in topological order.
+  const std::vector<int> &Nodes() const { return nodes_; }
+
+  /// Position of node `node` in Nodes()/WorldMatrices(), or -1 when the node
+  /// is not part of the scene.
+  int Slot(int node) const {
+    return ((node >= 0) && (size_t(node) < slots_.size())) ? slots_[size_t(node)]
+                                                           : -1;
+  }
+
+  /// World matrices of Nodes(), 16 column major elements each.
+  const std::vector<T> &WorldMatrices() const { return world_; }
+
+  /// World matrix of node `node`(16 column major elements), or nullptr when
+  /// the node is not part of the scene.
+  const T *WorldMatrix(int node) const {
+    const int slot = Slot(node);
+    return (slot >= 0) ? &world_[size_t(slot) * 16] : nullptr;
+  }
+
+  /// Local transform of node `node`, or nullptr when the node is not part of
+  /// the scene.
+  const NodeTransform<T> *LocalTransform(int node) const {
+    const int slot = Slot(node);
+    return (slot >= 0) ? &locals_[size_t(slot)] : nullptr;
+  }
+
+  /// Replaces the local transform of node `node` and marks it dirty. Ignored
+  /// when the node is not part of the scene.
+  void SetLocalTransform(int node, const NodeTransform<T> &transform) {
+    const int slot = Slot(node);
+    if (slot >= 0) {
+      locals_[size_t(slot)] = transform;
+      dirty_.push_back(size_t(slot));
+    }
+  }
+
+  /// Marks node `node` dirty, so Update() recomputes its subtree.
+  void MarkDirty(int node) {
+    const int slot = Slot(node);
+    if (slot >= 0) {
+      dirty_.push_back(size_t(slot));
+    }
+  }
+
+  ///
+  /// Recomputes the world matrices of the dirty nodes and their descendants.
+  /// The cost is proportional to the number of recomputed nodes.
+  ///
+  void Update() {
+    std::sort(dirty_.begin(), dirty_.end());
+    size_t updated_end = 0;
+    for (size_t slot : dirty_) {
+      // Skip nodes inside a subtree that was already recomputed.
+      if (slot < updated_end) {
+        continue;
+      }
+      updated_end = slot + sizes_[slot];
+      UpdateRange(slot, updated_end);
+    }
+    dirty_.clear();
+  }
+
+ private:
+  // Empties the scene of a model with `num_nodes` nodes.
+  void Clear(size_t num_nodes) {
+    nodes_.clear();
+    parents_.clear();
+    sizes_.clear();
+    locals_.clear();
+    world_.clear();
+    dirty_.clear();
+    slots_.assign(num_nodes, -1);
+  }
+
+  // Recomputes slots [begin, end), whose parents are up to date or inside the
+  // range.
+  void UpdateRange(size_t begin, size_t end) {
+    T local[16];
+    for (size_t i = begin; i < end; i++) {
+      T *world = &world_[i * 16];
+      locals_[i].LocalMatrix(local);
+      if (parents_[i] < 0) {
+        memcpy(world, local, sizeof(local));
+      } else {
+        Multiply(&world_[size_t(parents_[i]) * 16], local, world);
+      }
+    }
+  }
+
+  // out = a * b(column major). Written column by column so the compiler can
+  // vectorize the four rows.
+  static void Multiply(const T *a, const T *b, T *out) {
+    for (int c = 0; c < 4; c++) {
+      for (int r = 0; r < 4; r++) {
+        out[c * 4 + r] = a[r] * b[c * 4] + a[4 + r] * b[c * 4 + 1] +
+                         a[8 + r] * b[c * 4 + 2] + a[12 + r] * b[c * 4 + 3];
+      }
+    }
+  }
+
+  std::vector<int> nodes_;      // Node index of each slot.
+  std::vector<int> parents_;    // Parent slot of each slot, -1 for roots.
+  std::vector<size_t> sizes_;   // Subtree size of each slot.
+  std::vector<int> slots_;      // Slot of each node of the model, or -1.
+  std::vector<NodeTransform<T> > locals_;
+  std::vector<T> world_;
+  std::vector<size_t> dirty_;
+};
+
+///
+/// Maps a C++ arithmetic type to its TINYGLTF_COMPONENT_TYPE_*. -1 for types
+/// without a glTF counterpart.
+///
+template <typename T>
+struct ComponentTypeTraits {
+  static const int value = -1;
+};
+template <>
+struct ComponentTypeTraits<int8_t> {
+  static const int value = TINYGLTF_COMPONENT_TYPE_BYTE;
+};
+template <>
+struct ComponentTypeTraits<uint8_t> {
+  static const int value = TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE;
+};
+template <>
+struct ComponentTypeTraits<int16_t> {
+  static const int value = TINYGLTF_COMPONENT_TYPE_SHORT;
+};
+template <>
+struct ComponentTypeTraits<uint16_t> {
+  static const int value = TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT;
+};
+template <>
+struct ComponentTypeTraits<int32_t> {
+  static const int value = TINYGLTF_COMPONENT_TYPE_INT;
+};
+template <>
+struct ComponentTypeTraits<uint32_t> {
+  static const int value = TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
+};
+template <>
+struct ComponentTypeTraits<float> {
+  static const int value = TINYGLTF_COMPONENT_TYPE_FLOAT;
+};
+template <>
+struct ComponentTypeTraits<double> {
+  static const int value = TINYGLTF_COMPONENT_TYPE_DOUBLE;
+};
+
+///
+/// Element type description for AccessorView. Scalars and std::array are
+/// supported out of the box. Specialize this for your own vector/matrix types
+/// (e.g. glm::vec3). The type must be trivially copyable and laid out as
+/// `num_components` contiguous values of `component_type`. Matrices are column
+/// major, as in glTF.
+///
+template <typename T>
+struct AccessorElementTraits {
+  typedef T component_type;
+  static const int num_components = 1;
+};
+template <typename T, size_t N>
+struct AccessorElementTraits<std::array<T, N> > {
+  typedef T component_type;
+  static const int num_components = int(N);
+};
+
+///
+/// Resolved location and layout of accessor data. See AccessorView.
+///
+class AccessorViewBase {
+ public:
+  /// false when the accessor could not be resolved. The view is then empty.
+  bool IsValid() const { return valid_; }
+
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+ protected:
+  AccessorViewBase() = default;
+
+  // `num_components`: required number of components, -1 accepts any type.
+  bool Init(const Model &model, const Accessor &accessor, int num_components,
+            std::string *err) {
+    const int accessor_components =
+        GetNumComponentsInType(static_cast<uint32_t>(accessor.type));
+    const int component_size = GetComponentSizeInBytes(
+        static_cast<uint32_t>(accessor.componentType));
+    if ((accessor_components <= 0) || (component_size <= 0)) {
+      if (err) {
+        (*err) += "Accessor has invalid type or componentType.\n";
+      }
+      return false;
+    }
+    if ((num_components >= 0) && (accessor_components != num_components)) {
+      if (err) {
+        (*err) += "Accessor has " + std::to_string(accessor_components) +
+                  " components but the element type has " +
+                  std::to_string(num_components) + ".\n";
+      }
+      return false;
+    }
+
+    num_components_ = accessor_components;
+    component_type_ = accessor.componentType;
+    component_size_ = size_t(component_size);
+    normalized_ = accessor.normalized;
+
+    // Matrix columns start at 4 byte boundaries.
+    if ((accessor.type == TINYGLTF_TYPE_MAT2) ||
+        (accessor.type == TINYGLTF_TYPE_MAT3) ||
+        (accessor.type == TINYGLTF_TYPE_MAT4)) {
+      columns_ = accessor.type - 32;
+      rows_ = columns_;
+      column_stride_ = ((size_t(rows_) * component_size_ + 3) / 4) * 4;
+    } else {
+      columns_ = 1;
+      rows_ = accessor_components;
+      column_stride_ = size_t(rows_) * component_size_;
+    }
+    element_size_ = size_t(columns_) * column_stride_;
+
+    const size_t count = accessor.count;
+
+    if (accessor.bufferView >= 0) {
+      size_t view_length = 0;
+      const unsigned char *view_data =
+          ResolveBufferView(model, accessor.bufferView, &view_length, err);
+      if (view_data == nullptr) {
+        return false;
+      }
+      const BufferView &view = model.bufferViews[size_t(accessor.bufferView)];
+      byte_stride_ = (view.byteStride > 0) ? view.byteStride : element_size_;
+      if ((count > 0) &&
+          ((accessor.byteOffset > view_length) ||
+           (count - 1 > (view_length - accessor.byteOffset) / byte_stride_) ||
+           (accessor.byteOffset + (count - 1) * byte_stride_ + element_size_ >
+            view_length))) {
+        if (err) {
+          (*err) += "Accessor data exceeds its bufferView.\n";
+        }
+        return false;
+      }
+      data_ = view_data + accessor.byteOffset;
+    } else {
+      // Zero initialized unless overridden by sparse values.
+      data_ = nullptr;
+      byte_stride_ = element_size_;
+    }
+
+    if (accessor.sparse.isSparse) {
+      const size_t sparse_count = size_t(accessor.sparse.count);
+      const int index_type = accessor.sparse.indices.componentType;
+      const int index_size =
+          GetComponentSizeInBytes(static_cast<uint32_t>(index_type));
+      if ((accessor.sparse.count < 0) ||
+          ((index_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) &&
+           (index_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) &&
+           (index_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT))) {
+        if (err) {
+          (*err) += "Invalid sparse accessor.\n";
+        }
+        return false;
+      }
+      sparse_index_type_ = accessor.sparse.indices.componentType;
+
+      size_t indices_length = 0;
+      const unsigned char *indices = ResolveBufferView(
+          model, accessor.sparse.indices.bufferView, &indices_length, err);
+      size_t values_length = 0;
+      const unsigned char *values = ResolveBufferView(
+          model, accessor.sparse.values.bufferView, &values_length, err);
+      if ((indices == nullptr) || (values == nullptr)) {
+        return false;
+      }
+      const size_t indices_offset = size_t(accessor.sparse.indices.byteOffset);
+      const size_t values_offset = size_t(accessor.sparse.values.byteOffset);
+      if ((accessor.sparse.indices.byteOffset < 0) ||
+          (accessor.sparse.values.byteOffset < 0) ||
+          (indices_offset > indices_length) ||
+          (sparse_count > (indices_length - indices_offset) /
+                              size_t(index_size)) ||
+          (values_offset > values_length) ||
+          (sparse_count > (values_length - values_offset) / element_size_)) {
+        if (err) {
+          (*err) += "Sparse accessor data exceeds its bufferView.\n";
+        }
+        return false;
+      }
+      sparse_indices_ = indices + indices_offset;
+      sparse_values_ = values + values_offset;
+      sparse_count_ = sparse_count;
+
+      // Indices must be strictly increasing and less than count.
+      for (size_t k = 0; k < sparse_count_; k++) {
+        const size_t idx = ReadSparseIndex(k);
+        if ((idx >= count) || ((k > 0) && (idx <= ReadSparseIndex(k - 1)))) {
+          if (err) {
+            (*err) += "Sparse accessor indices must be strictly increasing "
+                      "and less than count.\n";
+          }
+          sparse_count_ = 0;
+          return false;
+        }
+      }
+    }
+
+    count_ = count;
+    return true;
+  }
+
+  static const unsigned char *ResolveBufferView(const Model &model,
+                                                int view_idx, size_t *length,
+                                                std::string *err) {
+    if ((view_idx < 0) || (size_t(view_idx) >= model.bufferViews.size())) {
+      if (err) {
+        (*err) += "Invalid bufferView index " + std::to_string(view_idx) +
+                  ".\n";
+      }
+      return nullptr;
+    }
+    const BufferView &view = model.bufferViews[size_t(view_idx)];
+    if ((view.buffer < 0) || (size_t(view.buffer) >= model.buffers.size())) {
+      if (err) {
+        (*err) += "Invalid buffer index " + std::to_string(view.buffer) +
+                  ".\n";
+      }
+      return nullptr;
+    }
+    const Buffer &buffer = model.buffers[size_t(view.buffer)];
+    if ((view.byteOffset > buffer.DataSize()) ||
+        (view.byteLength > buffer.DataSize() - view.byteOffset)) {
+      if (err) {
+        (*err) += "bufferView " + std::to_string(view_idx) +
+                  " exceeds its buffer.\n";
+      }
+      return nullptr;
+    }
+    *length = view.byteLength;
+    return buffer.DataPtr() + view.byteOffset;
+  }
+
+  size_t ReadSparseIndex(size_t k) const {
+    if (sparse_index_type_ == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
+      return sparse_indices_[k];
+    } else if (sparse_index_type_ == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
+      uint16_t idx;
+      memcpy(&idx, sparse_indices_ + k * 2, 2);
+      return idx;
+    }
+    uint32_t idx;
+    memcpy(&idx, sparse_indices_ + k * 4, 4);
+    return idx;
+  }
+
+  bool FindSparseIndex(size_t i, size_t *k) const {
+    size_t lo = 0;
+    size_t hi = sparse_count_;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      const size_t idx = ReadSparseIndex(mid);
+      if (idx == i) {
+        *k = mid;
+        return true;
+      } else if (idx < i) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return false;
+  }
+
+
+  bool valid_{false};
+  const unsigned char *data_{nullptr};  // nullptr: no bufferView(zeros).
+  size_t count_{0};
+  size_t byte_stride_{0};
+  size_t element_size_{0};  // Packed element size including column padding.
+  size_t component_size_{0};
+  size_t column_stride_{0};
+  int component_type_{-1};
+  int num_components_{0};
+  int rows_{0};
+  int columns_{0};
+  bool normalized_{false};
+
+  const unsigned char *sparse_indices_{nullptr};
+  const unsigned char *sparse_values_{nullptr};
+  size_t sparse_count_{0};
+  int sparse_index_type_{-1};
+};
+
+///
+/// Read-only typed view of accessor data. Resolves the buffer, byte offsets,
+/// byteStride, matrix column padding, normalized integer conversion and
+/// sparse substitution.
+///
+/// Components are converted to `component_type` of `T` with static_cast.
+/// When the accessor is `normalized` and `component_type` is floating point,
+/// integer components are normalized to [0, 1] or [-1, 1].
+///
+/// The view references the Model's buffer data. It must not outlive the
+/// Model or be used after the buffers are modified.
+///
+///   AccessorView<std::array<float, 3> > positions(model, accessor_idx, &err);
+///   if (positions.IsValid()) {
+///     for (const std::array<float, 3> &p : positions) { ... }
+///   }
+///
+template <typename T>
+class AccessorView : public AccessorViewBase {
+ public:
+  typedef AccessorElementTraits<T> traits_type;
+  typedef typename traits_type::component_type component_type;
+  static const int kNumComponents = traits_type::num_components;
+
+  static_assert(std::is_arithmetic<component_type>::value,
+                "component_type must be an arithmetic type.");
+  static_assert(sizeof(T) == sizeof(component_type) * kNumComponents,
+                "T must consist of num_components component_type values.");
+
+  class iterator {
+   public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const T *pointer;
+    typedef T reference;
+
+    iterator() = default;
+    iterator(const AccessorView *view, size_t idx) : view_(view), idx_(idx) {}
+
+    T operator*() const { return (*view_)[idx_]; }
+    iterator &operator++() {
+      idx_++;
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator it = *this;
+      idx_++;
+      return it;
+    }
+    bool operator==(const iterator &other) const { return idx_ == other.idx_; }
+    bool operator!=(const iterator &other) const { return idx_ != other.idx_; }
+
+   private:
+    const AccessorView *view_{nullptr};
+    size_t idx_{0};
+  };
+
+  AccessorView() = default;
+
+  AccessorView(const Model &model, const Accessor &accessor,
+               std::string *err = nullptr) {
+    valid_ = Init(model, accessor, kNumComponents, err);
+    direct_ = (ComponentTypeTraits<component_type>::value == component_type_) &&
+              (element_size_ == sizeof(T));
+  }
+
+  AccessorView(const Model &model, int accessor_idx,
+               std::string *err = nullptr) {
+    if ((accessor_idx < 0) ||
+        (size_t(accessor_idx) >= model.accessors.size())) {
+      if (err) {
+        (*err) += "Invalid accessor index " + std::to_string(accessor_idx) +
+                  ".\n";
+      }
+      return;
+    }
+    valid_ = Init(model, model.accessors[size_t(accessor_idx)], kNumComponents,
+                  err);
+    direct_ = (ComponentTypeTraits<component_type>::value == component_type_) &&
+              (element_size_ == sizeof(T));
+  }
+
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, count_); }
+
+  /// Returns element `i`. `i` must be less than size().
+  T operator[](size_t i) const {
+    if (sparse_count_ > 0) {
+      size_t k;
+      if (FindSparseIndex(i, &k)) {
+        return ReadElement(sparse_values_ + k * element_size_);
+      }
+    }
+    if (data_ == nullptr) {
+      return T();
+    }
+    return ReadElement(data_ + i * byte_stride_);
+  }
+
+  ///
+  /// Pointer to the elements when they are stored in the buffer exactly as
+  /// `T`(same component type, tightly packed, aligned and not sparse).
+  /// nullptr otherwise; use CopyTo() then.
+  ///
+  const T *Data() const {
+    if (!valid_ || !direct_ || (sparse_count_ > 0) || (data_ == nullptr) ||
+        (byte_stride_ != sizeof(T)) ||
+        ((reinterpret_cast<uintptr_t>(data_) % alignof(component_type)) !=
+         0)) {
+      return nullptr;
+    }
+    return reinterpret_cast<const T *>(data_);
+  }
+
+  ///
+  /// Writes all size() elements to `dst`. Tightly packed data of the same
+  /// component type is copied with a single memcpy.
+  ///
+  bool CopyTo(T *dst) const {
+    if (!valid_) {
+      return false;
+    }
+    if (count_ == 0) {
+      return true;
+    }
+
+    if (data_ == nullptr) {
+      for (size_t i = 0; i < count_; i++) {
+        dst[i] = T();
+      }
+    } else if (direct_ && (byte_stride_ == sizeof(T))) {
+      memcpy(dst, data_, count_ * sizeof(T));
+    } else {
+      switch (component_type_) {
+        case TINYGLTF_COMPONENT_TYPE_BYTE:
+          CopyElements<int8_t>(dst);
+          break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+          CopyElements<uint8_t>(dst);
+          break;
+        case TINYGLTF_COMPONENT_TYPE_SHORT:
+          CopyElements<int16_t>(dst);
+          break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+          CopyElements<uint16_t>(dst);
+          break;
+        case TINYGLTF_COMPONENT_TYPE_INT:
+          CopyElements<int32_t>(dst);
+          break;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+          CopyElements<uint32_t>(dst);
+          break;
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:
+          CopyElements<float>(dst);
+          break;
+        default:
+          CopyElements<double>(dst);
+          break;
+      }
+    }
+
+    // Indices are strictly increasing, so a single pass suffices.
+    for (size_t k = 0; k < sparse_count_; k++) {
+      dst[ReadSparseIndex(k)] =
+          ReadElement(sparse_values_ + k * element_size_);
+    }
+    return true;
+  }
+
+  /// Returns all elements. Empty if the view is invalid.
+  std::vector<T> ToVector() const {
+    std::vector<T> v;
+    if (valid_) {
+      v.resize(count_);
+      CopyTo(v.data());
+    }
+    return v;
+  }
+
+ private:
+  template <typename Src>
+  static component_type Convert(Src v, bool normalized) {
+    if (std::is_floating_point<component_type>::value &&
+        std::is_integral<Src>::value && normalized) {
+      const component_type c = static_cast<component_type>(v) /
+                               static_cast<component_type>(
+                                   (std::numeric_limits<Src>::max)());
+      // Signed: -max and -max - 1 both map to -1.
+      return (c < component_type(-1)) ? component_type(-1) : c;
+    }
+    return static_cast<component_type>(v);
+  }
+
+  template <typename Src>
+  void ReadComponents(const unsigned char *p, component_type *out) const {
+    for (int c = 0; c < columns_; c++) {
+      const unsigned char *column = p + size_t(c) * column_stride_;
+      for (int r = 0; r < rows_; r++) {
+        Src v;
+        memcpy(&v, column + size_t(r) * sizeof(Src), sizeof(Src));
+        out[c * rows_ + r] = Convert<Src>(v, normalized_);
+      }
+    }
+  }
+
+  T ReadElement(const unsigned char *p) const {
+    T ret;
+    if (direct_) {
+      memcpy(&ret, p, sizeof(T));
+      return ret;
+    }
+    component_type comps[kNumComponents];
+    switch (component_type_) {
+      case TINYGLTF_COMPONENT_TYPE_BYTE:
+        ReadComponents<int8_t>(p, comps);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        ReadComponents<uint8_t>(p, comps);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_SHORT:
+        ReadComponents<int16_t>(p, comps);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+        ReadComponents<uint16_t>(p, comps);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_INT:
+        ReadComponents<int32_t>(p, comps);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+        ReadComponents<uint32_t>(p, comps);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_FLOAT:
+        ReadComponents<float>(p, comps);
+        break;
+      default:
+        ReadComponents<double>(p, comps);
+        break;
+    }
+    memcpy(&ret, comps, sizeof(T));
+    return ret;
+  }
+
+  // Component type dispatch is hoisted out of the element loop.
+  template <typename Src>
+  void CopyElements(T *dst) const {
+    const unsigned char *p = data_;
+    if (direct_) {
+      for (size_t i = 0; i < count_; i++, p += byte_stride_) {
+        memcpy(dst + i, p, sizeof(T));
+      }
+      return;
+    }
+    component_type comps[kNumComponents];
+    for (size_t i = 0; i < count_; i++, p += byte_stride_) {
+      ReadComponents<Src>(p, comps);
+      memcpy(dst + i, comps, sizeof(T));
+    }
+  }
+
+  bool direct_{false};  // Elements are stored as `T`.
+};
+
+///
+/// Unpacks all elements of accessor `accessor_idx` to tightly packed float
+/// components(accessor.count * number of components, matrix column padding
+/// removed). Normalized integer components are mapped to [0, 1] or [-1, 1],
+/// sparse values are applied and accessors without a bufferView read as
+/// zeros. Uses SIMD kernels where available.
+///
+/// Returns false and appends to `err` for an invalid accessor or when
+/// `dst_size`(number of floats) is too small.
+///
+bool UnpackAccessorToFloat(const Model &model, int accessor_idx, float *dst,
+                           size_t dst_size, std::string *err = nullptr);
+bool UnpackAccessorToFloat(const Model &model, int accessor_idx,
+                           std::vector<float> *out, std::string *err = nullptr);
+
+///
+/// Same as UnpackAccessorToFloat for integer accessors(e.g. indices, joints).
+/// Values are not normalized. Signed values are converted with static_cast.
+/// Floating point accessors are rejected.
+///
+bool UnpackAccessorToUint32(const Model &model, int accessor_idx,
+                            uint32_t *dst, size_t dst_size,
+                            std::string *err = nullptr);
+bool UnpackAccessorToUint32(const Model &model, int accessor_idx,
+                            std::vector<uint32_t> *out,
+                            std::string *err = nullptr);
 
-  std::vector<Accessor> accessors;
-  std::vector<Animation> animations;
-  std::vector<Buffer> buffers;
-  std::vector<BufferView> bufferViews;
-  std::vector<Material> materials;
-  std::vector<Mesh> meshes;
-  std::vector<Node> nodes;
-  std::vector<Texture> textures;
-  std::vector<Image> images;
-  std::vector<Skin> skins;
-  std::vector<Sampler> samplers;
-  std::vector<Camera> cameras;
-  std::vector<Scene> scenes;
-  std::vector<Light> lights;
+///
+/// Writes the dense data of accessor `accessor_idx` to `out`: accessor.count
+/// tightly packed elements of the accessor's componentType and type(matrix
+/// column padding is kept, byteStride is not). Sparse values are applied on
+/// top of the base bufferView, or on top of zeros when it is absent.
+///
+bool MaterializeSparseAccessor(const Model &model, int accessor_idx,
+                               std::vector<unsigned char> *out,
+                               std::string *err = nullptr);
 
-  int defaultScene = -1;
-  std::vector<std::string> extensionsUsed;
-  std::vector<std::string> extensionsRequired;
+///
+/// Replaces every sparse accessor of `model` with its dense data so it is
+/// only computed once. The data is stored in one new buffer(one bufferView
+/// per accessor), the accessor is pointed at it and `sparse.isSparse` is
+/// cleared. Saving the model afterwards writes the dense data.
+///
+/// Accessors are processed on up to `num_threads` threads(0: all hardware
+/// threads). Returns false and leaves the model unchanged on error.
+///
+bool MaterializeSparseAccessors(Model *model, std::string *err = nullptr,
+                                int num_threads = 1);
 
-  Asset asset;
+///
+/// Playback state of one instance of an animation for AnimationEvaluator:
+/// the current keyframe of each sampler, so that playing forward finds the
+/// next keyframe without a binary search.
+///
+struct AnimationCursor {
+  std::vector<size_t> keys;
+};
 
-  Value extras;
-  ExtensionMap extensions;
+///
+/// Samples the channels of an Animation. Init() unpacks the keyframes of all
+/// samplers once. Evaluate() then writes the node translation/rotation/scale
+/// and morph target weights at a given time. LINEAR(slerp for rotations),
+/// STEP and CUBICSPLINE interpolation are supported. Times outside of the
+/// keyframes are clamped to the first/last keyframe.
+///
+/// The evaluator is not modified by Evaluate(), so one evaluator can be
+/// shared by many instances(each with its own AnimationCursor), also from
+/// several threads.
+///
+/// Usage:
+///
+///   tinygltf::AnimationEvaluator anim;
+///   if (!anim.Init(model, 0, &err)) { ... }
+///   std::vector<tinygltf::NodeTransform<float> > pose;
+///   tinygltf::BuildNodeTransforms(model, &pose);
+///   tinygltf::AnimationCursor cursor;
+///   anim.Evaluate(time, &cursor, &pose);
+///
+class AnimationEvaluator {
+ public:
+  ///
+  /// Prepares animation `animation_idx` of `model`. Returns false and appends
+  /// to `err` for invalid samplers or accessors. Channels without a target
+  /// node(e.g. using KHR_animation_pointer) or with an unknown path are
+  /// skipped.
+  ///
+  bool Init(const Model &model, int animation_idx, std::string *err = nullptr);
 
-  // Filled when SetStoreOriginalJSONForExtrasAndExtensions is enabled.
-  std::string extras_json_string;
-  std::string extensions_json_string;
+  /// Time of the first/last keyframe of all samplers.
+  float StartTime() const { return start_time_; }
+  float EndTime() const { return end_time_; }
+
+  ///
+  /// Writes the animated values at `time` to `transforms`(indexed by node,
+  /// e.g. filled by BuildNodeTransforms) and, when not nullptr, to `weights`
+  /// (indexed by node, resized as needed). Channels whose node is out of the
+  /// range of `transforms` are skipped. Animated components get their HAS_*
+  /// flag set.
+  ///
+  void Evaluate(float time, AnimationCursor *cursor,
+                std::vector<NodeTransform<float> > *transforms,
+                std::vector<std::vector<float> > *weights = nullptr) const;
+
+  ///
+  /// Evaluates `count` instances: instance `i` at `times[i]` with
+  /// `cursors[i]`, writing to `transforms[i]` and `weights[i]`(when `weights`
+  /// is not nullptr). Instances are distributed over up to `num_threads`
+  /// threads(0: all hardware threads).
+  ///
+  void Evaluate(size_t count, const float *times, AnimationCursor *cursors,
+                std::vector<NodeTransform<float> > *transforms,
+                std::vector<std::vector<float> > *weights = nullptr,
+                int num_threads = 1) const;
+
+ private:
+  enum Interpolation { LINEAR, STEP, CUBICSPLINE };
+  enum Path { TRANSLATION, ROTATION, SCALE, WEIGHTS };
+
+  struct Sampler {
+    std::vector<float> times;
+    std::vector<float> values;  // CUBICSPLINE: in-tangent, value, out-tangent.
+    size_t components;          // Per keyframe(the number of morph targets
+                                // for weights).
+    Interpolation interpolation;
+  };
+
+  struct Channel {
+    int node;
+    Path path;
+    size_t sampler;
+  };
+
+  // Keyframe `k` such that times[k] <= time < times[k + 1], starting the search
+  // from the previous keyframe `hint`.
+  static size_t FindKey(const std::vector<float> &times, float time,
+                        size_t hint);
+  static void Sample(const Sampler &sampler, float time, size_t *key,
+                     bool normalize, float *out);
+
+  std::vector<Sampler> samplers_;
+  std::vector<Channel> channels_;
+  float start_time_{0.0f};
+  float end_time_{0.0f};
 };
 
 enum SectionCheck {
@@ -1194,20 +3162,24 @@ enum SectionCheck {
   REQUIRE_ALL = 0x7f
 };
 
-///
-/// LoadImageDataFunction type. Signature for custom image loading callbacks.
-///
-typedef bool (*LoadImageDataFunction)(Image *, const int, std::string *,
-                                      std::string *, int, int,
-                                      const unsigned char *, int,
-                                      void *user_pointer);
-
 ///
 /// WriteImageDataFunction type. Signature for custom image writing callbacks.
 ///
 typedef bool (*WriteImageDataFunction)(const std::string *, const std::string *,
                                        Image *, bool, void *);
 
+///
+/// Option of the default image loader(LoadImageData). Passed as the
+/// user_pointer to the callback. It is not passed when the user supplies
+/// their own LoadImageData callback.
+///
+struct LoadImageDataOption {
+  // true: preserve image channels(e.g. load as RGB image if the image has RGB
+  // channels) default `false`(channels are expanded to RGBA for backward
+  // compatiblity).
+  bool preserve_channels{false};
+};
+
 #ifndef TINYGLTF_NO_STB_IMAGE
 // Declaration of default image loader callback
 bool LoadImageData(Image *image, const int image_idx, std::string *err,
@@ -1245,6 +3217,22 @@ typedef bool (*WriteWholeFileFunction)(std::string *, const std::string &,
                                        const std::vector<unsigned char> &,
                                        void *);
 
+///
+/// Read-only view of the whole contents of a file(e.g. a memory mapped file).
+/// `data` is valid as long as `owner`(or a copy of it) is alive.
+///
+struct MappedFile {
+  const unsigned char *data{nullptr};
+  size_t size{0};
+  std::shared_ptr<void> owner;  // Releases(e.g. unmaps) `data` when destroyed
+};
+
+///
+/// MapWholeFileFunction type. Signature for custom filesystem callbacks.
+///
+typedef bool (*MapWholeFileFunction)(MappedFile *, std::string *,
+                                     const std::string &, void *);
+
 ///
 /// A structure containing all required filesystem callbacks and a pointer to
 /// their user data.
@@ -1256,6 +3244,12 @@ struct FsCallbacks {
   WriteWholeFileFunction WriteWholeFile;
 
   void *user_data;  // An argument that is passed to all fs callbacks
+
+  // Optional. When set, glTF/GLB files and external buffer files are mapped
+  // with this callback instead of being read with `ReadWholeFile`, and the
+  // loaded Buffers reference the mapped memory(`Buffer::view_data`) instead
+  // of copying it.
+  MapWholeFileFunction MapWholeFile;
 };
 
 #ifndef TINYGLTF_NO_FS
@@ -1277,6 +3271,14 @@ bool ReadWholeFile(std::vector<unsigned char> *out, std::string *err,
 
 bool WriteWholeFile(std::string *err, const std::string &filepath,
                     const std::vector<unsigned char> &contents, void *);
+
+///
+/// Map the whole file read-only into memory(mmap on posix, file mapping on
+/// Windows). Not set in the default FsCallbacks; assign it to
+/// `FsCallbacks::MapWholeFile` to load files through memory mapping.
+///
+bool MapWholeFile(MappedFile *out, std::string *err,
+                  const std::string &filepath, void *);
 #endif
 
 ///
@@ -1313,7 +3315,7 @@ class TinyGLTF {
   /// Returns false and set error string to `err` if there's an error.
   ///
   bool LoadASCIIFromString(Model *model, std::string *err, std::string *warn,
-                           const char *str, const unsigned int length,
+                           const char *str, const size_t length,
                            const std::string &base_dir,
                            unsigned int check_sections = REQUIRE_VERSION);
 
@@ -1328,24 +3330,30 @@ class TinyGLTF {
 
   ///
   /// Loads glTF binary asset from memory.
-  /// `length` = strlen(str);
+  /// `length` = size of `bytes` in bytes. The GLB container itself is limited
+  /// to 4GB(32bit length fields), larger data must be stored in external
+  /// buffers.
   /// Set warning message to `warn` for example it fails to load asserts.
   /// Returns false and set error string to `err` if there's an error.
   ///
   bool LoadBinaryFromMemory(Model *model, std::string *err, std::string *warn,
-                            const unsigned char *bytes,
-                            const unsigned int length,
+                            const unsigned char *bytes, const size_t length,
                             const std::string &base_dir = "",
                             unsigned int check_sections = REQUIRE_VERSION);
 
   ///
   /// Write glTF to stream, buffers and images will be embeded
+  /// Returns false when `writeBinary` is true and the GLB would exceed the
+  /// 4GB limit of the container.
   ///
   bool WriteGltfSceneToStream(Model *model, std::ostream &stream,
                               bool prettyPrint, bool writeBinary);
 
   ///
   /// Write glTF to file.
+  /// When `writeBinary` is true and the first buffer is too large for the
+  /// GLB container(4GB), it is written as an external .bin file like the
+  /// other buffers.
   ///
   bool WriteGltfSceneToFile(Model *model, const std::string &filename,
                             bool embedImages, bool embedBuffers,
@@ -1399,6 +3407,23 @@ class TinyGLTF {
     return store_original_json_for_extras_and_extensions_;
   }
 
+  ///
+  /// Do not parse `extras` and `extensions` on load. The model keeps the
+  /// source JSON in `Model::lazy_json`, and each object refers to its
+  /// `extras` and `extensions` there with its `lazy_extras`(see LazyExtras),
+  /// which parses them on request and writes them when saving. The `extras`
+  /// and `extensions` members of the model objects are left empty, except
+  /// for the KHR_draco_mesh_compression primitive extension when Draco is
+  /// enabled. Lights(KHR_lights_punctual) are still loaded.
+  ///
+  void SetLazyExtrasAndExtensions(const bool enabled) {
+    lazy_extras_and_extensions_ = enabled;
+  }
+
+  bool GetLazyExtrasAndExtensions() const {
+    return lazy_extras_and_extensions_;
+  }
+
   ///
   /// Specify whether preserve image channales when loading images or not.
   /// (Not effective when the user suppy their own LoadImageData callbacks)
@@ -1409,6 +3434,96 @@ class TinyGLTF {
 
   bool GetPreserveImageChannels() const { return preserve_image_channels_; }
 
+  ///
+  /// Reference the BIN chunk of a GLB loaded by `LoadBinaryFromMemory()`
+  /// instead of copying it into `Buffer::data`(default = false).
+  /// When enabled, the GLB-stored buffer only holds a view(`Buffer::view_data`)
+  /// into `bytes`, so `bytes` must outlive the loaded Model.
+  /// (Not effective for `LoadBinaryFromFile()`, whose file contents are freed
+  /// on return)
+  ///
+  void SetZeroCopyBinaryBuffer(bool onoff) { zero_copy_binary_buffer_ = onoff; }
+
+  bool GetZeroCopyBinaryBuffer() const { return zero_copy_binary_buffer_; }
+
+  ///
+  /// Set the number of worker threads used for parallelizable steps of
+  /// loading(currently image decoding) and saving(serializing the top level
+  /// arrays). 1 = run on the calling thread(default), 0 = use the number of
+  /// hardware threads.
+  /// Results and `err`/`warn` messages are ordered as in the serial case, and
+  /// saved files are identical to the serial case.
+  /// A user supplied LoadImageData callback must be thread-safe when
+  /// `num_threads` is not 1.
+  /// (Not effective when compiled with TINYGLTF_NO_THREADS, which is also
+  /// defined for MinGW toolchains without std::thread)
+  ///
+  void SetNumThreads(int num_threads) { num_threads_ = num_threads; }
+
+  int GetNumThreads() const { return num_threads_; }
+
+  ///
+  /// Do not decode images while loading(default = false).
+  /// When enabled, images are kept as-is(`Image::as_is` = true): the encoded
+  /// data of `uri` images is stored in `Image::image` and bufferView images
+  /// keep referencing the bufferView. Call `Image::Decode()` to decode an
+  /// image on demand. As-is images are written back without re-encoding.
+  ///
+  void SetDeferImageDecoding(bool onoff) { defer_image_decoding_ = onoff; }
+
+  bool GetDeferImageDecoding() const { return defer_image_decoding_; }
+
+  ///
+  /// Parse glTF JSON with a streaming(SAX) parser(default = false).
+  /// Elements of the top level arrays(nodes, accessors, meshes, ...) are
+  /// converted to Model objects one at a time, so the JSON DOM of the whole
+  /// document is never built. Results are identical to the default parser.
+  /// (Not effective when compiled with TINYGLTF_USE_RAPIDJSON or
+  /// TINYGLTF_USE_SIMDJSON)
+  ///
+  void SetStreamingJsonParse(bool onoff) { streaming_json_parse_ = onoff; }
+
+  bool GetStreamingJsonParse() const { return streaming_json_parse_; }
+
+  ///
+  /// Parse glTF JSON in place(default = false). The JSON is copied into a
+  /// buffer kept by this TinyGLTF and parsed with RapidJSON's ParseInsitu, so
+  /// strings are not copied again into the document. JSON values are
+  /// allocated from a memory pool also kept between loads(unless
+  /// TINYGLTF_USE_RAPIDJSON_CRTALLOCATOR is defined): after a first load,
+  /// loading files of similar size does not allocate for the JSON document.
+  /// (Only effective when compiled with TINYGLTF_USE_RAPIDJSON)
+  ///
+  void SetInsituJsonParse(bool onoff) { insitu_json_parse_ = onoff; }
+
+  bool GetInsituJsonParse() const { return insitu_json_parse_; }
+
+  ///
+  /// Pack all buffers into the BIN chunk when writing GLB(default = false).
+  /// bufferViews are rewritten to point into the single packed buffer, which
+  /// takes over the name and extras of the first buffer. Images are stored
+  /// as bufferViews of the packed buffer too(by `WriteGltfSceneToStream()`,
+  /// and by `WriteGltfSceneToFile()` when `embedImages` is true).
+  /// Extensions referencing buffers by index are not rewritten.
+  /// Falls back to the regular layout when the packed GLB would exceed 4GB.
+  ///
+  void SetPackGlbBuffers(bool onoff) { pack_glb_buffers_ = onoff; }
+
+  bool GetPackGlbBuffers() const { return pack_glb_buffers_; }
+
+  ///
+  /// Write glTF JSON with the direct writer(default = false).
+  /// The JSON text is written while serializing the Model, without building
+  /// a JSON DOM first. Numbers are written in the shortest form which
+  /// round-trips. The output is semantically identical to the default, but
+  /// object members are written in the order they are serialized rather than
+  /// sorted by key.
+  /// (Always on when compiled with TINYGLTF_USE_SIMDJSON)
+  ///
+  void SetDirectJsonWriter(bool onoff) { direct_json_writer_ = onoff; }
+
+  bool GetDirectJsonWriter() const { return direct_json_writer_; }
+
  private:
   ///
   /// Loads glTF asset from string(memory).
@@ -1417,30 +3532,69 @@ class TinyGLTF {
   /// Returns false and set error string to `err` if there's an error.
   ///
   bool LoadFromString(Model *model, std::string *err, std::string *warn,
-                      const char *str, const unsigned int length,
+                      const char *str, const size_t length,
                       const std::string &base_dir, unsigned int check_sections);
 
+  ///
+  /// Implementations of `WriteGltfSceneToStream()`/`WriteGltfSceneToFile()`
+  /// for a JSON output type `J`(the JSON DOM or the direct writer).
+  ///
+  template <typename J>
+  bool WriteGltfSceneToStream(Model *model, std::ostream &stream,
+                              bool prettyPrint, bool writeBinary);
+
+  template <typename J>
+  bool WriteGltfSceneToFile(Model *model, const std::string &filename,
+                            bool embedImages, bool embedBuffers,
+                            bool prettyPrint, bool writeBinary);
+
   const unsigned char *bin_data_ = nullptr;
   size_t bin_size_ = 0;
+  std::shared_ptr<void> bin_owner_;  // Set when `bin_data_` is memory mapped
   bool is_binary_ = false;
 
   bool serialize_default_values_ = false;  ///< Serialize default values?
 
   bool store_original_json_for_extras_and_extensions_ = false;
 
+  bool lazy_extras_and_extensions_ = false;  /// Default false(parse on load).
+
   bool preserve_image_channels_ = false;  /// Default false(expand channels to
                                           /// RGBA) for backward compatibility.
 
+  bool zero_copy_binary_buffer_ = false;  /// Default false(copy the BIN chunk
+                                          /// into `Buffer::data`).
+
+  int num_threads_ = 1;  /// Default 1(single threaded).
+
+  bool defer_image_decoding_ = false;  /// Default false(decode on load).
+
+  bool streaming_json_parse_ = false;  /// Default false(parse to a DOM).
+
+  bool insitu_json_parse_ = false;  /// Default false(parse a const string).
+  std::vector<char> json_buffer_;   // Copy of the JSON parsed in place.
+  std::vector<char> json_pool_;     // Memory of the JSON value allocator.
+  size_t json_pool_size_ = 0;       // Size of `json_pool_` for the next load.
+
+  bool pack_glb_buffers_ = false;  /// Default false(only the first buffer is
+                                   /// stored in the BIN chunk).
+
+  bool direct_json_writer_ = false;  /// Default false(build a JSON DOM).
+
   FsCallbacks fs = {
 #ifndef TINYGLTF_NO_FS
       &tinygltf::FileExists, &tinygltf::ExpandFilePath,
       &tinygltf::ReadWholeFile, &tinygltf::WriteWholeFile,
 
-      nullptr  // Fs callback user data
+      nullptr,  // Fs callback user data
+
+      nullptr  // Files are read(not mapped) by default
 #else
       nullptr, nullptr, nullptr, nullptr,
 
-      nullptr  // Fs callback user data
+      nullptr,  // Fs callback user data
+
+      nullptr
 #endif
   };
 
@@ -1473,12 +3627,69 @@ class TinyGLTF {
 #if defined(TINYGLTF_IMPLEMENTATION) || defined(__INTELLISENSE__)
 #include <algorithm>
 //#include <cassert>
+#include <atomic>
+#include <functional>
+// MinGW's win32 thread model(before gcc 13) has no std::thread.
+#if defined(__MINGW32__) && !defined(_GLIBCXX_HAS_GTHREADS) && \
+    !defined(TINYGLTF_NO_THREADS)
+#define TINYGLTF_NO_THREADS
+#endif
+#ifndef TINYGLTF_NO_THREADS
+#include <exception>
+#include <mutex>
+#include <thread>
+#endif
 #ifndef TINYGLTF_NO_FS
 #include <cstdio>
 #include <fstream>
 #endif
 #include <sstream>
 
+#ifndef TINYGLTF_NO_SIMD
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define TINYGLTF_HAS_SSE2
+#endif
+// SSSE3/AVX2 kernels(base64) are compiled for any x86 target and picked at
+// first use from the CPU features(TINYGLTF_SIMD_DISPATCH), unless the compiler
+// already targets them(e.g. `-mavx2`, `/arch:AVX2`). gcc before 4.9 only
+// declares the intrinsics of the targeted instruction sets.
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+     defined(_M_IX86)) &&                                              \
+    ((defined(_MSC_VER) && !defined(__clang__)) ||                     \
+     (!defined(_MSC_VER) &&                                            \
+      (defined(__clang__) || (__GNUC__ > 4) ||                         \
+       ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))))
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TINYGLTF_TARGET_SSSE3
+#define TINYGLTF_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define TINYGLTF_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TINYGLTF_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#define TINYGLTF_HAS_SSSE3
+#define TINYGLTF_HAS_AVX2
+#if !defined(__AVX2__)
+#define TINYGLTF_SIMD_DISPATCH
+#endif
+#else
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TINYGLTF_HAS_AVX2
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define TINYGLTF_HAS_SSSE3
+#endif
+#define TINYGLTF_TARGET_SSSE3
+#define TINYGLTF_TARGET_AVX2
+#endif
+#endif
+
 #ifdef __clang__
 // Disable some warnings for external files.
 #pragma clang diagnostic push
@@ -1540,10 +3751,12 @@ class TinyGLTF {
 #pragma GCC diagnostic ignored "-Wtype-limits"
 #endif  // __GNUC__
 
+#if defined(TINYGLTF_USE_RAPIDJSON) && defined(TINYGLTF_USE_SIMDJSON)
+#error "Define only one of TINYGLTF_USE_RAPIDJSON and TINYGLTF_USE_SIMDJSON"
+#endif
+
 #ifndef TINYGLTF_NO_INCLUDE_JSON
-#ifndef TINYGLTF_USE_RAPIDJSON
-#include "json.hpp"
-#else
+#if defined(TINYGLTF_USE_RAPIDJSON)
 #ifndef TINYGLTF_NO_INCLUDE_RAPIDJSON
 #include "document.h"
 #include "prettywriter.h"
@@ -1551,6 +3764,12 @@ class TinyGLTF {
 #include "stringbuffer.h"
 #include "writer.h"
 #endif
+#elif defined(TINYGLTF_USE_SIMDJSON)
+#ifndef TINYGLTF_NO_INCLUDE_SIMDJSON
+#include "simdjson.h"
+#endif
+#else
+#include "json.hpp"
 #endif
 #endif
 
@@ -1615,6 +3834,15 @@ class TinyGLTF {
 #include <wordexp.h>
 #endif
 
+#if !defined(TINYGLTF_NO_FS) && !defined(_WIN32) && \
+    !defined(TINYGLTF_ANDROID_LOAD_FROM_ASSETS)
+// MapWholeFile
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #if defined(__sparcv9)
 // Big endian
 #else
@@ -1657,7 +3885,9 @@ rapidjson::Document::AllocatorType &GetAllocator() {
 #endif
 
 struct JsonDocument : public rapidjson::Document {
-  JsonDocument() {
+  // Values are allocated from `allocator` when given.
+  explicit JsonDocument(AllocatorType *allocator = nullptr)
+      : rapidjson::Document(allocator) {
     assert(s_pActiveDocument ==
            nullptr);  // When using default allocator, only one document can be
                       // active at a time, if you need multiple active at once,
@@ -1670,38 +3900,363 @@ struct JsonDocument : public rapidjson::Document {
     s_pActiveDocument = this;
     rhs.isNil = true;
   }
-  ~JsonDocument() {
-    if (!isNil) {
-      s_pActiveDocument = nullptr;
+  ~JsonDocument() {
+    if (!isNil) {
+      s_pActiveDocument = nullptr;
+    }
+  }
+
+ private:
+  bool isNil = false;
+};
+
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif
+
+#endif  // TINYGLTF_USE_RAPIDJSON_CRTALLOCATOR
+
+#elif defined(TINYGLTF_USE_SIMDJSON)
+// Read only JSON values of a simdjson DOM, read through simdjson's public
+// dom API. A `json` is a handle to an element of the document, so values are
+// read straight from the simdjson tape rather than copied. Iterators hold the
+// handle of their current value: a reference to it is valid until the
+// iterator moves. Strings and member names point into the simdjson document.
+// Models are always written with the direct JSON writer(JsonWriterValue).
+//
+// A `json` can also be a detached number(json(double)) or object of detached
+// members(JsonAddMember() on a JsonDocument), for JSON which is not parsed.
+struct JsonMember;
+
+struct json {
+  json() : number(0) {}
+  explicit json(simdjson::dom::element value)
+      : element(value), number(0), type(char(value.type())) {
+    if (type == 't' && !value.get_bool().value_unsafe()) {
+      type = 'f';
+    }
+  }
+  explicit json(double value) : number(value), type('d'), detached(true) {}
+
+  simdjson::dom::element element;
+  union {
+    double number;                           // Detached number
+    const std::vector<JsonMember> *members;  // Detached object
+  };
+  char type = 'n';  // simdjson::dom::element_type, 'f' for false
+  bool detached = false;
+};
+
+struct JsonMember {
+  std::string key;
+  json value;
+};
+
+inline char JsonType(const json &o) { return o.type; }
+
+template <typename T>
+T JsonNumberValue(const json &o) {
+  return o.detached ? T(o.number) : o.element.get<T>().value_unsafe();
+}
+
+inline const char *JsonStringData(const json &o, size_t *length) {
+  *length = o.element.get_string_length().value_unsafe();
+  return o.element.get_c_str().value_unsafe();
+}
+
+// Iterates the elements of an array.
+class json_const_array_iterator {
+ public:
+  json_const_array_iterator() {}
+  explicit json_const_array_iterator(simdjson::dom::array::iterator it)
+      : it_(it) {}
+  const json &operator*() const {
+    value_ = json(*it_);
+    return value_;
+  }
+  json_const_array_iterator &operator++() {
+    ++it_;
+    return *this;
+  }
+  bool operator==(const json_const_array_iterator &rhs) const {
+    return it_ == rhs.it_;
+  }
+  bool operator!=(const json_const_array_iterator &rhs) const {
+    return it_ != rhs.it_;
+  }
+
+ private:
+  simdjson::dom::array::iterator it_;
+  mutable json value_;
+};
+
+// Iterates the members of an object.
+class json_const_iterator {
+ public:
+  json_const_iterator() : member_(nullptr) {}
+  explicit json_const_iterator(simdjson::dom::object::iterator it)
+      : it_(it), member_(nullptr) {}
+  explicit json_const_iterator(const JsonMember *member) : member_(member) {}
+  const char *KeyData(size_t *length) const {
+    if (member_) {
+      *length = member_->key.size();
+      return member_->key.data();
+    }
+    *length = it_.key_length();
+    return it_.key_c_str();
+  }
+  const json &Value() const {
+    if (member_) {
+      return member_->value;
+    }
+    value_ = json(it_.value());
+    return value_;
+  }
+  json_const_iterator &operator++() {
+    if (member_) {
+      ++member_;
+    } else {
+      ++it_;
+    }
+    return *this;
+  }
+  bool operator==(const json_const_iterator &rhs) const {
+    return it_ == rhs.it_ && member_ == rhs.member_;
+  }
+  bool operator!=(const json_const_iterator &rhs) const {
+    return !(*this == rhs);
+  }
+
+ private:
+  simdjson::dom::object::iterator it_;
+  const JsonMember *member_;  // Of a detached object
+  mutable json value_;
+};
+
+struct JsonDocument {
+  // Root value. `null` until parsed successfully.
+  operator const json &() const { return root; }
+
+  // `root` refers to the document of `parser` or to `members`, which are
+  // allocated so that they stay in place when the JsonDocument is moved.
+  std::unique_ptr<simdjson::dom::parser> parser;
+  std::unique_ptr<std::vector<JsonMember>> members;
+  json root;
+};
+
+#elif defined(TINYGLTF_USE_ARENA)
+// Objects and arrays of the document are allocated from the current Arena.
+using json = nlohmann::basic_json<std::map, std::vector, std::string, bool,
+                                  std::int64_t, std::uint64_t, double,
+                                  tinygltf::ArenaAllocator>;
+using json_const_iterator = json::const_iterator;
+using json_const_array_iterator = json_const_iterator;
+using JsonDocument = json;
+#else
+using nlohmann::json;
+using json_const_iterator = json::const_iterator;
+using json_const_array_iterator = json_const_iterator;
+using JsonDocument = json;
+#endif
+
+// With `insitu_buffer`, `str` is copied into it and parsed in place when
+// supported: strings of `doc` then point into `insitu_buffer`, which must
+// outlive `doc`.
+void JsonParse(JsonDocument &doc, const char *str, size_t length,
+               bool throwExc = false,
+               std::vector<char> *insitu_buffer = nullptr) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  (void)throwExc;
+  if (insitu_buffer) {
+    insitu_buffer->assign(str, str + length);
+    insitu_buffer->push_back('\0');
+    doc.ParseInsitu(insitu_buffer->data());
+  } else {
+    doc.Parse(str, length);
+  }
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  static_assert(simdjson::SIMDJSON_VERSION_MAJOR >= 3,
+                "TINYGLTF_USE_SIMDJSON requires simdjson 3 or later");
+  (void)insitu_buffer;
+  // simdjson needs some padding after the input: `parse` copies `str` into
+  // the parser's own padded buffer.
+  doc.root = json();
+  doc.members.reset();
+  if (!doc.parser) {
+    doc.parser.reset(new simdjson::dom::parser());
+  }
+  simdjson::dom::element root;
+  const simdjson::error_code error = doc.parser->parse(str, length).get(root);
+  if (error == simdjson::SUCCESS) {
+    doc.root = json(root);
+  }
+#if (defined(__cpp_exceptions) || defined(__EXCEPTIONS) || \
+     defined(_CPPUNWIND)) &&                               \
+    !defined(TINYGLTF_NOEXCEPTION)
+  if (error != simdjson::SUCCESS && throwExc) {
+    throw std::runtime_error(simdjson::error_message(error));
+  }
+#else
+  (void)throwExc;
+#endif
+#else
+  (void)insitu_buffer;
+  doc = json::parse(str, str + length, nullptr, throwExc);
+#endif
+}
+
+#if !defined(TINYGLTF_USE_RAPIDJSON) && !defined(TINYGLTF_USE_SIMDJSON)
+///
+/// SAX handler for TinyGLTF::SetStreamingJsonParse(). Top level arrays with a
+/// registered callback are not stored: each element is built as a small DOM,
+/// passed to the callback and released. The arrays are left empty in `root`.
+/// All other top level members are stored in `root` as usual.
+///
+class StreamingJsonHandler {
+ public:
+  typedef std::function<bool(const json &)> ElementCallback;
+
+  StreamingJsonHandler(json *root,
+                       const std::map<std::string, ElementCallback> &sections)
+      : root_(root), sections_(sections) {
+    *root_ = json::object();
+  }
+
+  bool null() {
+    return OnValue(false, false, [](DomParser *p) { return p->null(); });
+  }
+  bool boolean(bool val) {
+    return OnValue(false, false,
+                   [val](DomParser *p) { return p->boolean(val); });
+  }
+  bool number_integer(json::number_integer_t val) {
+    return OnValue(false, false,
+                   [val](DomParser *p) { return p->number_integer(val); });
+  }
+  bool number_unsigned(json::number_unsigned_t val) {
+    return OnValue(false, false,
+                   [val](DomParser *p) { return p->number_unsigned(val); });
+  }
+  bool number_float(json::number_float_t val, const json::string_t &s) {
+    return OnValue(false, false, [val, &s](DomParser *p) {
+      return p->number_float(val, s);
+    });
+  }
+  bool string(json::string_t &val) {
+    return OnValue(false, false,
+                   [&val](DomParser *p) { return p->string(val); });
+  }
+  bool start_object(std::size_t len) {
+    return OnValue(true, false,
+                   [len](DomParser *p) { return p->start_object(len); });
+  }
+  bool start_array(std::size_t len) {
+    return OnValue(true, true,
+                   [len](DomParser *p) { return p->start_array(len); });
+  }
+  bool key(json::string_t &val) {
+    if (capture_) {
+      return capture_->key(val);
     }
+    key_ = val;
+    return true;
+  }
+  bool end_object() {
+    return OnEnd([](DomParser *p) { return p->end_object(); });
+  }
+  bool end_array() {
+    return OnEnd([](DomParser *p) { return p->end_array(); });
+  }
+  bool parse_error(std::size_t, const std::string &,
+                   const nlohmann::detail::exception &ex) {
+    error_ = ex.what();
+    return false;
   }
 
+  /// true when parsing stopped because an element callback failed.
+  bool CallbackFailed() const { return callback_failed_; }
+  const std::string &Error() const { return error_; }
+
  private:
-  bool isNil = false;
-};
+  typedef nlohmann::detail::json_sax_dom_parser<json> DomParser;
+
+  template <typename Fn>
+  bool OnValue(bool is_container, bool is_array, const Fn &fn) {
+    if (!capture_) {
+      if (depth_ == 0) {
+        if (!is_container || is_array) {
+          error_ = "Root element is not a JSON object\n";
+          return false;
+        }
+        depth_ = 1;
+        return true;
+      }
+      if ((depth_ == 1) && is_array) {
+        auto it = sections_.find(key_);
+        if (it != sections_.end()) {
+          section_ = &it->second;
+          (*root_)[key_] = json::array();
+          depth_ = 2;
+          return true;
+        }
+      }
+      // Start a new top level member or array element.
+      value_ = json();
+      capture_.reset(new DomParser(value_, false));
+      nesting_ = 0;
+    }
 
-#ifdef __clang__
-#pragma clang diagnostic pop
-#endif
+    if (!fn(capture_.get())) {
+      return false;
+    }
+    if (is_container) {
+      nesting_++;
+    }
+    return (nesting_ == 0) ? Finish() : true;
+  }
 
-#endif  // TINYGLTF_USE_RAPIDJSON_CRTALLOCATOR
+  template <typename Fn>
+  bool OnEnd(const Fn &fn) {
+    if (capture_) {
+      if (!fn(capture_.get())) {
+        return false;
+      }
+      nesting_--;
+      return (nesting_ == 0) ? Finish() : true;
+    }
+    // End of a streamed array or of the root object.
+    depth_--;
+    section_ = nullptr;
+    return true;
+  }
 
-#else
-using nlohmann::json;
-using json_const_iterator = json::const_iterator;
-using json_const_array_iterator = json_const_iterator;
-using JsonDocument = json;
-#endif
+  bool Finish() {
+    capture_.reset();
+    if (depth_ == 2) {
+      const bool ok = (*section_)(value_);
+      value_ = json();
+      if (!ok) {
+        callback_failed_ = true;
+        return false;
+      }
+      return true;
+    }
+    (*root_)[key_] = std::move(value_);
+    return true;
+  }
 
-void JsonParse(JsonDocument &doc, const char *str, size_t length,
-               bool throwExc = false) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  (void)throwExc;
-  doc.Parse(str, length);
-#else
-  doc = json::parse(str, str + length, nullptr, throwExc);
+  json *root_;
+  const std::map<std::string, ElementCallback> &sections_;
+  const ElementCallback *section_{nullptr};
+  std::unique_ptr<DomParser> capture_;
+  json value_;
+  std::string key_;
+  int depth_{0};    // 1: in the root object, 2: in a streamed array.
+  int nesting_{0};  // Nesting level inside the captured value.
+  bool callback_failed_{false};
+  std::string error_;
+};
 #endif
-}
 }  // namespace
 
 #ifdef __APPLE__
@@ -1715,18 +4270,123 @@ void JsonParse(JsonDocument &doc, const char *str, size_t length,
 
 namespace tinygltf {
 
+static inline int ResolveNumThreads(int num_threads) {
+#ifdef TINYGLTF_NO_THREADS
+  (void)num_threads;
+  return 1;
+#else
+  if (num_threads <= 0) {
+    num_threads = int(std::thread::hardware_concurrency());
+  }
+  return (std::max)(num_threads, 1);
+#endif
+}
+
 ///
-/// Internal LoadImageDataOption struct.
-/// This struct is passed through `user_pointer` in LoadImageData.
-/// The struct is not passed when the user supply their own LoadImageData
-/// callbacks.
+/// Calls `fn(i)` for each `i` in [0, count) using up to `num_threads` threads
+/// (including the calling thread). Items are handed out in increasing order
+/// through an atomic counter, so `fn` must be safe to call concurrently for
+/// different `i`.
+/// An exception thrown by `fn` stops handing out items and is rethrown on the
+/// calling thread after all threads are joined. When several items throw, the
+/// one with the lowest `i` is rethrown, as in the serial case.
 ///
-struct LoadImageDataOption {
-  // true: preserve image channels(e.g. load as RGB image if the image has RGB
-  // channels) default `false`(channels are expanded to RGBA for backward
-  // compatiblity).
-  bool preserve_channels{false};
-};
+template <typename Fn>
+static void ParallelFor(size_t count, int num_threads, const Fn &fn) {
+#ifndef TINYGLTF_NO_THREADS
+  const size_t num_workers = (std::min)(size_t(num_threads), count);
+  if (num_workers > 1) {
+    std::atomic<size_t> next(0);
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+    std::mutex exception_mutex;
+    std::exception_ptr exception;
+    size_t exception_index = count;
+    auto worker = [&]() {
+      for (size_t i = next++; i < count; i = next++) {
+        try {
+          fn(i);
+        } catch (...) {
+          next = count;
+          std::lock_guard<std::mutex> lock(exception_mutex);
+          if (i < exception_index) {
+            exception_index = i;
+            exception = std::current_exception();
+          }
+        }
+      }
+    };
+#else
+    auto worker = [&]() {
+      for (size_t i = next++; i < count; i = next++) {
+        fn(i);
+      }
+    };
+#endif
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_workers - 1);
+    for (size_t t = 0; t + 1 < num_workers; t++) {
+      threads.emplace_back(worker);
+    }
+    worker();
+    for (auto &th : threads) {
+      th.join();
+    }
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+    if (exception) {
+      std::rethrow_exception(exception);
+    }
+#endif
+    return;
+  }
+#else
+  (void)num_threads;
+#endif
+  for (size_t i = 0; i < count; i++) {
+    fn(i);
+  }
+}
+
+#ifdef TINYGLTF_USE_ARENA
+void *Arena::AllocateSlow(size_t size) {
+  const size_t n = kHeaderSize + RoundUp(size);
+  if (n > kMaxBlockSize / 4) {
+    // Large arrays(e.g. accessor bounds of a big mesh) would waste most of a
+    // block.
+    return AllocateHeap(size);
+  }
+
+  Retire();
+
+  const size_t header = RoundUp(sizeof(Block));
+  const size_t block_size = (std::max)(block_size_, header + n);
+  char *memory = static_cast<char *>(::operator new(block_size));
+  block_ = new (memory) Block();
+  next_ = memory + header;
+  end_ = memory + block_size;
+  num_blocks_++;
+  if (block_size_ < kMaxBlockSize) {
+    block_size_ *= 2;
+  }
+
+  return Allocate(size);
+}
+
+void Arena::Retire() {
+  if (block_) {
+    // Hand the allocations counted in `pending_` over to `refs`, and free the
+    // block if they were all freed already.
+    const size_t bias = kBias - pending_;
+    if (block_->refs.fetch_sub(bias) == bias) {
+      FreeBlock(block_);
+    }
+  }
+  block_ = nullptr;
+  next_ = nullptr;
+  end_ = nullptr;
+  pending_ = 0;
+}
+#endif
 
 // Equals function for Value, for recursivity
 static bool Equals(const tinygltf::Value &one, const tinygltf::Value &other) {
@@ -1741,9 +4401,11 @@ static bool Equals(const tinygltf::Value &one, const tinygltf::Value &other) {
       return TINYGLTF_DOUBLE_EQUAL(one.Get<double>(), other.Get<double>());
     case INT_TYPE:
       return one.Get<int>() == other.Get<int>();
+    case UINT_TYPE:
+      return one.Get<uint64_t>() == other.Get<uint64_t>();
     case OBJECT_TYPE: {
-      auto oneObj = one.Get<tinygltf::Value::Object>();
-      auto otherObj = other.Get<tinygltf::Value::Object>();
+      const auto &oneObj = one.Get<tinygltf::Value::Object>();
+      const auto &otherObj = other.Get<tinygltf::Value::Object>();
       if (oneObj.size() != otherObj.size()) return false;
       for (auto &it : oneObj) {
         auto otherIt = otherObj.find(it.first);
@@ -1772,8 +4434,9 @@ static bool Equals(const tinygltf::Value &one, const tinygltf::Value &other) {
 }
 
 // Equals function for std::vector<double> using TINYGLTF_DOUBLE_EPSILON
-static bool Equals(const std::vector<double> &one,
-                   const std::vector<double> &other) {
+template <typename A, typename B>
+static bool Equals(const std::vector<double, A> &one,
+                   const std::vector<double, B> &other) {
   if (one.size() != other.size()) return false;
   for (int i = 0; i < int(one.size()); ++i) {
     if (!TINYGLTF_DOUBLE_EQUAL(one[size_t(i)], other[size_t(i)])) return false;
@@ -1789,35 +4452,47 @@ bool Accessor::operator==(const Accessor &other) const {
          this->extras == other.extras &&
          Equals(this->maxValues, other.maxValues) &&
          Equals(this->minValues, other.minValues) && this->name == other.name &&
-         this->normalized == other.normalized && this->type == other.type;
+         this->normalized == other.normalized && this->type == other.type &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Animation::operator==(const Animation &other) const {
   return this->channels == other.channels &&
          this->extensions == other.extensions && this->extras == other.extras &&
-         this->name == other.name && this->samplers == other.samplers;
+         this->name == other.name && this->samplers == other.samplers &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool AnimationChannel::operator==(const AnimationChannel &other) const {
   return this->extensions == other.extensions && this->extras == other.extras &&
          this->target_node == other.target_node &&
          this->target_path == other.target_path &&
-         this->sampler == other.sampler;
+         this->sampler == other.sampler &&
+         this->lazy_extras == other.lazy_extras &&
+         this->target_lazy_extras == other.target_lazy_extras;
 }
 bool AnimationSampler::operator==(const AnimationSampler &other) const {
   return this->extras == other.extras && this->extensions == other.extensions &&
          this->input == other.input &&
          this->interpolation == other.interpolation &&
-         this->output == other.output;
+         this->output == other.output &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Asset::operator==(const Asset &other) const {
   return this->copyright == other.copyright &&
          this->extensions == other.extensions && this->extras == other.extras &&
          this->generator == other.generator &&
-         this->minVersion == other.minVersion && this->version == other.version;
+         this->minVersion == other.minVersion &&
+         this->version == other.version &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Buffer::operator==(const Buffer &other) const {
-  return this->data == other.data && this->extensions == other.extensions &&
+  if (this->DataSize() != other.DataSize()) return false;
+  if (this->DataSize() &&
+      memcmp(this->DataPtr(), other.DataPtr(), this->DataSize()) != 0) {
+    return false;
+  }
+  return this->extensions == other.extensions &&
          this->extras == other.extras && this->name == other.name &&
-         this->uri == other.uri;
+         this->uri == other.uri && this->lazy_extras == other.lazy_extras;
 }
 bool BufferView::operator==(const BufferView &other) const {
   return this->buffer == other.buffer && this->byteLength == other.byteLength &&
@@ -1825,13 +4500,15 @@ bool BufferView::operator==(const BufferView &other) const {
          this->byteStride == other.byteStride && this->name == other.name &&
          this->target == other.target && this->extensions == other.extensions &&
          this->extras == other.extras &&
-         this->dracoDecoded == other.dracoDecoded;
+         this->dracoDecoded == other.dracoDecoded &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Camera::operator==(const Camera &other) const {
   return this->name == other.name && this->extensions == other.extensions &&
          this->extras == other.extras &&
          this->orthographic == other.orthographic &&
-         this->perspective == other.perspective && this->type == other.type;
+         this->perspective == other.perspective && this->type == other.type &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Image::operator==(const Image &other) const {
   return this->bufferView == other.bufferView &&
@@ -1839,7 +4516,8 @@ bool Image::operator==(const Image &other) const {
          this->extensions == other.extensions && this->extras == other.extras &&
          this->height == other.height && this->image == other.image &&
          this->mimeType == other.mimeType && this->name == other.name &&
-         this->uri == other.uri && this->width == other.width;
+         this->uri == other.uri && this->width == other.width &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Light::operator==(const Light &other) const {
   return Equals(this->color, other.color) && this->name == other.name &&
@@ -1857,12 +4535,14 @@ bool Material::operator==(const Material &other) const {
          (this->extensions == other.extensions) &&
          (this->extras == other.extras) && (this->values == other.values) &&
          (this->additionalValues == other.additionalValues) &&
-         (this->name == other.name);
+         (this->name == other.name) &&
+         (this->lazy_extras == other.lazy_extras);
 }
 bool Mesh::operator==(const Mesh &other) const {
   return this->extensions == other.extensions && this->extras == other.extras &&
          this->name == other.name && Equals(this->weights, other.weights) &&
-         this->primitives == other.primitives;
+         this->primitives == other.primitives &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Model::operator==(const Model &other) const {
   return this->accessors == other.accessors &&
@@ -1878,7 +4558,8 @@ bool Model::operator==(const Model &other) const {
          this->lights == other.lights && this->materials == other.materials &&
          this->meshes == other.meshes && this->nodes == other.nodes &&
          this->samplers == other.samplers && this->scenes == other.scenes &&
-         this->skins == other.skins && this->textures == other.textures;
+         this->skins == other.skins && this->textures == other.textures &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Node::operator==(const Node &other) const {
   return this->camera == other.camera && this->children == other.children &&
@@ -1887,19 +4568,22 @@ bool Node::operator==(const Node &other) const {
          this->name == other.name && Equals(this->rotation, other.rotation) &&
          Equals(this->scale, other.scale) && this->skin == other.skin &&
          Equals(this->translation, other.translation) &&
-         Equals(this->weights, other.weights);
+         Equals(this->weights, other.weights) &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool SpotLight::operator==(const SpotLight &other) const {
   return this->extensions == other.extensions && this->extras == other.extras &&
          TINYGLTF_DOUBLE_EQUAL(this->innerConeAngle, other.innerConeAngle) &&
-         TINYGLTF_DOUBLE_EQUAL(this->outerConeAngle, other.outerConeAngle);
+         TINYGLTF_DOUBLE_EQUAL(this->outerConeAngle, other.outerConeAngle) &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool OrthographicCamera::operator==(const OrthographicCamera &other) const {
   return this->extensions == other.extensions && this->extras == other.extras &&
          TINYGLTF_DOUBLE_EQUAL(this->xmag, other.xmag) &&
          TINYGLTF_DOUBLE_EQUAL(this->ymag, other.ymag) &&
          TINYGLTF_DOUBLE_EQUAL(this->zfar, other.zfar) &&
-         TINYGLTF_DOUBLE_EQUAL(this->znear, other.znear);
+         TINYGLTF_DOUBLE_EQUAL(this->znear, other.znear) &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Parameter::operator==(const Parameter &other) const {
   if (this->bool_value != other.bool_value ||
@@ -1929,49 +4613,58 @@ bool PerspectiveCamera::operator==(const PerspectiveCamera &other) const {
          this->extensions == other.extensions && this->extras == other.extras &&
          TINYGLTF_DOUBLE_EQUAL(this->yfov, other.yfov) &&
          TINYGLTF_DOUBLE_EQUAL(this->zfar, other.zfar) &&
-         TINYGLTF_DOUBLE_EQUAL(this->znear, other.znear);
+         TINYGLTF_DOUBLE_EQUAL(this->znear, other.znear) &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Primitive::operator==(const Primitive &other) const {
   return this->attributes == other.attributes && this->extras == other.extras &&
          this->indices == other.indices && this->material == other.material &&
-         this->mode == other.mode && this->targets == other.targets;
+         this->mode == other.mode && this->targets == other.targets &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Sampler::operator==(const Sampler &other) const {
   return this->extensions == other.extensions && this->extras == other.extras &&
          this->magFilter == other.magFilter &&
          this->minFilter == other.minFilter && this->name == other.name &&
-         this->wrapT == other.wrapT;
+         this->wrapT == other.wrapT &&
+         this->lazy_extras == other.lazy_extras;
 
          //this->wrapR == other.wrapR && this->wrapS == other.wrapS &&
 }
 bool Scene::operator==(const Scene &other) const {
   return this->extensions == other.extensions && this->extras == other.extras &&
-         this->name == other.name && this->nodes == other.nodes;
+         this->name == other.name && this->nodes == other.nodes &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Skin::operator==(const Skin &other) const {
   return this->extensions == other.extensions && this->extras == other.extras &&
          this->inverseBindMatrices == other.inverseBindMatrices &&
          this->joints == other.joints && this->name == other.name &&
-         this->skeleton == other.skeleton;
+         this->skeleton == other.skeleton &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Texture::operator==(const Texture &other) const {
   return this->extensions == other.extensions && this->extras == other.extras &&
          this->name == other.name && this->sampler == other.sampler &&
-         this->source == other.source;
+         this->source == other.source &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool TextureInfo::operator==(const TextureInfo &other) const {
   return this->extensions == other.extensions && this->extras == other.extras &&
-         this->index == other.index && this->texCoord == other.texCoord;
+         this->index == other.index && this->texCoord == other.texCoord &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool NormalTextureInfo::operator==(const NormalTextureInfo &other) const {
   return this->extensions == other.extensions && this->extras == other.extras &&
          this->index == other.index && this->texCoord == other.texCoord &&
-         TINYGLTF_DOUBLE_EQUAL(this->scale, other.scale);
+         TINYGLTF_DOUBLE_EQUAL(this->scale, other.scale) &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool OcclusionTextureInfo::operator==(const OcclusionTextureInfo &other) const {
   return this->extensions == other.extensions && this->extras == other.extras &&
          this->index == other.index && this->texCoord == other.texCoord &&
-         TINYGLTF_DOUBLE_EQUAL(this->strength, other.strength);
+         TINYGLTF_DOUBLE_EQUAL(this->strength, other.strength) &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool PbrMetallicRoughness::operator==(const PbrMetallicRoughness &other) const {
   return this->extensions == other.extensions && this->extras == other.extras &&
@@ -1979,7 +4672,8 @@ bool PbrMetallicRoughness::operator==(const PbrMetallicRoughness &other) const {
          (this->metallicRoughnessTexture == other.metallicRoughnessTexture) &&
          Equals(this->baseColorFactor, other.baseColorFactor) &&
          TINYGLTF_DOUBLE_EQUAL(this->metallicFactor, other.metallicFactor) &&
-         TINYGLTF_DOUBLE_EQUAL(this->roughnessFactor, other.roughnessFactor);
+         TINYGLTF_DOUBLE_EQUAL(this->roughnessFactor, other.roughnessFactor) &&
+         this->lazy_extras == other.lazy_extras;
 }
 bool Value::operator==(const Value &other) const {
   return Equals(*this, other);
@@ -2051,9 +4745,18 @@ static std::string GetBaseFilename(const std::string &filepath) {
   return filepath.substr(filepath.find_last_of("/\\") + 1);
 }
 
-std::string base64_encode(unsigned char const *, unsigned int len);
+std::string base64_encode(unsigned char const *, size_t len);
 std::string base64_decode(std::string const &s);
 
+// Appends the base64 encoding of `bytes_to_encode` to `out`.
+void base64_encode(unsigned char const *bytes_to_encode, size_t in_len,
+                   std::string *out);
+
+// Appends decoded bytes to `out`. Decoding stops at padding('=') or at the
+// first non base64 character. Returns the number of decoded bytes.
+size_t base64_decode(const char *encoded, size_t in_len,
+                     std::vector<unsigned char> *out);
+
 /*
    base64.cpp and base64.h
 
@@ -2087,104 +4790,372 @@ std::string base64_decode(std::string const &s);
 #pragma clang diagnostic ignored "-Wconversion"
 #endif
 
-static inline bool is_base64(unsigned char c) {
-  return (isalnum(c) || (c == '+') || (c == '/'));
-}
+static const char kBase64Chars[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+    "abcdefghijklmnopqrstuvwxyz"
+    "0123456789+/";
+
+// 6bit value of a base64 character. 0xff for padding and any other character.
+static const unsigned char kBase64DecodeTable[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b,
+    0x3c, 0x3d, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e,
+    0x0f, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16,
+    0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20,
+    0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+    0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
 
-std::string base64_encode(unsigned char const *bytes_to_encode,
-                          unsigned int in_len) {
-  std::string ret;
-  int i = 0;
-  int j = 0;
-  unsigned char char_array_3[3];
-  unsigned char char_array_4[4];
+#if defined(TINYGLTF_HAS_SSSE3) || defined(TINYGLTF_HAS_AVX2)
+#ifdef TINYGLTF_SIMD_DISPATCH
+enum { kCpuSsse3 = 0x1, kCpuAvx2 = 0x2 };
+
+static int DetectCpuFeatures() {
+  unsigned int regs[4] = {0, 0, 0, 0};  // eax, ebx, ecx, edx
+  unsigned int max_leaf = 0;
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  max_leaf = unsigned(info[0]);
+  __cpuid(info, 1);
+  for (int k = 0; k < 4; k++) regs[k] = unsigned(info[k]);
+#else
+  max_leaf = __get_cpuid_max(0, nullptr);
+  if (max_leaf < 1) {
+    return 0;
+  }
+  __cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+  int features = 0;
+  if (regs[2] & (1u << 9)) {
+    features |= kCpuSsse3;
+  }
 
-  const char *base64_chars =
-      "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-      "abcdefghijklmnopqrstuvwxyz"
-      "0123456789+/";
+  // AVX2 also needs the OS to save the ymm registers(OSXSAVE, XCR0).
+  const unsigned int osxsave_avx = (1u << 27) | (1u << 28);
+  if ((max_leaf < 7) || ((regs[2] & osxsave_avx) != osxsave_avx)) {
+    return features;
+  }
+#ifdef _MSC_VER
+  const unsigned long long xcr0 = _xgetbv(0);
+  __cpuidex(info, 7, 0);
+  const unsigned int leaf7_ebx = unsigned(info[1]);
+#else
+  unsigned int xcr0_lo = 0;
+  unsigned int xcr0_hi = 0;
+  __asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+  const unsigned long long xcr0 = xcr0_lo;
+  __cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+  const unsigned int leaf7_ebx = regs[1];
+#endif
+  if (((xcr0 & 0x6) == 0x6) && (leaf7_ebx & (1u << 5))) {
+    features |= kCpuAvx2;
+  }
+  return features;
+}
 
-  while (in_len--) {
-    char_array_3[i++] = *(bytes_to_encode++);
-    if (i == 3) {
-      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-      char_array_4[1] =
-          ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-      char_array_4[2] =
-          ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-      char_array_4[3] = char_array_3[2] & 0x3f;
+static int CpuFeatures() {
+  static const int features = DetectCpuFeatures();
+  return features;
+}
 
-      for (i = 0; (i < 4); i++) ret += base64_chars[char_array_4[i]];
-      i = 0;
-    }
+static inline bool CpuHasSsse3() { return (CpuFeatures() & kCpuSsse3) != 0; }
+static inline bool CpuHasAvx2() { return (CpuFeatures() & kCpuAvx2) != 0; }
+#else
+static inline bool CpuHasSsse3() { return true; }
+static inline bool CpuHasAvx2() { return true; }
+#endif
+#endif
+
+#ifdef TINYGLTF_HAS_SSSE3
+// Encodes the first 12 bytes of `in` into 16 characters.
+// http://0x80.pl/notesen/2016-01-12-sse-base64-encoding.html
+TINYGLTF_TARGET_SSSE3 static inline __m128i base64_encode_ssse3(__m128i in) {
+  in = _mm_shuffle_epi8(
+      in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+
+  // Split each 24bit group into four 6bit indices.
+  const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  const __m128i indices = _mm_or_si128(t1, t3);
+
+  // Map each index range([A-Z], [a-z], [0-9], '+', '/') to its ASCII offset.
+  __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  range = _mm_or_si128(range, _mm_and_si128(less, _mm_set1_epi8(13)));
+  const __m128i offsets = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+}
+
+// Decodes 16 characters into the first 12 bytes of `*v`.
+// Returns false when the block contains a non base64 character.
+// http://0x80.pl/notesen/2016-01-17-sse-base64-decoding.html
+TINYGLTF_TARGET_SSSE3 static inline bool base64_decode_ssse3(__m128i *v) {
+  const __m128i lut_lo =
+      _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                    0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m128i lut_hi =
+      _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10,
+                    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m128i lut_roll =
+      _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+
+  const __m128i in = *v;
+  const __m128i hi_nibbles =
+      _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+  const __m128i lo_nibbles = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+  const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+  const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+  if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi),
+                                       _mm_setzero_si128())) != 0xffff) {
+    return false;
   }
 
-  if (i) {
-    for (j = i; j < 3; j++) char_array_3[j] = '\0';
+  const __m128i eq_2f = _mm_cmpeq_epi8(in, _mm_set1_epi8(0x2f));
+  const __m128i roll =
+      _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+  const __m128i values = _mm_add_epi8(in, roll);
 
-    char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-    char_array_4[1] =
-        ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-    char_array_4[2] =
-        ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
+  // Pack four 6bit values into 24bits.
+  const __m128i merged =
+      _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  const __m128i packed = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+  *v = _mm_shuffle_epi8(packed, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14,
+                                              13, 12, -1, -1, -1, -1));
+  return true;
+}
+
+// Encodes 12 byte groups of `src` from `*i` while 16 bytes can be loaded.
+// Advances `*i` and `*dst`.
+TINYGLTF_TARGET_SSSE3 static void base64_encode_blocks_ssse3(
+    const unsigned char *src, size_t in_len, size_t *i, char **dst) {
+  for (; *i + 16 <= in_len; *i += 12) {
+    const __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + *i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(*dst),
+                     base64_encode_ssse3(in));
+    *dst += 16;
+  }
+}
 
-    for (j = 0; (j < i + 1); j++) ret += base64_chars[char_array_4[j]];
+// Decodes 16 character blocks of `src` from `*i` while the 16 byte stores
+// stay inside the output. Stops at the first block with a non base64
+// character. Advances `*i` and `*dst`.
+TINYGLTF_TARGET_SSSE3 static void base64_decode_blocks_ssse3(
+    const unsigned char *src, size_t in_len, size_t *i, unsigned char **dst) {
+  for (; *i + 24 <= in_len; *i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + *i));
+    if (!base64_decode_ssse3(&v)) {
+      break;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(*dst), v);
+    *dst += 12;
+  }
+}
+#endif
 
-    while ((i++ < 3)) ret += '=';
+#ifdef TINYGLTF_HAS_AVX2
+// AVX2 version of base64_decode_ssse3(). Decodes 32 characters into the first
+// 24 bytes of `*v`.
+TINYGLTF_TARGET_AVX2 static inline bool base64_decode_avx2(__m256i *v) {
+  const __m256i lut_lo = _mm256_setr_epi8(
+      0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1a,
+      0x1b, 0x1b, 0x1b, 0x1a, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+      0x11, 0x11, 0x13, 0x1a, 0x1b, 0x1b, 0x1b, 0x1a);
+  const __m256i lut_hi = _mm256_setr_epi8(
+      0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+      0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+  const __m256i lut_roll = _mm256_setr_epi8(
+      0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4,
+      -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+
+  const __m256i in = *v;
+  const __m256i hi_nibbles =
+      _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0f));
+  const __m256i lo_nibbles = _mm256_and_si256(in, _mm256_set1_epi8(0x0f));
+  const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+  const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+  if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+          _mm256_and_si256(lo, hi), _mm256_setzero_si256())) != -1) {
+    return false;
   }
 
-  return ret;
+  const __m256i eq_2f = _mm256_cmpeq_epi8(in, _mm256_set1_epi8(0x2f));
+  const __m256i roll =
+      _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+  const __m256i values = _mm256_add_epi8(in, roll);
+
+  const __m256i merged =
+      _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+  const __m256i packed =
+      _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+  const __m256i shuffled = _mm256_shuffle_epi8(
+      packed, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1,
+                               -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                               -1, -1, -1, -1));
+  // Join the 12 bytes of each 128bit lane.
+  *v = _mm256_permutevar8x32_epi32(shuffled,
+                                   _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+  return true;
 }
 
-std::string base64_decode(std::string const &encoded_string) {
-  int in_len = static_cast<int>(encoded_string.size());
-  int i = 0;
-  int j = 0;
-  int in_ = 0;
-  unsigned char char_array_4[4], char_array_3[3];
-  std::string ret;
+// AVX2 version of base64_decode_blocks_ssse3() for 32 character blocks.
+TINYGLTF_TARGET_AVX2 static void base64_decode_blocks_avx2(
+    const unsigned char *src, size_t in_len, size_t *i, unsigned char **dst) {
+  for (; *i + 44 <= in_len; *i += 32) {
+    __m256i v =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + *i));
+    if (!base64_decode_avx2(&v)) {
+      break;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(*dst), v);
+    *dst += 24;
+  }
+}
+#endif
 
-  const std::string base64_chars =
-      "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-      "abcdefghijklmnopqrstuvwxyz"
-      "0123456789+/";
+void base64_encode(unsigned char const *bytes_to_encode, size_t in_len,
+                   std::string *out) {
+  const size_t offset = out->size();
+  out->resize(offset + ((in_len + 2) / 3) * 4);
+  if (in_len == 0) {
+    return;
+  }
+
+  char *dst = &(*out)[offset];
+  const unsigned char *src = bytes_to_encode;
+  size_t i = 0;
 
-  while (in_len-- && (encoded_string[in_] != '=') &&
-         is_base64(encoded_string[in_])) {
-    char_array_4[i++] = encoded_string[in_];
-    in_++;
-    if (i == 4) {
-      for (i = 0; i < 4; i++)
-        char_array_4[i] =
-            static_cast<unsigned char>(base64_chars.find(char_array_4[i]));
+#ifdef TINYGLTF_HAS_SSSE3
+  if (CpuHasSsse3()) {
+    base64_encode_blocks_ssse3(src, in_len, &i, &dst);
+  }
+#endif
 
-      char_array_3[0] =
-          (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-      char_array_3[1] =
-          ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-      char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+  for (; i + 3 <= in_len; i += 3) {
+    const uint32_t v = (uint32_t(src[i]) << 16) |
+                       (uint32_t(src[i + 1]) << 8) | uint32_t(src[i + 2]);
+    dst[0] = kBase64Chars[(v >> 18) & 0x3f];
+    dst[1] = kBase64Chars[(v >> 12) & 0x3f];
+    dst[2] = kBase64Chars[(v >> 6) & 0x3f];
+    dst[3] = kBase64Chars[v & 0x3f];
+    dst += 4;
+  }
 
-      for (i = 0; (i < 3); i++) ret += char_array_3[i];
-      i = 0;
+  if (i < in_len) {
+    uint32_t v = uint32_t(src[i]) << 16;
+    if (i + 1 < in_len) {
+      v |= uint32_t(src[i + 1]) << 8;
     }
+    dst[0] = kBase64Chars[(v >> 18) & 0x3f];
+    dst[1] = kBase64Chars[(v >> 12) & 0x3f];
+    dst[2] = (i + 1 < in_len) ? kBase64Chars[(v >> 6) & 0x3f] : '=';
+    dst[3] = '=';
   }
+}
+
+std::string base64_encode(unsigned char const *bytes_to_encode,
+                          size_t in_len) {
+  std::string ret;
+  base64_encode(bytes_to_encode, in_len, &ret);
+  return ret;
+}
+
+size_t base64_decode(const char *encoded, size_t in_len,
+                     std::vector<unsigned char> *out) {
+  const size_t offset = out->size();
+  // 3 bytes per 4 characters, up to 2 bytes for a trailing partial group.
+  out->resize(offset + (in_len / 4) * 3 + 2);
 
-  if (i) {
-    for (j = i; j < 4; j++) char_array_4[j] = 0;
+  const unsigned char *src = reinterpret_cast<const unsigned char *>(encoded);
+  unsigned char *begin = out->data() + offset;
+  unsigned char *dst = begin;
+  size_t i = 0;
 
-    for (j = 0; j < 4; j++)
-      char_array_4[j] =
-          static_cast<unsigned char>(base64_chars.find(char_array_4[j]));
+  // SIMD stores are wider than the decoded bytes. Stop early enough for
+  // them to stay inside the output.
+#ifdef TINYGLTF_HAS_AVX2
+  if (CpuHasAvx2()) {
+    base64_decode_blocks_avx2(src, in_len, &i, &dst);
+  }
+#endif
+#ifdef TINYGLTF_HAS_SSSE3
+  if (CpuHasSsse3()) {
+    base64_decode_blocks_ssse3(src, in_len, &i, &dst);
+  }
+#endif
 
-    char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-    char_array_3[1] =
-        ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-    char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+  for (; i + 4 <= in_len; i += 4) {
+    const uint32_t a = kBase64DecodeTable[src[i]];
+    const uint32_t b = kBase64DecodeTable[src[i + 1]];
+    const uint32_t c = kBase64DecodeTable[src[i + 2]];
+    const uint32_t d = kBase64DecodeTable[src[i + 3]];
+    if ((a | b | c | d) & 0x80) {
+      break;
+    }
+    const uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+    dst[0] = static_cast<unsigned char>(v >> 16);
+    dst[1] = static_cast<unsigned char>((v >> 8) & 0xff);
+    dst[2] = static_cast<unsigned char>(v & 0xff);
+    dst += 3;
+  }
 
-    for (j = 0; (j < i - 1); j++) ret += char_array_3[j];
+  // Partial group before padding, a non base64 character or the end.
+  uint32_t v = 0;
+  int n = 0;
+  for (; (i < in_len) && (n < 3); i++, n++) {
+    const uint32_t c = kBase64DecodeTable[src[i]];
+    if (c & 0x80) {
+      break;
+    }
+    v |= c << (18 - 6 * n);
+  }
+  if (n >= 2) {
+    *dst++ = static_cast<unsigned char>(v >> 16);
+  }
+  if (n >= 3) {
+    *dst++ = static_cast<unsigned char>((v >> 8) & 0xff);
   }
 
-  return ret;
+  const size_t len = size_t(dst - begin);
+  out->resize(offset + len);
+  return len;
+}
+
+std::string base64_decode(std::string const &encoded_string) {
+  std::vector<unsigned char> data;
+  base64_decode(encoded_string.data(), encoded_string.size(), &data);
+  return std::string(data.begin(), data.end());
 }
 #ifdef __clang__
 #pragma clang diagnostic pop
@@ -2340,6 +5311,59 @@ static bool LoadExternalFile(std::vector<unsigned char> *out, std::string *err,
   return true;
 }
 
+static bool MapExternalFile(MappedFile *out, std::string *err,
+                            const std::string &filename,
+                            const std::string &basedir, size_t reqBytes,
+                            bool checkSize, FsCallbacks *fs) {
+  if (fs == nullptr || fs->FileExists == nullptr ||
+      fs->ExpandFilePath == nullptr || fs->MapWholeFile == nullptr) {
+    // This is a developer error, assert() ?
+    if (err) {
+      (*err) += "FS callback[s] not set\n";
+    }
+    return false;
+  }
+
+  std::vector<std::string> paths;
+  paths.push_back(basedir);
+  paths.push_back(".");
+
+  std::string filepath = FindFile(paths, filename, fs);
+  if (filepath.empty() || filename.empty()) {
+    if (err) {
+      (*err) += "File not found : " + filename + "\n";
+    }
+    return false;
+  }
+
+  std::string fileMapErr;
+  if (!fs->MapWholeFile(out, &fileMapErr, filepath, fs->user_data)) {
+    if (err) {
+      (*err) += "File map error : " + filepath + " : " + fileMapErr + "\n";
+    }
+    return false;
+  }
+
+  if (out->size == 0) {
+    if (err) {
+      (*err) += "File is empty : " + filepath + "\n";
+    }
+    return false;
+  }
+
+  if (checkSize && (reqBytes != out->size)) {
+    std::stringstream ss;
+    ss << "File size mismatch : " << filepath << ", requestedBytes "
+       << reqBytes << ", but got " << out->size << std::endl;
+    if (err) {
+      (*err) += ss.str();
+    }
+    return false;
+  }
+
+  return true;
+}
+
 void TinyGLTF::SetImageLoader(LoadImageDataFunction func, void *user_data) {
   LoadImageData = func;
   load_image_user_data_ = user_data;
@@ -2448,29 +5472,137 @@ bool LoadImageData(Image *image, const int image_idx, std::string *err,
     }
   }
 
-  if (req_comp != 0) {
-    // loaded data has `req_comp` channels(components)
-    comp = req_comp;
+  if (req_comp != 0) {
+    // loaded data has `req_comp` channels(components)
+    comp = req_comp;
+  }
+
+  image->width = w;
+  image->height = h;
+  image->component = comp;
+  image->bits = bits;
+  image->pixel_type = pixel_type;
+  image->image.resize(static_cast<size_t>(w * h * comp) * size_t(bits / 8));
+  std::copy(data, data + w * h * comp * (bits / 8), image->image.begin());
+  stbi_image_free(data);
+
+  return true;
+}
+#endif
+
+bool Image::Decode(const Model &model, std::string *err, std::string *warn,
+                   LoadImageDataFunction load_image_data, void *user_data) {
+  if (!as_is) {
+    return true;
+  }
+
+  if (load_image_data == nullptr) {
+#ifndef TINYGLTF_NO_STB_IMAGE
+    load_image_data = &tinygltf::LoadImageData;
+#else
+    if (err) {
+      (*err) += "No LoadImageData callback specified.\n";
+    }
+    return false;
+#endif
+  }
+
+  // Index is only used for messages.
+  int image_idx = -1;
+  if (!model.images.empty() && (this >= model.images.data()) &&
+      (this < model.images.data() + model.images.size())) {
+    image_idx = int(this - model.images.data());
+  }
+
+  std::vector<unsigned char> encoded;
+  const unsigned char *bytes = nullptr;
+  size_t size = 0;
+  int req_width = 0;
+  int req_height = 0;
+
+  if (bufferView != -1) {
+    if ((bufferView < 0) || (size_t(bufferView) >= model.bufferViews.size())) {
+      if (err) {
+        std::stringstream ss;
+        ss << "image[" << image_idx << "] bufferView \"" << bufferView
+           << "\" not found in the scene." << std::endl;
+        (*err) += ss.str();
+      }
+      return false;
+    }
+    const BufferView &view = model.bufferViews[size_t(bufferView)];
+    if ((view.buffer < 0) || (size_t(view.buffer) >= model.buffers.size()) ||
+        (view.byteOffset + view.byteLength >
+         model.buffers[size_t(view.buffer)].DataSize())) {
+      if (err) {
+        std::stringstream ss;
+        ss << "image[" << image_idx << "] bufferView \"" << bufferView
+           << "\" does not reference valid buffer data." << std::endl;
+        (*err) += ss.str();
+      }
+      return false;
+    }
+    bytes = model.buffers[size_t(view.buffer)].DataPtr() + view.byteOffset;
+    size = view.byteLength;
+    req_width = width;
+    req_height = height;
+  } else {
+    encoded.swap(image);
+    bytes = encoded.data();
+    size = encoded.size();
+  }
+
+  if (size == 0) {
+    if (err) {
+      (*err) += "Image data is empty for image[" + std::to_string(image_idx) +
+                "] name = [" + name + "]\n";
+    }
+    image.swap(encoded);
+    return false;
+  }
+
+  // LoadImageDataFunction takes the data size as an int.
+  if (size > size_t((std::numeric_limits<int>::max)())) {
+    if (err) {
+      (*err) += "image[" + std::to_string(image_idx) +
+                "] data is too large to decode(" + std::to_string(size) +
+                " bytes).\n";
+    }
+    image.swap(encoded);
+    return false;
   }
 
-  image->width = w;
-  image->height = h;
-  image->component = comp;
-  image->bits = bits;
-  image->pixel_type = pixel_type;
-  image->image.resize(static_cast<size_t>(w * h * comp) * size_t(bits / 8));
-  std::copy(data, data + w * h * comp * (bits / 8), image->image.begin());
-  stbi_image_free(data);
+  as_is = false;
+  if (!load_image_data(this, image_idx, err, warn, req_width, req_height,
+                       bytes, static_cast<int>(size), user_data)) {
+    // Keep the image as-is.
+    as_is = true;
+    image.swap(encoded);
+    return false;
+  }
 
   return true;
 }
-#endif
 
 void TinyGLTF::SetImageWriter(WriteImageDataFunction func, void *user_data) {
   WriteImageData = func;
   write_image_user_data_ = user_data;
 }
 
+static std::string ExtToMime(const std::string &ext) {
+  if (ext == "jpg" || ext == "jpeg") {
+    return "image/jpeg";
+  } else if (ext == "png") {
+    return "image/png";
+  } else if (ext == "bmp") {
+    return "image/bmp";
+  } else if (ext == "gif") {
+    return "image/gif";
+  }
+
+  return "";
+}
+
 #ifndef TINYGLTF_NO_STB_IMAGE_WRITE
 static void WriteToMemory_stbi(void *context, void *data, int size) {
   std::vector<unsigned char> *buffer =
@@ -2489,7 +5621,17 @@ bool WriteImageData(const std::string *basepath, const std::string *filename,
   std::string header;
   std::vector<unsigned char> data;
 
-  if (ext == "png") {
+  if (image->as_is) {
+    // `image` already holds encoded data(e.g. loaded with
+    // `SetDeferImageDecoding(true)`). Write it without re-encoding.
+    const std::string mime_type =
+        image->mimeType.empty() ? ExtToMime(ext) : image->mimeType;
+    if (image->image.empty() || mime_type.empty()) {
+      return false;
+    }
+    data = image->image;
+    header = "data:" + mime_type + ";base64,";
+  } else if (ext == "png") {
     if ((image->bits != 8) ||
         (image->pixel_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)) {
       // Unsupported pixel format
@@ -2524,9 +5666,8 @@ bool WriteImageData(const std::string *basepath, const std::string *filename,
   if (embedImages) {
     // Embed base64-encoded image into URI
     if (data.size()) {
-      image->uri =
-          header +
-          base64_encode(&data[0], static_cast<unsigned int>(data.size()));
+      image->uri = header;
+      base64_encode(data.data(), data.size(), &image->uri);
     } else {
       // Throw error?
     }
@@ -2786,6 +5927,106 @@ bool WriteWholeFile(std::string *err, const std::string &filepath,
   return true;
 }
 
+bool MapWholeFile(MappedFile *out, std::string *err,
+                  const std::string &filepath, void *user_data) {
+#ifdef TINYGLTF_ANDROID_LOAD_FROM_ASSETS
+  // Assets can't be mapped. Read them into memory owned by `out`.
+  std::shared_ptr<std::vector<unsigned char> > buf =
+      std::make_shared<std::vector<unsigned char> >();
+  if (!ReadWholeFile(buf.get(), err, filepath, user_data)) {
+    return false;
+  }
+  out->data = buf->data();
+  out->size = buf->size();
+  out->owner = buf;
+  return true;
+#elif defined(_WIN32)
+  (void)user_data;
+  HANDLE file = CreateFileW(UTF8ToWchar(filepath).c_str(), GENERIC_READ,
+                            FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    if (err) {
+      (*err) += "File open error : " + filepath + "\n";
+    }
+    return false;
+  }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size) || (file_size.QuadPart <= 0)) {
+    CloseHandle(file);
+    if (err) {
+      (*err) += "File is empty : " + filepath + "\n";
+    }
+    return false;
+  }
+
+  HANDLE mapping =
+      CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    if (err) {
+      (*err) += "File mapping error : " + filepath + "\n";
+    }
+    return false;
+  }
+
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);  // The view keeps the mapping alive.
+  if (view == nullptr) {
+    if (err) {
+      (*err) += "File mapping error : " + filepath + "\n";
+    }
+    return false;
+  }
+
+  out->data = reinterpret_cast<const unsigned char *>(view);
+  out->size = static_cast<size_t>(file_size.QuadPart);
+  out->owner = std::shared_ptr<void>(view, [](void *p) { UnmapViewOfFile(p); });
+  return true;
+#else
+  (void)user_data;
+  int fd = open(filepath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    if (err) {
+      (*err) += "File open error : " + filepath + "\n";
+    }
+    return false;
+  }
+
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || !S_ISREG(st.st_mode)) {
+    close(fd);
+    if (err) {
+      (*err) += "Invalid file : " + filepath +
+                " (does the path point to a directory?)\n";
+    }
+    return false;
+  } else if (st.st_size <= 0) {
+    close(fd);
+    if (err) {
+      (*err) += "File is empty : " + filepath + "\n";
+    }
+    return false;
+  }
+
+  const size_t sz = static_cast<size_t>(st.st_size);
+  void *addr = mmap(nullptr, sz, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // The mapping stays valid after closing the descriptor.
+  if (addr == MAP_FAILED) {
+    if (err) {
+      (*err) += "File mapping error : " + filepath + "\n";
+    }
+    return false;
+  }
+
+  out->data = reinterpret_cast<const unsigned char *>(addr);
+  out->size = sz;
+  out->owner = std::shared_ptr<void>(addr, [sz](void *p) { munmap(p, sz); });
+  return true;
+#endif
+}
+
 #endif  // TINYGLTF_NO_FS
 
 static std::string MimeToExt(const std::string &mimeType) {
@@ -2848,99 +6089,865 @@ bool IsDataURI(const std::string &in) {
     return true;
   }
 
-  header = "data:image/bmp;base64,";
-  if (in.find(header) == 0) {
-    return true;
+  header = "data:image/bmp;base64,";
+  if (in.find(header) == 0) {
+    return true;
+  }
+
+  header = "data:image/gif;base64,";
+  if (in.find(header) == 0) {
+    return true;
+  }
+
+  header = "data:text/plain;base64,";
+  if (in.find(header) == 0) {
+    return true;
+  }
+
+  header = "data:application/gltf-buffer;base64,";
+  if (in.find(header) == 0) {
+    return true;
+  }
+
+  return false;
+}
+
+bool DecodeDataURI(std::vector<unsigned char> *out, std::string &mime_type,
+                   const std::string &in, size_t reqBytes, bool checkSize) {
+  struct DataURIHeader {
+    const char *header;
+    const char *mime_type;  // nullptr: leave `mime_type` as is.
+  };
+  static const DataURIHeader kHeaders[] = {
+      {"data:application/octet-stream;base64,", nullptr},
+      {"data:image/jpeg;base64,", "image/jpeg"},
+      {"data:image/png;base64,", "image/png"},
+      {"data:image/bmp;base64,", "image/bmp"},
+      {"data:image/gif;base64,", "image/gif"},
+      {"data:text/plain;base64,", "text/plain"},
+      {"data:application/gltf-buffer;base64,", nullptr}};
+
+  out->clear();
+  for (const DataURIHeader &h : kHeaders) {
+    const size_t header_len = strlen(h.header);
+    if (in.compare(0, header_len, h.header) != 0) {
+      continue;
+    }
+    if (h.mime_type) {
+      mime_type = h.mime_type;
+    }
+    // Decode directly into the destination.
+    base64_decode(in.data() + header_len, in.size() - header_len, out);
+    break;
+  }
+
+  // TODO(syoyo): Allow empty buffer? #229
+  if (out->empty()) {
+    return false;
+  }
+
+  if (checkSize && (out->size() != reqBytes)) {
+    return false;
+  }
+  return true;
+}
+
+//
+// Accessor unpacking.
+//
+
+// Scalar reference conversion of `n` components. Normalization follows the
+// glTF spec: c / max for unsigned, max(c / max, -1) for signed types.
+template <typename Src>
+static void ConvertToFloatScalar(const unsigned char *src, size_t n,
+                                 bool normalized, float *dst) {
+  const bool normalize = normalized && std::is_integral<Src>::value;
+  const float scale = static_cast<float>((std::numeric_limits<Src>::max)());
+  for (size_t i = 0; i < n; i++) {
+    Src v;
+    memcpy(&v, src + i * sizeof(Src), sizeof(Src));
+    float f = static_cast<float>(v);
+    if (normalize) {
+      f = f / scale;
+      f = (f < -1.0f) ? -1.0f : f;
+    }
+    dst[i] = f;
+  }
+}
+
+template <typename Src>
+static void ConvertToUint32Scalar(const unsigned char *src, size_t n,
+                                  uint32_t *dst) {
+  for (size_t i = 0; i < n; i++) {
+    Src v;
+    memcpy(&v, src + i * sizeof(Src), sizeof(Src));
+    dst[i] = static_cast<uint32_t>(v);
+  }
+}
+
+// SIMD kernels convert a prefix of the components and return its length.
+// The scalar kernels handle the rest.
+template <typename Src>
+static size_t ConvertToFloatSIMD(const unsigned char *, size_t, bool,
+                                 float *) {
+  return 0;
+}
+
+template <typename Src>
+static size_t ConvertToUint32SIMD(const unsigned char *, size_t, uint32_t *) {
+  return 0;
+}
+
+#ifdef TINYGLTF_HAS_SSE2
+static inline void StoreInt32AsFloat(__m128i v, bool normalized,
+                                     bool is_signed, float scale,
+                                     float *dst) {
+  __m128 f = _mm_cvtepi32_ps(v);
+  if (normalized) {
+    f = _mm_div_ps(f, _mm_set1_ps(scale));
+    if (is_signed) {
+      f = _mm_max_ps(f, _mm_set1_ps(-1.0f));
+    }
+  }
+  _mm_storeu_ps(dst, f);
+}
+
+template <>
+size_t ConvertToFloatSIMD<uint8_t>(const unsigned char *src, size_t n,
+                                   bool normalized, float *dst) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    const __m128i lo = _mm_unpacklo_epi8(b, zero);
+    const __m128i hi = _mm_unpackhi_epi8(b, zero);
+    StoreInt32AsFloat(_mm_unpacklo_epi16(lo, zero), normalized, false, 255.0f,
+                      dst + i);
+    StoreInt32AsFloat(_mm_unpackhi_epi16(lo, zero), normalized, false, 255.0f,
+                      dst + i + 4);
+    StoreInt32AsFloat(_mm_unpacklo_epi16(hi, zero), normalized, false, 255.0f,
+                      dst + i + 8);
+    StoreInt32AsFloat(_mm_unpackhi_epi16(hi, zero), normalized, false, 255.0f,
+                      dst + i + 12);
+  }
+  return i;
+}
+
+template <>
+size_t ConvertToFloatSIMD<int8_t>(const unsigned char *src, size_t n,
+                                  bool normalized, float *dst) {
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    // Sign extend by unpacking each value into the upper half and shifting.
+    const __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(b, b), 8);
+    const __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(b, b), 8);
+    StoreInt32AsFloat(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16),
+                      normalized, true, 127.0f, dst + i);
+    StoreInt32AsFloat(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16),
+                      normalized, true, 127.0f, dst + i + 4);
+    StoreInt32AsFloat(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16),
+                      normalized, true, 127.0f, dst + i + 8);
+    StoreInt32AsFloat(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16),
+                      normalized, true, 127.0f, dst + i + 12);
+  }
+  return i;
+}
+
+template <>
+size_t ConvertToFloatSIMD<uint16_t>(const unsigned char *src, size_t n,
+                                    bool normalized, float *dst) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+    StoreInt32AsFloat(_mm_unpacklo_epi16(v, zero), normalized, false,
+                      65535.0f, dst + i);
+    StoreInt32AsFloat(_mm_unpackhi_epi16(v, zero), normalized, false,
+                      65535.0f, dst + i + 4);
+  }
+  return i;
+}
+
+template <>
+size_t ConvertToFloatSIMD<int16_t>(const unsigned char *src, size_t n,
+                                   bool normalized, float *dst) {
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+    StoreInt32AsFloat(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16),
+                      normalized, true, 32767.0f, dst + i);
+    StoreInt32AsFloat(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16),
+                      normalized, true, 32767.0f, dst + i + 4);
+  }
+  return i;
+}
+
+template <>
+size_t ConvertToFloatSIMD<int32_t>(const unsigned char *src, size_t n,
+                                   bool normalized, float *dst) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+    StoreInt32AsFloat(v, normalized, true, 2147483647.0f, dst + i);
+  }
+  return i;
+}
+
+template <>
+size_t ConvertToFloatSIMD<uint32_t>(const unsigned char *src, size_t n,
+                                    bool normalized, float *dst) {
+  // No unsigned conversion in SSE2. Convert the 16bit halves separately;
+  // both are exact, so the sum is rounded once like a scalar conversion.
+  const __m128i mask = _mm_set1_epi32(0xffff);
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 4));
+    const __m128 hi = _mm_cvtepi32_ps(_mm_srli_epi32(v, 16));
+    const __m128 lo = _mm_cvtepi32_ps(_mm_and_si128(v, mask));
+    __m128 f = _mm_add_ps(_mm_mul_ps(hi, _mm_set1_ps(65536.0f)), lo);
+    if (normalized) {
+      f = _mm_div_ps(f, _mm_set1_ps(4294967295.0f));
+    }
+    _mm_storeu_ps(dst + i, f);
+  }
+  return i;
+}
+
+template <>
+size_t ConvertToFloatSIMD<double>(const unsigned char *src, size_t n, bool,
+                                  float *dst) {
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    double v[4];
+    memcpy(v, src + i * 8, sizeof(v));
+    const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(v));
+    const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(v + 2));
+    _mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+  }
+  return i;
+}
+
+template <>
+size_t ConvertToUint32SIMD<uint8_t>(const unsigned char *src, size_t n,
+                                    uint32_t *dst) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i b =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    const __m128i lo = _mm_unpacklo_epi8(b, zero);
+    const __m128i hi = _mm_unpackhi_epi8(b, zero);
+    __m128i *d = reinterpret_cast<__m128i *>(dst + i);
+    _mm_storeu_si128(d, _mm_unpacklo_epi16(lo, zero));
+    _mm_storeu_si128(d + 1, _mm_unpackhi_epi16(lo, zero));
+    _mm_storeu_si128(d + 2, _mm_unpacklo_epi16(hi, zero));
+    _mm_storeu_si128(d + 3, _mm_unpackhi_epi16(hi, zero));
+  }
+  return i;
+}
+
+template <>
+size_t ConvertToUint32SIMD<uint16_t>(const unsigned char *src, size_t n,
+                                     uint32_t *dst) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i v =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i * 2));
+    __m128i *d = reinterpret_cast<__m128i *>(dst + i);
+    _mm_storeu_si128(d, _mm_unpacklo_epi16(v, zero));
+    _mm_storeu_si128(d + 1, _mm_unpackhi_epi16(v, zero));
+  }
+  return i;
+}
+#endif
+
+template <typename Src>
+static void ConvertToFloat(const unsigned char *src, size_t n, bool normalized,
+                           float *dst) {
+  const size_t i = ConvertToFloatSIMD<Src>(src, n, normalized, dst);
+  ConvertToFloatScalar<Src>(src + i * sizeof(Src), n - i, normalized, dst + i);
+}
+
+template <>
+void ConvertToFloat<float>(const unsigned char *src, size_t n, bool,
+                           float *dst) {
+  if (n == 0) return;
+  memcpy(dst, src, n * sizeof(float));
+}
+
+template <typename Src>
+static void ConvertToUint32(const unsigned char *src, size_t n,
+                            uint32_t *dst) {
+  const size_t i = ConvertToUint32SIMD<Src>(src, n, dst);
+  ConvertToUint32Scalar<Src>(src + i * sizeof(Src), n - i, dst + i);
+}
+
+template <>
+void ConvertToUint32<uint32_t>(const unsigned char *src, size_t n,
+                               uint32_t *dst) {
+  if (n == 0) return;
+  memcpy(dst, src, n * sizeof(uint32_t));
+}
+
+namespace {
+
+// Converts `n` components of `component_type` at `src` to float.
+struct FloatConverter {
+  int component_type;
+  bool normalized;
+
+  void operator()(const unsigned char *src, size_t n, float *dst) const {
+    switch (component_type) {
+      case TINYGLTF_COMPONENT_TYPE_BYTE:
+        ConvertToFloat<int8_t>(src, n, normalized, dst);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        ConvertToFloat<uint8_t>(src, n, normalized, dst);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_SHORT:
+        ConvertToFloat<int16_t>(src, n, normalized, dst);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+        ConvertToFloat<uint16_t>(src, n, normalized, dst);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_INT:
+        ConvertToFloat<int32_t>(src, n, normalized, dst);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+        ConvertToFloat<uint32_t>(src, n, normalized, dst);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_FLOAT:
+        ConvertToFloat<float>(src, n, normalized, dst);
+        break;
+      default:
+        ConvertToFloat<double>(src, n, normalized, dst);
+        break;
+    }
+  }
+};
+
+// Converts `n` integer components of `component_type` at `src` to uint32.
+struct Uint32Converter {
+  int component_type;
+
+  void operator()(const unsigned char *src, size_t n, uint32_t *dst) const {
+    switch (component_type) {
+      case TINYGLTF_COMPONENT_TYPE_BYTE:
+        ConvertToUint32<int8_t>(src, n, dst);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        ConvertToUint32<uint8_t>(src, n, dst);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_SHORT:
+        ConvertToUint32<int16_t>(src, n, dst);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+        ConvertToUint32<uint16_t>(src, n, dst);
+        break;
+      case TINYGLTF_COMPONENT_TYPE_INT:
+        ConvertToUint32<int32_t>(src, n, dst);
+        break;
+      default:
+        ConvertToUint32<uint32_t>(src, n, dst);
+        break;
+    }
+  }
+};
+
+// Walks accessor data resolved by AccessorViewBase and feeds contiguous
+// component runs to a converter.
+class AccessorUnpacker : public AccessorViewBase {
+ public:
+  bool Init(const Model &model, int accessor_idx, std::string *err) {
+    if ((accessor_idx < 0) ||
+        (size_t(accessor_idx) >= model.accessors.size())) {
+      if (err) {
+        (*err) += "Invalid accessor index " + std::to_string(accessor_idx) +
+                  ".\n";
+      }
+      return false;
+    }
+    valid_ = AccessorViewBase::Init(
+        model, model.accessors[size_t(accessor_idx)], -1, err);
+    return valid_;
+  }
+
+  int ComponentType() const { return component_type_; }
+  bool Normalized() const { return normalized_; }
+  size_t NumValues() const { return count_ * size_t(num_components_); }
+
+  size_t DenseSize() const { return count_ * element_size_; }
+  size_t ComponentSize() const { return component_size_; }
+
+  // Writes DenseSize() bytes of tightly packed elements to `dst`.
+  void CopyDense(unsigned char *dst) const {
+    if (data_ == nullptr) {
+      memset(dst, 0, DenseSize());
+    } else if (byte_stride_ == element_size_) {
+      memcpy(dst, data_, DenseSize());
+    } else {
+      for (size_t i = 0; i < count_; i++) {
+        memcpy(dst + i * element_size_, data_ + i * byte_stride_,
+               element_size_);
+      }
+    }
+
+    for (size_t k = 0; k < sparse_count_; k++) {
+      memcpy(dst + ReadSparseIndex(k) * element_size_,
+             sparse_values_ + k * element_size_, element_size_);
+    }
+  }
+
+  template <typename Dst, typename Converter>
+  void Unpack(const Converter &convert, Dst *dst) const {
+    const size_t n = size_t(num_components_);
+    const size_t packed_size = n * component_size_;
+
+    if (data_ == nullptr) {
+      std::fill(dst, dst + NumValues(), Dst(0));
+    } else if ((byte_stride_ == packed_size) &&
+               (element_size_ == packed_size)) {
+      // No interleaving or column padding. Convert everything at once.
+      convert(data_, NumValues(), dst);
+    } else {
+      for (size_t i = 0; i < count_; i++) {
+        UnpackElement(convert, data_ + i * byte_stride_, dst + i * n);
+      }
+    }
+
+    for (size_t k = 0; k < sparse_count_; k++) {
+      UnpackElement(convert, sparse_values_ + k * element_size_,
+                    dst + ReadSparseIndex(k) * n);
+    }
+  }
+
+ private:
+  template <typename Dst, typename Converter>
+  void UnpackElement(const Converter &convert, const unsigned char *p,
+                     Dst *dst) const {
+    for (int c = 0; c < columns_; c++) {
+      convert(p + size_t(c) * column_stride_, size_t(rows_),
+              dst + c * rows_);
+    }
+  }
+};
+
+template <typename Dst, typename Converter>
+static bool UnpackAccessor(const AccessorUnpacker &unpacker,
+                           const Converter &convert, Dst *dst,
+                           size_t dst_size, std::string *err) {
+  if (dst_size < unpacker.NumValues()) {
+    if (err) {
+      (*err) += "Destination holds " + std::to_string(dst_size) +
+                " values but the accessor has " +
+                std::to_string(unpacker.NumValues()) + ".\n";
+    }
+    return false;
+  }
+  unpacker.Unpack(convert, dst);
+  return true;
+}
+
+}  // namespace
+
+bool UnpackAccessorToFloat(const Model &model, int accessor_idx, float *dst,
+                           size_t dst_size, std::string *err) {
+  AccessorUnpacker unpacker;
+  if (!unpacker.Init(model, accessor_idx, err)) {
+    return false;
+  }
+  FloatConverter convert = {unpacker.ComponentType(), unpacker.Normalized()};
+  return UnpackAccessor(unpacker, convert, dst, dst_size, err);
+}
+
+bool UnpackAccessorToFloat(const Model &model, int accessor_idx,
+                           std::vector<float> *out, std::string *err) {
+  AccessorUnpacker unpacker;
+  if (!unpacker.Init(model, accessor_idx, err)) {
+    out->clear();
+    return false;
+  }
+  out->resize(unpacker.NumValues());
+  FloatConverter convert = {unpacker.ComponentType(), unpacker.Normalized()};
+  return UnpackAccessor(unpacker, convert, out->data(), out->size(), err);
+}
+
+static bool InitUint32Unpacker(const Model &model, int accessor_idx,
+                               AccessorUnpacker *unpacker, std::string *err) {
+  if (!unpacker->Init(model, accessor_idx, err)) {
+    return false;
+  }
+  if ((unpacker->ComponentType() == TINYGLTF_COMPONENT_TYPE_FLOAT) ||
+      (unpacker->ComponentType() == TINYGLTF_COMPONENT_TYPE_DOUBLE)) {
+    if (err) {
+      (*err) += "Cannot unpack a floating point accessor to uint32.\n";
+    }
+    return false;
+  }
+  return true;
+}
+
+bool UnpackAccessorToUint32(const Model &model, int accessor_idx,
+                            uint32_t *dst, size_t dst_size,
+                            std::string *err) {
+  AccessorUnpacker unpacker;
+  if (!InitUint32Unpacker(model, accessor_idx, &unpacker, err)) {
+    return false;
+  }
+  Uint32Converter convert = {unpacker.ComponentType()};
+  return UnpackAccessor(unpacker, convert, dst, dst_size, err);
+}
+
+bool UnpackAccessorToUint32(const Model &model, int accessor_idx,
+                            std::vector<uint32_t> *out, std::string *err) {
+  AccessorUnpacker unpacker;
+  if (!InitUint32Unpacker(model, accessor_idx, &unpacker, err)) {
+    out->clear();
+    return false;
+  }
+  out->resize(unpacker.NumValues());
+  Uint32Converter convert = {unpacker.ComponentType()};
+  return UnpackAccessor(unpacker, convert, out->data(), out->size(), err);
+}
+
+bool MaterializeSparseAccessor(const Model &model, int accessor_idx,
+                               std::vector<unsigned char> *out,
+                               std::string *err) {
+  AccessorUnpacker unpacker;
+  if (!unpacker.Init(model, accessor_idx, err)) {
+    out->clear();
+    return false;
+  }
+  out->resize(unpacker.DenseSize());
+  if (!out->empty()) {
+    unpacker.CopyDense(out->data());
+  }
+  return true;
+}
+
+bool MaterializeSparseAccessors(Model *model, std::string *err,
+                                int num_threads) {
+  std::vector<size_t> sparse_accessors;
+  for (size_t i = 0; i < model->accessors.size(); i++) {
+    if (model->accessors[i].sparse.isSparse) {
+      sparse_accessors.push_back(i);
+    }
   }
-
-  header = "data:image/gif;base64,";
-  if (in.find(header) == 0) {
+  if (sparse_accessors.empty()) {
     return true;
   }
 
-  header = "data:text/plain;base64,";
-  if (in.find(header) == 0) {
-    return true;
+  num_threads = ResolveNumThreads(num_threads);
+
+  // Validate(including the sparse indices) in parallel.
+  std::vector<AccessorUnpacker> unpackers(sparse_accessors.size());
+  std::vector<std::string> errs(sparse_accessors.size());
+  std::vector<char> ok(sparse_accessors.size(), 0);
+  ParallelFor(sparse_accessors.size(), num_threads, [&](size_t j) {
+    ok[j] = unpackers[j].Init(*model, int(sparse_accessors[j]), &errs[j]);
+  });
+
+  bool valid = true;
+  for (size_t j = 0; j < sparse_accessors.size(); j++) {
+    if (!ok[j]) {
+      if (err) {
+        (*err) += "accessor[" + std::to_string(sparse_accessors[j]) +
+                  "]: " + errs[j];
+      }
+      valid = false;
+    }
+  }
+  if (!valid) {
+    return false;
   }
 
-  header = "data:application/gltf-buffer;base64,";
-  if (in.find(header) == 0) {
-    return true;
+  // Lay out all dense data in a single buffer.
+  std::vector<size_t> offsets(sparse_accessors.size());
+  size_t total = 0;
+  for (size_t j = 0; j < sparse_accessors.size(); j++) {
+    const size_t align = (std::max)(size_t(4), unpackers[j].ComponentSize());
+    total = ((total + align - 1) / align) * align;
+    offsets[j] = total;
+    total += unpackers[j].DenseSize();
   }
 
-  return false;
-}
+  Buffer buffer;
+  buffer.data.resize(total);
+  ParallelFor(sparse_accessors.size(), num_threads, [&](size_t j) {
+    if (unpackers[j].DenseSize() > 0) {
+      unpackers[j].CopyDense(buffer.data.data() + offsets[j]);
+    }
+  });
 
-bool DecodeDataURI(std::vector<unsigned char> *out, std::string &mime_type,
-                   const std::string &in, size_t reqBytes, bool checkSize) {
-  std::string header = "data:application/octet-stream;base64,";
-  std::string data;
-  if (in.find(header) == 0) {
-    data = base64_decode(in.substr(header.size()));  // cut mime string.
+  const int buffer_idx = int(model->buffers.size());
+  model->buffers.push_back(std::move(buffer));
+  for (size_t j = 0; j < sparse_accessors.size(); j++) {
+    BufferView view;
+    view.buffer = buffer_idx;
+    view.byteOffset = offsets[j];
+    view.byteLength = unpackers[j].DenseSize();
+    model->bufferViews.push_back(view);
+
+    Accessor &accessor = model->accessors[sparse_accessors[j]];
+    accessor.bufferView = int(model->bufferViews.size() - 1);
+    accessor.byteOffset = 0;
+    accessor.sparse.isSparse = false;
   }
+  return true;
+}
 
-  if (data.empty()) {
-    header = "data:image/jpeg;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/jpeg";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
+bool AnimationEvaluator::Init(const Model &model, int animation_idx,
+                              std::string *err) {
+  samplers_.clear();
+  channels_.clear();
+  start_time_ = 0.0f;
+  end_time_ = 0.0f;
+
+  if ((animation_idx < 0) ||
+      (size_t(animation_idx) >= model.animations.size())) {
+    if (err) {
+      (*err) += "Invalid animation index " + std::to_string(animation_idx) +
+                ".\n";
     }
+    return false;
   }
+  const Animation &animation = model.animations[size_t(animation_idx)];
 
-  if (data.empty()) {
-    header = "data:image/png;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/png";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
+  bool first = true;
+  samplers_.resize(animation.samplers.size());
+  for (size_t i = 0; i < animation.samplers.size(); i++) {
+    const AnimationSampler &src = animation.samplers[i];
+    Sampler &dst = samplers_[i];
+    const std::string prefix = "animations[" + std::to_string(animation_idx) +
+                               "].samplers[" + std::to_string(i) + "]";
+
+    if (src.interpolation == "STEP") {
+      dst.interpolation = STEP;
+    } else if (src.interpolation == "CUBICSPLINE") {
+      dst.interpolation = CUBICSPLINE;
+    } else {
+      dst.interpolation = LINEAR;
     }
-  }
 
-  if (data.empty()) {
-    header = "data:image/bmp;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/bmp";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
+    if (!UnpackAccessorToFloat(model, src.input, &dst.times, err) ||
+        !UnpackAccessorToFloat(model, src.output, &dst.values, err)) {
+      if (err) {
+        (*err) += "Failed to read the keyframes of " + prefix + ".\n";
+      }
+      return false;
     }
-  }
+    const size_t keys = dst.times.size();
+    const size_t values_per_key = (dst.interpolation == CUBICSPLINE) ? 3 : 1;
+    if ((keys == 0) || (dst.values.size() % (keys * values_per_key) != 0)) {
+      if (err) {
+        (*err) += prefix + " has " + std::to_string(keys) +
+                  " keyframes but " + std::to_string(dst.values.size()) +
+                  " output values.\n";
+      }
+      return false;
+    }
+    dst.components = dst.values.size() / (keys * values_per_key);
 
-  if (data.empty()) {
-    header = "data:image/gif;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "image/gif";
-      data = base64_decode(in.substr(header.size()));  // cut mime string.
+    if (first || dst.times.front() < start_time_) {
+      start_time_ = dst.times.front();
+    }
+    if (first || dst.times.back() > end_time_) {
+      end_time_ = dst.times.back();
     }
+    first = false;
   }
 
-  if (data.empty()) {
-    header = "data:text/plain;base64,";
-    if (in.find(header) == 0) {
-      mime_type = "text/plain";
-      data = base64_decode(in.substr(header.size()));
+  for (const AnimationChannel &src : animation.channels) {
+    if (src.target_node < 0) {
+      continue;
+    }
+    Channel channel;
+    channel.node = src.target_node;
+    if (src.target_path == "translation") {
+      channel.path = TRANSLATION;
+    } else if (src.target_path == "rotation") {
+      channel.path = ROTATION;
+    } else if (src.target_path == "scale") {
+      channel.path = SCALE;
+    } else if (src.target_path == "weights") {
+      channel.path = WEIGHTS;
+    } else {
+      continue;
+    }
+    if ((src.sampler < 0) || (size_t(src.sampler) >= samplers_.size())) {
+      if (err) {
+        (*err) += "Invalid sampler index " + std::to_string(src.sampler) +
+                  " in animations[" + std::to_string(animation_idx) +
+                  "].channels.\n";
+      }
+      return false;
+    }
+    channel.sampler = size_t(src.sampler);
+
+    const size_t expected = (channel.path == ROTATION)  ? 4
+                            : (channel.path == WEIGHTS) ? 0
+                                                        : 3;
+    if (expected && (samplers_[channel.sampler].components != expected)) {
+      if (err) {
+        (*err) += "Sampler " + std::to_string(src.sampler) + " of " +
+                  src.target_path + " channel in animations[" +
+                  std::to_string(animation_idx) + "] must have " +
+                  std::to_string(expected) + " components.\n";
+      }
+      return false;
     }
+    channels_.push_back(channel);
   }
+  return true;
+}
 
-  if (data.empty()) {
-    header = "data:application/gltf-buffer;base64,";
-    if (in.find(header) == 0) {
-      data = base64_decode(in.substr(header.size()));
+size_t AnimationEvaluator::FindKey(const std::vector<float> &times, float time,
+                                   size_t hint) {
+  const size_t last = times.size() - 1;
+  if (hint < last && times[hint] <= time) {
+    // Playing forward: the same or one of the next two keyframes.
+    for (size_t k = hint; (k < last) && (k < hint + 3); k++) {
+      if (time < times[k + 1]) {
+        return k;
+      }
+    }
+  }
+  if (time < times[0]) {
+    return 0;
+  }
+  if (time >= times[last]) {
+    return last;
+  }
+  return size_t(std::upper_bound(times.begin(), times.end(), time) -
+                times.begin()) -
+         1;
+}
+
+void AnimationEvaluator::Sample(const Sampler &sampler, float time,
+                                size_t *key, bool normalize, float *out) {
+  const size_t n = sampler.components;
+  const std::vector<float> &times = sampler.times;
+  const size_t k = FindKey(times, time, *key);
+  *key = k;
+
+  const size_t stride = (sampler.interpolation == CUBICSPLINE) ? 3 * n : n;
+  const size_t value_offset = (sampler.interpolation == CUBICSPLINE) ? n : 0;
+  const float *v0 = &sampler.values[k * stride + value_offset];
+
+  if ((k + 1 >= times.size()) || (time <= times[k]) ||
+      (sampler.interpolation == STEP)) {
+    memcpy(out, v0, n * sizeof(float));
+    return;
+  }
+
+  const float dt = times[k + 1] - times[k];
+  const float s = (dt > 0.0f) ? (time - times[k]) / dt : 0.0f;
+  const float *v1 = &sampler.values[(k + 1) * stride + value_offset];
+
+  if (sampler.interpolation == CUBICSPLINE) {
+    // Hermite spline with the out-tangent of k and the in-tangent of k + 1.
+    const float *b0 = v0 + n;
+    const float *a1 = v1 - n;
+    const float s2 = s * s;
+    const float s3 = s2 * s;
+    const float h00 = 2.0f * s3 - 3.0f * s2 + 1.0f;
+    const float h10 = (s3 - 2.0f * s2 + s) * dt;
+    const float h01 = -2.0f * s3 + 3.0f * s2;
+    const float h11 = (s3 - s2) * dt;
+    for (size_t c = 0; c < n; c++) {
+      out[c] = h00 * v0[c] + h10 * b0[c] + h01 * v1[c] + h11 * a1[c];
+    }
+  } else if (normalize) {
+    // Spherical linear interpolation along the shortest path.
+    float d = v0[0] * v1[0] + v0[1] * v1[1] + v0[2] * v1[2] + v0[3] * v1[3];
+    const float sign = (d < 0.0f) ? -1.0f : 1.0f;
+    d = std::fabs(d);
+    float w0 = 1.0f - s;
+    float w1 = s;
+    if (d < 0.9995f) {
+      const float theta = std::acos(d);
+      const float sin_theta = std::sin(theta);
+      w0 = std::sin((1.0f - s) * theta) / sin_theta;
+      w1 = std::sin(s * theta) / sin_theta;
+    }
+    for (size_t c = 0; c < 4; c++) {
+      out[c] = w0 * v0[c] + sign * w1 * v1[c];
+    }
+  } else {
+    for (size_t c = 0; c < n; c++) {
+      out[c] = v0[c] + s * (v1[c] - v0[c]);
     }
   }
 
-  // TODO(syoyo): Allow empty buffer? #229
-  if (data.empty()) {
-    return false;
+  if (normalize) {
+    const float len = std::sqrt(out[0] * out[0] + out[1] * out[1] +
+                                out[2] * out[2] + out[3] * out[3]);
+    if (len > 0.0f) {
+      for (size_t c = 0; c < 4; c++) {
+        out[c] /= len;
+      }
+    }
   }
+}
 
-  if (checkSize) {
-    if (data.size() != reqBytes) {
-      return false;
+void AnimationEvaluator::Evaluate(
+    float time, AnimationCursor *cursor,
+    std::vector<NodeTransform<float> > *transforms,
+    std::vector<std::vector<float> > *weights) const {
+  if (cursor->keys.size() != samplers_.size()) {
+    cursor->keys.assign(samplers_.size(), 0);
+  }
+  for (const Channel &channel : channels_) {
+    const Sampler &sampler = samplers_[channel.sampler];
+    size_t *key = &cursor->keys[channel.sampler];
+    const size_t node = size_t(channel.node);
+    if (channel.path == WEIGHTS) {
+      if (!weights) {
+        continue;
+      }
+      if (weights->size() <= node) {
+        weights->resize(node + 1);
+      }
+      std::vector<float> &dst = (*weights)[node];
+      dst.resize(sampler.components);
+      if (!dst.empty()) {
+        Sample(sampler, time, key, false, dst.data());
+      }
+      continue;
+    }
+    if (node >= transforms->size()) {
+      continue;
+    }
+    NodeTransform<float> &xform = (*transforms)[node];
+    if (channel.path == TRANSLATION) {
+      Sample(sampler, time, key, false, xform.translation);
+      xform.flags |= NodeTransform<float>::HAS_TRANSLATION;
+    } else if (channel.path == ROTATION) {
+      Sample(sampler, time, key, true, xform.rotation);
+      xform.flags |= NodeTransform<float>::HAS_ROTATION;
+    } else {
+      Sample(sampler, time, key, false, xform.scale);
+      xform.flags |= NodeTransform<float>::HAS_SCALE;
     }
-    out->resize(reqBytes);
-  } else {
-    out->resize(data.size());
   }
-  std::copy(data.begin(), data.end(), out->begin());
-  return true;
+}
+
+void AnimationEvaluator::Evaluate(
+    size_t count, const float *times, AnimationCursor *cursors,
+    std::vector<NodeTransform<float> > *transforms,
+    std::vector<std::vector<float> > *weights, int num_threads) const {
+  ParallelFor(count, ResolveNumThreads(num_threads), [&](size_t i) {
+    Evaluate(times[i], &cursors[i], &transforms[i],
+             weights ? &weights[i] : nullptr);
+  });
 }
 
 namespace {
@@ -2963,6 +6970,17 @@ bool GetInt(const json &o, int &val) {
   }
 
   return false;
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  switch (JsonType(o)) {
+    case 'l':
+      val = static_cast<int>(JsonNumberValue<int64_t>(o));
+      return true;
+    case 'u':
+      val = static_cast<int>(JsonNumberValue<uint64_t>(o));
+      return true;
+    default:
+      return false;
+  }
 #else
   auto type = o.type();
 
@@ -2995,6 +7013,20 @@ bool GetNumber(const json &o, double &val) {
   }
 
   return false;
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  switch (JsonType(o)) {
+    case 'l':
+      val = static_cast<double>(JsonNumberValue<int64_t>(o));
+      return true;
+    case 'u':
+      val = static_cast<double>(JsonNumberValue<uint64_t>(o));
+      return true;
+    case 'd':
+      val = JsonNumberValue<double>(o);
+      return true;
+    default:
+      return false;
+  }
 #else
   if (o.is_number()) {
     val = o.get<double>();
@@ -3012,6 +7044,15 @@ bool GetString(const json &o, std::string &val) {
     return true;
   }
 
+  return false;
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  if (JsonType(o) == '"') {
+    size_t length;
+    const char *data = JsonStringData(o, &length);
+    val.assign(data, length);
+    return true;
+  }
+
   return false;
 #else
   if (o.type() == json::value_t::string) {
@@ -3026,6 +7067,8 @@ bool GetString(const json &o, std::string &val) {
 bool IsArray(const json &o) {
 #ifdef TINYGLTF_USE_RAPIDJSON
   return o.IsArray();
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  return JsonType(o) == '[';
 #else
   return o.is_array();
 #endif
@@ -3034,6 +7077,10 @@ bool IsArray(const json &o) {
 json_const_array_iterator ArrayBegin(const json &o) {
 #ifdef TINYGLTF_USE_RAPIDJSON
   return o.Begin();
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  return IsArray(o) ? json_const_array_iterator(
+                          o.element.get_array().value_unsafe().begin())
+                    : json_const_array_iterator();
 #else
   return o.begin();
 #endif
@@ -3042,14 +7089,43 @@ json_const_array_iterator ArrayBegin(const json &o) {
 json_const_array_iterator ArrayEnd(const json &o) {
 #ifdef TINYGLTF_USE_RAPIDJSON
   return o.End();
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  // ArrayBegin() for other values.
+  return IsArray(o) ? json_const_array_iterator(
+                          o.element.get_array().value_unsafe().end())
+                    : json_const_array_iterator();
 #else
   return o.end();
 #endif
 }
 
+size_t ArraySize(const json &o) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  return o.Size();
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  // simdjson saturates the size of large arrays at 0xFFFFFF: count those.
+  size_t count = 0;
+  if (IsArray(o)) {
+    const simdjson::dom::array array = o.element.get_array().value_unsafe();
+    count = array.size();
+    if (count >= 0xFFFFFF) {
+      count = 0;
+      for (auto it = array.begin(); it != array.end(); ++it) {
+        count++;
+      }
+    }
+  }
+  return count;
+#else
+  return o.size();
+#endif
+}
+
 bool IsObject(const json &o) {
 #ifdef TINYGLTF_USE_RAPIDJSON
   return o.IsObject();
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  return JsonType(o) == '{';
 #else
   return o.is_object();
 #endif
@@ -3058,6 +7134,14 @@ bool IsObject(const json &o) {
 json_const_iterator ObjectBegin(const json &o) {
 #ifdef TINYGLTF_USE_RAPIDJSON
   return o.MemberBegin();
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  if (!IsObject(o)) {
+    return json_const_iterator();
+  }
+  if (o.detached) {
+    return json_const_iterator(o.members->data());
+  }
+  return json_const_iterator(o.element.get_object().value_unsafe().begin());
 #else
   return o.begin();
 #endif
@@ -3066,6 +7150,15 @@ json_const_iterator ObjectBegin(const json &o) {
 json_const_iterator ObjectEnd(const json &o) {
 #ifdef TINYGLTF_USE_RAPIDJSON
   return o.MemberEnd();
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  // ObjectBegin() for other values.
+  if (!IsObject(o)) {
+    return json_const_iterator();
+  }
+  if (o.detached) {
+    return json_const_iterator(o.members->data() + o.members->size());
+  }
+  return json_const_iterator(o.element.get_object().value_unsafe().end());
 #else
   return o.end();
 #endif
@@ -3076,6 +7169,10 @@ json_const_iterator ObjectEnd(const json &o) {
 std::string GetKey(json_const_iterator &it) {
 #ifdef TINYGLTF_USE_RAPIDJSON
   return it->name.GetString();
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  size_t length;
+  const char *data = it.KeyData(&length);
+  return std::string(data, length);
 #else
   return it.key().c_str();
 #endif
@@ -3088,6 +7185,17 @@ bool FindMember(const json &o, const char *member, json_const_iterator &it) {
   }
   it = o.FindMember(member);
   return it != o.MemberEnd();
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  const size_t member_length = strlen(member);
+  const json_const_iterator end = ObjectEnd(o);
+  for (it = ObjectBegin(o); it != end; ++it) {
+    size_t length;
+    const char *key = it.KeyData(&length);
+    if (length == member_length && memcmp(key, member, length) == 0) {
+      return true;
+    }
+  }
+  return false;
 #else
   it = o.find(member);
   return it != o.end();
@@ -3097,11 +7205,347 @@ bool FindMember(const json &o, const char *member, json_const_iterator &it) {
 const json &GetValue(json_const_iterator &it) {
 #ifdef TINYGLTF_USE_RAPIDJSON
   return it->value;
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  return it.Value();
 #else
   return it.value();
 #endif
 }
 
+#ifdef TINYGLTF_USE_SIMDJSON
+// A simdjson value found by FindMember(). The value is a handle held by the
+// iterator, so it is kept here: the pointer is valid until the end of the
+// full-expression which found it.
+class JsonMemberPointer {
+ public:
+  JsonMemberPointer() : found_(false) {}
+  explicit JsonMemberPointer(const json &value)
+      : value_(value), found_(true) {}
+  operator const json *() const { return found_ ? &value_ : nullptr; }
+
+ private:
+  json value_;
+  bool found_;
+};
+
+// Value of `member`, or nullptr when `o` has no such member.
+JsonMemberPointer FindMember(const json &o, const char *member) {
+  json_const_iterator it;
+  return FindMember(o, member, it) ? JsonMemberPointer(GetValue(it))
+                                   : JsonMemberPointer();
+}
+#else
+// Value of `member`, or nullptr when `o` has no such member.
+const json *FindMember(const json &o, const char *member) {
+  json_const_iterator it;
+  return FindMember(o, member, it) ? &GetValue(it) : nullptr;
+}
+#endif
+
+// FNV-1a hash of a member name. The constexpr form makes the names known to
+// FindJsonKey() case labels, so a collision between them fails to compile.
+constexpr uint32_t JsonKeyHashStep(const char *s, uint32_t hash) {
+  return (*s == '\0')
+             ? hash
+             : JsonKeyHashStep(s + 1, (hash ^ static_cast<unsigned char>(*s)) *
+                                          16777619u);
+}
+
+constexpr uint32_t JsonKeyHash(const char *s) {
+  return JsonKeyHashStep(s, 2166136261u);
+}
+
+uint32_t JsonKeyHash(const char *s, size_t length) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ static_cast<unsigned char>(s[i])) * 16777619u;
+  }
+  return hash;
+}
+
+// Member names looked up through JsonMembers.
+enum JsonKey {
+  JSON_KEY_ALPHA_CUTOFF,
+  JSON_KEY_ALPHA_MODE,
+  JSON_KEY_ATTRIBUTES,
+  JSON_KEY_BASE_COLOR_FACTOR,
+  JSON_KEY_BASE_COLOR_TEXTURE,
+  JSON_KEY_BUFFER,
+  JSON_KEY_BUFFER_VIEW,
+  JSON_KEY_BYTE_LENGTH,
+  JSON_KEY_BYTE_OFFSET,
+  JSON_KEY_BYTE_STRIDE,
+  JSON_KEY_CAMERA,
+  JSON_KEY_CHILDREN,
+  JSON_KEY_COMPONENT_TYPE,
+  JSON_KEY_COUNT,
+  JSON_KEY_DOUBLE_SIDED,
+  JSON_KEY_EMISSIVE_FACTOR,
+  JSON_KEY_EMISSIVE_TEXTURE,
+  JSON_KEY_EXTENSIONS,
+  JSON_KEY_EXTRAS,
+  JSON_KEY_INDICES,
+  JSON_KEY_MATERIAL,
+  JSON_KEY_MATRIX,
+  JSON_KEY_MAX,
+  JSON_KEY_MESH,
+  JSON_KEY_METALLIC_FACTOR,
+  JSON_KEY_METALLIC_ROUGHNESS_TEXTURE,
+  JSON_KEY_MIN,
+  JSON_KEY_MODE,
+  JSON_KEY_NAME,
+  JSON_KEY_NORMAL_TEXTURE,
+  JSON_KEY_NORMALIZED,
+  JSON_KEY_OCCLUSION_TEXTURE,
+  JSON_KEY_PBR_METALLIC_ROUGHNESS,
+  JSON_KEY_PRIMITIVES,
+  JSON_KEY_ROTATION,
+  JSON_KEY_ROUGHNESS_FACTOR,
+  JSON_KEY_SCALE,
+  JSON_KEY_SKIN,
+  JSON_KEY_SPARSE,
+  JSON_KEY_TARGET,
+  JSON_KEY_TARGETS,
+  JSON_KEY_TRANSLATION,
+  JSON_KEY_TYPE,
+  JSON_KEY_WEIGHTS,
+  JSON_KEY_UNKNOWN  // Also the number of known keys.
+};
+
+template <size_t N>
+JsonKey MatchJsonKey(const char *key, size_t length, const char (&name)[N],
+                     JsonKey id) {
+  return (length == N - 1 && memcmp(key, name, N - 1) == 0) ? id
+                                                            : JSON_KEY_UNKNOWN;
+}
+
+JsonKey FindJsonKey(const char *key, size_t length) {
+  switch (JsonKeyHash(key, length)) {
+    case JsonKeyHash("alphaCutoff"):
+      return MatchJsonKey(key, length, "alphaCutoff", JSON_KEY_ALPHA_CUTOFF);
+    case JsonKeyHash("alphaMode"):
+      return MatchJsonKey(key, length, "alphaMode", JSON_KEY_ALPHA_MODE);
+    case JsonKeyHash("attributes"):
+      return MatchJsonKey(key, length, "attributes", JSON_KEY_ATTRIBUTES);
+    case JsonKeyHash("baseColorFactor"):
+      return MatchJsonKey(key, length, "baseColorFactor",
+                          JSON_KEY_BASE_COLOR_FACTOR);
+    case JsonKeyHash("baseColorTexture"):
+      return MatchJsonKey(key, length, "baseColorTexture",
+                          JSON_KEY_BASE_COLOR_TEXTURE);
+    case JsonKeyHash("buffer"):
+      return MatchJsonKey(key, length, "buffer", JSON_KEY_BUFFER);
+    case JsonKeyHash("bufferView"):
+      return MatchJsonKey(key, length, "bufferView", JSON_KEY_BUFFER_VIEW);
+    case JsonKeyHash("byteLength"):
+      return MatchJsonKey(key, length, "byteLength", JSON_KEY_BYTE_LENGTH);
+    case JsonKeyHash("byteOffset"):
+      return MatchJsonKey(key, length, "byteOffset", JSON_KEY_BYTE_OFFSET);
+    case JsonKeyHash("byteStride"):
+      return MatchJsonKey(key, length, "byteStride", JSON_KEY_BYTE_STRIDE);
+    case JsonKeyHash("camera"):
+      return MatchJsonKey(key, length, "camera", JSON_KEY_CAMERA);
+    case JsonKeyHash("children"):
+      return MatchJsonKey(key, length, "children", JSON_KEY_CHILDREN);
+    case JsonKeyHash("componentType"):
+      return MatchJsonKey(key, length, "componentType",
+                          JSON_KEY_COMPONENT_TYPE);
+    case JsonKeyHash("count"):
+      return MatchJsonKey(key, length, "count", JSON_KEY_COUNT);
+    case JsonKeyHash("doubleSided"):
+      return MatchJsonKey(key, length, "doubleSided", JSON_KEY_DOUBLE_SIDED);
+    case JsonKeyHash("emissiveFactor"):
+      return MatchJsonKey(key, length, "emissiveFactor",
+                          JSON_KEY_EMISSIVE_FACTOR);
+    case JsonKeyHash("emissiveTexture"):
+      return MatchJsonKey(key, length, "emissiveTexture",
+                          JSON_KEY_EMISSIVE_TEXTURE);
+    case JsonKeyHash("extensions"):
+      return MatchJsonKey(key, length, "extensions", JSON_KEY_EXTENSIONS);
+    case JsonKeyHash("extras"):
+      return MatchJsonKey(key, length, "extras", JSON_KEY_EXTRAS);
+    case JsonKeyHash("indices"):
+      return MatchJsonKey(key, length, "indices", JSON_KEY_INDICES);
+    case JsonKeyHash("material"):
+      return MatchJsonKey(key, length, "material", JSON_KEY_MATERIAL);
+    case JsonKeyHash("matrix"):
+      return MatchJsonKey(key, length, "matrix", JSON_KEY_MATRIX);
+    case JsonKeyHash("max"):
+      return MatchJsonKey(key, length, "max", JSON_KEY_MAX);
+    case JsonKeyHash("mesh"):
+      return MatchJsonKey(key, length, "mesh", JSON_KEY_MESH);
+    case JsonKeyHash("metallicFactor"):
+      return MatchJsonKey(key, length, "metallicFactor",
+                          JSON_KEY_METALLIC_FACTOR);
+    case JsonKeyHash("metallicRoughnessTexture"):
+      return MatchJsonKey(key, length, "metallicRoughnessTexture",
+                          JSON_KEY_METALLIC_ROUGHNESS_TEXTURE);
+    case JsonKeyHash("min"):
+      return MatchJsonKey(key, length, "min", JSON_KEY_MIN);
+    case JsonKeyHash("mode"):
+      return MatchJsonKey(key, length, "mode", JSON_KEY_MODE);
+    case JsonKeyHash("name"):
+      return MatchJsonKey(key, length, "name", JSON_KEY_NAME);
+    case JsonKeyHash("normalTexture"):
+      return MatchJsonKey(key, length, "normalTexture",
+                          JSON_KEY_NORMAL_TEXTURE);
+    case JsonKeyHash("normalized"):
+      return MatchJsonKey(key, length, "normalized", JSON_KEY_NORMALIZED);
+    case JsonKeyHash("occlusionTexture"):
+      return MatchJsonKey(key, length, "occlusionTexture",
+                          JSON_KEY_OCCLUSION_TEXTURE);
+    case JsonKeyHash("pbrMetallicRoughness"):
+      return MatchJsonKey(key, length, "pbrMetallicRoughness",
+                          JSON_KEY_PBR_METALLIC_ROUGHNESS);
+    case JsonKeyHash("primitives"):
+      return MatchJsonKey(key, length, "primitives", JSON_KEY_PRIMITIVES);
+    case JsonKeyHash("rotation"):
+      return MatchJsonKey(key, length, "rotation", JSON_KEY_ROTATION);
+    case JsonKeyHash("roughnessFactor"):
+      return MatchJsonKey(key, length, "roughnessFactor",
+                          JSON_KEY_ROUGHNESS_FACTOR);
+    case JsonKeyHash("scale"):
+      return MatchJsonKey(key, length, "scale", JSON_KEY_SCALE);
+    case JsonKeyHash("skin"):
+      return MatchJsonKey(key, length, "skin", JSON_KEY_SKIN);
+    case JsonKeyHash("sparse"):
+      return MatchJsonKey(key, length, "sparse", JSON_KEY_SPARSE);
+    case JsonKeyHash("target"):
+      return MatchJsonKey(key, length, "target", JSON_KEY_TARGET);
+    case JsonKeyHash("targets"):
+      return MatchJsonKey(key, length, "targets", JSON_KEY_TARGETS);
+    case JsonKeyHash("translation"):
+      return MatchJsonKey(key, length, "translation", JSON_KEY_TRANSLATION);
+    case JsonKeyHash("type"):
+      return MatchJsonKey(key, length, "type", JSON_KEY_TYPE);
+    case JsonKeyHash("weights"):
+      return MatchJsonKey(key, length, "weights", JSON_KEY_WEIGHTS);
+    default:
+      return JSON_KEY_UNKNOWN;
+  }
+}
+
+// Values of the known members of a JSON object, collected in a single pass
+// over the object instead of one FindMember() per property. Like
+// FindMember(), the first of duplicated members wins. JsonKey is shared by
+// all object types: a Parse*() only reads the keys of its own type, so the
+// members of other types are skipped like unknown ones.
+class JsonMembers {
+ public:
+  explicit JsonMembers(const json &o) : values_() {
+    if (!IsObject(o)) {
+      return;
+    }
+    json_const_iterator it(ObjectBegin(o));
+    json_const_iterator itEnd(ObjectEnd(o));
+    for (; it != itEnd; ++it) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+      const JsonKey key =
+          FindJsonKey(it->name.GetString(), it->name.GetStringLength());
+#elif defined(TINYGLTF_USE_SIMDJSON)
+      size_t length;
+      const char *name = it.KeyData(&length);
+      const JsonKey key = FindJsonKey(name, length);
+#else
+      const JsonKey key = FindJsonKey(it.key().data(), it.key().size());
+#endif
+      if (key != JSON_KEY_UNKNOWN && !values_[key]) {
+#ifdef TINYGLTF_USE_SIMDJSON
+        // Values are handles held by the iterator.
+        found_[key] = GetValue(it);
+        values_[key] = &found_[key];
+#else
+        values_[key] = &GetValue(it);
+#endif
+      }
+    }
+  }
+
+  JsonMembers(const JsonMembers &) = delete;
+  JsonMembers &operator=(const JsonMembers &) = delete;
+
+  // nullptr when the member is absent.
+  const json *operator[](JsonKey key) const { return values_[key]; }
+
+ private:
+  const json *values_[JSON_KEY_UNKNOWN];
+#ifdef TINYGLTF_USE_SIMDJSON
+  json found_[JSON_KEY_UNKNOWN];
+#endif
+};
+
+// Reserve `ret` for the elements of the array `member` so that parsing a
+// top level array does not regrow (and move) the model vectors.
+template <typename T>
+void ReserveArrayMember(const json &o, const char *member,
+                        std::vector<T> *ret) {
+  json_const_iterator it;
+  if (FindMember(o, member, it) && IsArray(GetValue(it))) {
+    ret->reserve(ret->size() + ArraySize(GetValue(it)));
+  }
+}
+
+#ifdef TINYGLTF_USE_SIMDJSON
+// JSON text writer, defined with the direct JSON writer.
+void JsonWriterAppendString(std::string *out, const char *s, size_t n);
+template <typename T>
+void JsonWriterAppendNumber(std::string *out, T v);
+std::string JsonWriterIndent(const std::string &in, int spacing);
+
+void JsonAppendText(std::string *out, const json &o) {
+  switch (JsonType(o)) {
+    case '{': {
+      out->push_back('{');
+      const json_const_iterator end = ObjectEnd(o);
+      for (json_const_iterator it = ObjectBegin(o); it != end; ++it) {
+        if (it != ObjectBegin(o)) out->push_back(',');
+        size_t length;
+        const char *key = it.KeyData(&length);
+        JsonWriterAppendString(out, key, length);
+        out->push_back(':');
+        JsonAppendText(out, it.Value());
+      }
+      out->push_back('}');
+      break;
+    }
+    case '[': {
+      out->push_back('[');
+      const json_const_array_iterator end = ArrayEnd(o);
+      for (json_const_array_iterator it = ArrayBegin(o); it != end; ++it) {
+        if (it != ArrayBegin(o)) out->push_back(',');
+        JsonAppendText(out, *it);
+      }
+      out->push_back(']');
+      break;
+    }
+    case '"': {
+      size_t length;
+      const char *data = JsonStringData(o, &length);
+      JsonWriterAppendString(out, data, length);
+      break;
+    }
+    case 'l':
+      JsonWriterAppendNumber(out, JsonNumberValue<int64_t>(o));
+      break;
+    case 'u':
+      JsonWriterAppendNumber(out, JsonNumberValue<uint64_t>(o));
+      break;
+    case 'd':
+      JsonWriterAppendNumber(out, JsonNumberValue<double>(o));
+      break;
+    case 't':
+      out->append("true");
+      break;
+    case 'f':
+      out->append("false");
+      break;
+    default:
+      out->append("null");
+      break;
+  }
+}
+#endif
+
 std::string JsonToString(const json &o, int spacing = -1) {
 #ifdef TINYGLTF_USE_RAPIDJSON
   using namespace rapidjson;
@@ -3115,6 +7559,13 @@ std::string JsonToString(const json &o, int spacing = -1) {
     o.Accept(writer);
   }
   return buffer.GetString();
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  std::string out;
+  JsonAppendText(&out, o);
+  if (spacing >= 0) {
+    return JsonWriterIndent(out, spacing);
+  }
+  return out;
 #else
   return o.dump(spacing);
 #endif
@@ -3122,6 +7573,13 @@ std::string JsonToString(const json &o, int spacing = -1) {
 
 }  // namespace
 
+// How the `extras` and `extensions` of glTF objects are loaded.
+enum ExtrasMode {
+  EXTRAS_PARSE,             // Parsed into Value.
+  EXTRAS_PARSE_STORE_JSON,  // Also stored as JSON strings.
+  EXTRAS_LAZY               // Left in the source JSON(see LazyJson).
+};
+
 static bool ParseJsonAsValue(Value *ret, const json &o) {
   Value val{};
 #ifdef TINYGLTF_USE_RAPIDJSON
@@ -3170,6 +7628,58 @@ static bool ParseJsonAsValue(Value *ret, const json &o) {
       break;
       // all types are covered, so no `case default`
   }
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  switch (JsonType(o)) {
+    case '{': {
+      Value::Object value_object;
+      const json_const_iterator end = ObjectEnd(o);
+      for (json_const_iterator it = ObjectBegin(o); it != end; ++it) {
+        Value entry;
+        ParseJsonAsValue(&entry, it.Value());
+        if (entry.Type() != NULL_TYPE)
+          value_object.emplace(GetKey(it), std::move(entry));
+      }
+      if (value_object.size() > 0) val = Value(std::move(value_object));
+    } break;
+    case '[': {
+      Value::Array value_array;
+      value_array.reserve(ArraySize(o));
+      const json_const_array_iterator end = ArrayEnd(o);
+      for (json_const_array_iterator it = ArrayBegin(o); it != end; ++it) {
+        Value entry;
+        ParseJsonAsValue(&entry, *it);
+        if (entry.Type() != NULL_TYPE)
+          value_array.emplace_back(std::move(entry));
+      }
+      if (value_array.size() > 0) val = Value(std::move(value_array));
+    } break;
+    case '"': {
+      std::string str;
+      GetString(o, str);
+      val = Value(std::move(str));
+    } break;
+    case 't':
+    case 'f':
+      val = Value(JsonType(o) == 't');
+      break;
+    case 'l': {
+      // Like nlohmann::json, non-negative integers are unsigned.
+      const int64_t i = JsonNumberValue<int64_t>(o);
+      if (i < 0) {
+        val = Value(static_cast<int>(i));
+      } else {
+        val = Value(static_cast<uint64_t>(i));
+      }
+    } break;
+    case 'u':
+      val = Value(JsonNumberValue<uint64_t>(o));
+      break;
+    case 'd':
+      val = Value(JsonNumberValue<double>(o));
+      break;
+    default:
+      break;
+  }
 #else
   switch (o.type()) {
     case json::value_t::object: {
@@ -3201,6 +7711,7 @@ static bool ParseJsonAsValue(Value *ret, const json &o) {
       break;
     case json::value_t::number_integer:
       val = Value(static_cast<int>(o.get<int64_t>()));
+      break;
     case json::value_t::number_unsigned:
       val = Value(o.get<uint64_t>());
       break;
@@ -3213,39 +7724,52 @@ static bool ParseJsonAsValue(Value *ret, const json &o) {
       break;
   }
 #endif
+  const bool is_null = (val.Type() == NULL_TYPE);
   if (ret) *ret = std::move(val);
 
-  return val.Type() != NULL_TYPE;
+  return !is_null;
 }
 
-static bool ParseExtrasProperty(Value *ret, const json &o) {
-  json_const_iterator it;
-  if (!FindMember(o, "extras", it)) {
+static bool ParseExtrasMember(Value *ret, const json *member,
+                              ExtrasMode extras_mode) {
+  if (extras_mode == EXTRAS_LAZY || !member) {
     return false;
   }
 
-  return ParseJsonAsValue(ret, GetValue(it));
+  return ParseJsonAsValue(ret, *member);
 }
 
-static bool ParseBooleanProperty(bool *ret, std::string *err, const json &o,
-                                 const std::string &property,
-                                 const bool required,
-                                 const std::string &parent_node = "") {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
+static bool ParseExtrasProperty(Value *ret, const json &o,
+                                ExtrasMode extras_mode) {
+  return ParseExtrasMember(ret, FindMember(o, "extras"), extras_mode);
+}
+
+static void AppendMissingPropertyError(std::string *err, const char *property,
+                                       const char *parent_node) {
+  if (err) {
+    (*err) += "'" + std::string(property) + "' property is missing";
+    if (parent_node[0] != '\0') {
+      (*err) += " in " + std::string(parent_node);
+    }
+    (*err) += ".\n";
+  }
+}
+
+// Parse*Member() convert the value of a member already looked up, `member`
+// being nullptr when it is absent. Parse*Property() look `property` up in `o`
+// first.
+
+static bool ParseBooleanMember(bool *ret, std::string *err, const json *member,
+                               const char *property, const bool required,
+                               const char *parent_node = "") {
+  if (!member) {
     if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
-      }
+      AppendMissingPropertyError(err, property, parent_node);
     }
     return false;
   }
 
-  auto &value = GetValue(it);
+  auto &value = *member;
 
   bool isBoolean;
   bool boolValue = false;
@@ -3254,6 +7778,11 @@ static bool ParseBooleanProperty(bool *ret, std::string *err, const json &o,
   if (isBoolean) {
     boolValue = value.GetBool();
   }
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  isBoolean = (JsonType(value) == 't' || JsonType(value) == 'f');
+  if (isBoolean) {
+    boolValue = (JsonType(value) == 't');
+  }
 #else
   isBoolean = value.is_boolean();
   if (isBoolean) {
@@ -3263,7 +7792,7 @@ static bool ParseBooleanProperty(bool *ret, std::string *err, const json &o,
   if (!isBoolean) {
     if (required) {
       if (err) {
-        (*err) += "'" + property + "' property is not a bool type.\n";
+        (*err) += "'" + std::string(property) + "' property is not a bool type.\n";
       }
     }
     return false;
@@ -3276,30 +7805,23 @@ static bool ParseBooleanProperty(bool *ret, std::string *err, const json &o,
   return true;
 }
 
-static bool ParseIntegerProperty(int *ret, std::string *err, const json &o,
-                                 const std::string &property,
-                                 const bool required,
-                                 const std::string &parent_node = "") {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
+static bool ParseIntegerMember(int *ret, std::string *err, const json *member,
+                               const char *property, const bool required,
+                               const char *parent_node = "") {
+  if (!member) {
     if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
-      }
+      AppendMissingPropertyError(err, property, parent_node);
     }
     return false;
   }
 
   int intValue;
-  bool isInt = GetInt(GetValue(it), intValue);
+  bool isInt = GetInt(*member, intValue);
   if (!isInt) {
     if (required) {
       if (err) {
-        (*err) += "'" + property + "' property is not an integer type.\n";
+        (*err) += "'" + std::string(property) +
+                  "' property is not an integer type.\n";
       }
     }
     return false;
@@ -3312,25 +7834,26 @@ static bool ParseIntegerProperty(int *ret, std::string *err, const json &o,
   return true;
 }
 
-static bool ParseUnsignedProperty(size_t *ret, std::string *err, const json &o,
-                                  const std::string &property,
-                                  const bool required,
-                                  const std::string &parent_node = "") {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
+static bool ParseIntegerProperty(int *ret, std::string *err, const json &o,
+                                 const std::string &property,
+                                 const bool required,
+                                 const std::string &parent_node = "") {
+  return ParseIntegerMember(ret, err, FindMember(o, property.c_str()),
+                            property.c_str(), required, parent_node.c_str());
+}
+
+static bool ParseUnsignedMember(size_t *ret, std::string *err,
+                                const json *member, const char *property,
+                                const bool required,
+                                const char *parent_node = "") {
+  if (!member) {
     if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
-      }
+      AppendMissingPropertyError(err, property, parent_node);
     }
     return false;
   }
 
-  auto &value = GetValue(it);
+  auto &value = *member;
 
   size_t uValue = 0;
   bool isUValue;
@@ -3343,6 +7866,16 @@ static bool ParseUnsignedProperty(size_t *ret, std::string *err, const json &o,
     uValue = value.GetUint64();
     isUValue = true;
   }
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  isUValue = false;
+  if (JsonType(value) == 'u') {
+    uValue = size_t(JsonNumberValue<uint64_t>(value));
+    isUValue = true;
+  } else if (JsonType(value) == 'l' &&
+             JsonNumberValue<int64_t>(value) >= 0) {
+    uValue = size_t(JsonNumberValue<int64_t>(value));
+    isUValue = true;
+  }
 #else
   isUValue = value.is_number_unsigned();
   if (isUValue) {
@@ -3352,7 +7885,8 @@ static bool ParseUnsignedProperty(size_t *ret, std::string *err, const json &o,
   if (!isUValue) {
     if (required) {
       if (err) {
-        (*err) += "'" + property + "' property is not a positive integer.\n";
+        (*err) += "'" + std::string(property) +
+                  "' property is not a positive integer.\n";
       }
     }
     return false;
@@ -3365,32 +7899,33 @@ static bool ParseUnsignedProperty(size_t *ret, std::string *err, const json &o,
   return true;
 }
 
-static bool ParseNumberProperty(double *ret, std::string *err, const json &o,
-                                const std::string &property,
-                                const bool required,
-                                const std::string &parent_node = "") {
-  json_const_iterator it;
+static bool ParseUnsignedProperty(size_t *ret, std::string *err, const json &o,
+                                  const std::string &property,
+                                  const bool required,
+                                  const std::string &parent_node = "") {
+  return ParseUnsignedMember(ret, err, FindMember(o, property.c_str()),
+                             property.c_str(), required, parent_node.c_str());
+}
 
-  if (!FindMember(o, property.c_str(), it)) {
+static bool ParseNumberMember(double *ret, std::string *err,
+                              const json *member, const char *property,
+                              const bool required,
+                              const char *parent_node = "") {
+  if (!member) {
     if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
-      }
+      AppendMissingPropertyError(err, property, parent_node);
     }
     return false;
   }
 
   double numberValue;
-  bool isNumber = GetNumber(GetValue(it), numberValue);
+  bool isNumber = GetNumber(*member, numberValue);
 
   if (!isNumber) {
     if (required) {
       if (err) {
-        (*err) += "'" + property + "' property is not a number type.\n";
+        (*err) += "'" + std::string(property) +
+                  "' property is not a number type.\n";
       }
     }
     return false;
@@ -3403,30 +7938,32 @@ static bool ParseNumberProperty(double *ret, std::string *err, const json &o,
   return true;
 }
 
-static bool ParseNumberArrayProperty(std::vector<double> *ret, std::string *err,
-                                     const json &o, const std::string &property,
-                                     bool required,
-                                     const std::string &parent_node = "") {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
+static bool ParseNumberProperty(double *ret, std::string *err, const json &o,
+                                const std::string &property,
+                                const bool required,
+                                const std::string &parent_node = "") {
+  return ParseNumberMember(ret, err, FindMember(o, property.c_str()),
+                           property.c_str(), required, parent_node.c_str());
+}
+
+template <typename Alloc>
+static bool ParseNumberArrayMember(std::vector<double, Alloc> *ret,
+                                   std::string *err,
+                                   const json *member, const char *property,
+                                   bool required, const char *parent_node = "") {
+  if (!member) {
     if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
-      }
+      AppendMissingPropertyError(err, property, parent_node);
     }
     return false;
   }
 
-  if (!IsArray(GetValue(it))) {
+  if (!IsArray(*member)) {
     if (required) {
       if (err) {
-        (*err) += "'" + property + "' property is not an array";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
+        (*err) += "'" + std::string(property) + "' property is not an array";
+        if (parent_node[0] != '\0') {
+          (*err) += " in " + std::string(parent_node);
         }
         (*err) += ".\n";
       }
@@ -3435,16 +7972,18 @@ static bool ParseNumberArrayProperty(std::vector<double> *ret, std::string *err,
   }
 
   ret->clear();
-  auto end = ArrayEnd(GetValue(it));
-  for (auto i = ArrayBegin(GetValue(it)); i != end; ++i) {
+  ret->reserve(ArraySize(*member));
+  auto end = ArrayEnd(*member);
+  for (auto i = ArrayBegin(*member); i != end; ++i) {
     double numberValue;
     const bool isNumber = GetNumber(*i, numberValue);
     if (!isNumber) {
       if (required) {
         if (err) {
-          (*err) += "'" + property + "' property is not a number.\n";
-          if (!parent_node.empty()) {
-            (*err) += " in " + parent_node;
+          (*err) += "'" + std::string(property) +
+                    "' property is not a number.\n";
+          if (parent_node[0] != '\0') {
+            (*err) += " in " + std::string(parent_node);
           }
           (*err) += ".\n";
         }
@@ -3457,31 +7996,35 @@ static bool ParseNumberArrayProperty(std::vector<double> *ret, std::string *err,
   return true;
 }
 
-static bool ParseIntegerArrayProperty(std::vector<int> *ret, std::string *err,
-                                      const json &o,
-                                      const std::string &property,
-                                      bool required,
-                                      const std::string &parent_node = "") {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
+template <typename Alloc>
+static bool ParseNumberArrayProperty(std::vector<double, Alloc> *ret,
+                                     std::string *err,
+                                     const json &o, const std::string &property,
+                                     bool required,
+                                     const std::string &parent_node = "") {
+  return ParseNumberArrayMember(ret, err, FindMember(o, property.c_str()),
+                                property.c_str(), required,
+                                parent_node.c_str());
+}
+
+template <typename Alloc>
+static bool ParseIntegerArrayMember(std::vector<int, Alloc> *ret,
+                                    std::string *err,
+                                    const json *member, const char *property,
+                                    bool required, const char *parent_node = "") {
+  if (!member) {
     if (required) {
-      if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
-        }
-        (*err) += ".\n";
-      }
+      AppendMissingPropertyError(err, property, parent_node);
     }
     return false;
   }
 
-  if (!IsArray(GetValue(it))) {
+  if (!IsArray(*member)) {
     if (required) {
       if (err) {
-        (*err) += "'" + property + "' property is not an array";
-        if (!parent_node.empty()) {
-          (*err) += " in " + parent_node;
+        (*err) += "'" + std::string(property) + "' property is not an array";
+        if (parent_node[0] != '\0') {
+          (*err) += " in " + std::string(parent_node);
         }
         (*err) += ".\n";
       }
@@ -3490,16 +8033,18 @@ static bool ParseIntegerArrayProperty(std::vector<int> *ret, std::string *err,
   }
 
   ret->clear();
-  auto end = ArrayEnd(GetValue(it));
-  for (auto i = ArrayBegin(GetValue(it)); i != end; ++i) {
+  ret->reserve(ArraySize(*member));
+  auto end = ArrayEnd(*member);
+  for (auto i = ArrayBegin(*member); i != end; ++i) {
     int numberValue;
     bool isNumber = GetInt(*i, numberValue);
     if (!isNumber) {
       if (required) {
         if (err) {
-          (*err) += "'" + property + "' property is not an integer type.\n";
-          if (!parent_node.empty()) {
-            (*err) += " in " + parent_node;
+          (*err) += "'" + std::string(property) +
+                    "' property is not an integer type.\n";
+          if (parent_node[0] != '\0') {
+            (*err) += " in " + std::string(parent_node);
           }
           (*err) += ".\n";
         }
@@ -3512,19 +8057,28 @@ static bool ParseIntegerArrayProperty(std::vector<int> *ret, std::string *err,
   return true;
 }
 
-static bool ParseStringProperty(
-    std::string *ret, std::string *err, const json &o,
-    const std::string &property, bool required,
-    const std::string &parent_node = std::string()) {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
+template <typename Alloc>
+static bool ParseIntegerArrayProperty(std::vector<int, Alloc> *ret,
+                                      std::string *err, const json &o,
+                                      const std::string &property,
+                                      bool required,
+                                      const std::string &parent_node = "") {
+  return ParseIntegerArrayMember(ret, err, FindMember(o, property.c_str()),
+                                 property.c_str(), required,
+                                 parent_node.c_str());
+}
+
+static bool ParseStringMember(std::string *ret, std::string *err,
+                              const json *member, const char *property,
+                              bool required, const char *parent_node = "") {
+  if (!member) {
     if (required) {
       if (err) {
-        (*err) += "'" + property + "' property is missing";
-        if (parent_node.empty()) {
+        (*err) += "'" + std::string(property) + "' property is missing";
+        if (parent_node[0] == '\0') {
           (*err) += ".\n";
         } else {
-          (*err) += " in `" + parent_node + "'.\n";
+          (*err) += " in `" + std::string(parent_node) + "'.\n";
         }
       }
     }
@@ -3532,10 +8086,11 @@ static bool ParseStringProperty(
   }
 
   std::string strValue;
-  if (!GetString(GetValue(it), strValue)) {
+  if (!GetString(*member, strValue)) {
     if (required) {
       if (err) {
-        (*err) += "'" + property + "' property is not a string type.\n";
+        (*err) += "'" + std::string(property) +
+                  "' property is not a string type.\n";
       }
     }
     return false;
@@ -3548,33 +8103,32 @@ static bool ParseStringProperty(
   return true;
 }
 
-static bool ParseStringIntegerProperty(std::map<std::string, int> *ret,
-                                       std::string *err, const json &o,
-                                       const std::string &property,
-                                       bool required,
-                                       const std::string &parent = "") {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
+static bool ParseStringProperty(
+    std::string *ret, std::string *err, const json &o,
+    const std::string &property, bool required,
+    const std::string &parent_node = std::string()) {
+  return ParseStringMember(ret, err, FindMember(o, property.c_str()),
+                           property.c_str(), required, parent_node.c_str());
+}
+
+static bool ParseStringIntegerMember(StringMap<int> *ret, std::string *err,
+                                     const json *member, const char *property,
+                                     bool required, const char *parent = "") {
+  if (!member) {
     if (required) {
-      if (err) {
-        if (!parent.empty()) {
-          (*err) +=
-              "'" + property + "' property is missing in " + parent + ".\n";
-        } else {
-          (*err) += "'" + property + "' property is missing.\n";
-        }
-      }
+      AppendMissingPropertyError(err, property, parent);
     }
     return false;
   }
 
-  const json &dict = GetValue(it);
+  const json &dict = *member;
 
   // Make sure we are dealing with an object / dictionary.
   if (!IsObject(dict)) {
     if (required) {
       if (err) {
-        (*err) += "'" + property + "' property is not an object.\n";
+        (*err) += "'" + std::string(property) +
+                  "' property is not an object.\n";
       }
     }
     return false;
@@ -3590,7 +8144,8 @@ static bool ParseStringIntegerProperty(std::map<std::string, int> *ret,
     if (!GetInt(GetValue(dictIt), intVal)) {
       if (required) {
         if (err) {
-          (*err) += "'" + property + "' value is not an integer type.\n";
+          (*err) += "'" + std::string(property) +
+                    "' value is not an integer type.\n";
         }
       }
       return false;
@@ -3602,25 +8157,25 @@ static bool ParseStringIntegerProperty(std::map<std::string, int> *ret,
   return true;
 }
 
-static bool ParseJSONProperty(std::map<std::string, double> *ret,
-                              std::string *err, const json &o,
-                              const std::string &property, bool required) {
-  json_const_iterator it;
-  if (!FindMember(o, property.c_str(), it)) {
+static bool ParseJSONMember(std::map<std::string, double> *ret,
+                            std::string *err, const json *member,
+                            const char *property, bool required) {
+  if (!member) {
     if (required) {
       if (err) {
-        (*err) += "'" + property + "' property is missing. \n'";
+        (*err) += "'" + std::string(property) + "' property is missing. \n'";
       }
     }
     return false;
   }
 
-  const json &obj = GetValue(it);
+  const json &obj = *member;
 
   if (!IsObject(obj)) {
     if (required) {
       if (err) {
-        (*err) += "'" + property + "' property is not a JSON object.\n";
+        (*err) += "'" + std::string(property) +
+                  "' property is not a JSON object.\n";
       }
     }
     return false;
@@ -3639,27 +8194,29 @@ static bool ParseJSONProperty(std::map<std::string, double> *ret,
   return true;
 }
 
-static bool ParseParameterProperty(Parameter *param, std::string *err,
-                                   const json &o, const std::string &prop,
-                                   bool required) {
+static bool ParseParameterMember(Parameter *param, std::string *err,
+                                 const json *member, const char *prop,
+                                 bool required) {
   // A parameter value can either be a string or an array of either a boolean or
   // a number. Booleans of any kind aren't supported here. Granted, it
   // complicates the Parameter structure and breaks it semantically in the sense
   // that the client probably works off the assumption that if the string is
   // empty the vector is used, etc. Would a tagged union work?
-  if (ParseStringProperty(&param->string_value, err, o, prop, false)) {
+  if (ParseStringMember(&param->string_value, err, member, prop, false)) {
     // Found string property.
     return true;
-  } else if (ParseNumberArrayProperty(&param->number_array, err, o, prop,
-                                      false)) {
+  } else if (ParseNumberArrayMember(&param->number_array, err, member, prop,
+                                    false)) {
     // Found a number array.
     return true;
-  } else if (ParseNumberProperty(&param->number_value, err, o, prop, false)) {
-    return param->has_number_value = true;
-  } else if (ParseJSONProperty(&param->json_double_value, err, o, prop,
+  } else if (ParseNumberMember(&param->number_value, err, member, prop,
                                false)) {
+    return param->has_number_value = true;
+  } else if (ParseJSONMember(&param->json_double_value, err, member, prop,
+                             false)) {
     return true;
-  } else if (ParseBooleanProperty(&param->bool_value, err, o, prop, false)) {
+  } else if (ParseBooleanMember(&param->bool_value, err, member, prop,
+                                false)) {
     return true;
   } else {
     if (required) {
@@ -3671,16 +8228,44 @@ static bool ParseParameterProperty(Parameter *param, std::string *err,
   }
 }
 
+static bool ParseExtensionsObject(ExtensionMap *ret, const json &obj);
+
+static bool ParseExtensionsMember(ExtensionMap *ret, const json *member,
+                                  ExtrasMode extras_mode) {
+  if (extras_mode == EXTRAS_LAZY || !member) {
+    return false;
+  }
+
+  return ParseExtensionsObject(ret, *member);
+}
+
 static bool ParseExtensionsProperty(ExtensionMap *ret, std::string *err,
-                                    const json &o) {
+                                    const json &o, ExtrasMode extras_mode) {
   (void)err;
+  return ParseExtensionsMember(ret, FindMember(o, "extensions"), extras_mode);
+}
 
-  json_const_iterator it;
-  if (!FindMember(o, "extensions", it)) {
-    return false;
+// Parses the `extensions` and `extras` of `object`, and keeps their JSON with
+// EXTRAS_PARSE_STORE_JSON.
+template <typename T>
+static void ParseExtensionsAndExtras(T *object, const JsonMembers &members,
+                                     ExtrasMode extras_mode) {
+  const json *extensions = members[JSON_KEY_EXTENSIONS];
+  const json *extras = members[JSON_KEY_EXTRAS];
+  ParseExtensionsMember(&object->extensions, extensions, extras_mode);
+  ParseExtrasMember(&object->extras, extras, extras_mode);
+
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
+    if (extensions) {
+      object->extensions_json_string = JsonToString(*extensions);
+    }
+    if (extras) {
+      object->extras_json_string = JsonToString(*extras);
+    }
   }
+}
 
-  auto &obj = GetValue(it);
+static bool ParseExtensionsObject(ExtensionMap *ret, const json &obj) {
   if (!IsObject(obj)) {
     return false;
   }
@@ -3705,19 +8290,443 @@ static bool ParseExtensionsProperty(ExtensionMap *ret, std::string *err,
   return true;
 }
 
+namespace {
+
+const char *SkipJsonWhitespace(const char *p, const char *end) {
+  while (p < end &&
+         (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) {
+    ++p;
+  }
+  return p;
+}
+
+// `p` points to the opening quote. Returns the position after the closing
+// quote, or `end`.
+const char *SkipJsonString(const char *p, const char *end) {
+  for (++p; p < end; ++p) {
+    if (*p == '\\') {
+      ++p;
+    } else if (*p == '"') {
+      return p + 1;
+    }
+  }
+  return end;
+}
+
+// Skips the value at `p` without looking into it.
+const char *SkipJsonValue(const char *p, const char *end) {
+  int nesting = 0;
+  while (p < end) {
+    const char c = *p;
+    if (c == '"') {
+      p = SkipJsonString(p, end);
+    } else if (c == '{' || c == '[') {
+      ++nesting;
+      ++p;
+    } else if (c == '}' || c == ']') {
+      if (nesting == 0) return p;
+      --nesting;
+      ++p;
+    } else if (c == ',' && nesting == 0) {
+      return p;
+    } else {
+      ++p;
+    }
+    if (nesting == 0 && (c == '"' || c == '}' || c == ']')) {
+      return p;
+    }
+  }
+  return end;
+}
+
+// Whether `raw`, the text between the quotes of a JSON key, is `key`. The
+// escapes glTF may contain are decoded.
+bool JsonKeyEquals(const char *raw, size_t raw_length, const char *key,
+                   size_t key_length) {
+  size_t k = 0;
+  for (size_t i = 0; i < raw_length; i++, k++) {
+    char c = raw[i];
+    if (c == '\\' && i + 1 < raw_length &&
+        (raw[i + 1] == '"' || raw[i + 1] == '\\' || raw[i + 1] == '/')) {
+      c = raw[++i];
+    }
+    if (k >= key_length || key[k] != c) return false;
+  }
+  return k == key_length;
+}
+
+// Span of the root value of `json`, after the UTF-8 BOM the JSON parsers
+// accept.
+JsonSpan JsonRootSpan(const std::string &json) {
+  const char *end = json.data() + json.size();
+  const char *p = json.data();
+  if (json.compare(0, 3, "\xEF\xBB\xBF") == 0) p += 3;
+  p = SkipJsonWhitespace(p, end);
+  return JsonSpan{size_t(p - json.data()), size_t(SkipJsonValue(p, end) - p)};
+}
+
+// Calls `fn(key, key_length, value)` for each member of the JSON object at
+// `object` in `json`, `key` being the text between the quotes. Does nothing
+// when `object` is not an object.
+template <typename Fn>
+void ForEachJsonMember(const std::string &json, const JsonSpan &object,
+                       Fn fn) {
+  if (object.length == 0 || json[object.offset] != '{') return;
+  const char *p = json.data() + object.offset;
+  const char *end = p + object.length;
+  p = SkipJsonWhitespace(p + 1, end);
+  while (p < end && *p == '"') {
+    const char *key = p + 1;
+    p = SkipJsonString(p, end);
+    if (p >= end) return;
+    const size_t key_length = size_t(p - key) - 1;
+    p = SkipJsonWhitespace(p, end);
+    if (p < end && *p == ':') p = SkipJsonWhitespace(p + 1, end);
+
+    const char *value = p;
+    p = SkipJsonValue(p, end);
+    fn(key, key_length,
+       JsonSpan{size_t(value - json.data()), size_t(p - value)});
+
+    p = SkipJsonWhitespace(p, end);
+    if (p < end && *p == ',') p = SkipJsonWhitespace(p + 1, end);
+  }
+}
+
+// Calls `fn(value)` for each element of the JSON array at `array` in `json`.
+// Does nothing when `array` is not an array.
+template <typename Fn>
+void ForEachJsonElement(const std::string &json, const JsonSpan &array,
+                        Fn fn) {
+  if (array.length == 0 || json[array.offset] != '[') return;
+  const char *p = json.data() + array.offset;
+  const char *end = p + array.length;
+  p = SkipJsonWhitespace(p + 1, end);
+  while (p < end && *p != ']') {
+    const char *value = p;
+    p = SkipJsonValue(p, end);
+    if (p == value) return;  // Not a value.
+    fn(JsonSpan{size_t(value - json.data()), size_t(p - value)});
+
+    p = SkipJsonWhitespace(p, end);
+    if (p < end && *p == ',') p = SkipJsonWhitespace(p + 1, end);
+  }
+}
+
+// Span of the value of member `key` of the JSON object at `object` in
+// `json`. Zero length when it is absent.
+JsonSpan FindJsonMember(const std::string &json, const JsonSpan &object,
+                        const char *key, size_t key_length) {
+  JsonSpan member = {0, 0};
+  ForEachJsonMember(json, object,
+                    [&](const char *raw, size_t raw_length,
+                        const JsonSpan &value) {
+                      // The last one wins, like with the JSON parsers.
+                      if (JsonKeyEquals(raw, raw_length, key, key_length)) {
+                        member = value;
+                      }
+                    });
+  return member;
+}
+
+JsonSpan FindJsonMember(const std::string &json, const JsonSpan &object,
+                        const char *key) {
+  return FindJsonMember(json, object, key, strlen(key));
+}
+
+// Spans of the `extras` and `extensions` members of the JSON object at
+// `object` in `json`, zero length when absent.
+void FindJsonExtras(const std::string &json, const JsonSpan &object,
+                    JsonSpan *extras, JsonSpan *extensions) {
+  ForEachJsonMember(
+      json, object,
+      [&](const char *key, size_t key_length, const JsonSpan &value) {
+        if (JsonKeyEquals(key, key_length, "extras", 6)) {
+          *extras = value;
+        } else if (JsonKeyEquals(key, key_length, "extensions", 10)) {
+          *extensions = value;
+        }
+      });
+}
+
+// Span of the value at JSON pointer(RFC 6901) `pointer` in `json`, found by
+// walking `json`. Returns false when there is none.
+bool LocateJsonPointer(const std::string &json, const std::string &pointer,
+                       JsonSpan *value) {
+  JsonSpan current = JsonRootSpan(json);
+  std::string token;
+  size_t pos = 0;
+  while (pos < pointer.size() && current.length != 0) {
+    if (pointer[pos] != '/') return false;
+    size_t next = pointer.find('/', pos + 1);
+    if (next == std::string::npos) next = pointer.size();
+    token.clear();
+    for (size_t i = pos + 1; i < next; i++) {
+      if (pointer[i] == '~' && i + 1 < next &&
+          (pointer[i + 1] == '0' || pointer[i + 1] == '1')) {
+        token.push_back(pointer[++i] == '0' ? '~' : '/');
+      } else {
+        token.push_back(pointer[i]);
+      }
+    }
+    pos = next;
+
+    if (json[current.offset] == '{') {
+      current = FindJsonMember(json, current, token.data(), token.size());
+    } else if (json[current.offset] == '[' && !token.empty() &&
+               token.find_first_not_of("0123456789") == std::string::npos) {
+      const size_t index = size_t(std::strtoull(token.c_str(), nullptr, 10));
+      JsonSpan element = {0, 0};
+      size_t i = 0;
+      ForEachJsonElement(json, current, [&](const JsonSpan &e) {
+        if (i++ == index) element = e;
+      });
+      current = element;
+    } else {
+      return false;
+    }
+  }
+  *value = current;
+  return current.length != 0;
+}
+
+// Spans of the `extras` and `extensions` of the object at JSON pointer
+// `pointer` in `json`.
+void LocateJsonExtras(const std::string &json, const std::string &pointer,
+                      JsonSpan *extras, JsonSpan *extensions) {
+  *extras = JsonSpan{0, 0};
+  *extensions = JsonSpan{0, 0};
+  JsonSpan object;
+  if (LocateJsonPointer(json, pointer, &object)) {
+    FindJsonExtras(json, object, extras, extensions);
+  }
+}
+
+#if defined(TINYGLTF_USE_RAPIDJSON) && \
+    !defined(TINYGLTF_USE_RAPIDJSON_CRTALLOCATOR)
+// A JsonDocument is the single active document of the default RapidJSON
+// allocator, which a load or save on another thread may be using. Values are
+// only read here, so a plain rapidjson::Document is enough.
+typedef rapidjson::Document LazyJsonDocument;
+
+void ParseLazyJsonDocument(LazyJsonDocument &doc, const char *str,
+                           size_t length) {
+  doc.Parse(str, length);
+}
+#else
+typedef JsonDocument LazyJsonDocument;
+
+void ParseLazyJsonDocument(LazyJsonDocument &doc, const char *str,
+                           size_t length) {
+  JsonParse(doc, str, length);
+}
+#endif
+
+}  // namespace
+
+bool LazyJson::GetExtrasJson(const std::string &pointer,
+                             std::string *json) const {
+  JsonSpan extras;
+  JsonSpan extensions;
+  LocateJsonExtras(json_, pointer, &extras, &extensions);
+  if (extras.length == 0) return false;
+  if (json) json->assign(json_, extras.offset, extras.length);
+  return true;
+}
+
+bool LazyJson::GetExtensionsJson(const std::string &pointer,
+                                 std::string *json) const {
+  JsonSpan extras;
+  JsonSpan extensions;
+  LocateJsonExtras(json_, pointer, &extras, &extensions);
+  if (extensions.length == 0) return false;
+  if (json) json->assign(json_, extensions.offset, extensions.length);
+  return true;
+}
+
+void LazyJson::ParseExtras(const JsonSpan &span, Value *extras) const {
+  LazyJsonDocument doc;
+  ParseLazyJsonDocument(doc, json_.data() + span.offset, span.length);
+  Value value;
+  ParseJsonAsValue(&value, doc);
+  if (extras) (*extras) = std::move(value);
+}
+
+bool LazyJson::ParseExtensions(const JsonSpan &span,
+                               ExtensionMap *extensions) const {
+  LazyJsonDocument doc;
+  ParseLazyJsonDocument(doc, json_.data() + span.offset, span.length);
+  return ParseExtensionsObject(extensions, doc);
+}
+
+bool LazyJson::GetExtras(const std::string &pointer, Value *extras) const {
+  JsonSpan extras_span;
+  JsonSpan extensions_span;
+  LocateJsonExtras(json_, pointer, &extras_span, &extensions_span);
+  if (extras_span.length == 0) return false;
+  ParseExtras(extras_span, extras);
+  return true;
+}
+
+bool LazyJson::GetExtensions(const std::string &pointer,
+                             ExtensionMap *extensions) const {
+  JsonSpan extras_span;
+  JsonSpan extensions_span;
+  LocateJsonExtras(json_, pointer, &extras_span, &extensions_span);
+  if (extensions_span.length == 0) return false;
+  return ParseExtensions(extensions_span, extensions);
+}
+
+LazyExtras::LazyExtras(const std::shared_ptr<const LazyJson> &json,
+                       const std::string &pointer) {
+  if (!json) return;
+  LocateJsonExtras(json->Source(), pointer, &extras_, &extensions_);
+  if (HasExtras() || HasExtensions()) json_ = json;
+}
+
+LazyExtras::LazyExtras(const std::shared_ptr<const LazyJson> &json,
+                       const JsonSpan &object) {
+  if (!json) return;
+  FindJsonExtras(json->Source(), object, &extras_, &extensions_);
+  if (HasExtras() || HasExtensions()) json_ = json;
+}
+
+bool LazyExtras::GetExtras(Value *extras) const {
+  if (!HasExtras()) return false;
+  json_->ParseExtras(extras_, extras);
+  return true;
+}
+
+bool LazyExtras::GetExtensions(ExtensionMap *extensions) const {
+  if (!HasExtensions()) return false;
+  return json_->ParseExtensions(extensions_, extensions);
+}
+
+void LazyExtras::Load(Value *extras, ExtensionMap *extensions) {
+  if (extras && extras->Type() == NULL_TYPE) {
+    GetExtras(extras);
+  }
+  ExtensionMap lazy_extensions;
+  if (extensions && GetExtensions(&lazy_extensions)) {
+    for (auto &extension : lazy_extensions) {
+      if (extensions->find(extension.first) == extensions->end()) {
+        (*extensions)[extension.first] = std::move(extension.second);
+      }
+    }
+  }
+  Reset();
+}
+
+bool LazyExtras::operator==(const LazyExtras &other) const {
+  auto equal = [](const LazyExtras &a, const JsonSpan &a_span,
+                  const LazyExtras &b, const JsonSpan &b_span) {
+    return a_span.length == b_span.length &&
+           (a_span.length == 0 ||
+            a.json_->Source().compare(a_span.offset, a_span.length,
+                                      b.json_->Source(), b_span.offset,
+                                      b_span.length) == 0);
+  };
+  return equal(*this, extras_, other, other.extras_) &&
+         equal(*this, extensions_, other, other.extensions_);
+}
+
+namespace {
+
+// Spans of the elements of the arrays of a JSON object in a LazyJson. Each
+// array is split the first time one of its elements is asked for, so the
+// loaded objects find their span by their index.
+class LazyJsonArrays {
+ public:
+  LazyJsonArrays(const LazyJson *json, const JsonSpan &object)
+      : json_(json), object_(object) {}
+
+  // Span of element `index` of the array member `name`(a literal), zero
+  // length when absent.
+  JsonSpan Element(const char *name, size_t index) {
+    std::vector<JsonSpan> *elements = nullptr;
+    for (auto &array : arrays_) {
+      if (strcmp(array.first, name) == 0) elements = &array.second;
+    }
+    if (!elements) {
+      arrays_.emplace_back(name, std::vector<JsonSpan>());
+      elements = &arrays_.back().second;
+      if (json_) {
+        const std::string &source = json_->Source();
+        ForEachJsonElement(source, FindJsonMember(source, object_, name),
+                           [elements](const JsonSpan &element) {
+                             elements->push_back(element);
+                           });
+      }
+    }
+    return index < elements->size() ? (*elements)[index] : JsonSpan{0, 0};
+  }
+
+ private:
+  const LazyJson *json_;
+  JsonSpan object_;
+  std::vector<std::pair<const char *, std::vector<JsonSpan>>> arrays_;
+};
+
+}  // namespace
+
+// Attaches the lazily loaded `extras` and `extensions` of the JSON object at
+// `span` in `lazy` to `object`, and those of its nested objects.
+template <typename T>
+static void AttachLazyExtras(const std::shared_ptr<const LazyJson> &lazy,
+                             const JsonSpan &span, T *object) {
+  object->lazy_extras = LazyExtras(lazy, span);
+}
+
+static void AttachLazyExtras(const std::shared_ptr<const LazyJson> &lazy,
+                             const JsonSpan &span, Material *material) {
+  const std::string &source = lazy->Source();
+  const JsonSpan pbr_span =
+      FindJsonMember(source, span, "pbrMetallicRoughness");
+  PbrMetallicRoughness &pbr = material->pbrMetallicRoughness;
+  material->lazy_extras = LazyExtras(lazy, span);
+  pbr.lazy_extras = LazyExtras(lazy, pbr_span);
+  pbr.baseColorTexture.lazy_extras =
+      LazyExtras(lazy, FindJsonMember(source, pbr_span, "baseColorTexture"));
+  pbr.metallicRoughnessTexture.lazy_extras = LazyExtras(
+      lazy, FindJsonMember(source, pbr_span, "metallicRoughnessTexture"));
+  material->normalTexture.lazy_extras =
+      LazyExtras(lazy, FindJsonMember(source, span, "normalTexture"));
+  material->occlusionTexture.lazy_extras =
+      LazyExtras(lazy, FindJsonMember(source, span, "occlusionTexture"));
+  material->emissiveTexture.lazy_extras =
+      LazyExtras(lazy, FindJsonMember(source, span, "emissiveTexture"));
+}
+
+static void AttachLazyExtras(const std::shared_ptr<const LazyJson> &lazy,
+                             const JsonSpan &span, Camera *camera) {
+  const std::string &source = lazy->Source();
+  camera->lazy_extras = LazyExtras(lazy, span);
+  camera->perspective.lazy_extras =
+      LazyExtras(lazy, FindJsonMember(source, span, "perspective"));
+  camera->orthographic.lazy_extras =
+      LazyExtras(lazy, FindJsonMember(source, span, "orthographic"));
+}
+
+static void AttachLazyExtras(const std::shared_ptr<const LazyJson> &lazy,
+                             const JsonSpan &span, Light *light) {
+  light->lazy_extras = LazyExtras(lazy, span);
+  light->spot.lazy_extras =
+      LazyExtras(lazy, FindJsonMember(lazy->Source(), span, "spot"));
+}
+
 static bool ParseAsset(Asset *asset, std::string *err, const json &o,
-                       bool store_original_json_for_extras_and_extensions) {
+                       ExtrasMode extras_mode) {
   ParseStringProperty(&asset->version, err, o, "version", true, "Asset");
   ParseStringProperty(&asset->generator, err, o, "generator", false, "Asset");
   ParseStringProperty(&asset->minVersion, err, o, "minVersion", false, "Asset");
   ParseStringProperty(&asset->copyright, err, o, "copyright", false, "Asset");
 
-  ParseExtensionsProperty(&asset->extensions, err, o);
+  ParseExtensionsProperty(&asset->extensions, err, o, extras_mode);
 
   // Unity exporter version is added as extra here
-  ParseExtrasProperty(&(asset->extras), o);
+  ParseExtrasProperty(&(asset->extras), o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -3736,12 +8745,12 @@ static bool ParseAsset(Asset *asset, std::string *err, const json &o,
 }
 
 static bool ParseImage(Image *image, const int image_idx, std::string *err,
-                       std::string *warn, const json &o,
-                       bool store_original_json_for_extras_and_extensions,
+                       std::string *warn, const json &o, ExtrasMode extras_mode,
                        const std::string &basedir, FsCallbacks *fs,
-                       LoadImageDataFunction *LoadImageData = nullptr,
-                       void *load_image_user_data = nullptr) {
+                       std::vector<unsigned char> *encoded_image) {
   // A glTF image must either reference a bufferView or an image uri
+  // The image data loaded from `uri` is returned in `encoded_image` and is
+  // decoded by the caller.
 
   // schema says oneOf [`bufferView`, `uri`]
   // TODO(syoyo): Check the type of each parameters.
@@ -3771,10 +8780,10 @@ static bool ParseImage(Image *image, const int image_idx, std::string *err,
     return false;
   }
 
-  ParseExtensionsProperty(&image->extensions, err, o);
-  ParseExtrasProperty(&image->extras, o);
+  ParseExtensionsProperty(&image->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&image->extras, o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator eit;
       if (FindMember(o, "extensions", eit)) {
@@ -3872,19 +8881,12 @@ static bool ParseImage(Image *image, const int image_idx, std::string *err,
     }
   }
 
-  if (*LoadImageData == nullptr) {
-    if (err) {
-      (*err) += "No LoadImageData callback specified.\n";
-    }
-    return false;
-  }
-  return (*LoadImageData)(image, image_idx, err, warn, 0, 0, &img.at(0),
-                          static_cast<int>(img.size()), load_image_user_data);
+  encoded_image->swap(img);
+  return true;
 }
 
 static bool ParseTexture(Texture *texture, std::string *err, const json &o,
-                         bool store_original_json_for_extras_and_extensions,
-                         const std::string &basedir) {
+                         ExtrasMode extras_mode, const std::string &basedir) {
   (void)basedir;
   int sampler = -1;
   int source = -1;
@@ -3895,10 +8897,10 @@ static bool ParseTexture(Texture *texture, std::string *err, const json &o,
   texture->sampler = sampler;
   texture->source = source;
 
-  ParseExtensionsProperty(&texture->extensions, err, o);
-  ParseExtrasProperty(&texture->extras, o);
+  ParseExtensionsProperty(&texture->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&texture->extras, o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -3918,9 +8920,8 @@ static bool ParseTexture(Texture *texture, std::string *err, const json &o,
   return true;
 }
 
-static bool ParseTextureInfo(
-    TextureInfo *texinfo, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
+static bool ParseTextureInfo(TextureInfo *texinfo, std::string *err,
+                             const json &o, ExtrasMode extras_mode) {
   if (texinfo == nullptr) {
     return false;
   }
@@ -3932,10 +8933,10 @@ static bool ParseTextureInfo(
 
   ParseIntegerProperty(&texinfo->texCoord, err, o, "texCoord", false);
 
-  ParseExtensionsProperty(&texinfo->extensions, err, o);
-  ParseExtrasProperty(&texinfo->extras, o);
+  ParseExtensionsProperty(&texinfo->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&texinfo->extras, o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -3953,9 +8954,8 @@ static bool ParseTextureInfo(
   return true;
 }
 
-static bool ParseNormalTextureInfo(
-    NormalTextureInfo *texinfo, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
+static bool ParseNormalTextureInfo(NormalTextureInfo *texinfo, std::string *err,
+                                   const json &o, ExtrasMode extras_mode) {
   if (texinfo == nullptr) {
     return false;
   }
@@ -3968,10 +8968,10 @@ static bool ParseNormalTextureInfo(
   ParseIntegerProperty(&texinfo->texCoord, err, o, "texCoord", false);
   ParseNumberProperty(&texinfo->scale, err, o, "scale", false);
 
-  ParseExtensionsProperty(&texinfo->extensions, err, o);
-  ParseExtrasProperty(&texinfo->extras, o);
+  ParseExtensionsProperty(&texinfo->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&texinfo->extras, o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -3991,7 +8991,7 @@ static bool ParseNormalTextureInfo(
 
 static bool ParseOcclusionTextureInfo(
     OcclusionTextureInfo *texinfo, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
+    ExtrasMode extras_mode) {
   if (texinfo == nullptr) {
     return false;
   }
@@ -4004,10 +9004,10 @@ static bool ParseOcclusionTextureInfo(
   ParseIntegerProperty(&texinfo->texCoord, err, o, "texCoord", false);
   ParseNumberProperty(&texinfo->strength, err, o, "strength", false);
 
-  ParseExtensionsProperty(&texinfo->extensions, err, o);
-  ParseExtrasProperty(&texinfo->extras, o);
+  ParseExtensionsProperty(&texinfo->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&texinfo->extras, o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -4025,12 +9025,36 @@ static bool ParseOcclusionTextureInfo(
   return true;
 }
 
+static bool LoadExternalBuffer(Buffer *buffer, std::string *err,
+                               const std::string &basedir, size_t byteLength,
+                               FsCallbacks *fs) {
+  std::string decoded_uri = dlib::urldecode(buffer->uri);
+
+  if (fs && fs->MapWholeFile) {
+    // Reference the mapped file instead of reading it into `data`.
+    MappedFile mapped;
+    if (!MapExternalFile(&mapped, err, decoded_uri, basedir, byteLength,
+                         /* checkSize */ true, fs)) {
+      return false;
+    }
+    buffer->data.clear();
+    buffer->view_data = mapped.data;
+    buffer->view_size = mapped.size;
+    buffer->view_owner = mapped.owner;
+    return true;
+  }
+
+  return LoadExternalFile(&buffer->data, err, /* warn */ nullptr, decoded_uri,
+                          basedir, /* required */ true, byteLength,
+                          /* checkSize */ true, fs);
+}
+
 static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
-                        bool store_original_json_for_extras_and_extensions,
-                        FsCallbacks *fs, const std::string &basedir,
-                        bool is_binary = false,
+                        ExtrasMode extras_mode, FsCallbacks *fs,
+                        const std::string &basedir, bool is_binary = false,
                         const unsigned char *bin_data = nullptr,
-                        size_t bin_size = 0) {
+                        size_t bin_size = 0, bool zero_copy = false,
+                        const std::shared_ptr<void> &bin_owner = nullptr) {
   size_t byteLength;
   if (!ParseUnsignedProperty(&byteLength, err, o, "byteLength", true,
                              "Buffer")) {
@@ -4074,10 +9098,7 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
         }
       } else {
         // External .bin file.
-        std::string decoded_uri = dlib::urldecode(buffer->uri);
-        if (!LoadExternalFile(&buffer->data, err, /* warn */ nullptr,
-                              decoded_uri, basedir, /* required */ true,
-                              byteLength, /* checkSize */ true, fs)) {
+        if (!LoadExternalBuffer(buffer, err, basedir, byteLength, fs)) {
           return false;
         }
       }
@@ -4102,9 +9123,19 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
         return false;
       }
 
-      // Read buffer data
-      buffer->data.resize(static_cast<size_t>(byteLength));
-      memcpy(&(buffer->data.at(0)), bin_data, static_cast<size_t>(byteLength));
+      if (zero_copy) {
+        // Reference the binary chunk. Its lifetime is managed by the caller
+        // or by `bin_owner`.
+        buffer->data.clear();
+        buffer->view_data = bin_data;
+        buffer->view_size = static_cast<size_t>(byteLength);
+        buffer->view_owner = bin_owner;
+      } else {
+        // Read buffer data
+        buffer->data.resize(static_cast<size_t>(byteLength));
+        memcpy(&(buffer->data.at(0)), bin_data,
+               static_cast<size_t>(byteLength));
+      }
     }
 
   } else {
@@ -4119,10 +9150,7 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
       }
     } else {
       // Assume external .bin file.
-      std::string decoded_uri = dlib::urldecode(buffer->uri);
-      if (!LoadExternalFile(&buffer->data, err, /* warn */ nullptr, decoded_uri,
-                            basedir, /* required */ true, byteLength,
-                            /* checkSize */ true, fs)) {
+      if (!LoadExternalBuffer(buffer, err, basedir, byteLength, fs)) {
         return false;
       }
     }
@@ -4130,10 +9158,10 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
 
   ParseStringProperty(&buffer->name, err, o, "name", false);
 
-  ParseExtensionsProperty(&buffer->extensions, err, o);
-  ParseExtrasProperty(&buffer->extras, o);
+  ParseExtensionsProperty(&buffer->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&buffer->extras, o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -4151,25 +9179,29 @@ static bool ParseBuffer(Buffer *buffer, std::string *err, const json &o,
   return true;
 }
 
-static bool ParseBufferView(
-    BufferView *bufferView, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
+static bool ParseBufferView(BufferView *bufferView, std::string *err,
+                            const json &o, ExtrasMode extras_mode) {
+  const JsonMembers members(o);
+
   int buffer = -1;
-  if (!ParseIntegerProperty(&buffer, err, o, "buffer", true, "BufferView")) {
+  if (!ParseIntegerMember(&buffer, err, members[JSON_KEY_BUFFER], "buffer",
+                          true, "BufferView")) {
     return false;
   }
 
   size_t byteOffset = 0;
-  ParseUnsignedProperty(&byteOffset, err, o, "byteOffset", false);
+  ParseUnsignedMember(&byteOffset, err, members[JSON_KEY_BYTE_OFFSET],
+                      "byteOffset", false);
 
   size_t byteLength = 1;
-  if (!ParseUnsignedProperty(&byteLength, err, o, "byteLength", true,
-                             "BufferView")) {
+  if (!ParseUnsignedMember(&byteLength, err, members[JSON_KEY_BYTE_LENGTH],
+                           "byteLength", true, "BufferView")) {
     return false;
   }
 
   size_t byteStride = 0;
-  if (!ParseUnsignedProperty(&byteStride, err, o, "byteStride", false)) {
+  if (!ParseUnsignedMember(&byteStride, err, members[JSON_KEY_BYTE_STRIDE],
+                           "byteStride", false)) {
     // Spec says: When byteStride of referenced bufferView is not defined, it
     // means that accessor elements are tightly packed, i.e., effective stride
     // equals the size of the element.
@@ -4191,7 +9223,7 @@ static bool ParseBufferView(
   }
 
   int target = 0;
-  ParseIntegerProperty(&target, err, o, "target", false);
+  ParseIntegerMember(&target, err, members[JSON_KEY_TARGET], "target", false);
   if ((target == TINYGLTF_TARGET_ARRAY_BUFFER) ||
       (target == TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER)) {
     // OK
@@ -4200,25 +9232,10 @@ static bool ParseBufferView(
   }
   bufferView->target = target;
 
-  ParseStringProperty(&bufferView->name, err, o, "name", false);
+  ParseStringMember(&bufferView->name, err, members[JSON_KEY_NAME], "name",
+                    false);
 
-  ParseExtensionsProperty(&bufferView->extensions, err, o);
-  ParseExtrasProperty(&bufferView->extras, o);
-
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        bufferView->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        bufferView->extras_json_string = JsonToString(GetValue(it));
-      }
-    }
-  }
+  ParseExtensionsAndExtras(bufferView, members, extras_mode);
 
   bufferView->buffer = buffer;
   bufferView->byteOffset = byteOffset;
@@ -4253,7 +9270,7 @@ static bool ParseSparseAccessor(Accessor *accessor, std::string *err,
   ParseIntegerProperty(&indices_buffer_view, err, indices_obj, "bufferView",
                        true);
   ParseIntegerProperty(&indices_byte_offset, err, indices_obj, "byteOffset",
-                       true);
+                       false);
   ParseIntegerProperty(&component_type, err, indices_obj, "componentType",
                        true);
 
@@ -4261,7 +9278,7 @@ static bool ParseSparseAccessor(Accessor *accessor, std::string *err,
   ParseIntegerProperty(&values_buffer_view, err, values_obj, "bufferView",
                        true);
   ParseIntegerProperty(&values_byte_offset, err, values_obj, "byteOffset",
-                       true);
+                       false);
 
   accessor->sparse.count = count;
   accessor->sparse.indices.bufferView = indices_buffer_view;
@@ -4270,35 +9287,53 @@ static bool ParseSparseAccessor(Accessor *accessor, std::string *err,
   accessor->sparse.values.bufferView = values_buffer_view;
   accessor->sparse.values.byteOffset = values_byte_offset;
 
-  // todo check theses values
+  if ((component_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) &&
+      (component_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) &&
+      (component_type != TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)) {
+    std::stringstream ss;
+    ss << "Invalid `componentType` in sparse accessor indices. Got "
+       << component_type << "\n";
+    if (err) {
+      (*err) += ss.str();
+    }
+    return false;
+  }
 
   return true;
 }
 
 static bool ParseAccessor(Accessor *accessor, std::string *err, const json &o,
-                          bool store_original_json_for_extras_and_extensions) {
+                          ExtrasMode extras_mode) {
+  const JsonMembers members(o);
+
   int bufferView = -1;
-  ParseIntegerProperty(&bufferView, err, o, "bufferView", false, "Accessor");
+  ParseIntegerMember(&bufferView, err, members[JSON_KEY_BUFFER_VIEW],
+                     "bufferView", false, "Accessor");
 
   size_t byteOffset = 0;
-  ParseUnsignedProperty(&byteOffset, err, o, "byteOffset", false, "Accessor");
+  ParseUnsignedMember(&byteOffset, err, members[JSON_KEY_BYTE_OFFSET],
+                      "byteOffset", false, "Accessor");
 
   bool normalized = false;
-  ParseBooleanProperty(&normalized, err, o, "normalized", false, "Accessor");
+  ParseBooleanMember(&normalized, err, members[JSON_KEY_NORMALIZED],
+                     "normalized", false, "Accessor");
 
   size_t componentType = 0;
-  if (!ParseUnsignedProperty(&componentType, err, o, "componentType", true,
-                             "Accessor")) {
+  if (!ParseUnsignedMember(&componentType, err,
+                           members[JSON_KEY_COMPONENT_TYPE], "componentType",
+                           true, "Accessor")) {
     return false;
   }
 
   size_t count = 0;
-  if (!ParseUnsignedProperty(&count, err, o, "count", true, "Accessor")) {
+  if (!ParseUnsignedMember(&count, err, members[JSON_KEY_COUNT], "count", true,
+                           "Accessor")) {
     return false;
   }
 
   std::string type;
-  if (!ParseStringProperty(&type, err, o, "type", true, "Accessor")) {
+  if (!ParseStringMember(&type, err, members[JSON_KEY_TYPE], "type", true,
+                         "Accessor")) {
     return false;
   }
 
@@ -4325,15 +9360,16 @@ static bool ParseAccessor(Accessor *accessor, std::string *err, const json &o,
     return false;
   }
 
-  ParseStringProperty(&accessor->name, err, o, "name", false);
+  ParseStringMember(&accessor->name, err, members[JSON_KEY_NAME], "name",
+                    false);
 
   accessor->minValues.clear();
   accessor->maxValues.clear();
-  ParseNumberArrayProperty(&accessor->minValues, err, o, "min", false,
-                           "Accessor");
+  ParseNumberArrayMember(&accessor->minValues, err, members[JSON_KEY_MIN],
+                         "min", false, "Accessor");
 
-  ParseNumberArrayProperty(&accessor->maxValues, err, o, "max", false,
-                           "Accessor");
+  ParseNumberArrayMember(&accessor->maxValues, err, members[JSON_KEY_MAX],
+                         "max", false, "Accessor");
 
   accessor->count = count;
   accessor->bufferView = bufferView;
@@ -4355,29 +9391,12 @@ static bool ParseAccessor(Accessor *accessor, std::string *err, const json &o,
     }
   }
 
-  ParseExtensionsProperty(&(accessor->extensions), err, o);
-  ParseExtrasProperty(&(accessor->extras), o);
-
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        accessor->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        accessor->extras_json_string = JsonToString(GetValue(it));
-      }
-    }
-  }
+  ParseExtensionsAndExtras(accessor, members, extras_mode);
 
   // check if accessor has a "sparse" object:
-  json_const_iterator iterator;
-  if (FindMember(o, "sparse", iterator)) {
+  if (members[JSON_KEY_SPARSE]) {
     // here this accessor has a "sparse" subobject
-    return ParseSparseAccessor(accessor, err, GetValue(iterator));
+    return ParseSparseAccessor(accessor, err, *members[JSON_KEY_SPARSE]);
   }
 
   return true;
@@ -4495,7 +9514,7 @@ static bool ParseDracoExtension(Primitive *primitive, Model *model,
   view.dracoDecoded = true;
 
   const char *bufferViewData =
-      reinterpret_cast<const char *>(buffer.data.data() + view.byteOffset);
+      reinterpret_cast<const char *>(buffer.DataPtr() + view.byteOffset);
   size_t bufferViewSize = view.byteLength;
 
   // decode draco
@@ -4576,32 +9595,35 @@ static bool ParseDracoExtension(Primitive *primitive, Model *model,
 #endif
 
 static bool ParsePrimitive(Primitive *primitive, Model *model, std::string *err,
-                           const json &o,
-                           bool store_original_json_for_extras_and_extensions) {
+                           const json &o, ExtrasMode extras_mode) {
+  const JsonMembers members(o);
+
   int material = -1;
-  ParseIntegerProperty(&material, err, o, "material", false);
+  ParseIntegerMember(&material, err, members[JSON_KEY_MATERIAL], "material",
+                     false);
   primitive->material = material;
 
   int mode = TINYGLTF_MODE_TRIANGLES;
-  ParseIntegerProperty(&mode, err, o, "mode", false);
+  ParseIntegerMember(&mode, err, members[JSON_KEY_MODE], "mode", false);
   primitive->mode = mode;  // Why only triangled were supported ?
 
   int indices = -1;
-  ParseIntegerProperty(&indices, err, o, "indices", false);
+  ParseIntegerMember(&indices, err, members[JSON_KEY_INDICES], "indices",
+                     false);
   primitive->indices = indices;
-  if (!ParseStringIntegerProperty(&primitive->attributes, err, o, "attributes",
-                                  true, "Primitive")) {
+  if (!ParseStringIntegerMember(&primitive->attributes, err,
+                                members[JSON_KEY_ATTRIBUTES], "attributes",
+                                true, "Primitive")) {
     return false;
   }
 
   // Look for morph targets
-  json_const_iterator targetsObject;
-  if (FindMember(o, "targets", targetsObject) &&
-      IsArray(GetValue(targetsObject))) {
-    auto targetsObjectEnd = ArrayEnd(GetValue(targetsObject));
-    for (json_const_array_iterator i = ArrayBegin(GetValue(targetsObject));
+  const json *targetsObject = members[JSON_KEY_TARGETS];
+  if (targetsObject && IsArray(*targetsObject)) {
+    auto targetsObjectEnd = ArrayEnd(*targetsObject);
+    for (json_const_array_iterator i = ArrayBegin(*targetsObject);
          i != targetsObjectEnd; ++i) {
-      std::map<std::string, int> targetAttribues;
+      StringMap<int> targetAttribues;
 
       const json &dict = *i;
       if (IsObject(dict)) {
@@ -4618,23 +9640,14 @@ static bool ParsePrimitive(Primitive *primitive, Model *model, std::string *err,
     }
   }
 
-  ParseExtrasProperty(&(primitive->extras), o);
-  ParseExtensionsProperty(&primitive->extensions, err, o);
-
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        primitive->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        primitive->extras_json_string = JsonToString(GetValue(it));
-      }
-    }
+  ParseExtensionsAndExtras(primitive, members, extras_mode);
+#ifdef TINYGLTF_ENABLE_DRACO
+  // KHR_draco_mesh_compression is needed below.
+  if (extras_mode == EXTRAS_LAZY) {
+    ParseExtensionsMember(&primitive->extensions,
+                          members[JSON_KEY_EXTENSIONS], EXTRAS_PARSE);
   }
+#endif
 
 #ifdef TINYGLTF_ENABLE_DRACO
   auto dracoExtension =
@@ -4649,20 +9662,31 @@ static bool ParsePrimitive(Primitive *primitive, Model *model, std::string *err,
   return true;
 }
 
+// With EXTRAS_LAZY, `span` is the location of the mesh in `lazy`.
 static bool ParseMesh(Mesh *mesh, Model *model, std::string *err, const json &o,
-                      bool store_original_json_for_extras_and_extensions) {
-  ParseStringProperty(&mesh->name, err, o, "name", false);
+                      ExtrasMode extras_mode,
+                      const std::shared_ptr<const LazyJson> &lazy,
+                      const JsonSpan &span) {
+  const JsonMembers members(o);
+
+  ParseStringMember(&mesh->name, err, members[JSON_KEY_NAME], "name", false);
 
   mesh->primitives.clear();
-  json_const_iterator primObject;
-  if (FindMember(o, "primitives", primObject) &&
-      IsArray(GetValue(primObject))) {
-    json_const_array_iterator primEnd = ArrayEnd(GetValue(primObject));
-    for (json_const_array_iterator i = ArrayBegin(GetValue(primObject));
-         i != primEnd; ++i) {
+  const json *primObject = members[JSON_KEY_PRIMITIVES];
+  if (primObject && IsArray(*primObject)) {
+    mesh->primitives.reserve(ArraySize(*primObject));
+    json_const_array_iterator primEnd = ArrayEnd(*primObject);
+    LazyJsonArrays lazy_arrays(lazy.get(), span);
+    size_t index = 0;
+    for (json_const_array_iterator i = ArrayBegin(*primObject); i != primEnd;
+         ++i, ++index) {
       Primitive primitive;
-      if (ParsePrimitive(&primitive, model, err, *i,
-                         store_original_json_for_extras_and_extensions)) {
+      if (ParsePrimitive(&primitive, model, err, *i, extras_mode)) {
+        if (lazy) {
+          // By the source index, as failed primitives are skipped.
+          AttachLazyExtras(lazy, lazy_arrays.Element("primitives", index),
+                           &primitive);
+        }
         // Only add the primitive if the parsing succeeds.
         mesh->primitives.emplace_back(std::move(primitive));
       }
@@ -4670,88 +9694,73 @@ static bool ParseMesh(Mesh *mesh, Model *model, std::string *err, const json &o,
   }
 
   // Should probably check if has targets and if dimensions fit
-  ParseNumberArrayProperty(&mesh->weights, err, o, "weights", false);
-
-  ParseExtensionsProperty(&mesh->extensions, err, o);
-  ParseExtrasProperty(&(mesh->extras), o);
+  ParseNumberArrayMember(&mesh->weights, err, members[JSON_KEY_WEIGHTS],
+                         "weights", false);
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        mesh->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        mesh->extras_json_string = JsonToString(GetValue(it));
-      }
-    }
+  ParseExtensionsAndExtras(mesh, members, extras_mode);
+  if (lazy) {
+    AttachLazyExtras(lazy, span, mesh);
   }
 
   return true;
 }
 
 static bool ParseNode(Node *node, std::string *err, const json &o,
-                      bool store_original_json_for_extras_and_extensions) {
-  ParseStringProperty(&node->name, err, o, "name", false);
+                      ExtrasMode extras_mode) {
+  const JsonMembers members(o);
+
+  ParseStringMember(&node->name, err, members[JSON_KEY_NAME], "name", false);
 
   int skin = -1;
-  ParseIntegerProperty(&skin, err, o, "skin", false);
+  ParseIntegerMember(&skin, err, members[JSON_KEY_SKIN], "skin", false);
   node->skin = skin;
 
   // Matrix and T/R/S are exclusive
-  if (!ParseNumberArrayProperty(&node->matrix, err, o, "matrix", false)) {
-    ParseNumberArrayProperty(&node->rotation, err, o, "rotation", false);
-    ParseNumberArrayProperty(&node->scale, err, o, "scale", false);
-    ParseNumberArrayProperty(&node->translation, err, o, "translation", false);
+  if (!ParseNumberArrayMember(&node->matrix, err, members[JSON_KEY_MATRIX],
+                              "matrix", false)) {
+    ParseNumberArrayMember(&node->rotation, err, members[JSON_KEY_ROTATION],
+                           "rotation", false);
+    ParseNumberArrayMember(&node->scale, err, members[JSON_KEY_SCALE], "scale",
+                           false);
+    ParseNumberArrayMember(&node->translation, err,
+                           members[JSON_KEY_TRANSLATION], "translation",
+                           false);
   }
 
   int camera = -1;
-  ParseIntegerProperty(&camera, err, o, "camera", false);
+  ParseIntegerMember(&camera, err, members[JSON_KEY_CAMERA], "camera", false);
   node->camera = camera;
 
   int mesh = -1;
-  ParseIntegerProperty(&mesh, err, o, "mesh", false);
+  ParseIntegerMember(&mesh, err, members[JSON_KEY_MESH], "mesh", false);
   node->mesh = mesh;
 
   node->children.clear();
-  ParseIntegerArrayProperty(&node->children, err, o, "children", false);
-
-  ParseNumberArrayProperty(&node->weights, err, o, "weights", false);
+  ParseIntegerArrayMember(&node->children, err, members[JSON_KEY_CHILDREN],
+                          "children", false);
 
-  ParseExtensionsProperty(&node->extensions, err, o);
-  ParseExtrasProperty(&(node->extras), o);
+  ParseNumberArrayMember(&node->weights, err, members[JSON_KEY_WEIGHTS],
+                         "weights", false);
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        node->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        node->extras_json_string = JsonToString(GetValue(it));
-      }
-    }
-  }
+  ParseExtensionsAndExtras(node, members, extras_mode);
 
   return true;
 }
 
 static bool ParsePbrMetallicRoughness(
     PbrMetallicRoughness *pbr, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
+    ExtrasMode extras_mode) {
   if (pbr == nullptr) {
     return false;
   }
 
-  std::vector<double> baseColorFactor;
-  if (ParseNumberArrayProperty(&baseColorFactor, err, o, "baseColorFactor",
-                               /* required */ false)) {
+  const JsonMembers members(o);
+
+  ModelVector<double> baseColorFactor;
+  if (ParseNumberArrayMember(&baseColorFactor, err,
+                             members[JSON_KEY_BASE_COLOR_FACTOR],
+                             "baseColorFactor",
+                             /* required */ false)) {
     if (baseColorFactor.size() != 4) {
       if (err) {
         (*err) +=
@@ -4761,56 +9770,43 @@ static bool ParsePbrMetallicRoughness(
       }
       return false;
     }
-    pbr->baseColorFactor = baseColorFactor;
-  }
-
-  {
-    json_const_iterator it;
-    if (FindMember(o, "baseColorTexture", it)) {
-      ParseTextureInfo(&pbr->baseColorTexture, err, GetValue(it),
-                       store_original_json_for_extras_and_extensions);
-    }
-  }
-
-  {
-    json_const_iterator it;
-    if (FindMember(o, "metallicRoughnessTexture", it)) {
-      ParseTextureInfo(&pbr->metallicRoughnessTexture, err, GetValue(it),
-                       store_original_json_for_extras_and_extensions);
-    }
+    pbr->baseColorFactor = std::move(baseColorFactor);
   }
 
-  ParseNumberProperty(&pbr->metallicFactor, err, o, "metallicFactor", false);
-  ParseNumberProperty(&pbr->roughnessFactor, err, o, "roughnessFactor", false);
-
-  ParseExtensionsProperty(&pbr->extensions, err, o);
-  ParseExtrasProperty(&pbr->extras, o);
+  if (members[JSON_KEY_BASE_COLOR_TEXTURE]) {
+    ParseTextureInfo(&pbr->baseColorTexture, err,
+                     *members[JSON_KEY_BASE_COLOR_TEXTURE], extras_mode);
+  }
 
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        pbr->extensions_json_string = JsonToString(GetValue(it));
-      }
-    }
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extras", it)) {
-        pbr->extras_json_string = JsonToString(GetValue(it));
-      }
-    }
+  if (members[JSON_KEY_METALLIC_ROUGHNESS_TEXTURE]) {
+    ParseTextureInfo(&pbr->metallicRoughnessTexture, err,
+                     *members[JSON_KEY_METALLIC_ROUGHNESS_TEXTURE],
+                     extras_mode);
   }
 
+  ParseNumberMember(&pbr->metallicFactor, err,
+                    members[JSON_KEY_METALLIC_FACTOR], "metallicFactor",
+                    false);
+  ParseNumberMember(&pbr->roughnessFactor, err,
+                    members[JSON_KEY_ROUGHNESS_FACTOR], "roughnessFactor",
+                    false);
+
+  ParseExtensionsAndExtras(pbr, members, extras_mode);
+
   return true;
 }
 
 static bool ParseMaterial(Material *material, std::string *err, const json &o,
-                          bool store_original_json_for_extras_and_extensions) {
-  ParseStringProperty(&material->name, err, o, "name", /* required */ false);
+                          ExtrasMode extras_mode) {
+  const JsonMembers members(o);
 
-  if (ParseNumberArrayProperty(&material->emissiveFactor, err, o,
-                               "emissiveFactor",
-                               /* required */ false)) {
+  ParseStringMember(&material->name, err, members[JSON_KEY_NAME], "name",
+                    /* required */ false);
+
+  if (ParseNumberArrayMember(&material->emissiveFactor, err,
+                             members[JSON_KEY_EMISSIVE_FACTOR],
+                             "emissiveFactor",
+                             /* required */ false)) {
     if (material->emissiveFactor.size() != 3) {
       if (err) {
         (*err) +=
@@ -4825,44 +9821,35 @@ static bool ParseMaterial(Material *material, std::string *err, const json &o,
     material->emissiveFactor = {0.0, 0.0, 0.0};
   }
 
-  ParseStringProperty(&material->alphaMode, err, o, "alphaMode",
-                      /* required */ false);
-  ParseNumberProperty(&material->alphaCutoff, err, o, "alphaCutoff",
-                      /* required */ false);
-  ParseBooleanProperty(&material->doubleSided, err, o, "doubleSided",
-                       /* required */ false);
+  ParseStringMember(&material->alphaMode, err, members[JSON_KEY_ALPHA_MODE],
+                    "alphaMode", /* required */ false);
+  ParseNumberMember(&material->alphaCutoff, err,
+                    members[JSON_KEY_ALPHA_CUTOFF], "alphaCutoff",
+                    /* required */ false);
+  ParseBooleanMember(&material->doubleSided, err,
+                     members[JSON_KEY_DOUBLE_SIDED], "doubleSided",
+                     /* required */ false);
 
-  {
-    json_const_iterator it;
-    if (FindMember(o, "pbrMetallicRoughness", it)) {
-      ParsePbrMetallicRoughness(&material->pbrMetallicRoughness, err,
-                                GetValue(it),
-                                store_original_json_for_extras_and_extensions);
-    }
+  if (members[JSON_KEY_PBR_METALLIC_ROUGHNESS]) {
+    ParsePbrMetallicRoughness(&material->pbrMetallicRoughness, err,
+                              *members[JSON_KEY_PBR_METALLIC_ROUGHNESS],
+                              extras_mode);
   }
 
-  {
-    json_const_iterator it;
-    if (FindMember(o, "normalTexture", it)) {
-      ParseNormalTextureInfo(&material->normalTexture, err, GetValue(it),
-                             store_original_json_for_extras_and_extensions);
-    }
+  if (members[JSON_KEY_NORMAL_TEXTURE]) {
+    ParseNormalTextureInfo(&material->normalTexture, err,
+                           *members[JSON_KEY_NORMAL_TEXTURE], extras_mode);
   }
 
-  {
-    json_const_iterator it;
-    if (FindMember(o, "occlusionTexture", it)) {
-      ParseOcclusionTextureInfo(&material->occlusionTexture, err, GetValue(it),
-                                store_original_json_for_extras_and_extensions);
-    }
+  if (members[JSON_KEY_OCCLUSION_TEXTURE]) {
+    ParseOcclusionTextureInfo(&material->occlusionTexture, err,
+                              *members[JSON_KEY_OCCLUSION_TEXTURE],
+                              extras_mode);
   }
 
-  {
-    json_const_iterator it;
-    if (FindMember(o, "emissiveTexture", it)) {
-      ParseTextureInfo(&material->emissiveTexture, err, GetValue(it),
-                       store_original_json_for_extras_and_extensions);
-    }
+  if (members[JSON_KEY_EMISSIVE_TEXTURE]) {
+    ParseTextureInfo(&material->emissiveTexture, err,
+                     *members[JSON_KEY_EMISSIVE_TEXTURE], extras_mode);
   }
 
   // Old code path. For backward compatibility, we still store material values
@@ -4887,9 +9874,10 @@ static bool ParseMaterial(Material *material, std::string *err, const json &o,
 
         for (; itVal != itValEnd; ++itVal) {
           Parameter param;
-          if (ParseParameterProperty(&param, err, values_object, GetKey(itVal),
-                                     false)) {
-            material->values.emplace(GetKey(itVal), std::move(param));
+          std::string valueKey(GetKey(itVal));
+          if (ParseParameterMember(&param, err, &GetValue(itVal),
+                                   valueKey.c_str(), false)) {
+            material->values.emplace(std::move(valueKey), std::move(param));
           }
         }
       }
@@ -4898,7 +9886,8 @@ static bool ParseMaterial(Material *material, std::string *err, const json &o,
       // parametermap and serialized again later
     } else {
       Parameter param;
-      if (ParseParameterProperty(&param, err, o, key, false)) {
+      if (ParseParameterMember(&param, err, &GetValue(it), key.c_str(),
+                               false)) {
         // names of materials have already been parsed. Putting it in this map
         // doesn't correctly reflext the glTF specification
         if (key != "name")
@@ -4908,30 +9897,13 @@ static bool ParseMaterial(Material *material, std::string *err, const json &o,
   }
 
   material->extensions.clear();
-  ParseExtensionsProperty(&material->extensions, err, o);
-  ParseExtrasProperty(&(material->extras), o);
-
-  if (store_original_json_for_extras_and_extensions) {
-    {
-      json_const_iterator eit;
-      if (FindMember(o, "extensions", eit)) {
-        material->extensions_json_string = JsonToString(GetValue(eit));
-      }
-    }
-    {
-      json_const_iterator eit;
-      if (FindMember(o, "extras", eit)) {
-        material->extras_json_string = JsonToString(GetValue(eit));
-      }
-    }
-  }
+  ParseExtensionsAndExtras(material, members, extras_mode);
 
   return true;
 }
 
-static bool ParseAnimationChannel(
-    AnimationChannel *channel, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
+static bool ParseAnimationChannel(AnimationChannel *channel, std::string *err,
+                                  const json &o, ExtrasMode extras_mode) {
   int samplerIndex = -1;
   int targetIndex = -1;
   if (!ParseIntegerProperty(&samplerIndex, err, o, "sampler", true,
@@ -4960,8 +9932,9 @@ static bool ParseAnimationChannel(
       }
       return false;
     }
-    ParseExtensionsProperty(&channel->target_extensions, err, target_object);
-    if (store_original_json_for_extras_and_extensions) {
+    ParseExtensionsProperty(&channel->target_extensions, err, target_object,
+                            extras_mode);
+    if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
       json_const_iterator it;
       if (FindMember(target_object, "extensions", it)) {
         channel->target_extensions_json_string = JsonToString(GetValue(it));
@@ -4972,10 +9945,10 @@ static bool ParseAnimationChannel(
   channel->sampler = samplerIndex;
   channel->target_node = targetIndex;
 
-  ParseExtensionsProperty(&channel->extensions, err, o);
-  ParseExtrasProperty(&(channel->extras), o);
+  ParseExtensionsProperty(&channel->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&(channel->extras), o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -4993,20 +9966,30 @@ static bool ParseAnimationChannel(
   return true;
 }
 
+// With EXTRAS_LAZY, `span` is the location of the animation in `lazy`.
 static bool ParseAnimation(Animation *animation, std::string *err,
-                           const json &o,
-                           bool store_original_json_for_extras_and_extensions) {
+                           const json &o, ExtrasMode extras_mode,
+                           const std::shared_ptr<const LazyJson> &lazy,
+                           const JsonSpan &span) {
+  LazyJsonArrays lazy_arrays(lazy.get(), span);
   {
     json_const_iterator channelsIt;
     if (FindMember(o, "channels", channelsIt) &&
         IsArray(GetValue(channelsIt))) {
       json_const_array_iterator channelEnd = ArrayEnd(GetValue(channelsIt));
+      size_t index = 0;
       for (json_const_array_iterator i = ArrayBegin(GetValue(channelsIt));
-           i != channelEnd; ++i) {
+           i != channelEnd; ++i, ++index) {
         AnimationChannel channel;
-        if (ParseAnimationChannel(
-                &channel, err, *i,
-                store_original_json_for_extras_and_extensions)) {
+        if (ParseAnimationChannel(&channel, err, *i, extras_mode)) {
+          if (lazy) {
+            // By the source index, as failed channels are skipped.
+            const JsonSpan channel_span =
+                lazy_arrays.Element("channels", index);
+            AttachLazyExtras(lazy, channel_span, &channel);
+            channel.target_lazy_extras = LazyExtras(
+                lazy, FindJsonMember(lazy->Source(), channel_span, "target"));
+          }
           // Only add the channel if the parsing succeeds.
           animation->channels.emplace_back(std::move(channel));
         }
@@ -5044,19 +10027,25 @@ static bool ParseAnimation(Animation *animation, std::string *err,
         }
         sampler.input = inputIndex;
         sampler.output = outputIndex;
-        ParseExtensionsProperty(&(sampler.extensions), err, o);
-        ParseExtrasProperty(&(sampler.extras), s);
+        if (lazy) {
+          AttachLazyExtras(
+              lazy,
+              lazy_arrays.Element("samplers", animation->samplers.size()),
+              &sampler);
+        }
+        ParseExtensionsProperty(&(sampler.extensions), err, s, extras_mode);
+        ParseExtrasProperty(&(sampler.extras), s, extras_mode);
 
-        if (store_original_json_for_extras_and_extensions) {
+        if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
           {
             json_const_iterator eit;
-            if (FindMember(o, "extensions", eit)) {
+            if (FindMember(s, "extensions", eit)) {
               sampler.extensions_json_string = JsonToString(GetValue(eit));
             }
           }
           {
             json_const_iterator eit;
-            if (FindMember(o, "extras", eit)) {
+            if (FindMember(s, "extras", eit)) {
               sampler.extras_json_string = JsonToString(GetValue(eit));
             }
           }
@@ -5069,10 +10058,10 @@ static bool ParseAnimation(Animation *animation, std::string *err,
 
   ParseStringProperty(&animation->name, err, o, "name", false);
 
-  ParseExtensionsProperty(&animation->extensions, err, o);
-  ParseExtrasProperty(&(animation->extras), o);
+  ParseExtensionsProperty(&animation->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&(animation->extras), o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -5086,12 +10075,15 @@ static bool ParseAnimation(Animation *animation, std::string *err,
       }
     }
   }
+  if (lazy) {
+    AttachLazyExtras(lazy, span, animation);
+  }
 
   return true;
 }
 
 static bool ParseSampler(Sampler *sampler, std::string *err, const json &o,
-                         bool store_original_json_for_extras_and_extensions) {
+                         ExtrasMode extras_mode) {
   ParseStringProperty(&sampler->name, err, o, "name", false);
 
   int minFilter = -1;
@@ -5114,10 +10106,10 @@ static bool ParseSampler(Sampler *sampler, std::string *err, const json &o,
   sampler->wrapT = wrapT;
   //sampler->wrapR = wrapR;
 
-  ParseExtensionsProperty(&(sampler->extensions), err, o);
-  ParseExtrasProperty(&(sampler->extras), o);
+  ParseExtensionsProperty(&(sampler->extensions), err, o, extras_mode);
+  ParseExtrasProperty(&(sampler->extras), o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -5136,10 +10128,10 @@ static bool ParseSampler(Sampler *sampler, std::string *err, const json &o,
 }
 
 static bool ParseSkin(Skin *skin, std::string *err, const json &o,
-                      bool store_original_json_for_extras_and_extensions) {
+                      ExtrasMode extras_mode) {
   ParseStringProperty(&skin->name, err, o, "name", false, "Skin");
 
-  std::vector<int> joints;
+  ModelVector<int> joints;
   if (!ParseIntegerArrayProperty(&joints, err, o, "joints", false, "Skin")) {
     return false;
   }
@@ -5153,10 +10145,10 @@ static bool ParseSkin(Skin *skin, std::string *err, const json &o,
   ParseIntegerProperty(&invBind, err, o, "inverseBindMatrices", true, "Skin");
   skin->inverseBindMatrices = invBind;
 
-  ParseExtensionsProperty(&(skin->extensions), err, o);
-  ParseExtrasProperty(&(skin->extras), o);
+  ParseExtensionsProperty(&(skin->extensions), err, o, extras_mode);
+  ParseExtrasProperty(&(skin->extras), o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -5174,9 +10166,8 @@ static bool ParseSkin(Skin *skin, std::string *err, const json &o,
   return true;
 }
 
-static bool ParsePerspectiveCamera(
-    PerspectiveCamera *camera, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
+static bool ParsePerspectiveCamera(PerspectiveCamera *camera, std::string *err,
+                                   const json &o, ExtrasMode extras_mode) {
   double yfov = 0.0;
   if (!ParseNumberProperty(&yfov, err, o, "yfov", true, "OrthographicCamera")) {
     return false;
@@ -5200,10 +10191,10 @@ static bool ParsePerspectiveCamera(
   camera->yfov = yfov;
   camera->znear = znear;
 
-  ParseExtensionsProperty(&camera->extensions, err, o);
-  ParseExtrasProperty(&(camera->extras), o);
+  ParseExtensionsProperty(&camera->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&(camera->extras), o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -5224,14 +10215,14 @@ static bool ParsePerspectiveCamera(
 }
 
 static bool ParseSpotLight(SpotLight *light, std::string *err, const json &o,
-                           bool store_original_json_for_extras_and_extensions) {
+                           ExtrasMode extras_mode) {
   ParseNumberProperty(&light->innerConeAngle, err, o, "innerConeAngle", false);
   ParseNumberProperty(&light->outerConeAngle, err, o, "outerConeAngle", false);
 
-  ParseExtensionsProperty(&light->extensions, err, o);
-  ParseExtrasProperty(&light->extras, o);
+  ParseExtensionsProperty(&light->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&light->extras, o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -5253,7 +10244,7 @@ static bool ParseSpotLight(SpotLight *light, std::string *err, const json &o,
 
 static bool ParseOrthographicCamera(
     OrthographicCamera *camera, std::string *err, const json &o,
-    bool store_original_json_for_extras_and_extensions) {
+    ExtrasMode extras_mode) {
   double xmag = 0.0;
   if (!ParseNumberProperty(&xmag, err, o, "xmag", true, "OrthographicCamera")) {
     return false;
@@ -5275,10 +10266,10 @@ static bool ParseOrthographicCamera(
     return false;
   }
 
-  ParseExtensionsProperty(&camera->extensions, err, o);
-  ParseExtrasProperty(&(camera->extras), o);
+  ParseExtensionsProperty(&camera->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&(camera->extras), o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -5304,7 +10295,7 @@ static bool ParseOrthographicCamera(
 }
 
 static bool ParseCamera(Camera *camera, std::string *err, const json &o,
-                        bool store_original_json_for_extras_and_extensions) {
+                        ExtrasMode extras_mode) {
   if (!ParseStringProperty(&camera->type, err, o, "type", true, "Camera")) {
     return false;
   }
@@ -5330,9 +10321,7 @@ static bool ParseCamera(Camera *camera, std::string *err, const json &o,
       return false;
     }
 
-    if (!ParseOrthographicCamera(
-            &camera->orthographic, err, v,
-            store_original_json_for_extras_and_extensions)) {
+    if (!ParseOrthographicCamera(&camera->orthographic, err, v, extras_mode)) {
       return false;
     }
   } else if (camera->type.compare("perspective") == 0) {
@@ -5356,9 +10345,7 @@ static bool ParseCamera(Camera *camera, std::string *err, const json &o,
       return false;
     }
 
-    if (!ParsePerspectiveCamera(
-            &camera->perspective, err, v,
-            store_original_json_for_extras_and_extensions)) {
+    if (!ParsePerspectiveCamera(&camera->perspective, err, v, extras_mode)) {
       return false;
     }
   } else {
@@ -5373,10 +10360,10 @@ static bool ParseCamera(Camera *camera, std::string *err, const json &o,
 
   ParseStringProperty(&camera->name, err, o, "name", false);
 
-  ParseExtensionsProperty(&camera->extensions, err, o);
-  ParseExtrasProperty(&(camera->extras), o);
+  ParseExtensionsProperty(&camera->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&(camera->extras), o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -5395,7 +10382,7 @@ static bool ParseCamera(Camera *camera, std::string *err, const json &o,
 }
 
 static bool ParseLight(Light *light, std::string *err, const json &o,
-                       bool store_original_json_for_extras_and_extensions) {
+                       ExtrasMode extras_mode) {
   if (!ParseStringProperty(&light->type, err, o, "type", true)) {
     return false;
   }
@@ -5421,8 +10408,7 @@ static bool ParseLight(Light *light, std::string *err, const json &o,
       return false;
     }
 
-    if (!ParseSpotLight(&light->spot, err, v,
-                        store_original_json_for_extras_and_extensions)) {
+    if (!ParseSpotLight(&light->spot, err, v, extras_mode)) {
       return false;
     }
   }
@@ -5431,10 +10417,10 @@ static bool ParseLight(Light *light, std::string *err, const json &o,
   ParseNumberArrayProperty(&light->color, err, o, "color", false);
   ParseNumberProperty(&light->range, err, o, "range", false);
   ParseNumberProperty(&light->intensity, err, o, "intensity", false);
-  ParseExtensionsProperty(&light->extensions, err, o);
-  ParseExtrasProperty(&(light->extras), o);
+  ParseExtensionsProperty(&light->extensions, err, o, extras_mode);
+  ParseExtrasProperty(&(light->extras), o, extras_mode);
 
-  if (store_original_json_for_extras_and_extensions) {
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
     {
       json_const_iterator it;
       if (FindMember(o, "extensions", it)) {
@@ -5453,8 +10439,7 @@ static bool ParseLight(Light *light, std::string *err, const json &o,
 }
 
 bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
-                              const char *json_str,
-                              unsigned int json_str_length,
+                              const char *json_str, size_t json_str_length,
                               const std::string &base_dir,
                               unsigned int check_sections) {
   if (json_str_length < 4) {
@@ -5464,31 +10449,428 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
     return false;
   }
 
-  JsonDocument v;
+  model->buffers.clear();
+  model->bufferViews.clear();
+  model->accessors.clear();
+  model->meshes.clear();
+  model->cameras.clear();
+  model->nodes.clear();
+  model->extensionsUsed.clear();
+  model->extensionsRequired.clear();
+  model->extensions.clear();
+  model->defaultScene = -1;
+  model->lazy_json.reset();
+  model->lazy_extras.Reset();
 
-#if (defined(__cpp_exceptions) || defined(__EXCEPTIONS) || \
-     defined(_CPPUNWIND)) &&                               \
-    !defined(TINYGLTF_NOEXCEPTION)
-  try {
-    JsonParse(v, json_str, json_str_length, true);
+#ifdef TINYGLTF_USE_STRING_INTERNING
+  // Parts of `model` which are not cleared above may hold keys of its pool,
+  // keep using it then. Otherwise each model gets its own pool, so the pool
+  // does not grow with the loads of a long lived TinyGLTF.
+  if (!model->string_pool) {
+    model->string_pool = std::make_shared<StringPool>();
+  }
+  StringPool::Scope string_pool_scope(model->string_pool.get());
+#endif
 
-  } catch (const std::exception &e) {
-    if (err) {
-      (*err) = e.what();
+  const ExtrasMode extras_mode =
+      lazy_extras_and_extensions_
+          ? EXTRAS_LAZY
+          : (store_original_json_for_extras_and_extensions_
+                 ? EXTRAS_PARSE_STORE_JSON
+                 : EXTRAS_PARSE);
+
+  // Objects are attached to their lazy `extras` and `extensions` as they are
+  // parsed, by their index in the source arrays.
+  std::shared_ptr<const LazyJson> lazy_json;
+  if (extras_mode == EXTRAS_LAZY) {
+    lazy_json = std::make_shared<LazyJson>(json_str, json_str_length);
+  }
+  const JsonSpan lazy_root =
+      lazy_json ? JsonRootSpan(lazy_json->Source()) : JsonSpan{0, 0};
+  LazyJsonArrays lazy_arrays(lazy_json.get(), lazy_root);
+
+  // Parsers of the elements of top level arrays. Called from the DOM walk
+  // below, or while parsing with the streaming parser.
+  auto parse_buffers = [&](const json &o) -> bool {
+    if (!IsObject(o)) {
+      if (err) {
+        (*err) += "`buffers' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Buffer buffer;
+    if (!ParseBuffer(&buffer, err, o, extras_mode, &fs, base_dir, is_binary_,
+                     bin_data_, bin_size_,
+                     zero_copy_binary_buffer_ || bin_owner_, bin_owner_)) {
+      return false;
+    }
+
+    if (lazy_json) {
+      AttachLazyExtras(lazy_json,
+                       lazy_arrays.Element("buffers", model->buffers.size()),
+                       &buffer);
+    }
+    model->buffers.emplace_back(std::move(buffer));
+    return true;
+  };
+
+  auto parse_buffer_views = [&](const json &o) -> bool {
+    if (!IsObject(o)) {
+      if (err) {
+        (*err) += "`bufferViews' does not contain an JSON object.";
+      }
+      return false;
+    }
+    BufferView bufferView;
+    if (!ParseBufferView(&bufferView, err, o, extras_mode)) {
+      return false;
+    }
+
+    if (lazy_json) {
+      AttachLazyExtras(
+          lazy_json,
+          lazy_arrays.Element("bufferViews", model->bufferViews.size()),
+          &bufferView);
+    }
+    model->bufferViews.emplace_back(std::move(bufferView));
+    return true;
+  };
+
+  auto parse_accessors = [&](const json &o) -> bool {
+    if (!IsObject(o)) {
+      if (err) {
+        (*err) += "`accessors' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Accessor accessor;
+    if (!ParseAccessor(&accessor, err, o, extras_mode)) {
+      return false;
+    }
+
+    if (lazy_json) {
+      AttachLazyExtras(
+          lazy_json, lazy_arrays.Element("accessors", model->accessors.size()),
+          &accessor);
+    }
+    model->accessors.emplace_back(std::move(accessor));
+    return true;
+  };
+
+  auto parse_meshes = [&](const json &o) -> bool {
+    if (!IsObject(o)) {
+      if (err) {
+        (*err) += "`meshes' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Mesh mesh;
+    if (!ParseMesh(&mesh, model, err, o, extras_mode, lazy_json,
+                   lazy_arrays.Element("meshes", model->meshes.size()))) {
+      return false;
+    }
+
+    model->meshes.emplace_back(std::move(mesh));
+    return true;
+  };
+
+  auto parse_nodes = [&](const json &o) -> bool {
+    if (!IsObject(o)) {
+      if (err) {
+        (*err) += "`nodes' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Node node;
+    if (!ParseNode(&node, err, o, extras_mode)) {
+      return false;
+    }
+
+    if (lazy_json) {
+      AttachLazyExtras(lazy_json,
+                       lazy_arrays.Element("nodes", model->nodes.size()),
+                       &node);
+    }
+    model->nodes.emplace_back(std::move(node));
+    return true;
+  };
+
+  auto parse_scenes = [&](const json &o) -> bool {
+    if (!IsObject(o)) {
+      if (err) {
+        (*err) += "`scenes' does not contain an JSON object.";
+      }
+      return false;
+    }
+    ModelVector<int> nodes;
+    ParseIntegerArrayProperty(&nodes, err, o, "nodes", false);
+
+    Scene scene;
+    scene.nodes = std::move(nodes);
+
+    ParseStringProperty(&scene.name, err, o, "name", false);
+
+    ParseExtensionsProperty(&scene.extensions, err, o, extras_mode);
+    ParseExtrasProperty(&scene.extras, o, extras_mode);
+
+    if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
+      {
+        json_const_iterator it;
+        if (FindMember(o, "extensions", it)) {
+          scene.extensions_json_string = JsonToString(GetValue(it));
+        }
+      }
+      {
+        json_const_iterator it;
+        if (FindMember(o, "extras", it)) {
+          scene.extras_json_string = JsonToString(GetValue(it));
+        }
+      }
+    }
+
+    if (lazy_json) {
+      AttachLazyExtras(lazy_json,
+                       lazy_arrays.Element("scenes", model->scenes.size()),
+                       &scene);
+    }
+    model->scenes.emplace_back(std::move(scene));
+    return true;
+  };
+
+  auto parse_materials = [&](const json &o) -> bool {
+    if (!IsObject(o)) {
+      if (err) {
+        (*err) += "`materials' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Material material;
+    ParseStringProperty(&material.name, err, o, "name", false);
+
+    if (!ParseMaterial(&material, err, o, extras_mode)) {
+      return false;
+    }
+
+    if (lazy_json) {
+      AttachLazyExtras(
+          lazy_json, lazy_arrays.Element("materials", model->materials.size()),
+          &material);
+    }
+    model->materials.emplace_back(std::move(material));
+    return true;
+  };
+
+  auto parse_textures = [&](const json &o) -> bool {
+    if (!IsObject(o)) {
+      if (err) {
+        (*err) += "`textures' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Texture texture;
+    if (!ParseTexture(&texture, err, o, extras_mode, base_dir)) {
+      return false;
+    }
+
+    if (lazy_json) {
+      AttachLazyExtras(lazy_json,
+                       lazy_arrays.Element("textures", model->textures.size()),
+                       &texture);
+    }
+    model->textures.emplace_back(std::move(texture));
+    return true;
+  };
+
+  auto parse_animations = [&](const json &o) -> bool {
+    if (!IsObject(o)) {
+      if (err) {
+        (*err) += "`animations' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Animation animation;
+    if (!ParseAnimation(
+            &animation, err, o, extras_mode, lazy_json,
+            lazy_arrays.Element("animations", model->animations.size()))) {
+      return false;
+    }
+
+    model->animations.emplace_back(std::move(animation));
+    return true;
+  };
+
+  auto parse_skins = [&](const json &o) -> bool {
+    if (!IsObject(o)) {
+      if (err) {
+        (*err) += "`skins' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Skin skin;
+    if (!ParseSkin(&skin, err, o, extras_mode)) {
+      return false;
+    }
+
+    if (lazy_json) {
+      AttachLazyExtras(lazy_json,
+                       lazy_arrays.Element("skins", model->skins.size()),
+                       &skin);
+    }
+    model->skins.emplace_back(std::move(skin));
+    return true;
+  };
+
+  auto parse_samplers = [&](const json &o) -> bool {
+    if (!IsObject(o)) {
+      if (err) {
+        (*err) += "`samplers' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Sampler sampler;
+    if (!ParseSampler(&sampler, err, o, extras_mode)) {
+      return false;
+    }
+
+    if (lazy_json) {
+      AttachLazyExtras(lazy_json,
+                       lazy_arrays.Element("samplers", model->samplers.size()),
+                       &sampler);
+    }
+    model->samplers.emplace_back(std::move(sampler));
+    return true;
+  };
+
+  auto parse_cameras = [&](const json &o) -> bool {
+    if (!IsObject(o)) {
+      if (err) {
+        (*err) += "`cameras' does not contain an JSON object.";
+      }
+      return false;
+    }
+    Camera camera;
+    if (!ParseCamera(&camera, err, o, extras_mode)) {
+      return false;
+    }
+
+    if (lazy_json) {
+      AttachLazyExtras(lazy_json,
+                       lazy_arrays.Element("cameras", model->cameras.size()),
+                       &camera);
+    }
+    model->cameras.emplace_back(std::move(camera));
+    return true;
+  };
+
+#if defined(TINYGLTF_USE_RAPIDJSON) && \
+    !defined(TINYGLTF_USE_RAPIDJSON_CRTALLOCATOR)
+  // Allocate the values from `json_pool_`, sized by the previous loads. The
+  // pool only allocates more when the document does not fit.
+  std::unique_ptr<rapidjson::Document::AllocatorType> json_pool;
+  if (insitu_json_parse_) {
+    if (json_pool_.size() < json_pool_size_) {
+      json_pool_.resize(json_pool_size_);
+    }
+    if (json_pool_.empty()) {
+      json_pool.reset(new rapidjson::Document::AllocatorType());
+    } else {
+      json_pool.reset(new rapidjson::Document::AllocatorType(
+          json_pool_.data(), json_pool_.size()));
     }
-    return false;
   }
+  JsonDocument v(json_pool.get());
 #else
+  JsonDocument v;
+#endif
+  std::vector<char> *insitu_buffer =
+      insitu_json_parse_ ? &json_buffer_ : nullptr;
+
+#ifdef TINYGLTF_USE_ARENA
+  // The document is released at the end of the load while the model is
+  // kept, so they are allocated from different arenas.
+  Arena dom_arena;
+  Arena model_arena;
+#endif
+
+#if !defined(TINYGLTF_USE_RAPIDJSON) && !defined(TINYGLTF_USE_SIMDJSON)
+  if (streaming_json_parse_) {
+#ifdef TINYGLTF_USE_ARENA
+    Arena::Scope dom_scope(&dom_arena);
+#endif
+    std::map<std::string, StreamingJsonHandler::ElementCallback> sections;
+    sections["buffers"] = parse_buffers;
+    sections["bufferViews"] = parse_buffer_views;
+    sections["accessors"] = parse_accessors;
+#ifndef TINYGLTF_ENABLE_DRACO
+    // Draco decoding needs buffers, bufferViews and accessors.
+    sections["meshes"] = parse_meshes;
+#endif
+    sections["nodes"] = parse_nodes;
+    sections["scenes"] = parse_scenes;
+    sections["materials"] = parse_materials;
+    sections["textures"] = parse_textures;
+    sections["animations"] = parse_animations;
+    sections["skins"] = parse_skins;
+    sections["samplers"] = parse_samplers;
+    sections["cameras"] = parse_cameras;
+#ifdef TINYGLTF_USE_ARENA
+    for (auto &section : sections) {
+      StreamingJsonHandler::ElementCallback callback =
+          std::move(section.second);
+      section.second = [callback, &model_arena](const json &o) {
+        Arena::Scope model_scope(&model_arena);
+        return callback(o);
+      };
+    }
+#endif
+
+    StreamingJsonHandler handler(&v, sections);
+    if (!json::sax_parse(json_str, json_str + json_str_length, &handler)) {
+      if (err && !handler.CallbackFailed()) {
+        (*err) = handler.Error();
+      }
+      return false;
+    }
+  } else
+#endif
   {
-    JsonParse(v, json_str, json_str_length);
+#ifdef TINYGLTF_USE_ARENA
+    Arena::Scope dom_scope(&dom_arena);
+#endif
+#if (defined(__cpp_exceptions) || defined(__EXCEPTIONS) || \
+     defined(_CPPUNWIND)) &&                               \
+    !defined(TINYGLTF_NOEXCEPTION)
+    try {
+      JsonParse(v, json_str, json_str_length, true, insitu_buffer);
 
-    if (!IsObject(v)) {
-      // Assume parsing was failed.
+    } catch (const std::exception &e) {
       if (err) {
-        (*err) = "Failed to parse JSON object\n";
+        (*err) = e.what();
       }
       return false;
     }
+#else
+    {
+      JsonParse(v, json_str, json_str_length, false, insitu_buffer);
+
+      if (!IsObject(v)) {
+        // Assume parsing was failed.
+        if (err) {
+          (*err) = "Failed to parse JSON object\n";
+        }
+        return false;
+      }
+    }
+#endif
+  }
+
+#if defined(TINYGLTF_USE_RAPIDJSON) && \
+    !defined(TINYGLTF_USE_RAPIDJSON_CRTALLOCATOR)
+  if (json_pool) {
+    // Room for this document, plus a chunk header and some slack.
+    json_pool_size_ =
+        (std::max)(json_pool_size_, json_pool->Size() + json_pool->Size() / 8 +
+                                        size_t(1024));
   }
 #endif
 
@@ -5500,6 +10882,10 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
     return false;
   }
 
+#ifdef TINYGLTF_USE_ARENA
+  Arena::Scope model_scope(&model_arena);
+#endif
+
   {
     bool version_found = false;
     json_const_iterator it;
@@ -5579,25 +10965,18 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
     }
   }
 
-  model->buffers.clear();
-  model->bufferViews.clear();
-  model->accessors.clear();
-  model->meshes.clear();
-  model->cameras.clear();
-  model->nodes.clear();
-  model->extensionsUsed.clear();
-  model->extensionsRequired.clear();
-  model->extensions.clear();
-  model->defaultScene = -1;
-
   // 1. Parse Asset
   {
     json_const_iterator it;
     if (FindMember(v, "asset", it) && IsObject(GetValue(it))) {
       const json &root = GetValue(it);
 
-      ParseAsset(&model->asset, err, root,
-                 store_original_json_for_extras_and_extensions_);
+      ParseAsset(&model->asset, err, root, extras_mode);
+      if (lazy_json) {
+        AttachLazyExtras(
+            lazy_json, FindJsonMember(lazy_json->Source(), lazy_root, "asset"),
+            &model->asset);
+      }
     }
   }
 
@@ -5644,24 +11023,9 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   }
 
   // 3. Parse Buffer
-  {
-    bool success = ForEachInArray(v, "buffers", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`buffers' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Buffer buffer;
-      if (!ParseBuffer(&buffer, err, o,
-                       store_original_json_for_extras_and_extensions_, &fs,
-                       base_dir, is_binary_, bin_data_, bin_size_)) {
-        return false;
-      }
-
-      model->buffers.emplace_back(std::move(buffer));
-      return true;
-    });
+  {
+    ReserveArrayMember(v, "buffers", &model->buffers);
+    bool success = ForEachInArray(v, "buffers", parse_buffers);
 
     if (!success) {
       return false;
@@ -5669,22 +11033,8 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   }
   // 4. Parse BufferView
   {
-    bool success = ForEachInArray(v, "bufferViews", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`bufferViews' does not contain an JSON object.";
-        }
-        return false;
-      }
-      BufferView bufferView;
-      if (!ParseBufferView(&bufferView, err, o,
-                           store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->bufferViews.emplace_back(std::move(bufferView));
-      return true;
-    });
+    ReserveArrayMember(v, "bufferViews", &model->bufferViews);
+    bool success = ForEachInArray(v, "bufferViews", parse_buffer_views);
 
     if (!success) {
       return false;
@@ -5693,22 +11043,8 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 5. Parse Accessor
   {
-    bool success = ForEachInArray(v, "accessors", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`accessors' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Accessor accessor;
-      if (!ParseAccessor(&accessor, err, o,
-                         store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->accessors.emplace_back(std::move(accessor));
-      return true;
-    });
+    ReserveArrayMember(v, "accessors", &model->accessors);
+    bool success = ForEachInArray(v, "accessors", parse_accessors);
 
     if (!success) {
       return false;
@@ -5717,22 +11053,8 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 6. Parse Mesh
   {
-    bool success = ForEachInArray(v, "meshes", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`meshes' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Mesh mesh;
-      if (!ParseMesh(&mesh, model, err, o,
-                     store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->meshes.emplace_back(std::move(mesh));
-      return true;
-    });
+    ReserveArrayMember(v, "meshes", &model->meshes);
+    bool success = ForEachInArray(v, "meshes", parse_meshes);
 
     if (!success) {
       return false;
@@ -5793,22 +11115,8 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 7. Parse Node
   {
-    bool success = ForEachInArray(v, "nodes", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`nodes' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Node node;
-      if (!ParseNode(&node, err, o,
-                     store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->nodes.emplace_back(std::move(node));
-      return true;
-    });
+    ReserveArrayMember(v, "nodes", &model->nodes);
+    bool success = ForEachInArray(v, "nodes", parse_nodes);
 
     if (!success) {
       return false;
@@ -5817,42 +11125,8 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 8. Parse scenes.
   {
-    bool success = ForEachInArray(v, "scenes", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`scenes' does not contain an JSON object.";
-        }
-        return false;
-      }
-      std::vector<int> nodes;
-      ParseIntegerArrayProperty(&nodes, err, o, "nodes", false);
-
-      Scene scene;
-      scene.nodes = std::move(nodes);
-
-      ParseStringProperty(&scene.name, err, o, "name", false);
-
-      ParseExtensionsProperty(&scene.extensions, err, o);
-      ParseExtrasProperty(&scene.extras, o);
-
-      if (store_original_json_for_extras_and_extensions_) {
-        {
-          json_const_iterator it;
-          if (FindMember(o, "extensions", it)) {
-            scene.extensions_json_string = JsonToString(GetValue(it));
-          }
-        }
-        {
-          json_const_iterator it;
-          if (FindMember(o, "extras", it)) {
-            scene.extras_json_string = JsonToString(GetValue(it));
-          }
-        }
-      }
-
-      model->scenes.emplace_back(std::move(scene));
-      return true;
-    });
+    ReserveArrayMember(v, "scenes", &model->scenes);
+    bool success = ForEachInArray(v, "scenes", parse_scenes);
 
     if (!success) {
       return false;
@@ -5870,24 +11144,8 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 10. Parse Material
   {
-    bool success = ForEachInArray(v, "materials", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`materials' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Material material;
-      ParseStringProperty(&material.name, err, o, "name", false);
-
-      if (!ParseMaterial(&material, err, o,
-                         store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->materials.emplace_back(std::move(material));
-      return true;
-    });
+    ReserveArrayMember(v, "materials", &model->materials);
+    bool success = ForEachInArray(v, "materials", parse_materials);
 
     if (!success) {
       return false;
@@ -5908,7 +11166,49 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   }
 
   {
+    // On a single thread, each image is decoded as soon as it is parsed.
+    // With multiple threads, images are decoded after all of them have been
+    // parsed. `jobs` holds the encoded data of each image to decode.
+    struct ImageDecodeJob {
+      int image_idx;
+      int req_width;
+      int req_height;
+      std::vector<unsigned char> data;  // Image data loaded from `uri`
+      const unsigned char *bytes;       // Image data in a bufferView
+      size_t size;
+    };
+    std::vector<ImageDecodeJob> jobs;
+    const int num_threads = ResolveNumThreads(num_threads_);
+
+    // Decodes `job` into `image` right away on a single thread, or queues it.
+    auto decode_image = [&](Image *image, ImageDecodeJob &&job) -> bool {
+      if (*LoadImageData == nullptr) {
+        if (err) {
+          (*err) += "No LoadImageData callback specified.\n";
+        }
+        return false;
+      }
+      // LoadImageDataFunction takes the data size as an int.
+      if (job.size > size_t((std::numeric_limits<int>::max)())) {
+        if (err) {
+          (*err) += "image[" + std::to_string(job.image_idx) +
+                    "] data is too large to decode(" +
+                    std::to_string(job.size) + " bytes).\n";
+        }
+        return false;
+      }
+      if (num_threads > 1) {
+        jobs.emplace_back(std::move(job));
+        return true;
+      }
+      const unsigned char *bytes = job.bytes ? job.bytes : job.data.data();
+      return LoadImageData(image, job.image_idx, err, warn, job.req_width,
+                           job.req_height, bytes, static_cast<int>(job.size),
+                           load_image_user_data);
+    };
+
     int idx = 0;
+    ReserveArrayMember(v, "images", &model->images);
     bool success = ForEachInArray(v, "images", [&](const json &o) {
       if (!IsObject(o)) {
         if (err) {
@@ -5917,12 +11217,30 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
         return false;
       }
       Image image;
-      if (!ParseImage(&image, idx, err, warn, o,
-                      store_original_json_for_extras_and_extensions_, base_dir,
-                      &fs, &this->LoadImageData, load_image_user_data)) {
+      std::vector<unsigned char> encoded_image;
+      if (!ParseImage(&image, idx, err, warn, o, extras_mode, base_dir, &fs,
+                      &encoded_image)) {
         return false;
       }
 
+      if (defer_image_decoding_) {
+        if (!encoded_image.empty()) {
+          image.image.swap(encoded_image);
+          image.as_is = true;
+        }
+      } else if (!encoded_image.empty()) {
+        ImageDecodeJob job;
+        job.image_idx = idx;
+        job.req_width = 0;
+        job.req_height = 0;
+        job.data.swap(encoded_image);
+        job.bytes = nullptr;
+        job.size = job.data.size();
+        if (!decode_image(&image, std::move(job))) {
+          return false;
+        }
+      }
+
       if (image.bufferView != -1) {
         // Load image from the buffer view.
         if (size_t(image.bufferView) >= model->bufferViews.size()) {
@@ -5948,21 +11266,39 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
         }
         const Buffer &buffer = model->buffers[size_t(bufferView.buffer)];
 
-        if (*LoadImageData == nullptr) {
+        if (bufferView.byteOffset + bufferView.byteLength >
+            buffer.DataSize()) {
           if (err) {
-            (*err) += "No LoadImageData callback specified.\n";
+            std::stringstream ss;
+            ss << "image[" << idx << "] bufferView \"" << image.bufferView
+               << "\" exceeds the size of buffer \"" << bufferView.buffer
+               << "\"." << std::endl;
+            (*err) += ss.str();
           }
           return false;
         }
-        bool ret = LoadImageData(
-            &image, idx, err, warn, image.width, image.height,
-            &buffer.data[bufferView.byteOffset],
-            static_cast<int>(bufferView.byteLength), load_image_user_data);
-        if (!ret) {
-          return false;
+
+        if (defer_image_decoding_) {
+          // Decoded on demand with `Image::Decode()`.
+          image.as_is = true;
+        } else {
+          ImageDecodeJob job;
+          job.image_idx = idx;
+          job.req_width = image.width;
+          job.req_height = image.height;
+          job.bytes = buffer.DataPtr() + bufferView.byteOffset;
+          job.size = bufferView.byteLength;
+          if (!decode_image(&image, std::move(job))) {
+            return false;
+          }
         }
       }
 
+      if (lazy_json) {
+        AttachLazyExtras(lazy_json,
+                         lazy_arrays.Element("images", model->images.size()),
+                         &image);
+      }
       model->images.emplace_back(std::move(image));
       ++idx;
       return true;
@@ -5971,27 +11307,53 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
     if (!success) {
       return false;
     }
-  }
 
-  // 12. Parse Texture
-  {
-    bool success = ForEachInArray(v, "textures", [&](const json &o) {
-      if (!IsObject(o)) {
+    if (!jobs.empty()) {
+      // Decode concurrently. Messages are collected per image and appended in
+      // image order afterwards. Jobs are handed out in increasing order, so
+      // every image before the first one that fails is decoded. Messages of
+      // later images are dropped, whether or not they were decoded, so `err`
+      // and `warn` are the same as when decoding on a single thread.
+      std::vector<std::string> job_errs(jobs.size());
+      std::vector<std::string> job_warns(jobs.size());
+      std::atomic<size_t> first_failed(jobs.size());
+      ParallelFor(jobs.size(), num_threads, [&](size_t j) {
+        if (j > first_failed.load()) {
+          return;
+        }
+        const ImageDecodeJob &job = jobs[j];
+        const unsigned char *bytes = job.bytes ? job.bytes : job.data.data();
+        if (!LoadImageData(&model->images[size_t(job.image_idx)],
+                           job.image_idx, &job_errs[j], &job_warns[j],
+                           job.req_width, job.req_height, bytes,
+                           static_cast<int>(job.size), load_image_user_data)) {
+          size_t failed = first_failed.load();
+          while ((j < failed) &&
+                 !first_failed.compare_exchange_weak(failed, j)) {
+          }
+        }
+      });
+
+      const size_t failed = first_failed.load();
+      const size_t num_reported = (std::min)(failed + 1, jobs.size());
+      for (size_t j = 0; j < num_reported; j++) {
+        if (warn) {
+          (*warn) += job_warns[j];
+        }
         if (err) {
-          (*err) += "`textures' does not contain an JSON object.";
+          (*err) += job_errs[j];
         }
-        return false;
       }
-      Texture texture;
-      if (!ParseTexture(&texture, err, o,
-                        store_original_json_for_extras_and_extensions_,
-                        base_dir)) {
+      if (failed < jobs.size()) {
         return false;
       }
+    }
+  }
 
-      model->textures.emplace_back(std::move(texture));
-      return true;
-    });
+  // 12. Parse Texture
+  {
+    ReserveArrayMember(v, "textures", &model->textures);
+    bool success = ForEachInArray(v, "textures", parse_textures);
 
     if (!success) {
       return false;
@@ -6000,22 +11362,8 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 13. Parse Animation
   {
-    bool success = ForEachInArray(v, "animations", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`animations' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Animation animation;
-      if (!ParseAnimation(&animation, err, o,
-                          store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->animations.emplace_back(std::move(animation));
-      return true;
-    });
+    ReserveArrayMember(v, "animations", &model->animations);
+    bool success = ForEachInArray(v, "animations", parse_animations);
 
     if (!success) {
       return false;
@@ -6024,22 +11372,8 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 14. Parse Skin
   {
-    bool success = ForEachInArray(v, "skins", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`skins' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Skin skin;
-      if (!ParseSkin(&skin, err, o,
-                     store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->skins.emplace_back(std::move(skin));
-      return true;
-    });
+    ReserveArrayMember(v, "skins", &model->skins);
+    bool success = ForEachInArray(v, "skins", parse_skins);
 
     if (!success) {
       return false;
@@ -6048,22 +11382,8 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 15. Parse Sampler
   {
-    bool success = ForEachInArray(v, "samplers", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`samplers' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Sampler sampler;
-      if (!ParseSampler(&sampler, err, o,
-                        store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->samplers.emplace_back(std::move(sampler));
-      return true;
-    });
+    ReserveArrayMember(v, "samplers", &model->samplers);
+    bool success = ForEachInArray(v, "samplers", parse_samplers);
 
     if (!success) {
       return false;
@@ -6072,22 +11392,8 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
   // 16. Parse Camera
   {
-    bool success = ForEachInArray(v, "cameras", [&](const json &o) {
-      if (!IsObject(o)) {
-        if (err) {
-          (*err) += "`cameras' does not contain an JSON object.";
-        }
-        return false;
-      }
-      Camera camera;
-      if (!ParseCamera(&camera, err, o,
-                       store_original_json_for_extras_and_extensions_)) {
-        return false;
-      }
-
-      model->cameras.emplace_back(std::move(camera));
-      return true;
-    });
+    ReserveArrayMember(v, "cameras", &model->cameras);
+    bool success = ForEachInArray(v, "cameras", parse_cameras);
 
     if (!success) {
       return false;
@@ -6095,7 +11401,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   }
 
   // 17. Parse Extensions
-  ParseExtensionsProperty(&model->extensions, err, v);
+  ParseExtensionsProperty(&model->extensions, err, v, extras_mode);
 
   // 18. Specific extension implementations
   {
@@ -6117,14 +11423,25 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
               continue;
             }
 
+            LazyJsonArrays lazy_lights(
+                lazy_json.get(),
+                lazy_json ? FindJsonMember(lazy_json->Source(),
+                                           FindJsonMember(lazy_json->Source(),
+                                                          lazy_root,
+                                                          "extensions"),
+                                           "KHR_lights_punctual")
+                          : JsonSpan{0, 0});
             auto arrayIt(ArrayBegin(lights));
             auto arrayItEnd(ArrayEnd(lights));
-            for (; arrayIt != arrayItEnd; ++arrayIt) {
+            for (size_t index = 0; arrayIt != arrayItEnd; ++arrayIt, ++index) {
               Light light;
-              if (!ParseLight(&light, err, *arrayIt,
-                              store_original_json_for_extras_and_extensions_)) {
+              if (!ParseLight(&light, err, *arrayIt, extras_mode)) {
                 return false;
               }
+              if (lazy_json) {
+                AttachLazyExtras(lazy_json,
+                                 lazy_lights.Element("lights", index), &light);
+              }
               model->lights.emplace_back(std::move(light));
             }
           }
@@ -6134,11 +11451,21 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
   }
 
   // 19. Parse Extras
-  ParseExtrasProperty(&model->extras, v);
+  ParseExtrasProperty(&model->extras, v, extras_mode);
+
+  if (extras_mode == EXTRAS_PARSE_STORE_JSON) {
+    json_const_iterator it;
+    if (FindMember(v, "extras", it)) {
+      model->extras_json_string = JsonToString(GetValue(it));
+    }
+    if (FindMember(v, "extensions", it)) {
+      model->extensions_json_string = JsonToString(GetValue(it));
+    }
+  }
 
-  if (store_original_json_for_extras_and_extensions_) {
-    model->extras_json_string = JsonToString(v["extras"]);
-    model->extensions_json_string = JsonToString(v["extensions"]);
+  if (lazy_json) {
+    AttachLazyExtras(lazy_json, lazy_root, model);
+    model->lazy_json = lazy_json;
   }
 
   return true;
@@ -6146,7 +11473,7 @@ bool TinyGLTF::LoadFromString(Model *model, std::string *err, std::string *warn,
 
 bool TinyGLTF::LoadASCIIFromString(Model *model, std::string *err,
                                    std::string *warn, const char *str,
-                                   unsigned int length,
+                                   size_t length,
                                    const std::string &base_dir,
                                    unsigned int check_sections) {
   is_binary_ = false;
@@ -6162,7 +11489,7 @@ bool TinyGLTF::LoadASCIIFromFile(Model *model, std::string *err,
                                  unsigned int check_sections) {
   std::stringstream ss;
 
-  if (fs.ReadWholeFile == nullptr) {
+  if (fs.ReadWholeFile == nullptr && fs.MapWholeFile == nullptr) {
     // Programmer error, assert() ?
     ss << "Failed to read file: " << filename
        << ": one or more FS callback not set" << std::endl;
@@ -6172,6 +11499,29 @@ bool TinyGLTF::LoadASCIIFromFile(Model *model, std::string *err,
     return false;
   }
 
+  if (fs.MapWholeFile) {
+    MappedFile mapped;
+    std::string fileerr;
+    if (!fs.MapWholeFile(&mapped, &fileerr, filename, fs.user_data)) {
+      ss << "Failed to map file: " << filename << ": " << fileerr << std::endl;
+      if (err) {
+        (*err) = ss.str();
+      }
+      return false;
+    }
+
+    if (mapped.size == 0) {
+      if (err) {
+        (*err) = "Empty file.";
+      }
+      return false;
+    }
+
+    return LoadASCIIFromString(
+        model, err, warn, reinterpret_cast<const char *>(mapped.data),
+        mapped.size, GetBaseDir(filename), check_sections);
+  }
+
   std::vector<unsigned char> data;
   std::string fileerr;
   bool fileread = fs.ReadWholeFile(&data, &fileerr, filename, fs.user_data);
@@ -6193,17 +11543,16 @@ bool TinyGLTF::LoadASCIIFromFile(Model *model, std::string *err,
 
   std::string basedir = GetBaseDir(filename);
 
-  bool ret = LoadASCIIFromString(
-      model, err, warn, reinterpret_cast<const char *>(&data.at(0)),
-      static_cast<unsigned int>(data.size()), basedir, check_sections);
+  bool ret = LoadASCIIFromString(model, err, warn,
+                                 reinterpret_cast<const char *>(&data.at(0)),
+                                 data.size(), basedir, check_sections);
 
   return ret;
 }
 
 bool TinyGLTF::LoadBinaryFromMemory(Model *model, std::string *err,
                                     std::string *warn,
-                                    const unsigned char *bytes,
-                                    unsigned int size,
+                                    const unsigned char *bytes, size_t size,
                                     const std::string &base_dir,
                                     unsigned int check_sections) {
   if (size < 20) {
@@ -6241,8 +11590,11 @@ bool TinyGLTF::LoadBinaryFromMemory(Model *model, std::string *err,
   // In case the Bin buffer is not present, the size is exactly 20 + size of
   // JSON contents,
   // so use "greater than" operator.
-  if ((20 + model_length > size) || (model_length < 1) || (length > size) ||
-      (20 + model_length > length) ||
+  // Header fields are 32bit, so compare in 64bit to avoid wrap around.
+  const uint64_t json_chunk_end = 20 + uint64_t(model_length);
+  if ((json_chunk_end > uint64_t(size)) || (model_length < 1) ||
+      (uint64_t(length) > uint64_t(size)) ||
+      (json_chunk_end > uint64_t(length)) ||
       (model_format != 0x4E4F534A)) {  // 0x4E4F534A = JSON format.
     if (err) {
       (*err) = "Invalid glTF binary.";
@@ -6250,15 +11602,28 @@ bool TinyGLTF::LoadBinaryFromMemory(Model *model, std::string *err,
     return false;
   }
 
-  // Extract JSON string.
-  std::string jsonString(reinterpret_cast<const char *>(&bytes[20]),
-                         model_length);
-
   is_binary_ = true;
-  bin_data_ = bytes + 20 + model_length +
-              8;  // 4 bytes (buffer_length) + 4 bytes(buffer_format)
-  bin_size_ =
-      length - (20 + model_length);  // extract header + JSON scene data.
+  bin_data_ = nullptr;
+  bin_size_ = 0;
+
+  // BIN chunk(optional): 4 bytes(chunk_length) + 4 bytes(chunk_format) + data
+  // A chunk of any other type is ignored, as the spec requires for unknown
+  // chunk types.
+  if (uint64_t(length) >= json_chunk_end + 8) {
+    unsigned int chunk_length;
+    unsigned int chunk_format;
+    memcpy(&chunk_length, bytes + json_chunk_end, 4);
+    swap4(&chunk_length);
+    memcpy(&chunk_format, bytes + json_chunk_end + 4, 4);
+    swap4(&chunk_format);
+
+    if (chunk_format == 0x004E4942) {  // 0x004E4942 = BIN format.
+      const size_t available =
+          static_cast<size_t>(length - (json_chunk_end + 8));
+      bin_data_ = bytes + json_chunk_end + 8;
+      bin_size_ = (std::min)(size_t(chunk_length), available);
+    }
+  }
 
   bool ret = LoadFromString(model, err, warn,
                             reinterpret_cast<const char *>(&bytes[20]),
@@ -6276,7 +11641,7 @@ bool TinyGLTF::LoadBinaryFromFile(Model *model, std::string *err,
                                   unsigned int check_sections) {
   std::stringstream ss;
 
-  if (fs.ReadWholeFile == nullptr) {
+  if (fs.ReadWholeFile == nullptr && fs.MapWholeFile == nullptr) {
     // Programmer error, assert() ?
     ss << "Failed to read file: " << filename
        << ": one or more FS callback not set" << std::endl;
@@ -6286,6 +11651,26 @@ bool TinyGLTF::LoadBinaryFromFile(Model *model, std::string *err,
     return false;
   }
 
+  if (fs.MapWholeFile) {
+    MappedFile mapped;
+    std::string fileerr;
+    if (!fs.MapWholeFile(&mapped, &fileerr, filename, fs.user_data)) {
+      ss << "Failed to map file: " << filename << ": " << fileerr << std::endl;
+      if (err) {
+        (*err) = ss.str();
+      }
+      return false;
+    }
+
+    // The GLB-stored buffer references the BIN chunk and keeps the mapping
+    // alive through `Buffer::view_owner`.
+    bin_owner_ = mapped.owner;
+    bool ret = LoadBinaryFromMemory(model, err, warn, mapped.data, mapped.size,
+                                    GetBaseDir(filename), check_sections);
+    bin_owner_.reset();
+    return ret;
+  }
+
   std::vector<unsigned char> data;
   std::string fileerr;
   bool fileread = fs.ReadWholeFile(&data, &fileerr, filename, fs.user_data);
@@ -6299,10 +11684,15 @@ bool TinyGLTF::LoadBinaryFromFile(Model *model, std::string *err,
 
   std::string basedir = GetBaseDir(filename);
 
-  bool ret = LoadBinaryFromMemory(model, err, warn, &data.at(0),
-                                  static_cast<unsigned int>(data.size()),
+  // `data` is released on return, so the BIN chunk can't be referenced.
+  const bool zero_copy = zero_copy_binary_buffer_;
+  zero_copy_binary_buffer_ = false;
+
+  bool ret = LoadBinaryFromMemory(model, err, warn, &data.at(0), data.size(),
                                   basedir, check_sections);
 
+  zero_copy_binary_buffer_ = zero_copy;
+
   return ret;
 }
 
@@ -6310,6 +11700,9 @@ bool TinyGLTF::LoadBinaryFromFile(Model *model, std::string *err,
 // GLTF Serialization
 ///////////////////////
 namespace {
+// The JSON DOM is read only with simdjson: only the direct JSON writer is
+// available.
+#ifndef TINYGLTF_USE_SIMDJSON
 json JsonFromString(const char *s) {
 #ifdef TINYGLTF_USE_RAPIDJSON
   return json(s, GetAllocator());
@@ -6318,59 +11711,289 @@ json JsonFromString(const char *s) {
 #endif
 }
 
-void JsonAssign(json &dest, const json &src) {
+void JsonAddMember(json &o, const char *key, json &&value) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  if (!o.IsObject()) {
+    o.SetObject();
+  }
+  o.AddMember(json(key, GetAllocator()), std::move(value), GetAllocator());
+#else
+  o[key] = std::move(value);
+#endif
+}
+
+void JsonPushBack(json &o, json &&value) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  o.PushBack(std::move(value), GetAllocator());
+#else
+  o.push_back(std::move(value));
+#endif
+}
+
+bool JsonIsNull(const json &o) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  return o.IsNull();
+#else
+  return o.is_null();
+#endif
+}
+
+void JsonSetObject(json &o) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  o.SetObject();
+#else
+  o = o.object({});
+#endif
+}
+
+void JsonReserveArray(json &o, size_t s) {
+#ifdef TINYGLTF_USE_RAPIDJSON
+  o.SetArray();
+  o.Reserve(static_cast<rapidjson::SizeType>(s), GetAllocator());
+#endif
+  (void)(o);
+  (void)(s);
+}
+#else
+// Appends a member to `doc`, which becomes a detached object(parsed values
+// can't be changed).
+void JsonAddMember(JsonDocument &doc, const char *key, json &&value) {
+  if (!doc.members) {
+    doc.members.reset(new std::vector<JsonMember>());
+  }
+  doc.members->push_back(JsonMember{key, std::move(value)});
+  doc.root = json();
+  doc.root.type = '{';
+  doc.root.detached = true;
+  doc.root.members = doc.members.get();
+}
+#endif  // !TINYGLTF_USE_SIMDJSON
+
+///
+/// Value of the direct JSON writer(TinyGLTF::SetDirectJsonWriter()).
+/// Stands in for a JSON DOM value while serializing, but only holds the
+/// serialized text of its members or elements. Members are written in
+/// insertion order.
+///
+struct JsonWriterValue {
+  enum Kind { kNull, kObject, kArray, kLiteral };
+  Kind kind = kNull;
+  std::string text;  // Members/elements without brackets, or the literal.
+};
+
+void JsonWriterAppendString(std::string *out, const char *s, size_t n) {
+  static const char kHex[] = "0123456789abcdef";
+  out->push_back('"');
+  size_t run = 0;  // Start of the characters not needing escapes.
+  for (size_t i = 0; i < n; i++) {
+    const unsigned char c = static_cast<unsigned char>(s[i]);
+    if (c >= 0x20 && c != '"' && c != '\\') continue;
+    out->append(s + run, i - run);
+    run = i + 1;
+    out->push_back('\\');
+    switch (c) {
+      case '"':
+        out->push_back('"');
+        break;
+      case '\\':
+        out->push_back('\\');
+        break;
+      case '\b':
+        out->push_back('b');
+        break;
+      case '\f':
+        out->push_back('f');
+        break;
+      case '\n':
+        out->push_back('n');
+        break;
+      case '\r':
+        out->push_back('r');
+        break;
+      case '\t':
+        out->push_back('t');
+        break;
+      default:
+        out->append("u00");
+        out->push_back(kHex[c >> 4]);
+        out->push_back(kHex[c & 0xf]);
+        break;
+    }
+  }
+  out->append(s + run, n - run);
+  out->push_back('"');
+}
+
+void JsonWriterAppendUint(std::string *out, uint64_t v) {
+  char buf[20];
+  char *p = buf + sizeof(buf);
+  do {
+    *--p = char('0' + (v % 10));
+    v /= 10;
+  } while (v);
+  out->append(p, size_t(buf + sizeof(buf) - p));
+}
+
+template <typename T>
+void JsonWriterAppendNumber(std::string *out, T v, std::true_type) {
+  // Floating point: shortest representation which round-trips.
+  const double d = static_cast<double>(v);
+  if (!std::isfinite(d)) {
+    out->append("null");
+    return;
+  }
+  char buf[64];
 #ifdef TINYGLTF_USE_RAPIDJSON
-  dest.CopyFrom(src, GetAllocator());
+  const char *end = rapidjson::internal::dtoa(d, buf);
+#elif defined(TINYGLTF_USE_SIMDJSON)
+  const char *end = simdjson::internal::to_chars(buf, buf + sizeof(buf), d);
 #else
-  dest = src;
+  const char *end = nlohmann::detail::to_chars(buf, buf + sizeof(buf), d);
 #endif
+  out->append(buf, size_t(end - buf));
+}
+
+template <typename T>
+void JsonWriterAppendNumber(std::string *out, T v, std::false_type) {
+  if (v < T(0)) {
+    out->push_back('-');
+    JsonWriterAppendUint(out, uint64_t(0) - uint64_t(int64_t(v)));
+  } else {
+    JsonWriterAppendUint(out, uint64_t(v));
+  }
+}
+
+template <typename T>
+void JsonWriterAppendNumber(std::string *out, T v) {
+  JsonWriterAppendNumber(out, v, std::is_floating_point<T>());
+}
+
+void JsonWriterAppendValue(std::string *out, const JsonWriterValue &v) {
+  switch (v.kind) {
+    case JsonWriterValue::kObject:
+      out->push_back('{');
+      out->append(v.text);
+      out->push_back('}');
+      break;
+    case JsonWriterValue::kArray:
+      out->push_back('[');
+      out->append(v.text);
+      out->push_back(']');
+      break;
+    case JsonWriterValue::kLiteral:
+      out->append(v.text);
+      break;
+    case JsonWriterValue::kNull:
+      out->append("null");
+      break;
+  }
+}
+
+// Starts a member of `o` and returns the text to write its value to.
+std::string *JsonWriterBeginMember(JsonWriterValue &o, const char *key) {
+  o.kind = JsonWriterValue::kObject;
+  if (!o.text.empty()) o.text.push_back(',');
+  JsonWriterAppendString(&o.text, key, strlen(key));
+  o.text.push_back(':');
+  return &o.text;
 }
 
-void JsonAddMember(json &o, const char *key, json &&value) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  if (!o.IsObject()) {
-    o.SetObject();
-  }
-  o.AddMember(json(key, GetAllocator()), std::move(value), GetAllocator());
-#else
-  o[key] = std::move(value);
-#endif
+// Starts an element of `o` and returns the text to write it to.
+std::string *JsonWriterBeginElement(JsonWriterValue &o) {
+  o.kind = JsonWriterValue::kArray;
+  if (!o.text.empty()) o.text.push_back(',');
+  return &o.text;
 }
 
-void JsonPushBack(json &o, json &&value) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  o.PushBack(std::move(value), GetAllocator());
-#else
-  o.push_back(std::move(value));
-#endif
+void JsonAddMember(JsonWriterValue &o, const char *key,
+                   JsonWriterValue &&value) {
+  JsonWriterAppendValue(JsonWriterBeginMember(o, key), value);
 }
 
-bool JsonIsNull(const json &o) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  return o.IsNull();
-#else
-  return o.is_null();
-#endif
+void JsonPushBack(JsonWriterValue &o, JsonWriterValue &&value) {
+  JsonWriterAppendValue(JsonWriterBeginElement(o), value);
 }
 
-void JsonSetObject(json &o) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  o.SetObject();
-#else
-  o = o.object({});
-#endif
+bool JsonIsNull(const JsonWriterValue &o) {
+  return o.kind == JsonWriterValue::kNull;
 }
 
-void JsonReserveArray(json &o, size_t s) {
-#ifdef TINYGLTF_USE_RAPIDJSON
-  o.SetArray();
-  o.Reserve(static_cast<rapidjson::SizeType>(s), GetAllocator());
-#endif
-  (void)(o);
+void JsonSetObject(JsonWriterValue &o) {
+  o.kind = JsonWriterValue::kObject;
+  o.text.clear();
+}
+
+void JsonReserveArray(JsonWriterValue &o, size_t s) {
+  o.kind = JsonWriterValue::kArray;
   (void)(s);
 }
+
+// Indents the compact JSON text written by JsonWriterValue like
+// `json::dump(spacing)`.
+std::string JsonWriterIndent(const std::string &in, int spacing) {
+  std::string out;
+  out.reserve(in.size() + in.size() / 2);
+  size_t depth = 0;
+  auto newline = [&]() {
+    out.push_back('\n');
+    out.append(depth * size_t(spacing), ' ');
+  };
+  for (size_t i = 0; i < in.size(); i++) {
+    const char c = in[i];
+    switch (c) {
+      case '"': {
+        // Copy the string as is.
+        size_t j = i + 1;
+        while (j < in.size() && in[j] != '"') {
+          j += (in[j] == '\\') ? 2 : 1;
+        }
+        out.append(in, i, j + 1 - i);
+        i = j;
+        break;
+      }
+      case '{':
+      case '[':
+        out.push_back(c);
+        if (i + 1 < in.size() && (in[i + 1] == '}' || in[i + 1] == ']')) {
+          out.push_back(in[++i]);  // Empty object or array.
+        } else {
+          depth++;
+          newline();
+        }
+        break;
+      case '}':
+      case ']':
+        depth--;
+        newline();
+        out.push_back(c);
+        break;
+      case ',':
+        out.push_back(c);
+        newline();
+        break;
+      case ':':
+        out.append(": ");
+        break;
+      default:
+        out.push_back(c);
+        break;
+    }
+  }
+  return out;
+}
+
+std::string JsonToString(const JsonWriterValue &o, int spacing = -1) {
+  std::string out;
+  out.reserve(o.text.size() + 2);
+  JsonWriterAppendValue(&out, o);
+  if (spacing >= 0) {
+    return JsonWriterIndent(out, spacing);
+  }
+  return out;
+}
 }  // namespace
 
+#ifndef TINYGLTF_USE_SIMDJSON
 // typedef std::pair<std::string, json> json_object_pair;
 
 template <typename T>
@@ -6389,9 +12012,9 @@ void SerializeNumberProperty(const std::string &key, size_t number, json &obj) {
 }
 #endif
 
-template <typename T>
+template <typename T, typename Alloc>
 static void SerializeNumberArrayProperty(const std::string &key,
-                                         const std::vector<T> &value,
+                                         const std::vector<T, Alloc> &value,
                                          json &obj) {
   if (value.empty()) return;
 
@@ -6418,7 +12041,51 @@ static void SerializeStringArrayProperty(const std::string &key,
   }
   JsonAddMember(obj, key.c_str(), std::move(ary));
 }
+#endif  // !TINYGLTF_USE_SIMDJSON
+
+// Direct writer versions. Values are written without building a JSON value.
+
+template <typename T>
+static void SerializeNumberProperty(const std::string &key, T number,
+                                    JsonWriterValue &obj) {
+  JsonWriterAppendNumber(JsonWriterBeginMember(obj, key.c_str()), number);
+}
+
+template <typename T, typename Alloc>
+static void SerializeNumberArrayProperty(const std::string &key,
+                                         const std::vector<T, Alloc> &value,
+                                         JsonWriterValue &obj) {
+  if (value.empty()) return;
+
+  std::string *out = JsonWriterBeginMember(obj, key.c_str());
+  out->push_back('[');
+  for (size_t i = 0; i < value.size(); i++) {
+    if (i) out->push_back(',');
+    JsonWriterAppendNumber(out, value[i]);
+  }
+  out->push_back(']');
+}
+
+static void SerializeStringProperty(const std::string &key,
+                                    const std::string &value,
+                                    JsonWriterValue &obj) {
+  JsonWriterAppendString(JsonWriterBeginMember(obj, key.c_str()), value.data(),
+                         value.size());
+}
 
+static void SerializeStringArrayProperty(const std::string &key,
+                                         const std::vector<std::string> &value,
+                                         JsonWriterValue &obj) {
+  std::string *out = JsonWriterBeginMember(obj, key.c_str());
+  out->push_back('[');
+  for (size_t i = 0; i < value.size(); i++) {
+    if (i) out->push_back(',');
+    JsonWriterAppendString(out, value[i].data(), value[i].size());
+  }
+  out->push_back(']');
+}
+
+#ifndef TINYGLTF_USE_SIMDJSON
 static bool ValueToJson(const Value &value, json *ret) {
   json obj;
 #ifdef TINYGLTF_USE_RAPIDJSON
@@ -6454,7 +12121,7 @@ static bool ValueToJson(const Value &value, json *ret) {
       break;
     case OBJECT_TYPE: {
       obj.SetObject();
-      Value::Object objMap = value.Get<Value::Object>();
+      const Value::Object &objMap = value.Get<Value::Object>();
       for (auto &it : objMap) {
         json elementJson;
         if (ValueToJson(it.second, &elementJson)) {
@@ -6497,7 +12164,7 @@ static bool ValueToJson(const Value &value, json *ret) {
       return false;
       break;
     case OBJECT_TYPE: {
-      Value::Object objMap = value.Get<Value::Object>();
+      const Value::Object &objMap = value.Get<Value::Object>();
       for (auto &it : objMap) {
         json elementJson;
         if (ValueToJson(it.second, &elementJson)) obj[it.first] = elementJson;
@@ -6515,22 +12182,76 @@ static bool ValueToJson(const Value &value, json *ret) {
   if (ret) *ret = std::move(obj);
   return true;
 }
+#endif  // !TINYGLTF_USE_SIMDJSON
+
+static bool ValueToJson(const Value &value, JsonWriterValue *ret) {
+  JsonWriterValue obj;
+  switch (value.Type()) {
+    case REAL_TYPE:
+      obj.kind = JsonWriterValue::kLiteral;
+      JsonWriterAppendNumber(&obj.text, value.Get<double>());
+      break;
+    case INT_TYPE:
+      obj.kind = JsonWriterValue::kLiteral;
+      JsonWriterAppendNumber(&obj.text, value.Get<int>());
+      break;
+    case UINT_TYPE:
+      obj.kind = JsonWriterValue::kLiteral;
+      JsonWriterAppendNumber(&obj.text, value.Get<uint64_t>());
+      break;
+    case BOOL_TYPE:
+      obj.kind = JsonWriterValue::kLiteral;
+      obj.text = value.Get<bool>() ? "true" : "false";
+      break;
+    case STRING_TYPE: {
+      obj.kind = JsonWriterValue::kLiteral;
+      const std::string &str = value.Get<std::string>();
+      JsonWriterAppendString(&obj.text, str.data(), str.size());
+      break;
+    }
+    case ARRAY_TYPE: {
+      obj.kind = JsonWriterValue::kArray;
+      for (size_t i = 0; i < value.ArrayLen(); ++i) {
+        JsonWriterValue elementJson;
+        if (ValueToJson(value.Get(int(i)), &elementJson))
+          JsonPushBack(obj, std::move(elementJson));
+      }
+      break;
+    }
+    case OBJECT_TYPE: {
+      obj.kind = JsonWriterValue::kObject;
+      for (const auto &it : value.Get<Value::Object>()) {
+        JsonWriterValue elementJson;
+        if (ValueToJson(it.second, &elementJson))
+          JsonAddMember(obj, it.first.c_str(), std::move(elementJson));
+      }
+      break;
+    }
+    case BINARY_TYPE:
+    case NULL_TYPE:
+    default:
+      return false;
+  }
+  if (ret) *ret = std::move(obj);
+  return true;
+}
 
+template <typename J>
 static void SerializeValue(const std::string &key, const Value &value,
-                           json &obj) {
-  json ret;
+                           J &obj) {
+  J ret;
   if (ValueToJson(value, &ret)) {
     JsonAddMember(obj, key.c_str(), std::move(ret));
   }
 }
 
-static void SerializeGltfBufferData(const std::vector<unsigned char> &data,
-                                    json &o) {
+template <typename J>
+static void SerializeGltfBufferData(const unsigned char *data,
+                                    size_t data_size, J &o) {
   std::string header = "data:application/octet-stream;base64,";
-  if (data.size() > 0) {
-    std::string encodedData =
-        base64_encode(&data[0], static_cast<unsigned int>(data.size()));
-    SerializeStringProperty("uri", header + encodedData, o);
+  if (data_size > 0) {
+    base64_encode(data, data_size, &header);
+    SerializeStringProperty("uri", header, o);
   } else {
     // Issue #229
     // size 0 is allowd. Just emit mime header.
@@ -6538,7 +12259,8 @@ static void SerializeGltfBufferData(const std::vector<unsigned char> &data,
   }
 }
 
-static bool SerializeGltfBufferData(const std::vector<unsigned char> &data,
+static bool SerializeGltfBufferData(const unsigned char *data,
+                                    size_t data_size,
                                     const std::string &binFilename) {
 #ifdef _WIN32
 #if defined(__GLIBCXX__)  // mingw
@@ -6559,9 +12281,9 @@ static bool SerializeGltfBufferData(const std::vector<unsigned char> &data,
   std::ofstream output(binFilename.c_str(), std::ofstream::binary);
   if (!output.is_open()) return false;
 #endif
-  if (data.size() > 0) {
-    output.write(reinterpret_cast<const char *>(&data[0]),
-                 std::streamsize(data.size()));
+  if (data_size > 0) {
+    output.write(reinterpret_cast<const char *>(data),
+                 std::streamsize(data_size));
   } else {
     // Issue #229
     // size 0 will be still valid buffer data.
@@ -6601,14 +12323,15 @@ static void SerializeParameterMap(ParameterMap &param, json &o) {
 }
 #endif
 
-static void SerializeExtensionMap(const ExtensionMap &extensions, json &o) {
-  if (!extensions.size()) return;
-
-  json extMap;
+// Adds the members of `extensions` to `extMap`, except for `skip`.
+template <typename J>
+static void SerializeExtensionMembers(const ExtensionMap &extensions,
+                                      const char *skip, J &extMap) {
   for (ExtensionMap::const_iterator extIt = extensions.begin();
        extIt != extensions.end(); ++extIt) {
+    if (skip && extIt->first == skip) continue;
     // Allow an empty object for extension(#97)
-    json ret;
+    J ret;
     bool isNull = true;
     if (ValueToJson(extIt->second, &ret)) {
       isNull = JsonIsNull(ret);
@@ -6618,21 +12341,30 @@ static void SerializeExtensionMap(const ExtensionMap &extensions, json &o) {
       if (!(extIt->first.empty())) {  // name should not be empty, but for sure
         // create empty object so that an extension name is still included in
         // json.
-        json empty;
+        J empty;
         JsonSetObject(empty);
         JsonAddMember(extMap, extIt->first.c_str(), std::move(empty));
       }
     }
   }
+}
+
+template <typename J>
+static void SerializeExtensionMap(const ExtensionMap &extensions, J &o) {
+  if (!extensions.size()) return;
+
+  J extMap;
+  SerializeExtensionMembers(extensions, nullptr, extMap);
   JsonAddMember(o, "extensions", std::move(extMap));
 }
 
-static void SerializeGltfAccessor(Accessor &accessor, json &o) {
+template <typename J>
+static void SerializeGltfAccessor(Accessor &accessor, J &o) {
   if (accessor.bufferView >= 0)
     SerializeNumberProperty<int>("bufferView", accessor.bufferView, o);
 
   if (accessor.byteOffset != 0)
-    SerializeNumberProperty<int>("byteOffset", int(accessor.byteOffset), o);
+    SerializeNumberProperty<size_t>("byteOffset", accessor.byteOffset, o);
 
   SerializeNumberProperty<int>("componentType", accessor.componentType, o);
   SerializeNumberProperty<size_t>("count", accessor.count, o);
@@ -6693,15 +12425,18 @@ static void SerializeGltfAccessor(Accessor &accessor, json &o) {
   SerializeStringProperty("type", type, o);
   if (!accessor.name.empty()) SerializeStringProperty("name", accessor.name, o);
 
+  SerializeExtensionMap(accessor.extensions, o);
+
   if (accessor.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", accessor.extras, o);
   }
 }
 
-static void SerializeGltfAnimationChannel(AnimationChannel &channel, json &o) {
+template <typename J>
+static void SerializeGltfAnimationChannel(AnimationChannel &channel, J &o) {
   SerializeNumberProperty("sampler", channel.sampler, o);
   {
-    json target;
+    J target;
     SerializeNumberProperty("node", channel.target_node, target);
     SerializeStringProperty("path", channel.target_path, target);
 
@@ -6717,25 +12452,29 @@ static void SerializeGltfAnimationChannel(AnimationChannel &channel, json &o) {
   SerializeExtensionMap(channel.extensions, o);
 }
 
-static void SerializeGltfAnimationSampler(AnimationSampler &sampler, json &o) {
+template <typename J>
+static void SerializeGltfAnimationSampler(AnimationSampler &sampler, J &o) {
   SerializeNumberProperty("input", sampler.input, o);
   SerializeNumberProperty("output", sampler.output, o);
   SerializeStringProperty("interpolation", sampler.interpolation, o);
 
+  SerializeExtensionMap(sampler.extensions, o);
+
   if (sampler.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", sampler.extras, o);
   }
 }
 
-static void SerializeGltfAnimation(Animation &animation, json &o) {
+template <typename J>
+static void SerializeGltfAnimation(Animation &animation, J &o) {
   if (!animation.name.empty())
     SerializeStringProperty("name", animation.name, o);
 
   {
-    json channels;
+    J channels;
     JsonReserveArray(channels, animation.channels.size());
     for (unsigned int i = 0; i < animation.channels.size(); ++i) {
-      json channel;
+      J channel;
       AnimationChannel gltfChannel = animation.channels[i];
       SerializeGltfAnimationChannel(gltfChannel, channel);
       JsonPushBack(channels, std::move(channel));
@@ -6745,10 +12484,10 @@ static void SerializeGltfAnimation(Animation &animation, json &o) {
   }
 
   {
-    json samplers;
+    J samplers;
     JsonReserveArray(samplers, animation.samplers.size());
     for (unsigned int i = 0; i < animation.samplers.size(); ++i) {
-      json sampler;
+      J sampler;
       AnimationSampler gltfSampler = animation.samplers[i];
       SerializeGltfAnimationSampler(gltfSampler, sampler);
       JsonPushBack(samplers, std::move(sampler));
@@ -6763,7 +12502,8 @@ static void SerializeGltfAnimation(Animation &animation, json &o) {
   SerializeExtensionMap(animation.extensions, o);
 }
 
-static void SerializeGltfAsset(Asset &asset, json &o) {
+template <typename J>
+static void SerializeGltfAsset(Asset &asset, J &o) {
   if (!asset.generator.empty()) {
     SerializeStringProperty("generator", asset.generator, o);
   }
@@ -6788,46 +12528,84 @@ static void SerializeGltfAsset(Asset &asset, json &o) {
   SerializeExtensionMap(asset.extensions, o);
 }
 
-static void SerializeGltfBufferBin(Buffer &buffer, json &o,
-                                   std::vector<unsigned char> &binBuffer) {
-  SerializeNumberProperty("byteLength", buffer.data.size(), o);
-  binBuffer = buffer.data;
+// Part of the GLB BIN chunk, written at `offset` from the start of the chunk.
+// The gaps between segments are zero filled.
+struct GlbBinSegment {
+  const unsigned char *data;
+  size_t size;
+  size_t offset;
+};
+
+// BIN chunk of a GLB whose buffers(and images) are packed into one buffer.
+struct GlbBinLayout {
+  std::vector<GlbBinSegment> segments;
+  std::vector<size_t> bufferOffsets;  // BIN offset of each model buffer.
+  std::vector<BufferView> imageViews;  // Appended to the model's bufferViews.
+  std::vector<int> imageBufferViews;   // Per image, -1 = not packed.
+  std::vector<std::string> imageMimeTypes;
+  std::vector<std::vector<unsigned char> > imageData;  // Encoded images.
+  size_t size = 0;
+};
+
+// The buffer data itself is written as the GLB BIN chunk by the caller.
+template <typename J>
+static void SerializeGltfBufferBin(Buffer &buffer, J &o) {
+  SerializeNumberProperty("byteLength", buffer.DataSize(), o);
 
   if (buffer.name.size()) SerializeStringProperty("name", buffer.name, o);
 
+  SerializeExtensionMap(buffer.extensions, o);
+
   if (buffer.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", buffer.extras, o);
   }
 }
 
-static void SerializeGltfBuffer(Buffer &buffer, json &o) {
-  SerializeNumberProperty("byteLength", buffer.data.size(), o);
-  SerializeGltfBufferData(buffer.data, o);
+template <typename J>
+static void SerializeGltfBuffer(Buffer &buffer, J &o) {
+  SerializeNumberProperty("byteLength", buffer.DataSize(), o);
+  SerializeGltfBufferData(buffer.DataPtr(), buffer.DataSize(), o);
 
   if (buffer.name.size()) SerializeStringProperty("name", buffer.name, o);
 
+  SerializeExtensionMap(buffer.extensions, o);
+
   if (buffer.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", buffer.extras, o);
   }
 }
 
-static bool SerializeGltfBuffer(Buffer &buffer, json &o,
+template <typename J>
+static bool SerializeGltfBuffer(Buffer &buffer, J &o,
                                 const std::string &binFilename,
                                 const std::string &binBaseFilename) {
-  if (!SerializeGltfBufferData(buffer.data, binFilename)) return false;
-  SerializeNumberProperty("byteLength", buffer.data.size(), o);
+  if (!SerializeGltfBufferData(buffer.DataPtr(), buffer.DataSize(),
+                               binFilename))
+    return false;
+  SerializeNumberProperty("byteLength", buffer.DataSize(), o);
   SerializeStringProperty("uri", binBaseFilename, o);
 
   if (buffer.name.size()) SerializeStringProperty("name", buffer.name, o);
 
+  SerializeExtensionMap(buffer.extensions, o);
+
   if (buffer.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", buffer.extras, o);
   }
   return true;
 }
 
-static void SerializeGltfBufferView(BufferView &bufferView, json &o) {
-  SerializeNumberProperty("buffer", bufferView.buffer, o);
+// `layout`: when not null, the view is rewritten to point into the packed
+// GLB buffer.
+template <typename J>
+static void SerializeGltfBufferView(const BufferView &bufferView, J &o,
+                                    const GlbBinLayout *layout = nullptr) {
+  const int buffer = layout ? 0 : bufferView.buffer;
+  const size_t byteOffset =
+      layout ? layout->bufferOffsets[size_t(bufferView.buffer)] +
+                   bufferView.byteOffset
+             : bufferView.byteOffset;
+  SerializeNumberProperty("buffer", buffer, o);
   SerializeNumberProperty<size_t>("byteLength", bufferView.byteLength, o);
 
   // byteStride is optional, minimum allowed is 4
@@ -6835,8 +12613,8 @@ static void SerializeGltfBufferView(BufferView &bufferView, json &o) {
     SerializeNumberProperty<size_t>("byteStride", bufferView.byteStride, o);
   }
   // byteOffset is optional, default is 0
-  if (bufferView.byteOffset > 0) {
-    SerializeNumberProperty<size_t>("byteOffset", bufferView.byteOffset, o);
+  if (byteOffset > 0) {
+    SerializeNumberProperty<size_t>("byteOffset", byteOffset, o);
   }
   // Target is optional, check if it contains a valid value
   if (bufferView.target == TINYGLTF_TARGET_ARRAY_BUFFER ||
@@ -6847,14 +12625,23 @@ static void SerializeGltfBufferView(BufferView &bufferView, json &o) {
     SerializeStringProperty("name", bufferView.name, o);
   }
 
+  SerializeExtensionMap(bufferView.extensions, o);
+
   if (bufferView.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", bufferView.extras, o);
   }
 }
 
-static void SerializeGltfImage(Image &image, json &o) {
-  // if uri empty, the mimeType and bufferview should be set
-  if (image.uri.empty()) {
+// `packedBufferView`: when not -1, the image is stored in this bufferView of
+// the packed GLB buffer.
+template <typename J>
+static void SerializeGltfImage(Image &image, J &o, int packedBufferView = -1,
+                               const std::string &packedMimeType = "") {
+  if (packedBufferView != -1) {
+    SerializeStringProperty("mimeType", packedMimeType, o);
+    SerializeNumberProperty<int>("bufferView", packedBufferView, o);
+  } else if (image.uri.empty()) {
+    // if uri empty, the mimeType and bufferview should be set
     SerializeStringProperty("mimeType", image.mimeType, o);
     SerializeNumberProperty<int>("bufferView", image.bufferView, o);
   } else {
@@ -6873,7 +12660,8 @@ static void SerializeGltfImage(Image &image, json &o) {
   SerializeExtensionMap(image.extensions, o);
 }
 
-static void SerializeGltfTextureInfo(TextureInfo &texinfo, json &o) {
+template <typename J>
+static void SerializeGltfTextureInfo(TextureInfo &texinfo, J &o) {
   SerializeNumberProperty("index", texinfo.index, o);
 
   if (texinfo.texCoord != 0) {
@@ -6887,8 +12675,9 @@ static void SerializeGltfTextureInfo(TextureInfo &texinfo, json &o) {
   SerializeExtensionMap(texinfo.extensions, o);
 }
 
+template <typename J>
 static void SerializeGltfNormalTextureInfo(NormalTextureInfo &texinfo,
-                                           json &o) {
+                                           J &o) {
   SerializeNumberProperty("index", texinfo.index, o);
 
   if (texinfo.texCoord != 0) {
@@ -6906,8 +12695,9 @@ static void SerializeGltfNormalTextureInfo(NormalTextureInfo &texinfo,
   SerializeExtensionMap(texinfo.extensions, o);
 }
 
+template <typename J>
 static void SerializeGltfOcclusionTextureInfo(OcclusionTextureInfo &texinfo,
-                                              json &o) {
+                                              J &o) {
   SerializeNumberProperty("index", texinfo.index, o);
 
   if (texinfo.texCoord != 0) {
@@ -6925,8 +12715,9 @@ static void SerializeGltfOcclusionTextureInfo(OcclusionTextureInfo &texinfo,
   SerializeExtensionMap(texinfo.extensions, o);
 }
 
+template <typename J>
 static void SerializeGltfPbrMetallicRoughness(PbrMetallicRoughness &pbr,
-                                              json &o) {
+                                              J &o) {
   std::vector<double> default_baseColorFactor = {1.0, 1.0, 1.0, 1.0};
   if (!Equals(pbr.baseColorFactor, default_baseColorFactor)) {
     SerializeNumberArrayProperty<double>("baseColorFactor", pbr.baseColorFactor,
@@ -6942,13 +12733,13 @@ static void SerializeGltfPbrMetallicRoughness(PbrMetallicRoughness &pbr,
   }
 
   if (pbr.baseColorTexture.index > -1) {
-    json texinfo;
+    J texinfo;
     SerializeGltfTextureInfo(pbr.baseColorTexture, texinfo);
     JsonAddMember(o, "baseColorTexture", std::move(texinfo));
   }
 
   if (pbr.metallicRoughnessTexture.index > -1) {
-    json texinfo;
+    J texinfo;
     SerializeGltfTextureInfo(pbr.metallicRoughnessTexture, texinfo);
     JsonAddMember(o, "metallicRoughnessTexture", std::move(texinfo));
   }
@@ -6960,7 +12751,8 @@ static void SerializeGltfPbrMetallicRoughness(PbrMetallicRoughness &pbr,
   }
 }
 
-static void SerializeGltfMaterial(Material &material, json &o) {
+template <typename J>
+static void SerializeGltfMaterial(Material &material, J &o) {
   if (material.name.size()) {
     SerializeStringProperty("name", material.name, o);
   }
@@ -6976,22 +12768,22 @@ static void SerializeGltfMaterial(Material &material, json &o) {
   }
 
   if (material.doubleSided != false)
-    JsonAddMember(o, "doubleSided", json(material.doubleSided));
+    SerializeValue("doubleSided", Value(material.doubleSided), o);
 
   if (material.normalTexture.index > -1) {
-    json texinfo;
+    J texinfo;
     SerializeGltfNormalTextureInfo(material.normalTexture, texinfo);
     JsonAddMember(o, "normalTexture", std::move(texinfo));
   }
 
   if (material.occlusionTexture.index > -1) {
-    json texinfo;
+    J texinfo;
     SerializeGltfOcclusionTextureInfo(material.occlusionTexture, texinfo);
     JsonAddMember(o, "occlusionTexture", std::move(texinfo));
   }
 
   if (material.emissiveTexture.index > -1) {
-    json texinfo;
+    J texinfo;
     SerializeGltfTextureInfo(material.emissiveTexture, texinfo);
     JsonAddMember(o, "emissiveTexture", std::move(texinfo));
   }
@@ -7003,7 +12795,7 @@ static void SerializeGltfMaterial(Material &material, json &o) {
   }
 
   {
-    json pbrMetallicRoughness;
+    J pbrMetallicRoughness;
     SerializeGltfPbrMetallicRoughness(material.pbrMetallicRoughness,
                                       pbrMetallicRoughness);
     // Issue 204
@@ -7019,7 +12811,7 @@ static void SerializeGltfMaterial(Material &material, json &o) {
 
 #if 0  // legacy way. just for the record.
   if (material.values.size()) {
-    json pbrMetallicRoughness;
+    J pbrMetallicRoughness;
     SerializeParameterMap(material.values, pbrMetallicRoughness);
     JsonAddMember(o, "pbrMetallicRoughness", std::move(pbrMetallicRoughness));
   }
@@ -7036,14 +12828,15 @@ static void SerializeGltfMaterial(Material &material, json &o) {
   }
 }
 
-static void SerializeGltfMesh(Mesh &mesh, json &o) {
-  json primitives;
+template <typename J>
+static void SerializeGltfMesh(Mesh &mesh, J &o) {
+  J primitives;
   JsonReserveArray(primitives, mesh.primitives.size());
   for (unsigned int i = 0; i < mesh.primitives.size(); ++i) {
-    json primitive;
+    J primitive;
     const Primitive &gltfPrimitive = mesh.primitives[i];  // don't make a copy
     {
-      json attributes;
+      J attributes;
       for (auto attrIt = gltfPrimitive.attributes.begin();
            attrIt != gltfPrimitive.attributes.end(); ++attrIt) {
         SerializeNumberProperty<int>(attrIt->first, attrIt->second, attributes);
@@ -7065,12 +12858,12 @@ static void SerializeGltfMesh(Mesh &mesh, json &o) {
 
     // Morph targets
     if (gltfPrimitive.targets.size()) {
-      json targets;
+      J targets;
       JsonReserveArray(targets, gltfPrimitive.targets.size());
       for (unsigned int k = 0; k < gltfPrimitive.targets.size(); ++k) {
-        json targetAttributes;
-        std::map<std::string, int> targetData = gltfPrimitive.targets[k];
-        for (std::map<std::string, int>::iterator attrIt = targetData.begin();
+        J targetAttributes;
+        const StringMap<int> &targetData = gltfPrimitive.targets[k];
+        for (StringMap<int>::const_iterator attrIt = targetData.begin();
              attrIt != targetData.end(); ++attrIt) {
           SerializeNumberProperty<int>(attrIt->first, attrIt->second,
                                        targetAttributes);
@@ -7105,7 +12898,8 @@ static void SerializeGltfMesh(Mesh &mesh, json &o) {
   }
 }
 
-static void SerializeSpotLight(SpotLight &spot, json &o) {
+template <typename J>
+static void SerializeSpotLight(SpotLight &spot, J &o) {
   SerializeNumberProperty("innerConeAngle", spot.innerConeAngle, o);
   SerializeNumberProperty("outerConeAngle", spot.outerConeAngle, o);
   SerializeExtensionMap(spot.extensions, o);
@@ -7114,7 +12908,8 @@ static void SerializeSpotLight(SpotLight &spot, json &o) {
   }
 }
 
-static void SerializeGltfLight(Light &light, json &o) {
+template <typename J>
+static void SerializeGltfLight(Light &light, J &o) {
   if (!light.name.empty()) SerializeStringProperty("name", light.name, o);
   SerializeNumberProperty("intensity", light.intensity, o);
   if (light.range > 0.0) {
@@ -7123,7 +12918,7 @@ static void SerializeGltfLight(Light &light, json &o) {
   SerializeNumberArrayProperty("color", light.color, o);
   SerializeStringProperty("type", light.type, o);
   if (light.type == "spot") {
-    json spot;
+    J spot;
     SerializeSpotLight(light.spot, spot);
     JsonAddMember(o, "spot", std::move(spot));
   }
@@ -7133,7 +12928,8 @@ static void SerializeGltfLight(Light &light, json &o) {
   }
 }
 
-static void SerializeGltfNode(Node &node, json &o) {
+template <typename J>
+static void SerializeGltfNode(Node &node, J &o) {
   if (node.translation.size() > 0) {
     SerializeNumberArrayProperty<double>("translation", node.translation, o);
   }
@@ -7171,7 +12967,8 @@ static void SerializeGltfNode(Node &node, json &o) {
   SerializeNumberArrayProperty<int>("children", node.children, o);
 }
 
-static void SerializeGltfSampler(Sampler &sampler, json &o) {
+template <typename J>
+static void SerializeGltfSampler(Sampler &sampler, J &o) {
   if (sampler.magFilter != -1) {
     SerializeNumberProperty("magFilter", sampler.magFilter, o);
   }
@@ -7182,25 +12979,31 @@ static void SerializeGltfSampler(Sampler &sampler, json &o) {
   SerializeNumberProperty("wrapS", sampler.wrapS, o);
   SerializeNumberProperty("wrapT", sampler.wrapT, o);
 
+  SerializeExtensionMap(sampler.extensions, o);
+
   if (sampler.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", sampler.extras, o);
   }
 }
 
+template <typename J>
 static void SerializeGltfOrthographicCamera(const OrthographicCamera &camera,
-                                            json &o) {
+                                            J &o) {
   SerializeNumberProperty("zfar", camera.zfar, o);
   SerializeNumberProperty("znear", camera.znear, o);
   SerializeNumberProperty("xmag", camera.xmag, o);
   SerializeNumberProperty("ymag", camera.ymag, o);
 
+  SerializeExtensionMap(camera.extensions, o);
+
   if (camera.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", camera.extras, o);
   }
 }
 
+template <typename J>
 static void SerializeGltfPerspectiveCamera(const PerspectiveCamera &camera,
-                                           json &o) {
+                                           J &o) {
   SerializeNumberProperty("zfar", camera.zfar, o);
   SerializeNumberProperty("znear", camera.znear, o);
   if (camera.aspectRatio > 0) {
@@ -7211,23 +13014,26 @@ static void SerializeGltfPerspectiveCamera(const PerspectiveCamera &camera,
     SerializeNumberProperty("yfov", camera.yfov, o);
   }
 
+  SerializeExtensionMap(camera.extensions, o);
+
   if (camera.extras.Type() != NULL_TYPE) {
     SerializeValue("extras", camera.extras, o);
   }
 }
 
-static void SerializeGltfCamera(const Camera &camera, json &o) {
+template <typename J>
+static void SerializeGltfCamera(const Camera &camera, J &o) {
   SerializeStringProperty("type", camera.type, o);
   if (!camera.name.empty()) {
     SerializeStringProperty("name", camera.name, o);
   }
 
   if (camera.type.compare("orthographic") == 0) {
-    json orthographic;
+    J orthographic;
     SerializeGltfOrthographicCamera(camera.orthographic, orthographic);
     JsonAddMember(o, "orthographic", std::move(orthographic));
   } else if (camera.type.compare("perspective") == 0) {
-    json perspective;
+    J perspective;
     SerializeGltfPerspectiveCamera(camera.perspective, perspective);
     JsonAddMember(o, "perspective", std::move(perspective));
   } else {
@@ -7240,7 +13046,8 @@ static void SerializeGltfCamera(const Camera &camera, json &o) {
   SerializeExtensionMap(camera.extensions, o);
 }
 
-static void SerializeGltfScene(Scene &scene, json &o) {
+template <typename J>
+static void SerializeGltfScene(Scene &scene, J &o) {
   SerializeNumberArrayProperty<int>("nodes", scene.nodes, o);
 
   if (scene.name.size()) {
@@ -7252,7 +13059,8 @@ static void SerializeGltfScene(Scene &scene, json &o) {
   SerializeExtensionMap(scene.extensions, o);
 }
 
-static void SerializeGltfSkin(Skin &skin, json &o) {
+template <typename J>
+static void SerializeGltfSkin(Skin &skin, J &o) {
   // required
   SerializeNumberArrayProperty<int>("joints", skin.joints, o);
 
@@ -7267,9 +13075,16 @@ static void SerializeGltfSkin(Skin &skin, json &o) {
   if (skin.name.size()) {
     SerializeStringProperty("name", skin.name, o);
   }
+
+  SerializeExtensionMap(skin.extensions, o);
+
+  if (skin.extras.Type() != NULL_TYPE) {
+    SerializeValue("extras", skin.extras, o);
+  }
 }
 
-static void SerializeGltfTexture(Texture &texture, json &o) {
+template <typename J>
+static void SerializeGltfTexture(Texture &texture, J &o) {
   if (texture.sampler > -1) {
     SerializeNumberProperty("sampler", texture.sampler, o);
   }
@@ -7285,49 +13100,107 @@ static void SerializeGltfTexture(Texture &texture, json &o) {
   SerializeExtensionMap(texture.extensions, o);
 }
 
+// Number of elements serialized per parallel work item.
+static const size_t kSerializeBlockSize = 256;
+
+///
+/// Serializes `elements` into the JSON array `array` by calling
+/// `fn(element, json)`, which returns false to omit the element.
+/// With `num_threads` > 1 large arrays are serialized in parallel into
+/// separate values which are then appended in order, so the output is
+/// identical to the serial case.
+///
+template <typename T, typename Fn, typename J>
+static void SerializeGltfArray(std::vector<T> &elements, int num_threads,
+                               const Fn &fn, J &array) {
+  JsonReserveArray(array, elements.size());
+#if defined(TINYGLTF_USE_RAPIDJSON) && \
+    !defined(TINYGLTF_USE_RAPIDJSON_CRTALLOCATOR)
+  // The allocator of the active document is not thread safe.
+  num_threads = 1;
+#endif
+  const size_t numBlocks =
+      (elements.size() + kSerializeBlockSize - 1) / kSerializeBlockSize;
+  if (num_threads > 1 && numBlocks > 1) {
+    std::vector<J> fragments(elements.size());
+    std::vector<unsigned char> keep(elements.size());
+    ParallelFor(numBlocks, num_threads, [&](size_t b) {
+      const size_t end =
+          (std::min)(elements.size(), (b + 1) * kSerializeBlockSize);
+      for (size_t i = b * kSerializeBlockSize; i < end; i++) {
+        keep[i] = fn(elements[i], fragments[i]) ? 1 : 0;
+      }
+    });
+    for (size_t i = 0; i < elements.size(); i++) {
+      if (keep[i]) {
+        JsonPushBack(array, std::move(fragments[i]));
+      }
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < elements.size(); i++) {
+    J element;
+    if (fn(elements[i], element)) {
+      JsonPushBack(array, std::move(element));
+    }
+  }
+}
+
 ///
 /// Serialize all properties except buffers and images.
+/// `layout`: when not null, bufferViews are rewritten for the packed GLB
+/// buffer and the bufferViews of packed images are appended.
+/// `num_threads`: number of threads used for the top level arrays.
 ///
-static void SerializeGltfModel(Model *model, json &o) {
+template <typename J>
+static void SerializeGltfModel(Model *model, J &o, int num_threads = 1,
+                               const GlbBinLayout *layout = nullptr) {
   // ACCESSORS
   if (model->accessors.size()) {
-    json accessors;
-    JsonReserveArray(accessors, model->accessors.size());
-    for (unsigned int i = 0; i < model->accessors.size(); ++i) {
-      json accessor;
-      SerializeGltfAccessor(model->accessors[i], accessor);
-      JsonPushBack(accessors, std::move(accessor));
-    }
+    J accessors;
+    SerializeGltfArray(model->accessors, num_threads,
+                       [](Accessor &accessor, J &j) {
+                         SerializeGltfAccessor(accessor, j);
+                         return true;
+                       },
+                       accessors);
     JsonAddMember(o, "accessors", std::move(accessors));
   }
 
   // ANIMATIONS
   if (model->animations.size()) {
-    json animations;
-    JsonReserveArray(animations, model->animations.size());
-    for (unsigned int i = 0; i < model->animations.size(); ++i) {
-      if (model->animations[i].channels.size()) {
-        json animation;
-        SerializeGltfAnimation(model->animations[i], animation);
-        JsonPushBack(animations, std::move(animation));
-      }
-    }
+    J animations;
+    SerializeGltfArray(model->animations, num_threads,
+                       [](Animation &animation, J &j) {
+                         if (animation.channels.empty()) return false;
+                         SerializeGltfAnimation(animation, j);
+                         return true;
+                       },
+                       animations);
 
     JsonAddMember(o, "animations", std::move(animations));
   }
 
   // ASSET
-  json asset;
+  J asset;
   SerializeGltfAsset(model->asset, asset);
   JsonAddMember(o, "asset", std::move(asset));
 
   // BUFFERVIEWS
-  if (model->bufferViews.size()) {
-    json bufferViews;
-    JsonReserveArray(bufferViews, model->bufferViews.size());
-    for (unsigned int i = 0; i < model->bufferViews.size(); ++i) {
-      json bufferView;
-      SerializeGltfBufferView(model->bufferViews[i], bufferView);
+  const size_t numImageViews = layout ? layout->imageViews.size() : 0;
+  if (model->bufferViews.size() || numImageViews) {
+    J bufferViews;
+    SerializeGltfArray(model->bufferViews, num_threads,
+                       [layout](BufferView &bufferView, J &j) {
+                         SerializeGltfBufferView(bufferView, j, layout);
+                         return true;
+                       },
+                       bufferViews);
+    for (size_t i = 0; i < numImageViews; ++i) {
+      J bufferView;
+      // Already relative to the packed buffer.
+      SerializeGltfBufferView(layout->imageViews[i], bufferView);
       JsonPushBack(bufferViews, std::move(bufferView));
     }
     JsonAddMember(o, "bufferViews", std::move(bufferViews));
@@ -7341,47 +13214,48 @@ static void SerializeGltfModel(Model *model, json &o) {
 
   // MATERIALS
   if (model->materials.size()) {
-    json materials;
-    JsonReserveArray(materials, model->materials.size());
-    for (unsigned int i = 0; i < model->materials.size(); ++i) {
-      json material;
-      SerializeGltfMaterial(model->materials[i], material);
-
-      if (JsonIsNull(material)) {
-        // Issue 294.
-        // `material` does not have any required parameters
-        // so the result may be null(unmodified) when all material parameters
-        // have default value.
-        //
-        // null is not allowed thus we create an empty JSON object.
-        JsonSetObject(material);
-      }
-      JsonPushBack(materials, std::move(material));
-    }
+    J materials;
+    SerializeGltfArray(model->materials, num_threads,
+                       [](Material &material, J &j) {
+                         SerializeGltfMaterial(material, j);
+
+                         if (JsonIsNull(j)) {
+                           // Issue 294.
+                           // `material` does not have any required parameters
+                           // so the result may be null(unmodified) when all
+                           // material parameters have default value.
+                           //
+                           // null is not allowed thus we create an empty JSON
+                           // object.
+                           JsonSetObject(j);
+                         }
+                         return true;
+                       },
+                       materials);
     JsonAddMember(o, "materials", std::move(materials));
   }
 
   // MESHES
   if (model->meshes.size()) {
-    json meshes;
-    JsonReserveArray(meshes, model->meshes.size());
-    for (unsigned int i = 0; i < model->meshes.size(); ++i) {
-      json mesh;
-      SerializeGltfMesh(model->meshes[i], mesh);
-      JsonPushBack(meshes, std::move(mesh));
-    }
+    J meshes;
+    SerializeGltfArray(model->meshes, num_threads,
+                       [](Mesh &mesh, J &j) {
+                         SerializeGltfMesh(mesh, j);
+                         return true;
+                       },
+                       meshes);
     JsonAddMember(o, "meshes", std::move(meshes));
   }
 
   // NODES
   if (model->nodes.size()) {
-    json nodes;
-    JsonReserveArray(nodes, model->nodes.size());
-    for (unsigned int i = 0; i < model->nodes.size(); ++i) {
-      json node;
-      SerializeGltfNode(model->nodes[i], node);
-      JsonPushBack(nodes, std::move(node));
-    }
+    J nodes;
+    SerializeGltfArray(model->nodes, num_threads,
+                       [](Node &node, J &j) {
+                         SerializeGltfNode(node, j);
+                         return true;
+                       },
+                       nodes);
     JsonAddMember(o, "nodes", std::move(nodes));
   }
 
@@ -7392,89 +13266,85 @@ static void SerializeGltfModel(Model *model, json &o) {
 
   // SCENES
   if (model->scenes.size()) {
-    json scenes;
-    JsonReserveArray(scenes, model->scenes.size());
-    for (unsigned int i = 0; i < model->scenes.size(); ++i) {
-      json currentScene;
-      SerializeGltfScene(model->scenes[i], currentScene);
-      JsonPushBack(scenes, std::move(currentScene));
-    }
+    J scenes;
+    SerializeGltfArray(model->scenes, num_threads,
+                       [](Scene &currentScene, J &j) {
+                         SerializeGltfScene(currentScene, j);
+                         return true;
+                       },
+                       scenes);
     JsonAddMember(o, "scenes", std::move(scenes));
   }
 
   // SKINS
   if (model->skins.size()) {
-    json skins;
-    JsonReserveArray(skins, model->skins.size());
-    for (unsigned int i = 0; i < model->skins.size(); ++i) {
-      json skin;
-      SerializeGltfSkin(model->skins[i], skin);
-      JsonPushBack(skins, std::move(skin));
-    }
+    J skins;
+    SerializeGltfArray(model->skins, num_threads,
+                       [](Skin &skin, J &j) {
+                         SerializeGltfSkin(skin, j);
+                         return true;
+                       },
+                       skins);
     JsonAddMember(o, "skins", std::move(skins));
   }
 
   // TEXTURES
   if (model->textures.size()) {
-    json textures;
-    JsonReserveArray(textures, model->textures.size());
-    for (unsigned int i = 0; i < model->textures.size(); ++i) {
-      json texture;
-      SerializeGltfTexture(model->textures[i], texture);
-      JsonPushBack(textures, std::move(texture));
-    }
+    J textures;
+    SerializeGltfArray(model->textures, num_threads,
+                       [](Texture &texture, J &j) {
+                         SerializeGltfTexture(texture, j);
+                         return true;
+                       },
+                       textures);
     JsonAddMember(o, "textures", std::move(textures));
   }
 
   // SAMPLERS
   if (model->samplers.size()) {
-    json samplers;
-    JsonReserveArray(samplers, model->samplers.size());
-    for (unsigned int i = 0; i < model->samplers.size(); ++i) {
-      json sampler;
-      SerializeGltfSampler(model->samplers[i], sampler);
-      JsonPushBack(samplers, std::move(sampler));
-    }
+    J samplers;
+    SerializeGltfArray(model->samplers, num_threads,
+                       [](Sampler &sampler, J &j) {
+                         SerializeGltfSampler(sampler, j);
+                         return true;
+                       },
+                       samplers);
     JsonAddMember(o, "samplers", std::move(samplers));
   }
 
   // CAMERAS
   if (model->cameras.size()) {
-    json cameras;
-    JsonReserveArray(cameras, model->cameras.size());
-    for (unsigned int i = 0; i < model->cameras.size(); ++i) {
-      json camera;
-      SerializeGltfCamera(model->cameras[i], camera);
-      JsonPushBack(cameras, std::move(camera));
-    }
+    J cameras;
+    SerializeGltfArray(model->cameras, num_threads,
+                       [](Camera &camera, J &j) {
+                         SerializeGltfCamera(camera, j);
+                         return true;
+                       },
+                       cameras);
     JsonAddMember(o, "cameras", std::move(cameras));
   }
 
-  // EXTENSIONS
-  SerializeExtensionMap(model->extensions, o);
-
   auto extensionsUsed = model->extensionsUsed;
 
-  // LIGHTS as KHR_lights_punctual
-  if (model->lights.size()) {
-    json lights;
+  // EXTENSIONS
+  if (model->lights.empty()) {
+    SerializeExtensionMap(model->extensions, o);
+  } else {
+    // LIGHTS as KHR_lights_punctual
+
+    J lights;
     JsonReserveArray(lights, model->lights.size());
     for (unsigned int i = 0; i < model->lights.size(); ++i) {
-      json light;
+      J light;
       SerializeGltfLight(model->lights[i], light);
       JsonPushBack(lights, std::move(light));
     }
-    json khr_lights_cmn;
+    J khr_lights_cmn;
     JsonAddMember(khr_lights_cmn, "lights", std::move(lights));
-    json ext_j;
-
-    {
-      json_const_iterator it;
-      if (FindMember(o, "extensions", it)) {
-        JsonAssign(ext_j, GetValue(it));
-      }
-    }
 
+    // Replaces a "KHR_lights_punctual" stored in `model->extensions`.
+    J ext_j;
+    SerializeExtensionMembers(model->extensions, "KHR_lights_punctual", ext_j);
     JsonAddMember(ext_j, "KHR_lights_punctual", std::move(khr_lights_cmn));
 
     JsonAddMember(o, "extensions", std::move(ext_j));
@@ -7532,30 +13402,43 @@ static bool WriteGltfFile(const std::string &output,
   return WriteGltfStream(gltfFile, content);
 }
 
-static void WriteBinaryGltfStream(std::ostream &stream,
-                                  const std::string &content,
-                                  const std::vector<unsigned char> &binBuffer) {
-  const std::string header = "glTF";
-  const int version = 2;
+// 12 bytes for header, 8 bytes for JSON chunk info, 8 bytes for BIN chunk info.
+static const uint64_t kGlbChunksOverhead = 12 + 8 + 8;
 
-  // https://stackoverflow.com/questions/3407012/c-rounding-up-to-the-nearest-multiple-of-a-number
-  auto roundUp = [](uint32_t numToRound, uint32_t multiple) {
-    if (multiple == 0) return numToRound;
+// https://stackoverflow.com/questions/3407012/c-rounding-up-to-the-nearest-multiple-of-a-number
+static inline uint64_t RoundUp(uint64_t numToRound, uint64_t multiple) {
+  if (multiple == 0) return numToRound;
 
-    uint32_t remainder = numToRound % multiple;
-    if (remainder == 0) return numToRound;
+  uint64_t remainder = numToRound % multiple;
+  if (remainder == 0) return numToRound;
 
-    return numToRound + multiple - remainder;
-  };
+  return numToRound + multiple - remainder;
+}
 
-  const uint32_t padding_size =
-      roundUp(uint32_t(content.size()), 4) - uint32_t(content.size());
+// Writes the GLB container. The BIN chunk `segments` are written straight to
+// `stream`, so buffer data is never copied. Returns false without writing
+// anything when the GLB does not fit in the 32bit length fields of the
+// container, or when writing to `stream` failed.
+static bool WriteBinaryGltfStream(std::ostream &stream,
+                                  const std::string &content,
+                                  const std::vector<GlbBinSegment> &segments) {
+  const size_t bin_size =
+      segments.empty() ? 0 : segments.back().offset + segments.back().size;
+  const std::string header = "glTF";
+  const int version = 2;
 
   // 12 bytes for header, JSON content length, 8 bytes for JSON chunk info.
   // Chunk data must be located at 4-byte boundary.
-  const uint32_t length =
-      12 + 8 + roundUp(uint32_t(content.size()), 4) +
-      (binBuffer.size() ? (8 + roundUp(uint32_t(binBuffer.size()), 4)) : 0);
+  const uint64_t total_length =
+      12 + 8 + RoundUp(content.size(), 4) +
+      (bin_size ? (8 + RoundUp(bin_size, 4)) : 0);
+  if (total_length > uint64_t((std::numeric_limits<uint32_t>::max)())) {
+    return false;
+  }
+
+  const uint32_t padding_size =
+      uint32_t(RoundUp(content.size(), 4) - content.size());
+  const uint32_t length = uint32_t(total_length);
 
   stream.write(header.c_str(), std::streamsize(header.size()));
   stream.write(reinterpret_cast<const char *>(&version), sizeof(version));
@@ -7575,31 +13458,42 @@ static void WriteBinaryGltfStream(std::ostream &stream,
     const std::string padding = std::string(size_t(padding_size), ' ');
     stream.write(padding.c_str(), std::streamsize(padding.size()));
   }
-  if (binBuffer.size() > 0) {
+  if (bin_size > 0) {
     const uint32_t bin_padding_size =
-        roundUp(uint32_t(binBuffer.size()), 4) - uint32_t(binBuffer.size());
+        uint32_t(RoundUp(bin_size, 4) - bin_size);
     // BIN chunk info, then BIN data
-    const uint32_t bin_length = uint32_t(binBuffer.size()) + bin_padding_size;
+    const uint32_t bin_length = uint32_t(bin_size) + bin_padding_size;
     const uint32_t bin_format = 0x004e4942;
     stream.write(reinterpret_cast<const char *>(&bin_length),
                  sizeof(bin_length));
     stream.write(reinterpret_cast<const char *>(&bin_format),
                  sizeof(bin_format));
-    stream.write(reinterpret_cast<const char *>(binBuffer.data()),
-                 std::streamsize(binBuffer.size()));
-    // Chunksize must be multiplies of 4, so pad with zeroes
-    if (bin_padding_size > 0) {
-      const std::vector<unsigned char> padding =
-          std::vector<unsigned char>(size_t(bin_padding_size), 0);
-      stream.write(reinterpret_cast<const char *>(padding.data()),
-                   std::streamsize(padding.size()));
+    // Zero padding between segments and up to the chunk size, which must be
+    // multiplies of 4.
+    static const char zeros[16] = {0};
+    size_t offset = 0;
+    for (size_t i = 0; i <= segments.size(); i++) {
+      const size_t next =
+          (i < segments.size()) ? segments[i].offset : size_t(bin_length);
+      while (offset < next) {
+        const size_t n = (std::min)(next - offset, sizeof(zeros));
+        stream.write(zeros, std::streamsize(n));
+        offset += n;
+      }
+      if (i < segments.size()) {
+        stream.write(reinterpret_cast<const char *>(segments[i].data),
+                     std::streamsize(segments[i].size));
+        offset += segments[i].size;
+      }
     }
   }
+
+  return !stream.fail();
 }
 
-static void WriteBinaryGltfFile(const std::string &output,
+static bool WriteBinaryGltfFile(const std::string &output,
                                 const std::string &content,
-                                const std::vector<unsigned char> &binBuffer) {
+                                const std::vector<GlbBinSegment> &segments) {
 #ifdef _WIN32
 #if defined(_MSC_VER)
   std::ofstream gltfFile(UTF8ToWchar(output).c_str(), std::ios::binary);
@@ -7615,26 +13509,333 @@ static void WriteBinaryGltfFile(const std::string &output,
 #else
   std::ofstream gltfFile(output.c_str(), std::ios::binary);
 #endif
-  WriteBinaryGltfStream(gltfFile, content, binBuffer);
+  return WriteBinaryGltfStream(gltfFile, content, segments);
+}
+
+// Start of each buffer and image in a packed GLB BIN chunk.
+static const size_t kGlbBinAlignment = 16;
+
+static size_t AddGlbBinSegment(GlbBinLayout *layout, const unsigned char *data,
+                               size_t size) {
+  const size_t offset = size_t(RoundUp(layout->size, kGlbBinAlignment));
+  GlbBinSegment segment = {data, size, offset};
+  layout->segments.push_back(segment);
+  layout->size = offset + size;
+  return offset;
+}
+
+// Lays out all buffers of `model` and, when `packImages` is true, the encoded
+// data of its images in a single GLB BIN chunk. Images which are not packed
+// are updated for writing like the unpacked case(`embedImages`).
+// Returns false when the model can't be packed(invalid bufferView or larger
+// than the 4GB GLB container), `layout` is empty and the image URIs are
+// unchanged then.
+static bool BuildGlbBinLayout(Model *model, std::string &baseDir,
+                              bool packImages, bool embedImages,
+                              WriteImageDataFunction *WriteImageData,
+                              void *user_data, GlbBinLayout *layout) {
+  const uint64_t maxSize =
+      uint64_t((std::numeric_limits<uint32_t>::max)()) - kGlbChunksOverhead;
+  // The size of the encoded images is only known after writing them, check
+  // the buffers first.
+  uint64_t total = 0;
+  for (const Buffer &buffer : model->buffers) {
+    total = RoundUp(total, kGlbBinAlignment) + buffer.DataSize();
+  }
+  if (total > maxSize) {
+    return false;
+  }
+  for (const BufferView &bufferView : model->bufferViews) {
+    if (bufferView.buffer < 0 ||
+        size_t(bufferView.buffer) >= model->buffers.size()) {
+      return false;
+    }
+  }
+
+  for (const Buffer &buffer : model->buffers) {
+    layout->bufferOffsets.push_back(
+        AddGlbBinSegment(layout, buffer.DataPtr(), buffer.DataSize()));
+  }
+
+  // Segments point into `imageData`, so it must not reallocate.
+  layout->imageData.reserve(model->images.size());
+  // URIs of the images encoded through the image writer, restored when the
+  // packed images don't fit.
+  std::vector<std::pair<size_t, std::string> > encodedUris;
+  for (size_t i = 0; i < model->images.size(); i++) {
+    Image &image = model->images[i];
+    int bufferView = -1;
+    bool updated = false;
+    std::string mimeType = image.mimeType;
+    const bool inBufferView = image.uri.empty() && (image.bufferView != -1);
+    if (packImages && !inBufferView) {
+      const unsigned char *data = nullptr;
+      size_t size = 0;
+      if (image.as_is && !image.image.empty()) {
+        // Already encoded.
+        data = image.image.data();
+        size = image.image.size();
+        if (mimeType.empty()) {
+          mimeType = ExtToMime(GetFilePathExtension(image.uri));
+        }
+      } else {
+        if (!image.as_is && !image.image.empty()) {
+          // Encode through the image writer.
+          encodedUris.emplace_back(i, image.uri);
+          UpdateImageObject(image, baseDir, int(i), true, WriteImageData,
+                            user_data);
+          updated = true;
+        }
+        if (IsDataURI(image.uri)) {
+          layout->imageData.emplace_back();
+          if (DecodeDataURI(&layout->imageData.back(), mimeType, image.uri, 0,
+                            false)) {
+            data = layout->imageData.back().data();
+            size = layout->imageData.back().size();
+          }
+        }
+      }
+      if (data && !mimeType.empty()) {
+        BufferView view;
+        view.buffer = 0;
+        view.byteOffset = AddGlbBinSegment(layout, data, size);
+        view.byteLength = size;
+        bufferView = int(model->bufferViews.size() + layout->imageViews.size());
+        layout->imageViews.push_back(view);
+      }
+    }
+    if (bufferView == -1 && !updated) {
+      UpdateImageObject(image, baseDir, int(i), embedImages, WriteImageData,
+                        user_data);
+    }
+    layout->imageBufferViews.push_back(bufferView);
+    layout->imageMimeTypes.push_back(mimeType);
+  }
+  if (layout->size > maxSize) {
+    for (const std::pair<size_t, std::string> &uri : encodedUris) {
+      model->images[uri.first].uri = uri.second;
+    }
+    *layout = GlbBinLayout();
+    return false;
+  }
+  return true;
 }
 
+// Serializes the packed buffer and the images of `layout`.
+template <typename J>
+static void SerializeGlbBinLayout(Model *model, const GlbBinLayout &layout,
+                                  J &o) {
+  if (model->buffers.size() || layout.size) {
+    J buffers;
+    J buffer;
+    SerializeNumberProperty<size_t>("byteLength", layout.size, buffer);
+    if (model->buffers.size()) {
+      // The packed buffer takes over the name, extras and extensions of the
+      // first buffer.
+      if (model->buffers[0].name.size()) {
+        SerializeStringProperty("name", model->buffers[0].name, buffer);
+      }
+      if (model->buffers[0].extras.Type() != NULL_TYPE) {
+        SerializeValue("extras", model->buffers[0].extras, buffer);
+      }
+      SerializeExtensionMap(model->buffers[0].extensions, buffer);
+    }
+    JsonPushBack(buffers, std::move(buffer));
+    JsonAddMember(o, "buffers", std::move(buffers));
+  }
+
+  if (model->images.size()) {
+    J images;
+    JsonReserveArray(images, model->images.size());
+    for (size_t i = 0; i < model->images.size(); ++i) {
+      J image;
+      SerializeGltfImage(model->images[i], image, layout.imageBufferViews[i],
+                         layout.imageMimeTypes[i]);
+      JsonPushBack(images, std::move(image));
+    }
+    JsonAddMember(o, "images", std::move(images));
+  }
+}
+
+template <typename T, typename Fn>
+static void VisitExtrasOwner(T *object, const Fn &fn) {
+  fn(object->lazy_extras, &object->extras, &object->extensions);
+}
+
+template <typename T, typename A, typename Fn>
+static void VisitExtrasOwners(std::vector<T, A> &objects, const Fn &fn) {
+  for (T &object : objects) {
+    VisitExtrasOwner(&object, fn);
+  }
+}
+
+///
+/// Calls `fn(lazy_extras, extras, extensions)` for each object of `model`
+/// with `extras` and `extensions`. `extras` is nullptr for the targets of
+/// animation channels, which only have extensions.
+///
+template <typename Fn>
+static void ForEachExtrasOwner(Model *model, const Fn &fn) {
+  VisitExtrasOwner(model, fn);
+  VisitExtrasOwner(&model->asset, fn);
+  VisitExtrasOwners(model->accessors, fn);
+  for (Animation &animation : model->animations) {
+    VisitExtrasOwner(&animation, fn);
+    for (AnimationChannel &channel : animation.channels) {
+      VisitExtrasOwner(&channel, fn);
+      fn(channel.target_lazy_extras, nullptr, &channel.target_extensions);
+    }
+    VisitExtrasOwners(animation.samplers, fn);
+  }
+  VisitExtrasOwners(model->buffers, fn);
+  VisitExtrasOwners(model->bufferViews, fn);
+  for (Camera &camera : model->cameras) {
+    VisitExtrasOwner(&camera, fn);
+    VisitExtrasOwner(&camera.perspective, fn);
+    VisitExtrasOwner(&camera.orthographic, fn);
+  }
+  VisitExtrasOwners(model->images, fn);
+  for (Material &material : model->materials) {
+    PbrMetallicRoughness &pbr = material.pbrMetallicRoughness;
+    VisitExtrasOwner(&material, fn);
+    VisitExtrasOwner(&pbr, fn);
+    VisitExtrasOwner(&pbr.baseColorTexture, fn);
+    VisitExtrasOwner(&pbr.metallicRoughnessTexture, fn);
+    VisitExtrasOwner(&material.normalTexture, fn);
+    VisitExtrasOwner(&material.occlusionTexture, fn);
+    VisitExtrasOwner(&material.emissiveTexture, fn);
+  }
+  for (Mesh &mesh : model->meshes) {
+    VisitExtrasOwner(&mesh, fn);
+    VisitExtrasOwners(mesh.primitives, fn);
+  }
+  VisitExtrasOwners(model->nodes, fn);
+  VisitExtrasOwners(model->samplers, fn);
+  VisitExtrasOwners(model->scenes, fn);
+  VisitExtrasOwners(model->skins, fn);
+  VisitExtrasOwners(model->textures, fn);
+  for (Light &light : model->lights) {
+    VisitExtrasOwner(&light, fn);
+    VisitExtrasOwner(&light.spot, fn);
+  }
+}
+
+///
+/// Adds the lazily loaded `extras` and `extensions` of the objects of `model`
+/// (see LazyExtras) to their members while the model is written, so a lazily
+/// loaded model is saved like an eagerly loaded one. What was added is
+/// removed again on destruction.
+///
+class LazyExtrasWriteScope {
+ public:
+  explicit LazyExtrasWriteScope(Model *model) {
+    ForEachExtrasOwner(model, [&](const LazyExtras &lazy, Value *extras,
+                                  ExtensionMap *extensions) {
+      if (lazy.Empty()) {
+        return;
+      }
+      if (extras && extras->Type() == NULL_TYPE && lazy.GetExtras(extras)) {
+        extras_.push_back(extras);
+      }
+      ExtensionMap lazy_extensions;
+      if (!lazy.GetExtensions(&lazy_extensions)) {
+        return;
+      }
+      // Extensions of the object replace the lazy ones of the same name.
+      for (auto &extension : lazy_extensions) {
+        if (extensions->find(extension.first) == extensions->end()) {
+          extensions_.emplace_back(extensions, extension.first);
+          (*extensions)[extension.first] = std::move(extension.second);
+        }
+      }
+    });
+  }
+  ~LazyExtrasWriteScope() {
+    for (Value *extras : extras_) {
+      *extras = Value();
+    }
+    for (const auto &extension : extensions_) {
+      extension.first->erase(extension.second);
+    }
+  }
+  LazyExtrasWriteScope(const LazyExtrasWriteScope &) = delete;
+  LazyExtrasWriteScope &operator=(const LazyExtrasWriteScope &) = delete;
+
+ private:
+  std::vector<Value *> extras_;
+  std::vector<std::pair<ExtensionMap *, ExtensionMap::key_type> > extensions_;
+};
+
+// Root value of the JSON output: JsonDocument for the DOM(`json`).
+template <typename J>
+struct JsonOutputDocument {
+  typedef J type;
+};
+
+#ifndef TINYGLTF_USE_SIMDJSON
+template <>
+struct JsonOutputDocument<json> {
+  typedef JsonDocument type;
+};
+#endif
+
 bool TinyGLTF::WriteGltfSceneToStream(Model *model, std::ostream &stream,
                                       bool prettyPrint = true,
                                       bool writeBinary = false) {
-  JsonDocument output;
+#ifdef TINYGLTF_USE_SIMDJSON
+  return WriteGltfSceneToStream<JsonWriterValue>(model, stream, prettyPrint,
+                                                 writeBinary);
+#else
+  if (direct_json_writer_) {
+    return WriteGltfSceneToStream<JsonWriterValue>(model, stream, prettyPrint,
+                                                   writeBinary);
+  }
+  return WriteGltfSceneToStream<json>(model, stream, prettyPrint, writeBinary);
+#endif
+}
+
+template <typename J>
+bool TinyGLTF::WriteGltfSceneToStream(Model *model, std::ostream &stream,
+                                      bool prettyPrint, bool writeBinary) {
+  LazyExtrasWriteScope lazy_extras(model);
+  typename JsonOutputDocument<J>::type output;
+
+  if (writeBinary && pack_glb_buffers_) {
+    GlbBinLayout layout;
+    std::string dummystring = "";
+    if (BuildGlbBinLayout(model, dummystring, true, false,
+                          &this->WriteImageData, this->write_image_user_data_,
+                          &layout)) {
+      SerializeGltfModel<J>(model, output, ResolveNumThreads(num_threads_),
+                         &layout);
+      SerializeGlbBinLayout<J>(model, layout, output);
+      return WriteBinaryGltfStream(stream, JsonToString(output),
+                                   layout.segments);
+    }
+  }
 
   /// Serialize all properties except buffers and images.
-  SerializeGltfModel(model, output);
+  SerializeGltfModel<J>(model, output, ResolveNumThreads(num_threads_));
 
   // BUFFERS
-  std::vector<unsigned char> binBuffer;
+  // GLB BIN chunk. Points into the model's buffer.
+  std::vector<GlbBinSegment> binSegments;
   if (model->buffers.size()) {
-    json buffers;
+    J buffers;
     JsonReserveArray(buffers, model->buffers.size());
     for (unsigned int i = 0; i < model->buffers.size(); ++i) {
-      json buffer;
+      J buffer;
       if (writeBinary && i == 0 && model->buffers[i].uri.empty()) {
-        SerializeGltfBufferBin(model->buffers[i], buffer, binBuffer);
+        if (uint64_t(model->buffers[i].DataSize()) + kGlbChunksOverhead >
+            uint64_t((std::numeric_limits<uint32_t>::max)())) {
+          // Does not fit in the GLB and can't be split into an external file
+          // when writing to a stream.
+          return false;
+        }
+        SerializeGltfBufferBin(model->buffers[i], buffer);
+        const GlbBinSegment segment = {model->buffers[i].DataPtr(),
+                                       model->buffers[i].DataSize(), 0};
+        binSegments.push_back(segment);
       } else {
         SerializeGltfBuffer(model->buffers[i], buffer);
       }
@@ -7645,10 +13846,10 @@ bool TinyGLTF::WriteGltfSceneToStream(Model *model, std::ostream &stream,
 
   // IMAGES
   if (model->images.size()) {
-    json images;
+    J images;
     JsonReserveArray(images, model->images.size());
     for (unsigned int i = 0; i < model->images.size(); ++i) {
-      json image;
+      J image;
 
       std::string dummystring = "";
       // UpdateImageObject need baseDir but only uses it if embeddedImages is
@@ -7663,7 +13864,7 @@ bool TinyGLTF::WriteGltfSceneToStream(Model *model, std::ostream &stream,
   }
 
   if (writeBinary) {
-    WriteBinaryGltfStream(stream, JsonToString(output), binBuffer);
+    return WriteBinaryGltfStream(stream, JsonToString(output), binSegments);
   } else {
     WriteGltfStream(stream, JsonToString(output, prettyPrint ? 2 : -1));
   }
@@ -7676,7 +13877,25 @@ bool TinyGLTF::WriteGltfSceneToFile(Model *model, const std::string &filename,
                                     bool embedBuffers = false,
                                     bool prettyPrint = true,
                                     bool writeBinary = false) {
-  JsonDocument output;
+#ifdef TINYGLTF_USE_SIMDJSON
+  return WriteGltfSceneToFile<JsonWriterValue>(
+      model, filename, embedImages, embedBuffers, prettyPrint, writeBinary);
+#else
+  if (direct_json_writer_) {
+    return WriteGltfSceneToFile<JsonWriterValue>(
+        model, filename, embedImages, embedBuffers, prettyPrint, writeBinary);
+  }
+  return WriteGltfSceneToFile<json>(model, filename, embedImages, embedBuffers,
+                                    prettyPrint, writeBinary);
+#endif
+}
+
+template <typename J>
+bool TinyGLTF::WriteGltfSceneToFile(Model *model, const std::string &filename,
+                                    bool embedImages, bool embedBuffers,
+                                    bool prettyPrint, bool writeBinary) {
+  LazyExtrasWriteScope lazy_extras(model);
+  typename JsonOutputDocument<J>::type output;
   std::string defaultBinFilename = GetBaseFilename(filename);
   std::string defaultBinFileExt = ".bin";
   std::string::size_type pos =
@@ -7689,20 +13908,45 @@ bool TinyGLTF::WriteGltfSceneToFile(Model *model, const std::string &filename,
   if (baseDir.empty()) {
     baseDir = "./";
   }
+
+  if (writeBinary && pack_glb_buffers_) {
+    GlbBinLayout layout;
+    if (BuildGlbBinLayout(model, baseDir, embedImages, embedImages,
+                          &this->WriteImageData, this->write_image_user_data_,
+                          &layout)) {
+      SerializeGltfModel<J>(model, output, ResolveNumThreads(num_threads_),
+                         &layout);
+      SerializeGlbBinLayout<J>(model, layout, output);
+      return WriteBinaryGltfFile(filename, JsonToString(output),
+                                 layout.segments);
+    }
+  }
+
   /// Serialize all properties except buffers and images.
-  SerializeGltfModel(model, output);
+  SerializeGltfModel<J>(model, output, ResolveNumThreads(num_threads_));
 
   // BUFFERS
   std::vector<std::string> usedUris;
-  std::vector<unsigned char> binBuffer;
+  // GLB BIN chunk. Points into the model's buffer.
+  std::vector<GlbBinSegment> binSegments;
   if (model->buffers.size()) {
-    json buffers;
+    J buffers;
     JsonReserveArray(buffers, model->buffers.size());
     for (unsigned int i = 0; i < model->buffers.size(); ++i) {
-      json buffer;
-      if (writeBinary && i == 0 && model->buffers[i].uri.empty()) {
-        SerializeGltfBufferBin(model->buffers[i], buffer, binBuffer);
-      } else if (embedBuffers) {
+      J buffer;
+      // The GLB container is limited to 4GB. A larger GLB-stored buffer is
+      // split into an external .bin file instead.
+      const bool tooLargeForGlb =
+          writeBinary &&
+          (uint64_t(model->buffers[i].DataSize()) + kGlbChunksOverhead >
+           uint64_t((std::numeric_limits<uint32_t>::max)()));
+      if (writeBinary && i == 0 && model->buffers[i].uri.empty() &&
+          !tooLargeForGlb) {
+        SerializeGltfBufferBin(model->buffers[i], buffer);
+        const GlbBinSegment segment = {model->buffers[i].DataPtr(),
+                                       model->buffers[i].DataSize(), 0};
+        binSegments.push_back(segment);
+      } else if (embedBuffers && !tooLargeForGlb) {
         SerializeGltfBuffer(model->buffers[i], buffer);
       } else {
         std::string binSavePath;
@@ -7739,10 +13983,10 @@ bool TinyGLTF::WriteGltfSceneToFile(Model *model, const std::string &filename,
 
   // IMAGES
   if (model->images.size()) {
-    json images;
+    J images;
     JsonReserveArray(images, model->images.size());
     for (unsigned int i = 0; i < model->images.size(); ++i) {
-      json image;
+      J image;
 
       UpdateImageObject(model->images[i], baseDir, int(i), embedImages,
                         &this->WriteImageData, this->write_image_user_data_);
@@ -7753,7 +13997,7 @@ bool TinyGLTF::WriteGltfSceneToFile(Model *model, const std::string &filename,
   }
 
   if (writeBinary) {
-    WriteBinaryGltfFile(filename, JsonToString(output), binBuffer);
+    return WriteBinaryGltfFile(filename, JsonToString(output), binSegments);
   } else {
     WriteGltfFile(filename, JsonToString(output, (prettyPrint ? 2 : -1)));
   }